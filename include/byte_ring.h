@@ -0,0 +1,66 @@
+// Single-producer/single-consumer byte FIFO for streaming output
+//
+// The producer appends whole records or nothing, so a full buffer drops a record
+// instead of splitting it. The consumer reads contiguous spans so it can hand
+// large chunks straight to Serial.write().
+
+#ifndef BYTE_RING_H
+#define BYTE_RING_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <atomic>
+
+template <size_t N>
+class ByteRing {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "ByteRing size must be a power of two");
+
+public:
+    ByteRing() : head(0), tail(0) {}
+
+    // Producer: free space in bytes
+    size_t space() const {
+        return N - (head.load(std::memory_order_relaxed) - tail.load(std::memory_order_acquire));
+    }
+
+    // Producer: appends len bytes, or nothing if they do not fit
+    bool write(const void* data, size_t len) {
+        if (len > space()) return false;
+        uint32_t h = head.load(std::memory_order_relaxed);
+        size_t off = h & (N - 1);
+        size_t first = (len < N - off) ? len : N - off;
+        memcpy(&buf[off], data, first);
+        memcpy(&buf[0], (const uint8_t*)data + first, len - first);
+        head.store(h + len, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer: bytes waiting to be read
+    size_t available() const {
+        return head.load(std::memory_order_acquire) - tail.load(std::memory_order_relaxed);
+    }
+
+    // Consumer: longest readable run starting at the read position
+    size_t peek(const uint8_t** out) const {
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        size_t avail = head.load(std::memory_order_acquire) - t;
+        size_t off = t & (N - 1);
+        *out = &buf[off];
+        return (avail < N - off) ? avail : N - off;
+    }
+
+    // Consumer: releases n bytes returned by peek()
+    void consume(size_t n) {
+        tail.store(tail.load(std::memory_order_relaxed) + n, std::memory_order_release);
+    }
+
+    size_t capacity() const { return N; }
+
+private:
+    uint8_t buf[N];
+    std::atomic<uint32_t> head;   // Written by producer only
+    std::atomic<uint32_t> tail;   // Written by consumer only
+};
+
+#endif // BYTE_RING_H
@@ -0,0 +1,105 @@
+// Capture ring between the promiscuous RX callback and the parser task
+//
+// The WiFi driver callback is the only producer and the parser task is the only
+// consumer, so the ring needs no locks: each side owns one index and publishes
+// it with release/acquire ordering. The producer fills slots in place so a frame
+// is copied exactly once on the RX path.
+
+#ifndef CAPTURE_RING_H
+#define CAPTURE_RING_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+#ifndef CAPTURE_RING_SLOTS
+#define CAPTURE_RING_SLOTS 64      // Must be a power of two
+#endif
+
+#ifndef CAPTURE_SNAP_LEN
+#define CAPTURE_SNAP_LEN 256       // Bytes of each frame kept for parsing
+#endif
+
+#define CAPTURE_HT_40MHZ 0x01
+#define CAPTURE_HT_SGI   0x02
+
+#define CAPTURE_SEQ_VALID 0x01     // seq_ctrl holds the frame's sequence control field
+#define CAPTURE_RETRY     0x02     // Retry bit set in frame control
+
+// One received frame: the rx_ctrl fields we use plus the first bytes of the frame
+struct CapturedFrame {
+    uint32_t timestamp;    // rx_ctrl.timestamp, microseconds
+    uint16_t sig_len;      // Length on air, including FCS
+    uint16_t cap_len;      // Bytes valid in data[]
+    int8_t rssi;
+    int8_t noise_floor;
+    uint8_t channel;
+    uint8_t rate;          // Legacy PHY rate index (sig_mode 0)
+    uint8_t sig_mode;      // 0: 11b/g, 1: 11n, 3: VHT
+    uint8_t mcs;           // HT MCS index (sig_mode 1)
+    uint8_t ht_flags;      // CAPTURE_HT_40MHZ | CAPTURE_HT_SGI
+    uint8_t pkt_type;      // wifi_promiscuous_pkt_type_t
+    uint16_t hop_epoch;    // Channel hopper dwell the frame was captured in
+    uint16_t seq_ctrl;     // Sequence number << 4 | fragment number (management and data frames)
+    uint8_t seq_flags;     // CAPTURE_SEQ_VALID | CAPTURE_RETRY
+    uint8_t data[CAPTURE_SNAP_LEN];
+};
+
+template <typename T, size_t N>
+class SpscRing {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "SpscRing size must be a power of two");
+
+public:
+    SpscRing() : head(0), tail(0), dropped_count(0), pushed_count(0), peak_fill(0) {}
+
+    // Producer: returns the next free slot, or nullptr (and counts a drop) when full
+    T* acquire() {
+        uint32_t h = head.load(std::memory_order_relaxed);
+        uint32_t t = tail.load(std::memory_order_acquire);
+        if (h - t >= N) {
+            dropped_count.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        uint32_t fill = h - t + 1;
+        if (fill > peak_fill.load(std::memory_order_relaxed)) {
+            peak_fill.store(fill, std::memory_order_relaxed);
+        }
+        return &slots[h & (N - 1)];
+    }
+
+    // Producer: makes the slot returned by acquire() visible to the consumer
+    void publish() {
+        head.store(head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        pushed_count.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Consumer: number of frames ready to read
+    size_t available() const {
+        return head.load(std::memory_order_acquire) - tail.load(std::memory_order_relaxed);
+    }
+
+    // Consumer: i-th ready frame, valid until consume() releases it
+    const T& peek(size_t i) const {
+        return slots[(tail.load(std::memory_order_relaxed) + i) & (N - 1)];
+    }
+
+    // Consumer: hands n slots back to the producer
+    void consume(size_t n) {
+        tail.store(tail.load(std::memory_order_relaxed) + n, std::memory_order_release);
+    }
+
+    size_t capacity() const { return N; }
+    uint32_t dropped() const { return dropped_count.load(std::memory_order_relaxed); }
+    uint32_t pushed() const { return pushed_count.load(std::memory_order_relaxed); }
+    uint32_t peak() const { return peak_fill.load(std::memory_order_relaxed); }
+
+private:
+    T slots[N];
+    std::atomic<uint32_t> head;   // Written by producer only
+    std::atomic<uint32_t> tail;   // Written by consumer only
+    std::atomic<uint32_t> dropped_count;
+    std::atomic<uint32_t> pushed_count;
+    std::atomic<uint32_t> peak_fill;
+};
+
+#endif // CAPTURE_RING_H
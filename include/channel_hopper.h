@@ -0,0 +1,112 @@
+// Activity-weighted channel hopping
+//
+// Each dwell measures how many frames and how many new devices its channel
+// produced. Per-channel rates are smoothed and turn into a weight that sets both
+// the next dwell time and how soon the channel is picked again, so busy channels
+// (typically 1/6/11) get most of the radio time. A revisit bound keeps quiet
+// channels from being starved, and while the target is being heard the hopper
+// parks on its channel.
+//
+// poll() and begin_dwell() run on the task that owns esp_wifi_set_channel();
+// on_frame(), on_discovery() and on_target() run on the parser task. Frames carry the hop epoch they were
+// captured in, so frames queued before a hop never count toward the next dwell.
+
+#ifndef CHANNEL_HOPPER_H
+#define CHANNEL_HOPPER_H
+
+#include <stdint.h>
+#include <atomic>
+
+#define HOP_CHANNEL_MAX 13
+
+#ifndef HOP_FIXED_DWELL_MS
+#define HOP_FIXED_DWELL_MS 3000            // Round-robin dwell when adaptive hopping is off
+#endif
+#ifndef HOP_MIN_DWELL_MS
+#define HOP_MIN_DWELL_MS 300               // Shortest dwell, given to idle channels
+#endif
+#ifndef HOP_MAX_DWELL_MS
+#define HOP_MAX_DWELL_MS 3000              // Longest dwell, given to the busiest channel
+#endif
+#ifndef HOP_MAX_REVISIT_MS
+#define HOP_MAX_REVISIT_MS 20000           // Every channel is visited at least this often (0 = no bound)
+#endif
+#ifndef HOP_TARGET_LOCK_MS
+#define HOP_TARGET_LOCK_MS 15000           // Stay on the target's channel while it was heard this recently
+#endif
+
+#define HOP_RATE_ALPHA 0.3f                // EWMA weight of the newest dwell
+#define HOP_FRAME_WEIGHT 1.0f              // Score contribution of relative frame rate
+#define HOP_DISCOVERY_WEIGHT 2.0f          // Score contribution of relative new-device rate
+
+struct HopChannelStats {
+    float frame_rate;          // Smoothed frames/s while tuned to the channel
+    float discovery_rate;      // Smoothed new devices/s while tuned to the channel
+    uint32_t last_visit;       // millis() when the last dwell on it ended
+    uint32_t visits;
+    uint32_t dwell_ms_total;
+};
+
+class ChannelHopper {
+public:
+    ChannelHopper();
+
+    // Starts the first dwell on channel at time now
+    void begin(int channel, uint32_t now);
+
+    // Parser task: credits a frame captured in epoch on channel to the current dwell
+    void on_frame(int channel, uint16_t epoch) {
+        if (in_dwell(channel, epoch)) dwell_frames.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Parser task: the frame also added a device to a registry
+    void on_discovery(int channel, uint16_t epoch) {
+        if (in_dwell(channel, epoch)) dwell_new.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Parser task: the target was just heard on channel
+    void on_target(int channel, uint32_t now) {
+        target_channel.store(channel, std::memory_order_relaxed);
+        target_seen.store(now, std::memory_order_relaxed);
+    }
+
+    // Returns true when the current dwell is over and stores the channel to tune next.
+    // The caller switches the radio and then calls begin_dwell().
+    bool poll(uint32_t now, int* next_channel);
+
+    // Closes the current dwell and opens one on channel, advancing the epoch
+    void begin_dwell(int channel, uint32_t now);
+
+    // RX callback: epoch to stamp on captured frames
+    uint16_t epoch() const { return current_epoch.load(std::memory_order_acquire); }
+
+    // Any task (the console): takes effect from the next dwell
+    void set_adaptive(bool on) { adaptive.store(on, std::memory_order_relaxed); }
+    bool is_adaptive() const { return adaptive.load(std::memory_order_relaxed); }
+    bool is_locked(uint32_t now) const;
+    int channel() const { return dwell_channel.load(std::memory_order_relaxed); }
+    uint32_t dwell_ms() const { return dwell_length; }
+    const HopChannelStats& stats(int channel) const { return chan[channel]; }
+
+private:
+    bool in_dwell(int channel, uint16_t epoch) const {
+        return epoch == current_epoch.load(std::memory_order_acquire) &&
+               channel == dwell_channel.load(std::memory_order_relaxed);
+    }
+    float score(int channel) const;
+    uint32_t dwell_for(int channel) const;
+    int pick_next(uint32_t now) const;
+
+    HopChannelStats chan[HOP_CHANNEL_MAX + 1];   // Index 0 unused
+    std::atomic<bool> adaptive;
+    uint32_t dwell_start;
+    uint32_t dwell_length;
+    std::atomic<uint16_t> current_epoch;
+    std::atomic<int> dwell_channel;
+    std::atomic<uint32_t> dwell_frames;
+    std::atomic<uint32_t> dwell_new;
+    std::atomic<int> target_channel;
+    std::atomic<uint32_t> target_seen;
+};
+
+#endif // CHANNEL_HOPPER_H
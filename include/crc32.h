@@ -0,0 +1,20 @@
+// CRC-32 (IEEE 802.3, the zlib/PNG polynomial) for flash snapshots and the
+// telemetry stream
+//
+// A 16-entry table processes four bits at a time: 64 bytes of flash instead of
+// 1 KB, at about half the speed of a byte table, which is plenty for the few
+// kilobytes per second these callers checksum.
+
+#ifndef CRC32_H
+#define CRC32_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define CRC32_INIT 0
+
+// Continues crc (CRC32_INIT for a new message) over len bytes;
+// crc32_update(crc32_update(0, a), b) equals the CRC of a followed by b
+uint32_t crc32_update(uint32_t crc, const void* data, size_t len);
+
+#endif // CRC32_H
@@ -0,0 +1,54 @@
+// 802.11 MAC header decoding for data frames
+//
+// The ToDS/FromDS bits of the frame control field decide which of the three or
+// four address fields holds the BSSID, the station and the end points
+// (IEEE 802.11-2020 Table 9-30):
+//
+//   ToDS FromDS   Addr1      Addr2      Addr3   Addr4
+//    0    0       DA         SA         BSSID   -        IBSS / direct link
+//    1    0       BSSID      SA         DA      -        station -> AP
+//    0    1       DA         BSSID      SA      -        AP -> station
+//    1    1       RA         TA         DA      SA       WDS / mesh, no BSS
+//
+// Decoding is a few loads per frame, so clients can be attributed to their BSS
+// exactly instead of guessed from RSSI.
+
+#ifndef DOT11_HEADER_H
+#define DOT11_HEADER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "mac_addr.h"
+
+// Frame control flags (little-endian 16-bit field)
+#define FC_TO_DS      0x0100
+#define FC_FROM_DS    0x0200
+#define FC_MORE_FRAG  0x0400
+#define FC_RETRY      0x0800
+#define FC_PROTECTED  0x4000
+#define FC_ORDER      0x8000
+
+// Data frame subtype bits
+#define DATA_SUBTYPE_NULL 0x04       // No frame body (Null, QoS Null, CF-*)
+#define DATA_SUBTYPE_QOS  0x08       // QoS control field present
+
+#define DOT11_DATA_HEADER_MIN 24
+
+struct DataFrameAddrs {
+    MacAddr receiver;       // Addr1
+    MacAddr transmitter;    // Addr2; the RSSI belongs to this address
+    MacAddr dst;            // Final destination (DA)
+    MacAddr src;            // Original source (SA)
+    MacAddr bssid;          // Zero for WDS frames
+    MacAddr station;        // Non-AP end of the link, zero for WDS frames
+    bool station_is_transmitter;
+    bool wds;
+    bool qos;
+    bool null_data;
+    uint8_t header_len;     // Offset of the frame body
+};
+
+// Decodes the address fields of a data frame; false if the header is truncated
+bool decode_data_addrs(const uint8_t* frame, size_t len, DataFrameAddrs* out);
+
+#endif // DOT11_HEADER_H
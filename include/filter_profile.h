@@ -0,0 +1,105 @@
+// Hardware promiscuous filter profiles
+//
+// The driver can drop whole frame classes before the RX callback runs, which
+// saves the callback, the ring copy and the parse. Each profile passes the
+// classes one kind of view needs:
+//   discovery  management only: beacons, probes, (re)association, auth;
+//              only when pinned, as it starves the client and hopper counts
+//   hunt       management and data: client traffic and the watched targets
+//   full       management, data and control: airtime, retries and pcap export
+// The hardware filters by frame class only; the hunt profile cannot be narrowed
+// to the targets' addresses, so the watchlist match stays in the parser.
+//
+// Each profile keeps its own callback and parse counts, the cycles spent in
+// both and the time it was active, so the savings can be read off one run.
+// apply() runs on the UI task; on_callback() in the WiFi driver task and
+// on_parse() on the parser task. Each counter has one writer, and readers
+// accept a torn sample as the latency probes do.
+
+#ifndef FILTER_PROFILE_H
+#define FILTER_PROFILE_H
+
+#include <stdint.h>
+#include <atomic>
+#include "esp_wifi.h"
+#include "latency_probe.h"
+
+enum FilterProfile : uint8_t {
+    FILTER_DISCOVERY,
+    FILTER_HUNT,
+    FILTER_FULL,
+    FILTER_PROFILES
+};
+
+struct FilterStats {
+    uint32_t callbacks;        // RX callbacks while the profile was active
+    uint32_t parsed;           // Frames through process_frame()
+    uint64_t rx_ticks;         // probe_ticks() spent in the callback
+    uint64_t parse_ticks;      // ... and in process_frame()
+    uint32_t active_ms;        // Time the profile was applied, up to the snapshot
+    uint32_t activations;
+};
+
+class PromiscFilter {
+public:
+    PromiscFilter();
+
+    // UI task: programs the driver's filter for p; false when p is already
+    // active or the driver refused it
+    bool apply(FilterProfile p, uint32_t now);
+
+    FilterProfile active() const { return (FilterProfile)current.load(std::memory_order_relaxed); }
+
+    // RX callback: one delivered frame and the ticks it took
+    void on_callback(uint32_t ticks) {
+        FilterStats& s = stats[current.load(std::memory_order_relaxed)];
+        s.callbacks++;
+        s.rx_ticks += ticks;
+    }
+
+    // Parser task: one frame parsed
+    void on_parse(uint32_t ticks) {
+        FilterStats& s = stats[current.load(std::memory_order_relaxed)];
+        s.parsed++;
+        s.parse_ticks += ticks;
+    }
+
+    // Copies the counters, crediting the active profile with the time up to now
+    void snapshot(FilterStats out[FILTER_PROFILES], uint32_t now) const;
+
+    // Zeroes every counter; the active profile's time restarts at now
+    void reset(uint32_t now);
+
+    // Whether the hardware passes a frame of this class under p (used by the
+    // host replay, which has no driver to do it)
+    static bool passes(FilterProfile p, wifi_promiscuous_pkt_type_t type);
+
+    static const char* name(FilterProfile p);
+
+    // "discovery", "hunt" or "full"; false for anything else
+    static bool parse(const char* text, FilterProfile* out);
+
+private:
+    FilterStats stats[FILTER_PROFILES];
+    std::atomic<uint8_t> current;
+    bool programmed;           // The driver still has its default filter until the first apply()
+    uint32_t active_since;
+};
+
+// Times the rest of the enclosing block for the active profile's callback
+// (rx = true) or parse counter
+class FilterCostScope {
+public:
+    FilterCostScope(PromiscFilter& filter, bool rx) : filter(filter), rx(rx), start(probe_ticks()) {}
+    ~FilterCostScope() {
+        uint32_t ticks = probe_ticks() - start;
+        if (rx) filter.on_callback(ticks);
+        else filter.on_parse(ticks);
+    }
+private:
+    PromiscFilter& filter;
+    bool rx;
+    uint32_t start;
+};
+
+#endif // FILTER_PROFILE_H
@@ -0,0 +1,90 @@
+// Fixed-capacity overwrite-oldest ring of POD records
+//
+// The record array is allocated once in begin(), in PSRAM when the board has
+// it, so the ring can hold thousands of entries; push() copies one record and
+// never allocates. Every pushed record gets a sequence number. A reader takes
+// a snapshot (the range of sequence numbers held at that moment) and walks it
+// with at(); records overwritten since the snapshot come back as nullptr, so a
+// long walk can never read a slot twice or follow a wrapped index.
+//
+// Not thread-safe; the sniffer pushes and the UI reads under registry_mutex.
+
+#ifndef HISTORY_RING_H
+#define HISTORY_RING_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <type_traits>
+#include "pool_alloc.h"
+
+template <typename T>
+class HistoryRing {
+    static_assert(std::is_trivially_copyable<T>::value, "history records are copied as plain bytes");
+
+public:
+    // Sequence numbers [begin, end) held when snapshot() was called
+    struct Snapshot {
+        uint32_t begin;
+        uint32_t end;
+        uint32_t size() const { return end - begin; }
+    };
+
+    HistoryRing() : slots(nullptr), cap(0), head(0), pushed(0) {}
+    ~HistoryRing() { pool_free(slots); }
+
+    bool begin(uint32_t capacity) {
+        slots = (T*)pool_calloc((size_t)capacity * sizeof(T), POOL_PSRAM);
+        if (slots == nullptr) return false;
+        cap = capacity;
+        head = 0;
+        pushed = 0;
+        return true;
+    }
+
+    // Appends a record, overwriting the oldest when full
+    void push(const T& record) {
+        if (cap == 0) return;
+        slots[head] = record;
+        if (++head == cap) head = 0;
+        pushed++;
+    }
+
+    Snapshot snapshot() const {
+        Snapshot s;
+        s.end = pushed;
+        s.begin = pushed > cap ? pushed - cap : 0;
+        return s;
+    }
+
+    // Record with sequence number seq, or nullptr if not (or no longer) held
+    const T* at(uint32_t seq) const {
+        if (seq >= pushed || pushed - seq > cap) return nullptr;
+        return &slots[seq % cap];
+    }
+
+    // Copies up to max of the newest records into out, newest first
+    size_t copy_newest(T* out, size_t max) const {
+        Snapshot s = snapshot();
+        size_t n = 0;
+        for (uint32_t seq = s.end; seq != s.begin && n < max; n++) out[n] = slots[--seq % cap];
+        return n;
+    }
+
+    void clear() { head = pushed = 0; }
+
+    uint32_t size() const { return pushed < cap ? pushed : cap; }
+    uint32_t capacity() const { return cap; }
+    uint32_t total_pushed() const { return pushed; }
+    size_t footprint() const { return (size_t)cap * sizeof(T); }
+
+private:
+    T* slots;
+    uint32_t cap;
+    uint32_t head;             // Slot of the next push (pushed % cap without the divide)
+    uint32_t pushed;
+
+    HistoryRing(const HistoryRing&);
+    HistoryRing& operator=(const HistoryRing&);
+};
+
+#endif // HISTORY_RING_H
@@ -0,0 +1,116 @@
+// 802.11 information element (tagged parameter) parsing
+//
+// IeIterator walks the TLV list of a management frame body without copying:
+// each step yields the element id, its length and a pointer into the frame.
+// Iteration stops at the first element that would run past the buffer.
+// parse_security() builds on it to decode RSN and WPA elements.
+
+#ifndef IE_PARSER_H
+#define IE_PARSER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Offset of the first tagged parameter in each management frame body
+#define IE_OFFSET_BEACON 36          // 24 header + timestamp, interval, capability
+#define IE_OFFSET_PROBE_REQUEST 24
+#define IE_OFFSET_ASSOC_REQUEST 28   // 24 header + capability, listen interval
+#define IE_OFFSET_REASSOC_REQUEST 34 // ... + current AP address
+#define CAPABILITY_OFFSET 34         // Capability info in beacons/probe responses
+
+// Element ids
+#define IE_SSID 0
+#define IE_DS_PARAMS 3
+#define IE_RSN 48
+#define IE_VENDOR 221
+
+struct IeView {
+    uint8_t id;
+    uint8_t len;
+    const uint8_t* data;
+};
+
+class IeIterator {
+public:
+    IeIterator(const uint8_t* buf, size_t len) : pos(buf), end(buf + len), truncated(false) {}
+
+    // Fills out with the next element; false at the end of the list
+    bool next(IeView* out) {
+        if (end - pos < 2) return false;
+        uint8_t len = pos[1];
+        if ((size_t)(end - pos) < (size_t)len + 2) {
+            truncated = true;
+            return false;
+        }
+        out->id = pos[0];
+        out->len = len;
+        out->data = pos + 2;
+        pos += 2 + len;
+        return true;
+    }
+
+    // True if the list ended with an element longer than the remaining bytes
+    bool was_truncated() const { return truncated; }
+
+private:
+    const uint8_t* pos;
+    const uint8_t* end;
+    bool truncated;
+};
+
+// Finds the first element with the given id
+bool ie_find(const uint8_t* buf, size_t len, uint8_t id, IeView* out);
+
+// Copies an SSID element into out (33 bytes, NUL-terminated); false if absent or empty
+bool ie_copy_ssid(const uint8_t* buf, size_t len, char* out);
+
+// Cipher suites (bitmask for pairwise, single value for group)
+enum : uint8_t {
+    CIPHER_WEP40   = 0x01,
+    CIPHER_WEP104  = 0x02,
+    CIPHER_TKIP    = 0x04,
+    CIPHER_CCMP    = 0x08,
+    CIPHER_CCMP256 = 0x10,
+    CIPHER_GCMP    = 0x20,
+    CIPHER_GCMP256 = 0x40,
+    CIPHER_OTHER   = 0x80,
+};
+
+// Authentication and key management suites (bitmask)
+enum : uint8_t {
+    AKM_8021X   = 0x01,   // Including SHA256 and Suite B variants
+    AKM_PSK     = 0x02,   // Including SHA256 variant
+    AKM_SAE     = 0x04,   // Including SAE-EXT-KEY
+    AKM_OWE     = 0x08,
+    AKM_FT      = 0x10,   // Any fast-transition suite was advertised
+    AKM_OTHER   = 0x80,
+};
+
+// SecurityInfo::flags
+enum : uint8_t {
+    SEC_PRIVACY      = 0x01,  // Capability privacy bit
+    SEC_WPA          = 0x02,  // WPA (vendor) element present
+    SEC_RSN          = 0x04,  // RSN element present
+    SEC_PMF_CAPABLE  = 0x08,  // MFPC
+    SEC_PMF_REQUIRED = 0x10,  // MFPR
+    SEC_MALFORMED    = 0x80,  // A security element failed to parse
+};
+
+struct SecurityInfo {
+    uint8_t flags;
+    uint8_t group_cipher;
+    uint8_t pairwise;
+    uint8_t akm;
+};
+
+// Decodes the privacy bit plus RSN/WPA elements of a beacon or probe response
+void parse_security(uint16_t capability, const uint8_t* ies, size_t len, SecurityInfo* out);
+
+// Short display label: "Open", "WEP", "WPA", "WPA2", "WPA3", "WPA2/3", "OWE", "WPA2-EAP", ...
+const char* security_label(const SecurityInfo& sec);
+
+inline bool security_is_open(const SecurityInfo& sec) {
+    return (sec.flags & (SEC_PRIVACY | SEC_WPA | SEC_RSN)) == 0;
+}
+
+#endif // IE_PARSER_H
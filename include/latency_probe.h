@@ -0,0 +1,104 @@
+// Cycle-counter latency probes for the capture, parser and UI paths
+//
+// PROBE_SCOPE(id) times the rest of the enclosing block and records it in a
+// fixed log2 histogram for that probe: bucket b counts durations in
+// [2^b, 2^(b+1)) ticks. Ticks are CCOUNT cycles on the ESP32 and nanoseconds of
+// steady_clock on the host. Recording is a handful of adds with no allocation
+// or locking; each probe has one writer task, and readers accept a torn sample.
+// CCOUNT is per core, so a probed section must not migrate between cores.
+//
+// Build with -D LATENCY_PROBES=0 to compile every probe out.
+
+#ifndef LATENCY_PROBE_H
+#define LATENCY_PROBE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifndef LATENCY_PROBES
+#define LATENCY_PROBES 1
+#endif
+
+#define PROBE_BUCKETS 32
+
+enum ProbeId {
+    PROBE_RX,          // Promiscuous RX callback
+    PROBE_PARSE,       // process_frame(), one frame
+    PROBE_BATCH,       // Parser batch with registry_mutex held
+    PROBE_EXPIRY,      // expire_stale_entries() pass
+    PROBE_UI,          // update_card_content()
+    PROBE_RENDER,      // lv_timer_handler(), including flushes
+    PROBE_FLUSH,       // One display band: DMA wait and queueing
+    PROBE_COUNT
+};
+
+struct ProbeStats {
+    uint32_t count;
+    uint32_t overruns;         // Samples longer than the probe's budget
+    uint32_t max_ticks;
+    uint64_t total_ticks;
+    uint32_t buckets[PROBE_BUCKETS];
+};
+
+// Tick source, also used by the filter profile accounting when probes are off
+#ifdef ESP_PLATFORM
+#include "esp_cpu.h"
+static inline uint32_t probe_ticks() { return (uint32_t)esp_cpu_get_ccount(); }
+#else
+#include <chrono>
+static inline uint32_t probe_ticks() {
+    return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+#endif
+
+// probe_ticks() per microsecond
+uint32_t probe_ticks_per_us();
+
+#if LATENCY_PROBES
+
+extern ProbeStats probe_stats[PROBE_COUNT];
+extern uint32_t probe_budget_ticks[PROBE_COUNT];
+
+static inline void probe_record(ProbeId id, uint32_t ticks) {
+    ProbeStats& s = probe_stats[id];
+    s.count++;
+    s.total_ticks += ticks;
+    if (ticks > s.max_ticks) s.max_ticks = ticks;
+    if (ticks > probe_budget_ticks[id]) s.overruns++;
+    s.buckets[31 - __builtin_clz(ticks | 1)]++;
+}
+
+class ProbeScope {
+public:
+    explicit ProbeScope(ProbeId id) : id(id), start(probe_ticks()) {}
+    ~ProbeScope() { probe_record(id, probe_ticks() - start); }
+private:
+    ProbeId id;
+    uint32_t start;
+};
+
+#define PROBE_CONCAT_(a, b) a##b
+#define PROBE_CONCAT(a, b) PROBE_CONCAT_(a, b)
+#define PROBE_SCOPE(id) ProbeScope PROBE_CONCAT(probe_scope_, __LINE__)(id)
+
+#else
+
+#define PROBE_SCOPE(id) do {} while (0)
+
+#endif // LATENCY_PROBES
+
+// Converts overrun budgets to ticks; call once at startup
+void latency_probes_init();
+
+// Zeroes every histogram and counter
+void latency_probes_reset();
+
+// Upper bound of the bucket holding the pct-th percentile, in microseconds
+// (0 when the probe has no samples or probes are compiled out)
+float probe_percentile_us(ProbeId id, int pct);
+
+// Prints one line per probe: count, mean, p50/p90/p99, max, overruns
+void print_latency_probes();
+
+#endif // LATENCY_PROBE_H
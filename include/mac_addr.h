@@ -0,0 +1,73 @@
+// 48-bit MAC address held as a single integer
+//
+// The first octet is the most significant byte, so the OUI is simply the top 24
+// bits and ordering matches the usual textual ordering. Formatting happens only
+// at the display/serial boundary.
+
+#ifndef MAC_ADDR_H
+#define MAC_ADDR_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+struct MacAddr {
+    uint64_t value;
+
+    static MacAddr from_bytes(const uint8_t* b) {
+        MacAddr m;
+        m.value = ((uint64_t)b[0] << 40) | ((uint64_t)b[1] << 32) | ((uint64_t)b[2] << 24) |
+                  ((uint64_t)b[3] << 16) | ((uint64_t)b[4] << 8) | (uint64_t)b[5];
+        return m;
+    }
+
+    static MacAddr from_u64(uint64_t v) {
+        MacAddr m;
+        m.value = v & 0xFFFFFFFFFFFFULL;
+        return m;
+    }
+
+    // Parses "AA:BB:CC:DD:EE:FF" (':' or '-' separators, any case)
+    static bool parse(const char* str, MacAddr* out) {
+        uint64_t v = 0;
+        for (int i = 0; i < 6; i++) {
+            for (int n = 0; n < 2; n++) {
+                char c = *str++;
+                int d;
+                if (c >= '0' && c <= '9') d = c - '0';
+                else if (c >= 'a' && c <= 'f') d = c - 'a' + 10;
+                else if (c >= 'A' && c <= 'F') d = c - 'A' + 10;
+                else return false;
+                v = (v << 4) | (uint64_t)d;
+            }
+            if (i < 5 && *str != ':' && *str != '-') return false;
+            if (i < 5) str++;
+        }
+        if (*str != '\0') return false;
+        out->value = v;
+        return true;
+    }
+
+    void to_bytes(uint8_t* b) const {
+        for (int i = 0; i < 6; i++) b[i] = (uint8_t)(value >> (40 - 8 * i));
+    }
+
+    uint32_t oui() const { return (uint32_t)(value >> 24); }
+    bool is_null() const { return value == 0; }
+    bool is_broadcast() const { return value == 0xFFFFFFFFFFFFULL; }
+    bool is_multicast() const { return (value >> 40) & 0x01; }
+    bool is_local() const { return (value >> 40) & 0x02; }   // Locally administered (randomised)
+
+    // Writes "AA:BB:CC:DD:EE:FF"; out must hold 18 bytes
+    void format(char* out) const {
+        snprintf(out, 18, "%02X:%02X:%02X:%02X:%02X:%02X",
+                 (unsigned)(value >> 40) & 0xFF, (unsigned)(value >> 32) & 0xFF,
+                 (unsigned)(value >> 24) & 0xFF, (unsigned)(value >> 16) & 0xFF,
+                 (unsigned)(value >> 8) & 0xFF, (unsigned)value & 0xFF);
+    }
+
+    bool operator==(const MacAddr& o) const { return value == o.value; }
+    bool operator!=(const MacAddr& o) const { return value != o.value; }
+    bool operator<(const MacAddr& o) const { return value < o.value; }
+};
+
+#endif // MAC_ADDR_H
@@ -0,0 +1,267 @@
+// Fixed-capacity hash table keyed by a 48-bit MAC address packed into a uint64_t
+//
+// Records live in a preallocated entry array and never move, so an entry index
+// stays valid until that entry is erased or evicted. A separate open-addressing
+// bucket array (linear probing, backward-shift deletion, no tombstones) maps keys
+// to entry indices. Entries are also kept on an intrusive LRU list; inserting
+// into a full table evicts the least recently touched entry. An optional remove
+// hook sees every record just before it is erased or evicted, so indexes that
+// point into the table can drop it.
+//
+// The entry array is a fixed-size slab of records allocated once in begin(),
+// in PSRAM when the board has it; the bucket array, probed on every lookup,
+// stays in internal RAM.
+
+#ifndef MAC_TABLE_H
+#define MAC_TABLE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <new>
+#include <type_traits>
+#include "pool_alloc.h"
+
+template <typename V>
+class MacTable {
+    static_assert(std::is_trivially_destructible<V>::value, "slab records are freed without destructors");
+
+public:
+    static const uint16_t NIL = 0xFFFF;
+
+    struct Entry {
+        uint64_t key;
+        V value;
+        uint16_t prev;     // Towards most recently used
+        uint16_t next;     // Towards least recently used
+        bool used;
+    };
+
+    // Called with the entry index and record before the record is removed
+    typedef void (*RemoveHook)(uint16_t idx, V& value, void* ctx);
+
+    MacTable() : entries(nullptr), buckets(nullptr), cap(0), bucket_mask(0), count(0),
+                 lru_head(NIL), lru_tail(NIL), free_head(NIL), eviction_count(0),
+                 remove_hook(nullptr), remove_ctx(nullptr) {}
+
+    ~MacTable() {
+        pool_free(entries);
+        pool_free(buckets);
+    }
+
+    // Allocates storage for capacity records; call once before use
+    bool begin(uint16_t capacity) {
+        if (capacity == 0 || capacity >= NIL) return false;
+        size_t nb = 1;
+        while (nb < (size_t)capacity * 2) nb <<= 1;
+
+        entries = (Entry*)pool_calloc(capacity * sizeof(Entry), POOL_PSRAM);
+        buckets = (uint16_t*)pool_calloc(nb * sizeof(uint16_t), POOL_INTERNAL);
+        if (entries == nullptr || buckets == nullptr) return false;
+        for (uint16_t i = 0; i < capacity; i++) new (&entries[i]) Entry();
+
+        cap = capacity;
+        bucket_mask = nb - 1;
+        clear();
+        return true;
+    }
+
+    void set_remove_hook(RemoveHook hook, void* ctx) {
+        remove_hook = hook;
+        remove_ctx = ctx;
+    }
+
+    void clear() {
+        for (size_t i = 0; i <= bucket_mask; i++) buckets[i] = NIL;
+        for (uint16_t i = 0; i < cap; i++) {
+            entries[i].used = false;
+            entries[i].next = (i + 1 < cap) ? i + 1 : NIL;
+        }
+        free_head = cap > 0 ? 0 : NIL;
+        lru_head = lru_tail = NIL;
+        count = 0;
+    }
+
+    // Index of the entry for key, or NIL
+    uint16_t find_index(uint64_t key) const {
+        for (size_t b = bucket_of(key);; b = (b + 1) & bucket_mask) {
+            uint16_t idx = buckets[b];
+            if (idx == NIL) return NIL;
+            if (entries[idx].key == key) return idx;
+        }
+    }
+
+    V* find(uint64_t key) {
+        uint16_t idx = find_index(key);
+        return idx == NIL ? nullptr : &entries[idx].value;
+    }
+
+    const V* find(uint64_t key) const {
+        uint16_t idx = find_index(key);
+        return idx == NIL ? nullptr : &entries[idx].value;
+    }
+
+    // Returns the record for key, creating a value-initialised one if needed.
+    // Either way the entry becomes most recently used.
+    V& upsert(uint64_t key, bool* inserted = nullptr) {
+        size_t b = bucket_of(key);
+        for (;; b = (b + 1) & bucket_mask) {
+            uint16_t idx = buckets[b];
+            if (idx == NIL) break;
+            if (entries[idx].key == key) {
+                touch(idx);
+                if (inserted) *inserted = false;
+                return entries[idx].value;
+            }
+        }
+
+        if (free_head == NIL) {
+            erase_at(lru_tail);
+            eviction_count++;
+            // Backward shift may have moved entries; probe again for a free bucket
+            b = bucket_of(key);
+            while (buckets[b] != NIL) b = (b + 1) & bucket_mask;
+        }
+
+        uint16_t idx = free_head;
+        free_head = entries[idx].next;
+
+        Entry& e = entries[idx];
+        e.key = key;
+        e.value = V();
+        e.used = true;
+        link_front(idx);
+        buckets[b] = idx;
+        count++;
+
+        if (inserted) *inserted = true;
+        return e.value;
+    }
+
+    // Marks an entry as most recently used
+    void touch(uint16_t idx) {
+        if (idx == lru_head) return;
+        unlink(idx);
+        link_front(idx);
+    }
+
+    bool erase(uint64_t key) {
+        uint16_t idx = find_index(key);
+        if (idx == NIL) return false;
+        erase_at(idx);
+        return true;
+    }
+
+    void erase_at(uint16_t idx) {
+        Entry& e = entries[idx];
+        if (remove_hook != nullptr) remove_hook(idx, e.value, remove_ctx);
+        size_t hole = bucket_of(e.key);
+        while (buckets[hole] != idx) hole = (hole + 1) & bucket_mask;
+
+        // Backward-shift deletion keeps probe chains intact without tombstones
+        for (size_t j = (hole + 1) & bucket_mask; buckets[j] != NIL; j = (j + 1) & bucket_mask) {
+            size_t home = bucket_of(entries[buckets[j]].key);
+            bool movable = (hole <= j) ? (home <= hole || home > j) : (home <= hole && home > j);
+            if (movable) {
+                buckets[hole] = buckets[j];
+                hole = j;
+            }
+        }
+        buckets[hole] = NIL;
+
+        unlink(idx);
+        e.used = false;
+        e.value = V();
+        e.next = free_head;
+        free_head = idx;
+        count--;
+    }
+
+    // Erases every entry for which pred(key, value) is true; returns how many
+    template <typename Pred>
+    size_t remove_if(Pred pred) {
+        size_t removed = 0;
+        for (uint16_t i = 0; i < cap; i++) {
+            if (entries[i].used && pred(entries[i].key, entries[i].value)) {
+                erase_at(i);
+                removed++;
+            }
+        }
+        return removed;
+    }
+
+    size_t size() const { return count; }
+    size_t capacity() const { return cap; }
+    uint32_t evictions() const { return eviction_count; }
+    // Bytes allocated by begin(): entry array plus bucket array
+    size_t footprint() const { return cap * sizeof(Entry) + (cap ? (bucket_mask + 1) * sizeof(uint16_t) : 0); }
+    bool used(uint16_t idx) const { return idx < cap && entries[idx].used; }
+    Entry& at(uint16_t idx) { return entries[idx]; }
+    const Entry& at(uint16_t idx) const { return entries[idx]; }
+    uint16_t index_of(const Entry& e) const { return (uint16_t)(&e - entries); }
+    uint16_t index_of_value(const V& v) const {
+        return (uint16_t)(((const char*)&v - (const char*)&entries[0].value) / sizeof(Entry));
+    }
+    uint16_t lru_oldest() const { return lru_tail; }
+
+    // Iterates occupied entries in slot order, which is stable between inserts
+    template <typename E, typename T>
+    class Iter {
+    public:
+        Iter(T* t, uint16_t i) : table(t), idx(i) { skip(); }
+        E& operator*() const { return table->entries[idx]; }
+        E* operator->() const { return &table->entries[idx]; }
+        Iter& operator++() { idx++; skip(); return *this; }
+        bool operator!=(const Iter& o) const { return idx != o.idx; }
+        bool operator==(const Iter& o) const { return idx == o.idx; }
+    private:
+        void skip() { while (idx < table->cap && !table->entries[idx].used) idx++; }
+        T* table;
+        uint16_t idx;
+    };
+
+    typedef Iter<Entry, MacTable> iterator;
+    typedef Iter<const Entry, const MacTable> const_iterator;
+
+    iterator begin() { return iterator(this, 0); }
+    iterator end() { return iterator(this, cap); }
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, cap); }
+
+private:
+    size_t bucket_of(uint64_t key) const {
+        // Fibonacci hashing spreads OUI-clustered keys across the buckets
+        return (size_t)((key * 0x9E3779B97F4A7C15ULL) >> 40) & bucket_mask;
+    }
+
+    void link_front(uint16_t idx) {
+        entries[idx].prev = NIL;
+        entries[idx].next = lru_head;
+        if (lru_head != NIL) entries[lru_head].prev = idx;
+        lru_head = idx;
+        if (lru_tail == NIL) lru_tail = idx;
+    }
+
+    void unlink(uint16_t idx) {
+        Entry& e = entries[idx];
+        if (e.prev != NIL) entries[e.prev].next = e.next; else lru_head = e.next;
+        if (e.next != NIL) entries[e.next].prev = e.prev; else lru_tail = e.prev;
+        e.prev = e.next = NIL;
+    }
+
+    MacTable(const MacTable&);
+    MacTable& operator=(const MacTable&);
+
+    Entry* entries;
+    uint16_t* buckets;
+    uint16_t cap;
+    size_t bucket_mask;
+    size_t count;
+    uint16_t lru_head;
+    uint16_t lru_tail;
+    uint16_t free_head;
+    uint32_t eviction_count;
+    RemoveHook remove_hook;
+    void* remove_ctx;
+};
+
+#endif // MAC_TABLE_H
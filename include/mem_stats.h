@@ -0,0 +1,82 @@
+// Memory accounting: allocator pools and per-subsystem footprints
+//
+// mem_stats_update() samples the internal heap and PSRAM (through heap_caps on
+// the ESP32, through the replay allocator's counter on the host) and the
+// footprint of each sniffer subsystem. Callers that own other memory (LVGL's
+// pool, the display buffers, the pcap ring) report it with mem_set_pool() and
+// mem_set_subsystem(). On the ESP32 the heap's low-water marks come from the
+// allocator and include dips between samples; other pools keep the lowest
+// sample.
+//
+// When free internal heap drops below mem_evict_threshold the sniffer is under
+// memory pressure and expire_stale_entries() evicts with shortened TTLs.
+
+#ifndef MEM_STATS_H
+#define MEM_STATS_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifndef MEM_EVICT_THRESHOLD
+#define MEM_EVICT_THRESHOLD (32 * 1024)    // Free internal heap below this triggers early eviction
+#endif
+#define MEM_PRESSURE_TTL_DIV 4             // TTLs are divided by this under memory pressure
+#ifndef HOST_HEAP_SIZE
+#define HOST_HEAP_SIZE (320 * 1024)        // Internal heap the host build pretends to have
+#endif
+
+enum MemPoolId { MEM_POOL_INTERNAL, MEM_POOL_PSRAM, MEM_POOL_LVGL, MEM_POOLS };
+
+enum MemSubsystem {
+    MEM_AP_REGISTRY,
+    MEM_CLIENT_REGISTRY,
+    MEM_SSID_ARENA,
+    MEM_TARGET_PACKETS,
+    MEM_CAPTURE_RING,
+    MEM_PCAP_RING,
+    MEM_DISPLAY,
+    MEM_SNAPSHOT,
+    MEM_TELEMETRY,
+    MEM_SUBSYSTEMS
+};
+
+struct MemPoolStats {
+    size_t total;              // 0 when the pool does not exist (e.g. no PSRAM)
+    size_t free;
+    size_t min_free;           // Low-water mark of free
+    size_t largest_free;       // Largest allocatable block; much below free means fragmentation
+};
+
+struct MemSubsystemStats {
+    size_t used;               // Bytes holding live records
+    size_t reserved;           // Bytes set aside, used or not
+    size_t peak_used;
+};
+
+struct MemStats {
+    MemPoolStats pools[MEM_POOLS];
+    MemSubsystemStats subsystems[MEM_SUBSYSTEMS];
+    bool pressure;
+    uint32_t pressure_events;  // Transitions into memory pressure
+};
+
+extern MemStats mem_stats;
+extern size_t mem_evict_threshold;
+
+// Samples the heaps and the sniffer subsystems and re-evaluates pressure
+void mem_stats_update();
+
+// min_free is the allocator's own low-water mark when it keeps one; without
+// it the lowest free seen by these calls is used
+#define MEM_MIN_FREE_SAMPLED SIZE_MAX
+void mem_set_pool(MemPoolId id, size_t total, size_t free, size_t largest_free,
+                  size_t min_free = MEM_MIN_FREE_SAMPLED);
+void mem_set_subsystem(MemSubsystem id, size_t used, size_t reserved);
+
+// Used share of a pool, 0-100
+int mem_pool_used_pct(MemPoolId id);
+
+// Prints pools, low-water marks, subsystem footprints and pressure state
+void print_mem_stats();
+
+#endif // MEM_STATS_H
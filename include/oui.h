@@ -0,0 +1,20 @@
+// Vendor lookup by MAC address prefix
+//
+// The table is generated from the IEEE MA-L/MA-M/MA-S registries by
+// tools/gen_oui.py and lives in flash. Lookups binary-search the most specific
+// registry first; every search is log2(table size) compare-and-select steps.
+
+#ifndef OUI_H
+#define OUI_H
+
+#include "mac_addr.h"
+
+// Short vendor name for a universally administered MAC, or nullptr if the
+// prefix is not in the table. Locally administered (randomised) addresses
+// have no vendor: check MacAddr::is_local() first.
+const char* oui_vendor(MacAddr mac);
+
+// Prefixes in the generated table (MA-L + MA-M + MA-S)
+unsigned oui_table_size();
+
+#endif // OUI_H
@@ -0,0 +1,67 @@
+// pcap (LINKTYPE_IEEE802_11_RADIOTAP) encoding of captured frames
+//
+// PcapWriter runs on the parser task: it turns each CapturedFrame into a pcap
+// record with a radiotap header built from the rx_ctrl fields and appends it to
+// a byte ring. A separate task drains the ring to the serial port, so a slow
+// link only costs dropped records, never a stalled parser.
+
+#ifndef PCAP_EXPORT_H
+#define PCAP_EXPORT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include "capture_ring.h"
+#include "byte_ring.h"
+
+#ifndef PCAP_EXPORT_BUFFER
+#define PCAP_EXPORT_BUFFER 16384       // Bytes queued for the serial link, power of two
+#endif
+
+#define PCAP_GLOBAL_HEADER_LEN 24
+#define PCAP_RECORD_HEADER_LEN 16
+#define RADIOTAP_MAX_LEN 28
+#define PCAP_MAX_RECORD_LEN (PCAP_RECORD_HEADER_LEN + RADIOTAP_MAX_LEN + CAPTURE_SNAP_LEN)
+
+typedef ByteRing<PCAP_EXPORT_BUFFER> PcapRing;
+
+// Writes the 24-byte global header (snaplen covers radiotap + CAPTURE_SNAP_LEN)
+size_t pcap_global_header(uint8_t* out);
+
+// Writes the radiotap header for f; returns its length (at most RADIOTAP_MAX_LEN)
+size_t radiotap_header(uint8_t* out, const CapturedFrame& f, uint64_t tsf_us);
+
+// Writes a complete pcap record (record header, radiotap, frame bytes)
+size_t pcap_record(uint8_t* out, const CapturedFrame& f, uint64_t ts_us);
+
+class PcapWriter {
+public:
+    explicit PcapWriter(PcapRing& ring)
+        : ring(ring), enabled(false), header_pending(false), ts_high(0), ts_last(0),
+          frames(0), dropped(0) {}
+
+    // Any task: starts or stops the stream; a new stream begins with a global header
+    void set_enabled(bool on) {
+        if (on && !enabled.load()) header_pending.store(true);
+        enabled.store(on);
+    }
+    bool is_enabled() const { return enabled.load(); }
+
+    // Parser task: queues one frame, counting a drop if the ring is full
+    void on_frame(const CapturedFrame& f);
+
+    uint32_t frames_queued() const { return frames.load(std::memory_order_relaxed); }
+    uint32_t frames_dropped() const { return dropped.load(std::memory_order_relaxed); }
+
+private:
+    PcapRing& ring;
+    std::atomic<bool> enabled;
+    std::atomic<bool> header_pending;
+    uint64_t ts_high;       // rx_ctrl.timestamp is 32-bit microseconds; extend it
+    uint32_t ts_last;
+    std::atomic<uint32_t> frames;
+    std::atomic<uint32_t> dropped;
+    uint8_t scratch[PCAP_MAX_RECORD_LEN];
+};
+
+#endif // PCAP_EXPORT_H
@@ -0,0 +1,27 @@
+// Startup-time placement of large, long-lived buffers
+//
+// Registry slabs and the string arena are allocated once in sniffer_init() and
+// never freed, so they can live in PSRAM and leave internal RAM to DMA and WiFi
+// buffers. POOL_PSRAM falls back to internal RAM on boards without PSRAM (and
+// on the host, where everything goes through operator new).
+
+#ifndef POOL_ALLOC_H
+#define POOL_ALLOC_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+enum PoolPlacement {
+    POOL_PSRAM,        // Bulk data: PSRAM when present
+    POOL_INTERNAL      // Touched on every lookup: always internal RAM
+};
+
+// Zeroed block of bytes, or nullptr
+void* pool_calloc(size_t bytes, PoolPlacement where);
+void pool_free(void* p);
+
+// Bytes currently placed by pool_calloc() in each memory
+extern size_t pool_psram_bytes;
+extern size_t pool_internal_bytes;
+
+#endif // POOL_ALLOC_H
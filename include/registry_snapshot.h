@@ -0,0 +1,198 @@
+// Registry snapshot in flash for a warm start after reboot
+//
+// The AP and client registries are written to one of two files (slot A and
+// slot B) in turn, and the newest valid one is loaded at boot, so a reset does
+// not cost the minutes of hopping it takes to hear every device again.
+//
+// File format (version 1, little-endian):
+//   SnapshotHeader            32 bytes, written last; magic 0 until complete
+//   body                      body_len bytes of tagged records:
+//     'S' len bytes[len]      string definition; strings are numbered in order
+//     'A' SnapshotAp          24 bytes
+//     'C' SnapshotClient      40 bytes
+// Records refer to SSIDs by string number, each distinct name stored once.
+// APs come before clients so a client's AP is known when it is loaded, and
+// both run from least to most recently heard so the loaded LRU order (which
+// expiry relies on) matches the saved one. Ages are relative to the save, so
+// time spent powered off does not count against the TTLs.
+//
+// Saving is spread out: start() fixes the record order with the registry lock
+// held, then each encode() serialises at most SNAPSHOT_CHUNK_RECORDS records
+// under the lock, and write() appends them to the file without it. The header
+// with the body CRC and a higher sequence number goes in last, so a save cut
+// short by a reset leaves the other slot as the newest valid snapshot.
+// Alternating slots halves the writes each file sees, and nothing is written
+// while no frames arrive.
+//
+// Files are opened with stdio: LittleFS is mounted on the VFS on the device,
+// and the host tools use a plain directory. Not thread-safe; one task saves.
+
+#ifndef REGISTRY_SNAPSHOT_H
+#define REGISTRY_SNAPSHOT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include "ie_parser.h"
+
+#define SNAPSHOT_MAGIC 0x50534E57          // "WNSP"
+#define SNAPSHOT_VERSION 1
+#ifndef SNAPSHOT_INTERVAL_MS
+#define SNAPSHOT_INTERVAL_MS 300000        // Time between saves while frames arrive
+#endif
+#define SNAPSHOT_CHUNK_RECORDS 32          // Records serialised per registry lock hold
+#define SNAPSHOT_BUF_BYTES 2048            // Encode and load buffer
+#ifndef SNAPSHOT_STRING_SLOTS
+#define SNAPSHOT_STRING_SLOTS 2048         // Names deduplicated per save, power of two (8 bytes each on the ESP32)
+#endif
+#define SNAPSHOT_NO_STRING 0xFFFF          // String number of ""
+#ifndef SNAPSHOT_DIR
+#define SNAPSHOT_DIR "/littlefs"           // LittleFS mount point on the device
+#endif
+#define SNAPSHOT_PATH_MAX 48
+
+#define SNAPSHOT_TAG_STRING 'S'
+#define SNAPSHOT_TAG_AP 'A'
+#define SNAPSHOT_TAG_CLIENT 'C'
+
+struct SnapshotHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t header_len;       // sizeof(SnapshotHeader); lets a later version grow it
+    uint32_t sequence;         // The valid slot with the higher sequence is the newest
+    uint32_t saved_ms;         // Uptime when the save started
+    uint32_t body_len;
+    uint32_t body_crc;         // CRC-32 of the body
+    uint16_t ap_count;
+    uint16_t client_count;
+    uint16_t string_count;
+    uint16_t reserved;
+};
+static_assert(sizeof(SnapshotHeader) == 32, "snapshot header layout");
+
+struct SnapshotAp {
+    uint8_t bssid[6];
+    uint16_t ssid;             // String number
+    uint32_t age_ms;           // Since last heard, at the time of the save
+    uint32_t beacon_count;
+    SecurityInfo security;
+    int8_t rssi;
+    uint8_t channel;
+    uint16_t reserved;
+};
+static_assert(sizeof(SnapshotAp) == 24, "snapshot AP record layout");
+
+#define SNAPSHOT_CLIENT_ASSOCIATED 0x01
+#define SNAPSHOT_CLIENT_AP_EXACT 0x02
+
+struct SnapshotClient {
+    uint8_t mac[6];
+    uint8_t ap[6];             // connected_ap, zero when unknown
+    uint32_t age_ms;
+    uint32_t frame_count;
+    uint32_t retry_count;
+    uint32_t duplicate_count;
+    uint16_t probed[4];        // String numbers, newest first
+    int8_t rssi;
+    uint8_t flags;             // SNAPSHOT_CLIENT_*
+    uint8_t probe_count;
+    uint8_t reserved;
+};
+static_assert(sizeof(SnapshotClient) == 40, "snapshot client record layout");
+
+struct SnapshotStats {
+    uint32_t saves;
+    uint32_t failures;         // Saves abandoned on a write error
+    uint32_t sequence;         // Of the newest valid snapshot, 0 for none
+    char slot;                 // 'A' or 'B', 0 for none
+    uint32_t last_bytes;       // Size of the last save, header included
+    uint16_t last_aps;
+    uint16_t last_clients;
+    uint16_t last_strings;
+    uint32_t last_save_ms;     // Wall time from start() to commit()
+    uint32_t last_saved_at;    // millis() of the last commit
+    uint16_t loaded_aps;       // At boot
+    uint16_t loaded_clients;
+    uint16_t load_stale;       // Records older than their TTL, skipped
+    uint32_t load_us;
+    bool load_fallback;        // The newest slot was damaged and the other one was used
+};
+
+class RegistrySnapshot {
+public:
+    RegistrySnapshot();
+    ~RegistrySnapshot();
+
+    // Allocates the visit order for the registries' capacities and the name
+    // index, and reads both slot headers in dir; call after sniffer_init()
+    bool begin(const char* dir);
+
+    // Boot, before capture starts: loads the newest valid slot into the
+    // registries in one pass, falling back to the other slot if it is damaged.
+    // False when neither slot holds a usable snapshot (the registries are empty).
+    bool load(uint32_t now);
+
+    // Whether a save is due: the interval has passed and frames have arrived
+    bool due(uint32_t now) const;
+
+    // No lock: opens the older slot for a new save
+    bool open();
+
+    // Registry lock held: fixes the record order, oldest first
+    void start(uint32_t now);
+
+    // Registry lock held: encodes the next records into the buffer and returns
+    // its length, 0 once every record has been encoded
+    size_t encode(uint32_t now);
+
+    // No lock: appends what encode() produced
+    bool write(size_t len);
+
+    // No lock: completes the file with its header; it becomes the newest slot
+    bool commit(uint32_t now);
+
+    // Drops a save in progress after a failure
+    void abort();
+
+    bool saving() const { return file != nullptr; }
+    const SnapshotStats& stats() const { return st; }
+    size_t footprint() const;
+
+private:
+    void slot_path(int slot, char* out) const;
+    bool read_header(int slot, SnapshotHeader* out);
+    bool load_slot(int slot, const SnapshotHeader& h, uint32_t now);
+    uint16_t string_ref(const char* s, size_t* need, bool define);
+    bool room_for(size_t record_len, const char* const* names, int n);
+
+    char dir[SNAPSHOT_PATH_MAX];
+    uint8_t buf[SNAPSHOT_BUF_BYTES];
+    size_t buf_len;
+
+    // Save in progress
+    FILE* file;
+    int slot;                  // Being written
+    uint32_t started_at;
+    uint32_t body_len;
+    uint32_t body_crc;
+    uint16_t* ap_order;        // ap_registry indices, oldest first
+    uint16_t* client_order;
+    size_t ap_count, client_count;
+    size_t next_ap, next_client;
+    uint16_t aps_written, clients_written;
+    uint16_t strings_defined;
+    uint32_t arena_flips;      // A flip moves every name, so the index restarts
+    struct StringSlot { const char* s; uint16_t id; };
+    StringSlot* names;         // Open addressing by pointer: names are interned
+    size_t names_used;
+
+    // Slots on flash
+    uint32_t slot_sequence[2];
+    int newest;                // -1 for none
+    uint32_t frames_at_save;   // total_frames when the last save started
+    SnapshotStats st;
+};
+
+extern RegistrySnapshot registry_snapshot;
+
+#endif // REGISTRY_SNAPSHOT_H
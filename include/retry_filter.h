@@ -0,0 +1,70 @@
+// Retransmission filter: last sequence control seen per transmitter
+//
+// When an 802.11 frame is not acknowledged the sender repeats it with the
+// Retry bit set and the same sequence control field, so a monitor that heard
+// the first copy hears the frame twice. A frame is a duplicate when its Retry
+// bit is set and its sequence control equals the last one seen from the same
+// transmitter (Addr2), the rule Wireshark's wlan.analysis.retransmission uses.
+//
+// Each transmitter's address and last sequence control are packed into one
+// uint64_t in a small set-associative cache: a check reads one set of
+// RETRY_FILTER_WAYS entries and moves the hit to the front, so the least
+// recently heard transmitter of the set is the one replaced. A retry whose
+// transmitter was displaced counts as unique, never the other way round.
+//
+// Not thread-safe; the parser task owns it.
+
+#ifndef RETRY_FILTER_H
+#define RETRY_FILTER_H
+
+#include <stdint.h>
+#include <string.h>
+#include "mac_addr.h"
+
+#ifndef RETRY_FILTER_SET_BITS
+#define RETRY_FILTER_SET_BITS 7            // 128 sets
+#endif
+#define RETRY_FILTER_WAYS 4                // x 4 ways = 512 transmitters, 4 KB
+#define RETRY_FILTER_SLOTS ((1 << RETRY_FILTER_SET_BITS) * RETRY_FILTER_WAYS)
+
+class RetryFilter {
+public:
+    RetryFilter() { clear(); }
+
+    void clear() {
+        memset(slots, 0, sizeof(slots));
+        displaced_count = 0;
+    }
+
+    // Records seq_ctrl as ta's latest; true when the frame repeats the previous one
+    bool is_duplicate(MacAddr ta, uint16_t seq_ctrl, bool retry) {
+        uint64_t* set = &slots[set_of(ta.value) * RETRY_FILTER_WAYS];
+        uint64_t entry = (ta.value << 16) | seq_ctrl;
+        int way = RETRY_FILTER_WAYS - 1;   // Least recently heard, replaced on a miss
+        for (int i = 0; i < RETRY_FILTER_WAYS; i++) {
+            if ((set[i] >> 16) == ta.value) {
+                way = i;
+                break;
+            }
+        }
+        bool duplicate = retry && set[way] == entry;
+        if (set[way] != 0 && (set[way] >> 16) != ta.value) displaced_count++;
+        for (int i = way; i > 0; i--) set[i] = set[i - 1];
+        set[0] = entry;
+        return duplicate;
+    }
+
+    // Transmitters pushed out of a full set (cache pressure)
+    uint32_t displaced() const { return displaced_count; }
+
+private:
+    static size_t set_of(uint64_t mac) {
+        return (size_t)((mac * 0x9E3779B97F4A7C15ULL) >> (64 - RETRY_FILTER_SET_BITS));
+    }
+
+    // (address << 16) | sequence control, 0 when empty; most recent first in each set
+    uint64_t slots[RETRY_FILTER_SLOTS];
+    uint32_t displaced_count;
+};
+
+#endif // RETRY_FILTER_H
@@ -0,0 +1,73 @@
+// Smoothed RSSI of one device, with jitter and an approaching/receding trend
+//
+// Single readings jump 10-15 dB with multipath and body shadowing. Each
+// reading goes through a scalar Kalman filter whose process noise grows with
+// the time since the last one, so a burst of frames is averaged while a device
+// heard once a second still tracks within a few seconds. A reading that
+// disagrees with the estimate by more than RSSI_GATE standard deviations is
+// dropped as an outlier, unless the next one agrees with it (a real step).
+//
+// The filtered level is also sampled into a small ring at least
+// RSSI_TRACK_SPACING_MS apart; the least-squares slope over the ring is the
+// trend. add() is O(1); read() walks the ring and is meant for display.
+//
+// Plain data: an all-zero RssiTrack is empty, so registry records and
+// watchlist entries need no constructor.
+
+#ifndef RSSI_TRACK_H
+#define RSSI_TRACK_H
+
+#include <stdint.h>
+
+#define RSSI_TRACK_SAMPLES 8               // Filtered levels kept for the trend
+#ifndef RSSI_TRACK_SPACING_MS
+#define RSSI_TRACK_SPACING_MS 500          // Minimum spacing of ring samples (ring spans ~4 s)
+#endif
+#define RSSI_TRACK_STALE_MS 5000           // A gap this long restarts the track
+#define RSSI_MEAS_VAR 25.0f                // Variance of one reading, dB^2 (5 dB jitter)
+#ifndef RSSI_DRIFT_VAR
+#define RSSI_DRIFT_VAR 4.0f                // Variance the true level gains per second, dB^2/s
+#endif
+#define RSSI_GATE 3.0f                     // Outlier threshold in standard deviations
+#define RSSI_MAX_OUTLIERS 1                // Outliers in a row dropped before one is believed
+#define RSSI_JITTER_ALPHA 0.1f             // EWMA weight of the newest squared residual
+#ifndef RSSI_TREND_DB_S
+#define RSSI_TREND_DB_S 1.0f               // Slope that counts as approaching or receding
+#endif
+
+enum RssiTrend : int8_t {
+    RSSI_RECEDING = -1,
+    RSSI_STEADY = 0,
+    RSSI_APPROACHING = 1
+};
+
+struct RssiReading {
+    float smoothed;            // dBm
+    float variance;            // Of readings around the estimate, dB^2
+    float slope;               // dB/s, positive when the signal is getting stronger
+    RssiTrend trend;
+};
+
+class RssiTrack {
+public:
+    void reset();
+    void add(int8_t rssi, uint32_t now);
+
+    bool empty() const { return count == 0; }
+    int smoothed() const;      // Rounded dBm, 0 when empty
+
+    void read(RssiReading* out) const;
+
+private:
+    uint32_t time[RSSI_TRACK_SAMPLES];     // millis() of each ring sample
+    int16_t level[RSSI_TRACK_SAMPLES];     // Filtered dBm * 16
+    uint8_t head;                          // Next ring slot
+    uint8_t count;                         // Ring samples held
+    uint8_t outliers;                      // Consecutive readings rejected
+    uint32_t last_update;
+    float estimate;
+    float error_var;
+    float jitter_var;
+};
+
+#endif // RSSI_TRACK_H
@@ -0,0 +1,54 @@
+// Single-writer sequence lock for publishing a snapshot to other cores
+//
+// The writer bumps the sequence to odd, copies the value in and bumps it to
+// even again. Readers copy the value out and retry when the sequence was odd
+// or changed underneath them, so they never block the writer and never see a
+// half-written snapshot. Meant for small trivially copyable structs published
+// a few times a second; a reader only spins while a copy is in flight.
+
+#ifndef SEQLOCK_H
+#define SEQLOCK_H
+
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+#include <type_traits>
+
+template <typename T>
+class Seqlock {
+    static_assert(std::is_trivially_copyable<T>::value, "seqlock values are copied as plain bytes");
+
+public:
+    Seqlock() : seq(0) { memset(&value, 0, sizeof(T)); }
+
+    // Writer (one task only)
+    void publish(const T& v) {
+        uint32_t s = seq.load(std::memory_order_relaxed);
+        seq.store(s + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        memcpy(&value, &v, sizeof(T));
+        seq.store(s + 2, std::memory_order_release);
+    }
+
+    // Any task: copies the latest snapshot and returns its version (0 = never published)
+    uint32_t read(T* out) const {
+        for (;;) {
+            uint32_t s1 = seq.load(std::memory_order_acquire);
+            if (s1 & 1) continue;
+            memcpy(out, &value, sizeof(T));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (seq.load(std::memory_order_relaxed) == s1) return s1 / 2;
+        }
+    }
+
+    uint32_t version() const { return seq.load(std::memory_order_acquire) / 2; }
+
+private:
+    std::atomic<uint32_t> seq;
+    T value;
+
+    Seqlock(const Seqlock&);
+    Seqlock& operator=(const Seqlock&);
+};
+
+#endif // SEQLOCK_H
@@ -0,0 +1,96 @@
+// Per-channel signal statistics over a sliding time window
+//
+// Every captured frame feeds its channel's RSSI and noise floor into
+// constant-size estimators: an EWMA, exact min/max and P² quantile sketches
+// (Jain & Chlamtac) for the median and p90. Nothing is stored per frame.
+//
+// The window is two panes of SIGNAL_WINDOW_MS / 2. Frames go into the newest
+// pane; when it is full the older one is recycled, and a summary merges the
+// panes that still overlap the window. The covered span is therefore between
+// half and all of SIGNAL_WINDOW_MS, and a channel that falls silent ages out
+// instead of being reset wholesale.
+//
+// add() runs on the parser task with registry_mutex held; summary() is taken
+// under the same lock when sniffer_status is published.
+
+#ifndef SIGNAL_STATS_H
+#define SIGNAL_STATS_H
+
+#include <stdint.h>
+
+#ifndef SIGNAL_WINDOW_MS
+#define SIGNAL_WINDOW_MS 60000             // Span the channel statistics describe
+#endif
+#define SIGNAL_EWMA_ALPHA 0.0625f          // EWMA weight of the newest frame
+#define SIGNAL_QUANTILE_TOLERANCE_DB 2     // Window percentiles vs exact nearest rank, steady signal
+
+// Streaming estimate of one quantile in five markers. The first five samples
+// are kept exactly, so small counts return the exact nearest-rank value.
+class P2Quantile {
+public:
+    void reset(float p);
+    void add(float x);
+
+    // Current estimate, 0 before any sample
+    float value() const;
+    uint32_t count() const { return n; }
+
+    // Estimate of the p quantile of the union of a and b's samples, found by
+    // adding their marker-interpolated rank functions. Both must track p.
+    static float merge(const P2Quantile& a, const P2Quantile& b);
+
+private:
+    // Approximate number of samples <= x
+    float rank_at(float x) const;
+
+    float p;
+    float q[5];            // Marker heights
+    int32_t pos[5];        // Marker positions, 0-based ranks
+    uint32_t n;
+};
+
+// Estimators for one pane of the window
+struct SignalPane {
+    uint32_t start;        // millis() of the first frame, valid when frames > 0
+    uint32_t frames;
+    uint32_t retries;      // Frames with the Retry bit
+    int8_t rssi_min, rssi_max;
+    int8_t noise_min, noise_max;
+    P2Quantile rssi_p50, rssi_p90, noise_p50;
+
+    void reset(uint32_t now);
+    void add(int8_t rssi, int8_t noise, bool retry);
+};
+
+// What the UI and the serial console show for a channel; plain data so it can
+// travel in the sniffer_status snapshot
+struct SignalSummary {
+    uint32_t frames;           // In the window, every copy received
+    uint32_t retries;          // ... with the Retry bit (congestion: retries / frames)
+    uint32_t window_start;     // millis() of the oldest frame counted
+    int16_t rssi_ewma;         // dBm, over all frames since boot
+    int16_t noise_ewma;
+    int8_t rssi_min, rssi_max;
+    int8_t noise_min, noise_max;
+    int8_t rssi_p50, rssi_p90;
+    int8_t noise_p50;
+    int8_t snr;                // rssi_p50 - noise_p50, dB
+};
+
+class ChannelSignal {
+public:
+    void reset();
+    void add(int8_t rssi, int8_t noise, bool retry, uint32_t now);
+
+    // Window statistics at time now; frames is 0 when nothing was heard in it
+    void summary(uint32_t now, SignalSummary* out) const;
+
+private:
+    SignalPane panes[2];
+    uint8_t newest;
+    bool started;          // Any frame since reset() (seeds the EWMAs)
+    float rssi_ewma;
+    float noise_ewma;
+};
+
+#endif // SIGNAL_STATS_H
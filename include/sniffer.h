@@ -0,0 +1,248 @@
+// WiFi sniffer core: capture callback, frame parser and device registries
+//
+// Everything here is independent of the display and of FreeRTOS so it can be
+// built for the native host environment and driven by the pcap replay tool.
+// On the device, parser_task in main.cpp drains capture_ring into
+// process_frame() while holding registry_mutex.
+
+#ifndef SNIFFER_H
+#define SNIFFER_H
+
+#include <Arduino.h>
+#include "esp_wifi.h"
+#include "capture_ring.h"
+#include "mac_table.h"
+#include "mac_addr.h"
+#include "ie_parser.h"
+#include "channel_hopper.h"
+#include "dot11_header.h"
+#include "string_arena.h"
+#include "watchlist.h"
+#include "history_ring.h"
+#include "seqlock.h"
+#include "signal_stats.h"
+#include "rssi_track.h"
+#include "retry_filter.h"
+#include "filter_profile.h"
+
+// WiFi sniffer configuration
+#define WIFI_CHANNEL_MAX 13
+#define WIFI_MANAGEMENT_FRAME 0x00
+#define WIFI_CONTROL_FRAME 0x01
+#define WIFI_DATA_FRAME 0x02
+#ifndef AP_TABLE_CAPACITY
+#define AP_TABLE_CAPACITY 256              // Max APs tracked before LRU eviction
+#endif
+#ifndef CLIENT_TABLE_CAPACITY
+#define CLIENT_TABLE_CAPACITY 512          // Max clients tracked before LRU eviction
+#endif
+#ifndef SSID_ARENA_BYTES
+#define SSID_ARENA_BYTES 32768             // Interned SSIDs, two halves (PSRAM when present)
+#endif
+#define CLIENT_PROBE_SLOTS 4               // Most recent probed SSIDs kept per client
+#define ASSOC_NIL 0xFFFF                   // No entry in an association list
+#ifndef AP_TTL_MS
+#define AP_TTL_MS 300000                   // APs unheard this long are dropped
+#endif
+#ifndef CLIENT_TTL_MS
+#define CLIENT_TTL_MS 120000               // Clients unheard this long are dropped
+#endif
+#ifndef EXPIRY_BUDGET
+#define EXPIRY_BUDGET 8                    // Max entries expired per registry per call
+#endif
+#ifndef TARGET_HISTORY_LEN
+#define TARGET_HISTORY_LEN 4096            // Frames kept in the target history (16 bytes each, PSRAM when present)
+#endif
+
+// Management frame subtypes
+#define WIFI_BEACON_FRAME 0x08
+#define WIFI_PROBE_REQUEST 0x04
+#define WIFI_PROBE_RESPONSE 0x05
+#define WIFI_ASSOCIATION_REQUEST 0x00
+#define WIFI_ASSOCIATION_RESPONSE 0x01
+#define WIFI_REASSOCIATION_REQUEST 0x02
+#define WIFI_REASSOCIATION_RESPONSE 0x03
+#define WIFI_DISASSOCIATION 0x0A
+#define WIFI_AUTHENTICATION 0x0B
+#define WIFI_DEAUTHENTICATION 0x0C
+
+// Data structures
+// Registry records are fixed-size so updating them from a frame never allocates.
+// Names point into ssid_arena and are never nullptr; "" means unknown/hidden.
+// Each AP heads an intrusive list of the clients whose connected_ap it is; the
+// links are client_registry indices, kept up to date by set_client_ap().
+struct APInfo {
+    const char* ssid = "";
+    MacAddr bssid;
+    int channel;
+    int rssi;
+    int client_count;          // Length of the client list
+    SecurityInfo security;
+    unsigned long last_seen;
+    int beacon_count;
+    uint16_t first_client = ASSOC_NIL;
+};
+
+struct ClientInfo {
+    MacAddr mac;
+    MacAddr connected_ap;      // Zero when unknown
+    int rssi;                  // Last frame the client sent
+    RssiTrack rssi_track;
+    const char* vendor;        // Static string, nullptr until looked up
+    unsigned long last_seen;
+    int frame_count;           // Unique frames sent
+    int retry_count;           // Frames sent with the Retry bit
+    int duplicate_count;       // ... whose first copy was heard too (not in frame_count)
+    bool is_associated;
+    bool ap_exact;             // connected_ap came from frame addresses, not a guess
+    uint16_t ap_index = ASSOC_NIL;   // ap_registry index while linked into that AP's list
+    uint16_t ap_prev = ASSOC_NIL;
+    uint16_t ap_next = ASSOC_NIL;
+    uint8_t probe_count;       // Entries used in probed[]
+    const char* probed[CLIENT_PROBE_SLOTS];   // Directed probe SSIDs, newest first
+};
+
+struct ChannelStats {
+    int ap_count;              // Beacons heard on the channel
+    int total_frames;          // Unique frames since boot
+    int duplicate_frames;      // Retransmissions of frames already heard
+    unsigned long last_activity;
+    ChannelSignal signal;      // RSSI and noise floor over the last SIGNAL_WINDOW_MS
+};
+
+// Recent frames to or from any watched target, packed to 16 bytes
+enum TargetFrameType : uint8_t {
+    TARGET_FRAME_BEACON,
+    TARGET_FRAME_PROBE,
+    TARGET_FRAME_PROBE_RESP,
+    TARGET_FRAME_ASSOC,
+    TARGET_FRAME_ASSOC_RESP,
+    TARGET_FRAME_DISASSOC,
+    TARGET_FRAME_AUTH,
+    TARGET_FRAME_DEAUTH,
+    TARGET_FRAME_MGMT,
+    TARGET_FRAME_DATA,
+    TARGET_FRAME_TYPES
+};
+
+#define TARGET_PACKET_TX 0x01              // Sent by the target (otherwise received)
+
+struct TargetPacket {
+    uint32_t timestamp;    // millis()
+    uint8_t mac[6];        // Target address that sent or received the frame
+    uint8_t type;          // TargetFrameType
+    uint8_t flags;         // TARGET_PACKET_TX
+    int8_t rssi;
+    uint8_t channel;
+};
+static_assert(sizeof(TargetPacket) == 16, "TargetPacket is sized for deep PSRAM history");
+
+// Short display name of a TargetFrameType ("PROBE", "DATA", ...)
+const char* target_frame_name(uint8_t type);
+
+// Watched on first boot, before a watchlist has been saved to NVS
+extern const char* TARGET_PHONE;
+
+// Target tracking: per-target records live in the watchlist
+extern Watchlist watchlist;
+extern HistoryRing<TargetPacket> target_history;
+
+// WiFi Data
+extern MacTable<APInfo> ap_registry;
+extern MacTable<ClientInfo> client_registry;
+extern StringArena ssid_arena;
+extern ChannelStats channel_stats[14];
+extern int current_channel;
+extern ChannelHopper channel_hopper;
+extern int total_frames;
+extern int mgmt_frames;
+extern int data_frames;
+extern int ctrl_frames;
+
+// Retransmissions: every frame with the Retry bit counts in retry_frames; those
+// whose first copy was heard as well are duplicates and are left out of every
+// other counter (total_frames and the per-type, per-channel and per-device counts)
+extern int retry_frames;
+extern int duplicate_frames;
+extern RetryFilter retry_filter;
+
+// Hardware frame-class filter, switched by the UI task with the active view
+extern PromiscFilter promisc_filter;
+
+// Counters and per-channel state the UI shows, published as one consistent
+// snapshot so the UI core reads them without registry_mutex
+struct SnifferStatus {
+    unsigned long published_at;    // millis()
+    int current_channel;
+    int total_frames;
+    int mgmt_frames;
+    int data_frames;
+    int ctrl_frames;
+    int retry_frames;
+    int duplicate_frames;
+    uint16_t ap_count;
+    uint16_t client_count;
+    uint16_t open_aps;
+    uint16_t secure_aps;
+    uint32_t retry_displaced;      // Retry filter entries taken over by another transmitter
+    SignalSummary channels[WIFI_CHANNEL_MAX + 1];  // Index 0 unused
+    
+    // Hopper state, owned by the task that publishes
+    bool hop_adaptive;
+    bool hop_locked;
+    int hop_channel;
+    uint32_t hop_dwell_ms;
+    HopChannelStats hop[HOP_CHANNEL_MAX + 1];      // Index 0 unused
+};
+
+extern Seqlock<SnifferStatus> sniffer_status;
+
+// Registry expiry. Every update of a record touches it in its table's LRU list,
+// so the least recently used end is also the oldest last_seen and expiry only
+// ever looks at the tail.
+enum RegistryKind { REGISTRY_AP, REGISTRY_CLIENT };
+typedef void (*ExpiryCallback)(RegistryKind kind, MacAddr mac, void* ctx);
+
+extern uint32_t ap_ttl_ms;
+extern uint32_t client_ttl_ms;
+extern uint32_t ap_expired;
+extern uint32_t client_expired;
+
+// Capture path: RX callback -> capture_ring -> process_frame
+extern SpscRing<CapturedFrame, CAPTURE_RING_SLOTS> capture_ring;
+extern uint32_t frames_truncated;
+
+// Allocates the registries, resets statistics and loads the watchlist from NVS
+// (nvs_flash_init() must have run); call once before capture starts. The host
+// tools pass larger capacities.
+bool sniffer_init(uint16_t ap_capacity = AP_TABLE_CAPACITY, uint16_t client_capacity = CLIENT_TABLE_CAPACITY);
+
+// Promiscuous RX callback: copies the frame into capture_ring and returns
+void wifi_sniffer_packet_handler(void* buff, wifi_promiscuous_pkt_type_t type);
+
+// Parses one captured frame into the registries and statistics
+void process_frame(const CapturedFrame& f);
+
+// Fills and publishes sniffer_status; call from the task that drives
+// channel_hopper, with registry_mutex held
+void publish_sniffer_status(unsigned long now);
+
+// Short vendor name from the OUI table, VENDOR_RANDOM for locally
+// administered addresses, VENDOR_UNKNOWN otherwise
+#define VENDOR_RANDOM "Random"
+#define VENDOR_UNKNOWN "Unknown"
+const char* get_vendor_from_mac(MacAddr mac);
+uint64_t find_closest_ap(MacAddr client_mac, int client_rssi, unsigned long client_time);
+
+// Called for each record just before expiry removes it (registry lock held)
+void set_expiry_callback(ExpiryCallback cb, void* ctx);
+
+// Drops up to budget stale records from each registry; returns how many.
+// Call often with registry_mutex held: the work is O(budget), not O(size).
+size_t expire_stale_entries(unsigned long now, size_t budget);
+
+// Sets client.connected_ap and moves the client to that AP's list (O(1)).
+// exact is false when the AP was only guessed by find_closest_ap().
+void set_client_ap(ClientInfo& client, MacAddr ap, bool exact);
+
+#endif // SNIFFER_H
@@ -0,0 +1,59 @@
+// Interning bump arena for short strings (SSIDs)
+//
+// Strings are appended to the active half of the arena and never freed one by
+// one; an open-addressing index over the active half makes every distinct
+// string stored once, so records hold a const char* and compare names by
+// pointer. When the active half is full the owner calls flip() and re-interns
+// every string it still references: that copies the live strings into the
+// other half and leaves the dead ones behind. Strings in the old half stay
+// readable until the next flip, so a reader holding the owner's lock across
+// one compaction never sees a dangling pointer.
+//
+// Not thread-safe; the sniffer uses it under registry_mutex.
+
+#ifndef STRING_ARENA_H
+#define STRING_ARENA_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#define STRING_ARENA_MAX_LEN 255
+
+class StringArena {
+public:
+    StringArena();
+    ~StringArena();
+
+    // Allocates two halves of bytes / 2 plus the index, preferring PSRAM
+    bool begin(size_t bytes);
+
+    // Stable copy of s[0..len), or nullptr when the active half is full.
+    // The empty string is a shared constant and takes no space.
+    const char* intern(const char* s, size_t len);
+    const char* intern(const char* s) { return intern(s, strlen(s)); }
+
+    // Starts filling the other half with an empty index
+    void flip();
+
+    size_t used() const { return top; }               // Bytes in the active half
+    size_t capacity() const { return half_bytes; }    // Bytes per half
+    size_t strings() const { return count; }           // Distinct strings in the active half
+    uint32_t flips() const { return flip_count; }
+    size_t footprint() const { return 2 * half_bytes + (index_mask + 1) * sizeof(uint32_t); }
+
+private:
+    uint8_t* halves[2];
+    uint8_t* active;
+    size_t half_bytes;
+    size_t top;
+    uint32_t* index;           // Offset + 1 of each string's length byte; 0 = empty slot
+    size_t index_mask;
+    size_t count;
+    uint32_t flip_count;
+
+    StringArena(const StringArena&);
+    StringArena& operator=(const StringArena&);
+};
+
+#endif // STRING_ARENA_H
@@ -0,0 +1,223 @@
+// Telemetry stream: registry and channel deltas for collectors
+//
+// Every interval the telemetry task emits one batch: each channel whose window
+// statistics changed, the records expiry removed, every AP and client heard
+// since the previous batch, and last a summary of the global counters, which
+// closes the batch. Every TELEMETRY_FULL_EVERY batches, and on request, the
+// batch carries all records instead, so a collector that joined late or lost
+// frames catches up; records dropped by LRU eviction are not reported as
+// removed and vanish from the collector's view at that point.
+//
+// Binary encoding, little-endian:
+//   0xA5 0x5A  u16 len  payload[len]  u32 CRC-32(payload)
+//   payload = TelemetryFrameHeader, then count records of its type
+// A frame holds one record type and at most TELEMETRY_FRAME_MAX payload bytes.
+// Records are fixed width; an AP record is followed by its ssid_len SSID
+// bytes. A decoder resynchronises on the sync bytes and drops frames whose CRC
+// fails, so text written to the same port costs only the frames it hits.
+//
+// NDJSON encoding: one object per record and line, with a "type" member
+// ("channel", "gone", "ap", "client", "summary") and the batch number. SSID
+// bytes outside printable ASCII are written as \u00XX escapes.
+//
+// The encoder walks the registries a buffer at a time: start() and encode()
+// run with registry_mutex held, and the caller writes each filled buffer to
+// the link without it. Frames never straddle two buffers.
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "mac_addr.h"
+#include "ie_parser.h"
+
+#define TELEMETRY_SYNC0 0xA5
+#define TELEMETRY_SYNC1 0x5A
+#define TELEMETRY_VERSION 1
+#define TELEMETRY_FRAME_MAX 1024           // Payload bytes per binary frame
+#define TELEMETRY_FRAME_OVERHEAD 8         // Sync, length and CRC
+#ifndef TELEMETRY_BUF_BYTES
+#define TELEMETRY_BUF_BYTES 4096           // Encode buffer, one serial write
+#endif
+#ifndef TELEMETRY_INTERVAL_MS
+#define TELEMETRY_INTERVAL_MS 1000         // Time between batches
+#endif
+#define TELEMETRY_FULL_EVERY 60            // Every nth batch carries every record
+#define TELEMETRY_GONE_MAX 64              // Removals queued between batches
+#define TELEMETRY_MAX_BAUD 2000000
+
+enum TelemetryFormat : uint8_t {
+    TELEMETRY_OFF,
+    TELEMETRY_BINARY,
+    TELEMETRY_NDJSON
+};
+
+enum TelemetryType : uint8_t {
+    TELEMETRY_SUMMARY = 1,
+    TELEMETRY_CHANNEL = 2,
+    TELEMETRY_GONE = 3,
+    TELEMETRY_AP = 4,
+    TELEMETRY_CLIENT = 5
+};
+
+#define TELEMETRY_FLAG_FULL 0x01           // The batch lists every record, not only changes
+
+struct TelemetryFrameHeader {
+    uint8_t type;              // TelemetryType
+    uint8_t version;
+    uint8_t flags;             // TELEMETRY_FLAG_*
+    uint8_t reserved;
+    uint16_t count;            // Records in the frame
+    uint16_t reserved2;
+    uint32_t batch;
+    uint32_t sequence;         // Frame number since boot; a gap means lost frames
+    uint32_t time_ms;          // Uptime when the batch started
+};
+static_assert(sizeof(TelemetryFrameHeader) == 20, "telemetry frame header layout");
+
+struct TelemetrySummary {
+    uint32_t total_frames;     // Unique frames
+    uint32_t mgmt_frames;
+    uint32_t data_frames;
+    uint32_t ctrl_frames;
+    uint32_t retry_frames;
+    uint32_t duplicate_frames;
+    uint32_t capture_drops;    // Capture ring full
+    uint16_t ap_count;
+    uint16_t client_count;
+    uint8_t channel;           // Tuned channel
+    uint8_t filter;            // FilterProfile
+    uint16_t gone_dropped;     // Removals not reported since boot (queue full)
+};
+static_assert(sizeof(TelemetrySummary) == 36, "telemetry summary layout");
+
+struct TelemetryChannel {
+    uint8_t channel;
+    int8_t snr;
+    int8_t rssi_p50;
+    int8_t rssi_p90;
+    int8_t noise_p50;
+    uint8_t reserved[3];
+    uint32_t frames;           // In the signal window, every copy
+    uint32_t retries;
+};
+static_assert(sizeof(TelemetryChannel) == 16, "telemetry channel layout");
+
+#define TELEMETRY_GONE_AP 0
+#define TELEMETRY_GONE_CLIENT 1
+
+struct TelemetryGone {
+    uint8_t mac[6];
+    uint8_t kind;              // TELEMETRY_GONE_*
+    uint8_t reserved;
+};
+static_assert(sizeof(TelemetryGone) == 8, "telemetry removal layout");
+
+struct TelemetryAp {
+    uint8_t bssid[6];
+    int8_t rssi;
+    uint8_t channel;
+    uint32_t age_ms;           // Since last heard, at the start of the batch
+    uint32_t beacon_count;
+    SecurityInfo security;
+    uint16_t client_count;
+    uint8_t ssid_len;          // SSID bytes following the record
+    uint8_t reserved;
+};
+static_assert(sizeof(TelemetryAp) == 24, "telemetry AP layout");
+
+#define TELEMETRY_CLIENT_ASSOCIATED 0x01
+#define TELEMETRY_CLIENT_AP_EXACT 0x02
+
+struct TelemetryClient {
+    uint8_t mac[6];
+    uint8_t ap[6];             // Zero when unknown
+    uint32_t age_ms;
+    uint32_t frame_count;
+    uint32_t retry_count;
+    int8_t rssi;               // Smoothed when available
+    uint8_t flags;             // TELEMETRY_CLIENT_*
+    uint8_t probe_count;
+    uint8_t reserved;
+};
+static_assert(sizeof(TelemetryClient) == 28, "telemetry client layout");
+
+struct TelemetryStats {
+    uint32_t batches;
+    uint32_t frames;           // Binary frames (or NDJSON lines)
+    uint32_t records;
+    uint64_t bytes;
+    uint32_t last_bytes;       // Of the last batch
+    uint32_t last_records;
+    uint32_t gone_dropped;
+};
+
+class TelemetryEncoder {
+public:
+    TelemetryEncoder();
+
+    // Allocates the encode buffer; call once
+    bool begin();
+
+    void set_format(TelemetryFormat f) { format = f; }
+    TelemetryFormat get_format() const { return format; }
+
+    // The next batch lists every record
+    void request_full() { full_pending = true; }
+
+    // Registry lock held: opens a batch of what changed since the previous one
+    void start(uint32_t now);
+
+    // Registry lock held: fills the buffer with the next frames and returns
+    // its length, 0 once the batch is complete
+    size_t encode();
+    const uint8_t* data() const { return buf; }
+
+    // Expiry callback (registry lock held): queues a removal for the next batch
+    void on_removed(bool client, MacAddr mac);
+
+    const TelemetryStats& stats() const { return st; }
+    size_t footprint() const { return buf != nullptr ? TELEMETRY_BUF_BYTES : 0; }
+
+private:
+    enum Phase { PHASE_CHANNELS, PHASE_GONE, PHASE_APS, PHASE_CLIENTS, PHASE_SUMMARY, PHASE_DONE };
+
+    bool put(TelemetryType type, const void* rec, size_t rec_len, const char* tail, size_t tail_len);
+    bool put_json(TelemetryType type, const void* rec, const char* tail, size_t tail_len);
+    bool open_frame(TelemetryType type);
+    void close_frame();
+    bool step();
+
+    uint8_t* buf;
+    size_t len;
+    TelemetryFormat format;
+
+    // Batch in progress
+    Phase phase;
+    size_t cursor;
+    uint32_t batch;
+    uint32_t batch_start;
+    uint32_t since;            // Records heard at or after this are in the batch
+    bool full;
+    bool full_pending;
+    uint32_t sequence;
+    size_t frame_start;        // Offset of the open frame's sync bytes, SIZE_MAX for none
+    uint8_t frame_type;
+    uint16_t frame_count;
+
+    // Channel records as of start(), and as last sent to send only changes (index 0 unused)
+    TelemetryChannel channels[14];
+    TelemetryChannel sent[14];
+    TelemetrySummary summary;
+
+    MacAddr gone_mac[TELEMETRY_GONE_MAX];
+    uint8_t gone_kind[TELEMETRY_GONE_MAX];
+    size_t gone_head, gone_tail;
+
+    TelemetryStats st;
+};
+
+extern TelemetryEncoder telemetry;
+
+#endif // TELEMETRY_H
@@ -0,0 +1,109 @@
+// Watchlist of target devices: exact MACs and OUI prefixes
+//
+// Targets are added and removed at runtime (serial "watch" commands) and kept
+// in NVS. The parser tests both addresses of every frame against the list, so
+// membership is a probe into a small open-addressing set keyed by the packed
+// address: one lookup for the full MAC, one for its OUI, independent of how
+// many targets are watched. The set is rebuilt from the target array on every
+// change; changes are rare and the array is small.
+//
+// Not thread-safe; the sniffer uses it under registry_mutex.
+
+#ifndef WATCHLIST_H
+#define WATCHLIST_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "mac_addr.h"
+#include "rssi_track.h"
+
+#ifndef WATCHLIST_MAX
+#define WATCHLIST_MAX 32                   // Targets watched at once
+#endif
+#define WATCH_SET_BITS 7                   // 128 slots: at most 1/4 full
+#define WATCH_SET_SLOTS (1 << WATCH_SET_BITS)
+#define WATCH_TIMEOUT_MS 60000             // A target unheard this long is searched for again
+
+struct WatchTarget {
+    MacAddr key;               // Full address, or the OUI in the top 24 bits for a prefix
+    bool prefix;               // Matches every address with key's OUI
+    bool found;                // Heard within WATCH_TIMEOUT_MS
+    MacAddr last_mac;          // Address that matched most recently (differs from key for prefixes)
+    int rssi;                  // Last frame the target sent
+    RssiTrack rssi_track;      // Smoothed over the frames last_mac sent
+    int channel;
+    MacAddr ap;                // Zero until an association request names it
+    uint32_t tx_packets;       // Unique frames sent
+    uint32_t rx_packets;
+    uint32_t tx_retries;       // Frames sent with the Retry bit
+    uint32_t tx_duplicates;    // ... whose first copy was heard too (not in tx_packets)
+    unsigned long last_seen;
+    char ssid[33];             // Last directed probe, "" if none
+    char ip[16];               // "" until a data frame shows one
+};
+
+class Watchlist {
+public:
+    Watchlist();
+
+    // False when the list is full or the target is already watched
+    bool add(MacAddr key, bool prefix);
+    bool remove(MacAddr key, bool prefix);
+    void clear();
+
+    // Index of the target mac belongs to, or -1. An exact entry wins over a
+    // prefix covering the same address.
+    int match(MacAddr mac) const {
+        if (count == 0) return -1;
+        int i = probe(mac.value | KEY_MAC);
+        return i >= 0 ? i : probe((uint64_t)mac.oui() | KEY_PREFIX);
+    }
+
+    int find(MacAddr key, bool prefix) const;
+    size_t size() const { return count; }
+    WatchTarget& at(size_t i) { return targets[i]; }
+    const WatchTarget& at(size_t i) const { return targets[i]; }
+
+    // Targets lose "found" once unheard for timeout_ms
+    void expire(unsigned long now, unsigned long timeout_ms);
+
+    // Set keys of all targets (the persisted form) and the reverse
+    size_t export_keys(uint64_t* out, size_t max) const;
+    void import_keys(const uint64_t* keys, size_t n);
+
+    // Parses "AA:BB:CC:DD:EE:FF" or an OUI prefix "AA:BB:CC"
+    static bool parse(const char* str, MacAddr* key, bool* prefix);
+
+    // Writes the key as a MAC or as "AA:BB:CC:*"; out must hold 18 bytes
+    static void format(MacAddr key, bool prefix, char* out);
+
+private:
+    static const uint64_t KEY_MAC = 1ULL << 62;
+    static const uint64_t KEY_PREFIX = 1ULL << 63;
+
+    WatchTarget targets[WATCHLIST_MAX];
+    size_t count;
+    uint64_t slot_key[WATCH_SET_SLOTS];    // 0 = empty
+    uint8_t slot_target[WATCH_SET_SLOTS];
+
+    static uint64_t set_key(MacAddr key, bool prefix) {
+        return prefix ? ((uint64_t)key.oui() | KEY_PREFIX) : (key.value | KEY_MAC);
+    }
+    static size_t slot_of(uint64_t k) {
+        return (size_t)((k * 0x9E3779B97F4A7C15ULL) >> (64 - WATCH_SET_BITS));
+    }
+    int probe(uint64_t k) const {
+        for (size_t s = slot_of(k);; s = (s + 1) & (WATCH_SET_SLOTS - 1)) {
+            if (slot_key[s] == k) return slot_target[s];
+            if (slot_key[s] == 0) return -1;
+        }
+    }
+    void rebuild();
+};
+
+// Loads the watchlist saved by watchlist_save(); false if none is stored.
+// Both are no-ops on the host build.
+bool watchlist_load(Watchlist& list);
+bool watchlist_save(const Watchlist& list);
+
+#endif // WATCHLIST_H
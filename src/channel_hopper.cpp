@@ -0,0 +1,131 @@
+// Activity-weighted channel hopping
+
+#include "channel_hopper.h"
+#include <string.h>
+
+ChannelHopper::ChannelHopper()
+    : adaptive(true), dwell_start(0), dwell_length(HOP_FIXED_DWELL_MS), current_epoch(0),
+      dwell_channel(0), dwell_frames(0), dwell_new(0), target_channel(0), target_seen(0) {
+    memset(chan, 0, sizeof(chan));
+}
+
+void ChannelHopper::begin(int channel, uint32_t now) {
+    memset(chan, 0, sizeof(chan));
+    for (int ch = 1; ch <= HOP_CHANNEL_MAX; ch++) chan[ch].last_visit = now;
+    dwell_frames.store(0);
+    dwell_new.store(0);
+    dwell_channel.store(channel);
+    dwell_start = now;
+    dwell_length = dwell_for(channel);
+}
+
+bool ChannelHopper::is_locked(uint32_t now) const {
+    int tc = target_channel.load(std::memory_order_relaxed);
+    uint32_t seen = target_seen.load(std::memory_order_relaxed);
+    return is_adaptive() && tc >= 1 && tc <= HOP_CHANNEL_MAX && seen != 0 && now - seen < HOP_TARGET_LOCK_MS;
+}
+
+// 1 for a silent channel, up to 1 + HOP_FRAME_WEIGHT + HOP_DISCOVERY_WEIGHT for
+// the channel with both the highest frame rate and the highest discovery rate
+float ChannelHopper::score(int channel) const {
+    float max_frames = 0.0f;
+    float max_new = 0.0f;
+    for (int ch = 1; ch <= HOP_CHANNEL_MAX; ch++) {
+        if (chan[ch].frame_rate > max_frames) max_frames = chan[ch].frame_rate;
+        if (chan[ch].discovery_rate > max_new) max_new = chan[ch].discovery_rate;
+    }
+    
+    float s = 1.0f;
+    if (max_frames > 0.0f) s += HOP_FRAME_WEIGHT * chan[channel].frame_rate / max_frames;
+    if (max_new > 0.0f) s += HOP_DISCOVERY_WEIGHT * chan[channel].discovery_rate / max_new;
+    return s;
+}
+
+uint32_t ChannelHopper::dwell_for(int channel) const {
+    if (!is_adaptive()) return HOP_FIXED_DWELL_MS;
+    float share = (score(channel) - 1.0f) / (HOP_FRAME_WEIGHT + HOP_DISCOVERY_WEIGHT);
+    return HOP_MIN_DWELL_MS + (uint32_t)(share * (HOP_MAX_DWELL_MS - HOP_MIN_DWELL_MS));
+}
+
+int ChannelHopper::pick_next(uint32_t now) const {
+    int current = dwell_channel.load(std::memory_order_relaxed);
+    if (!is_adaptive()) return (current % HOP_CHANNEL_MAX) + 1;
+    
+    // Survey every channel once before weighting kicks in
+    for (int ch = 1; ch <= HOP_CHANNEL_MAX; ch++) {
+        if (chan[ch].visits == 0 && ch != current) return ch;
+    }
+    
+    // Channels past the revisit bound go first, oldest first
+    int overdue = 0;
+    uint32_t overdue_age = 0;
+    for (int ch = 1; ch <= HOP_CHANNEL_MAX; ch++) {
+        uint32_t age = now - chan[ch].last_visit;
+        if (ch != current && HOP_MAX_REVISIT_MS > 0 && age >= HOP_MAX_REVISIT_MS && age > overdue_age) {
+            overdue = ch;
+            overdue_age = age;
+        }
+    }
+    if (overdue != 0) return overdue;
+    
+    if (is_locked(now)) return target_channel.load(std::memory_order_relaxed);
+    
+    // Otherwise the channel whose weight times time-away is largest, so a
+    // channel with weight w is revisited roughly w times as often as an idle one
+    int best = current;
+    float best_priority = -1.0f;
+    for (int ch = 1; ch <= HOP_CHANNEL_MAX; ch++) {
+        if (ch == current) continue;
+        float priority = score(ch) * (float)(now - chan[ch].last_visit);
+        if (priority > best_priority) {
+            best_priority = priority;
+            best = ch;
+        }
+    }
+    return best;
+}
+
+bool ChannelHopper::poll(uint32_t now, int* next_channel) {
+    if (now - dwell_start < dwell_length) return false;
+    
+    int current = dwell_channel.load(std::memory_order_relaxed);
+    int next = pick_next(now);
+    if (next == current) {
+        // Staying put (target lock): close the dwell without retuning
+        begin_dwell(current, now);
+        return false;
+    }
+    *next_channel = next;
+    return true;
+}
+
+void ChannelHopper::begin_dwell(int channel, uint32_t now) {
+    int prev = dwell_channel.load(std::memory_order_relaxed);
+    
+    // Publish the new channel before the epoch, then stop crediting the old dwell
+    dwell_channel.store(channel, std::memory_order_relaxed);
+    current_epoch.fetch_add(1, std::memory_order_release);
+    uint32_t frames = dwell_frames.exchange(0, std::memory_order_relaxed);
+    uint32_t found = dwell_new.exchange(0, std::memory_order_relaxed);
+    
+    uint32_t elapsed = now - dwell_start;
+    if (prev >= 1 && prev <= HOP_CHANNEL_MAX && elapsed > 0) {
+        HopChannelStats& s = chan[prev];
+        float frame_rate = frames * 1000.0f / elapsed;
+        float discovery_rate = found * 1000.0f / elapsed;
+        if (s.visits == 0) {
+            s.frame_rate = frame_rate;
+            s.discovery_rate = discovery_rate;
+        } else {
+            s.frame_rate += HOP_RATE_ALPHA * (frame_rate - s.frame_rate);
+            s.discovery_rate += HOP_RATE_ALPHA * (discovery_rate - s.discovery_rate);
+        }
+        s.visits++;
+        s.last_visit = now;
+        s.dwell_ms_total += elapsed;
+    }
+    
+    dwell_start = now;
+    // While locked, dwell in short slices so revisits and unlock are checked often
+    dwell_length = is_locked(now) ? HOP_MIN_DWELL_MS : dwell_for(channel);
+}
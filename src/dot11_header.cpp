@@ -0,0 +1,56 @@
+// 802.11 MAC header decoding for data frames
+
+#include "dot11_header.h"
+
+bool decode_data_addrs(const uint8_t* frame, size_t len, DataFrameAddrs* out) {
+    if (len < DOT11_DATA_HEADER_MIN) return false;
+    
+    uint16_t fc = frame[0] | (frame[1] << 8);
+    uint8_t subtype = (fc >> 4) & 0x0F;
+    bool to_ds = fc & FC_TO_DS;
+    bool from_ds = fc & FC_FROM_DS;
+    
+    out->wds = to_ds && from_ds;
+    out->qos = subtype & DATA_SUBTYPE_QOS;
+    out->null_data = subtype & DATA_SUBTYPE_NULL;
+    
+    size_t header_len = DOT11_DATA_HEADER_MIN;
+    if (out->wds) header_len += 6;                         // Addr4
+    if (out->qos) header_len += 2;                         // QoS control
+    if (out->qos && (fc & FC_ORDER)) header_len += 4;      // HT control
+    if (len < header_len) return false;
+    out->header_len = header_len;
+    
+    MacAddr a1 = MacAddr::from_bytes(&frame[4]);
+    MacAddr a2 = MacAddr::from_bytes(&frame[10]);
+    MacAddr a3 = MacAddr::from_bytes(&frame[16]);
+    out->receiver = a1;
+    out->transmitter = a2;
+    
+    if (!to_ds && !from_ds) {
+        out->dst = a1;
+        out->src = a2;
+        out->bssid = a3;
+        out->station = a2;
+        out->station_is_transmitter = true;
+    } else if (to_ds && !from_ds) {
+        out->bssid = a1;
+        out->src = a2;
+        out->dst = a3;
+        out->station = a2;
+        out->station_is_transmitter = true;
+    } else if (!to_ds && from_ds) {
+        out->dst = a1;
+        out->bssid = a2;
+        out->src = a3;
+        out->station = a1;
+        out->station_is_transmitter = false;
+    } else {
+        out->dst = a3;
+        out->src = MacAddr::from_bytes(&frame[24]);
+        out->bssid = MacAddr{0};
+        out->station = MacAddr{0};
+        out->station_is_transmitter = false;
+    }
+    return true;
+}
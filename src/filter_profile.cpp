@@ -0,0 +1,67 @@
+// Hardware promiscuous filter profiles and their cost accounting
+
+#include "filter_profile.h"
+#include <string.h>
+
+// Frame classes each profile passes, as (1 << wifi_promiscuous_pkt_type_t)
+static const uint8_t PROFILE_TYPES[FILTER_PROFILES] = {
+    1 << WIFI_PKT_MGMT,
+    (1 << WIFI_PKT_MGMT) | (1 << WIFI_PKT_DATA),
+    (1 << WIFI_PKT_MGMT) | (1 << WIFI_PKT_DATA) | (1 << WIFI_PKT_CTRL)
+};
+
+static const char* const PROFILE_NAMES[FILTER_PROFILES] = {"discovery", "hunt", "full"};
+
+PromiscFilter::PromiscFilter() : current(FILTER_FULL), programmed(false), active_since(0) {
+    memset(stats, 0, sizeof(stats));
+}
+
+bool PromiscFilter::apply(FilterProfile p, uint32_t now) {
+    if (p >= FILTER_PROFILES || (programmed && p == active())) return false;
+#ifdef ESP_PLATFORM
+    wifi_promiscuous_filter_t filter = {0};
+    if (PROFILE_TYPES[p] & (1 << WIFI_PKT_MGMT)) filter.filter_mask |= WIFI_PROMIS_FILTER_MASK_MGMT;
+    if (PROFILE_TYPES[p] & (1 << WIFI_PKT_DATA)) filter.filter_mask |= WIFI_PROMIS_FILTER_MASK_DATA;
+    if (PROFILE_TYPES[p] & (1 << WIFI_PKT_CTRL)) {
+        // Control frames also need their subtypes enabled
+        wifi_promiscuous_filter_t ctrl = {WIFI_PROMIS_CTRL_FILTER_MASK_ALL};
+        filter.filter_mask |= WIFI_PROMIS_FILTER_MASK_CTRL;
+        if (esp_wifi_set_promiscuous_ctrl_filter(&ctrl) != ESP_OK) return false;
+    }
+    if (esp_wifi_set_promiscuous_filter(&filter) != ESP_OK) return false;
+#endif
+    if (programmed) stats[active()].active_ms += now - active_since;
+    active_since = now;
+    stats[p].activations++;
+    current.store(p, std::memory_order_relaxed);
+    programmed = true;
+    return true;
+}
+
+void PromiscFilter::snapshot(FilterStats out[FILTER_PROFILES], uint32_t now) const {
+    memcpy(out, stats, sizeof(stats));
+    if (programmed) out[active()].active_ms += now - active_since;
+}
+
+void PromiscFilter::reset(uint32_t now) {
+    memset(stats, 0, sizeof(stats));
+    active_since = now;
+}
+
+bool PromiscFilter::passes(FilterProfile p, wifi_promiscuous_pkt_type_t type) {
+    return p < FILTER_PROFILES && (PROFILE_TYPES[p] & (1 << type)) != 0;
+}
+
+const char* PromiscFilter::name(FilterProfile p) {
+    return p < FILTER_PROFILES ? PROFILE_NAMES[p] : "?";
+}
+
+bool PromiscFilter::parse(const char* text, FilterProfile* out) {
+    for (int i = 0; i < FILTER_PROFILES; i++) {
+        if (strcmp(text, PROFILE_NAMES[i]) == 0) {
+            *out = (FilterProfile)i;
+            return true;
+        }
+    }
+    return false;
+}
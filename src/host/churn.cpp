@@ -0,0 +1,328 @@
+// Synthetic registry churn benchmark for the native host build
+//
+// Simulates a long deployment on a virtual clock: a population of APs that
+// come and go with fresh SSIDs, and a faster-turning population of clients
+// (randomised MACs) that send directed probes for popular and rare networks.
+// The same event stream drives three setups:
+//
+//   pools     MacTable slabs + StringArena, the structures the sniffer uses
+//   default   one operator new per record and std::string/std::vector for
+//             names, the way the registries used to be built
+//   sniffer   beacons and probe requests built as CapturedFrames and fed to
+//             process_frame() with the real registries and expiry
+//
+// and the report compares time per event, allocations, and how much memory
+// the allocator is left holding in free blocks (glibc only) afterwards.
+
+#include <Arduino.h>
+#include <chrono>
+#include <math.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "sniffer.h"
+#include "mem_stats.h"
+#include "churn.h"
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+#define CHURN_EVENT_US 25000           // 40 frames/s
+#define CHURN_LIVE_APS 200
+#define CHURN_LIVE_CLIENTS 400
+#define CHURN_AP_LIFE_S 7200           // Mean AP lifetime
+#define CHURN_CLIENT_LIFE_S 900        // Mean client lifetime (MAC randomisation)
+#define CHURN_POPULAR_SSIDS 50
+#define CHURN_RARE_SSIDS 100000
+#define CHURN_EXPIRY_TICK_US 30000
+
+typedef std::chrono::steady_clock Clock;
+
+static uint64_t rng_state = 0x9E3779B97F4A7C15ULL;
+static uint64_t rng() {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return rng_state;
+}
+
+// Exponentially distributed lifetime with the given mean, in microseconds
+static uint64_t lifetime_us(uint32_t mean_s) {
+    double u = (double)((rng() >> 11) + 1) / 9007199254740993.0;
+    return (uint64_t)(-log(u) * mean_s * 1e6);
+}
+
+// Realistic spread of name lengths, most above std::string's inline capacity
+static void ssid_name(char* out, const char* kind, uint32_t id) {
+    static const char* const STEMS[] = {
+        "HomeNet", "TP-Link_Guest_5G", "eduroam", "AndroidAP", "DIRECT-Printer-Office",
+        "FRITZ!Box 7590", "Vodafone-Homespot", "iPhone de Marie", "Cafe_Free_WiFi_Guest"
+    };
+    snprintf(out, 33, "%s-%s%05u", STEMS[id % 9], kind, (unsigned)(id % 100000));
+}
+
+struct SimAp { uint64_t bssid; uint32_t ssid_id; uint64_t dies_us; };
+struct SimClient { uint64_t mac; uint32_t probes[3]; int probe_count; uint64_t dies_us; };
+
+struct ChurnEvent {
+    bool beacon;
+    uint64_t mac;
+    char ssid[33];
+};
+
+// Deterministic event source shared by every setup
+class ChurnSource {
+public:
+    ChurnSource() : next_mac(0x020000000000ULL), next_ssid(0) {}
+
+    void begin(uint64_t now_us) {
+        rng_state = 0x9E3779B97F4A7C15ULL;
+        next_mac = 0x020000000000ULL;
+        next_ssid = 0;
+        for (int i = 0; i < CHURN_LIVE_APS; i++) new_ap(&aps[i], now_us);
+        for (int i = 0; i < CHURN_LIVE_CLIENTS; i++) new_client(&clients[i], now_us);
+    }
+
+    void next(uint64_t now_us, ChurnEvent* ev) {
+        if (rng() & 1) {
+            SimAp& ap = aps[rng() % CHURN_LIVE_APS];
+            if (now_us >= ap.dies_us) new_ap(&ap, now_us);
+            ev->beacon = true;
+            ev->mac = ap.bssid;
+            ssid_name(ev->ssid, "AP", ap.ssid_id);
+        } else {
+            SimClient& c = clients[rng() % CHURN_LIVE_CLIENTS];
+            if (now_us >= c.dies_us) new_client(&c, now_us);
+            ev->beacon = false;
+            ev->mac = c.mac;
+            ev->ssid[0] = '\0';
+            if (c.probe_count > 0) ssid_name(ev->ssid, "P", c.probes[rng() % c.probe_count]);
+        }
+    }
+
+private:
+    void new_ap(SimAp* ap, uint64_t now_us) {
+        ap->bssid = next_mac++;
+        ap->ssid_id = next_ssid++;
+        ap->dies_us = now_us + lifetime_us(CHURN_AP_LIFE_S);
+    }
+
+    void new_client(SimClient* c, uint64_t now_us) {
+        c->mac = next_mac++;
+        c->probe_count = rng() % 4;
+        for (int i = 0; i < c->probe_count; i++) {
+            bool popular = rng() % 10 < 6;
+            c->probes[i] = popular ? rng() % CHURN_POPULAR_SSIDS : CHURN_POPULAR_SSIDS + rng() % CHURN_RARE_SSIDS;
+        }
+        c->dies_us = now_us + lifetime_us(CHURN_CLIENT_LIFE_S);
+    }
+
+    SimAp aps[CHURN_LIVE_APS];
+    SimClient clients[CHURN_LIVE_CLIENTS];
+    uint64_t next_mac;
+    uint32_t next_ssid;
+};
+
+// Record layouts for the two allocator setups
+struct PoolAp { const char* ssid = ""; unsigned long last_seen; };
+struct PoolClient { unsigned long last_seen; uint8_t probe_count; const char* probed[CLIENT_PROBE_SLOTS]; };
+struct HeapAp { std::string ssid; unsigned long last_seen; };
+struct HeapClient { unsigned long last_seen; std::vector<std::string> probed; };
+
+struct ChurnResult {
+    uint64_t ns;
+    size_t allocs;
+    size_t peak_live;
+    size_t heap_growth;        // Growth of the malloc heap over the run (glibc only)
+    size_t live_growth;        // Growth of live operator new bytes over the run
+    bool heap_known;
+};
+
+// Bytes the malloc heap has taken from the system, or 0 when unknown
+static size_t malloc_heap_bytes() {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+    struct mallinfo2 mi = mallinfo2();
+    return mi.arena + mi.hblkhd;
+#else
+    return 0;
+#endif
+}
+
+template <typename Step>
+static ChurnResult run_setup(uint64_t events, Step step) {
+    ChurnSource* src = new ChurnSource();
+    src->begin(1000000);
+    ChurnResult r = {};
+    size_t allocs0 = host_heap_allocs;
+    size_t live0 = host_heap_live;
+    size_t heap0 = malloc_heap_bytes();
+    ChurnEvent ev;
+    for (uint64_t i = 0; i < events; i++) {
+        uint64_t now_us = 1000000 + i * CHURN_EVENT_US;
+        src->next(now_us, &ev);
+        host_clock_set_us(now_us);
+        Clock::time_point t0 = Clock::now();
+        step(now_us, ev);
+        r.ns += std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - t0).count();
+        size_t live = host_heap_live - live0;
+        if (live > r.peak_live) r.peak_live = live;
+    }
+    r.allocs = host_heap_allocs - allocs0;
+    size_t heap1 = malloc_heap_bytes();
+    r.heap_growth = heap1 > heap0 ? heap1 - heap0 : 0;
+    r.live_growth = host_heap_live - live0;
+    r.heap_known = heap1 != 0;
+    delete src;
+    return r;
+}
+
+int run_churn(double hours) {
+    uint64_t events = (uint64_t)(hours * 3600e6 / CHURN_EVENT_US);
+    if (!sniffer_init()) {
+        fprintf(stderr, "sniffer_init failed\n");
+        return 1;
+    }
+    printf("churn         %.1f h virtual, %llu events, %d APs + %d clients live\n",
+           hours, (unsigned long long)events, CHURN_LIVE_APS, CHURN_LIVE_CLIENTS);
+
+    // pools: slab records and interned names, expired from the LRU tail
+    MacTable<PoolAp>* pool_aps = new MacTable<PoolAp>();
+    MacTable<PoolClient>* pool_clients = new MacTable<PoolClient>();
+    StringArena* arena = new StringArena();
+    if (!pool_aps->begin(AP_TABLE_CAPACITY) || !pool_clients->begin(CLIENT_TABLE_CAPACITY) ||
+        !arena->begin(SSID_ARENA_BYTES)) {
+        fprintf(stderr, "pool setup failed\n");
+        return 1;
+    }
+    uint64_t next_tick = 0;
+    ChurnResult pools = run_setup(events, [&](uint64_t now_us, const ChurnEvent& ev) {
+        unsigned long now = millis();
+        const char* s = ev.ssid[0] ? arena->intern(ev.ssid) : "";
+        if (s == nullptr) {
+            arena->flip();
+            for (auto& e : *pool_aps) e.value.ssid = arena->intern(e.value.ssid);
+            for (auto& e : *pool_clients) {
+                for (int i = 0; i < e.value.probe_count; i++) e.value.probed[i] = arena->intern(e.value.probed[i]);
+            }
+            s = arena->intern(ev.ssid);
+        }
+        if (ev.beacon) {
+            PoolAp& ap = pool_aps->upsert(ev.mac);
+            ap.ssid = s;
+            ap.last_seen = now;
+        } else {
+            PoolClient& c = pool_clients->upsert(ev.mac);
+            c.last_seen = now;
+            if (s[0] && (c.probe_count == 0 || c.probed[0] != s)) {
+                int n = c.probe_count < CLIENT_PROBE_SLOTS ? c.probe_count++ : CLIENT_PROBE_SLOTS - 1;
+                for (int i = n; i > 0; i--) c.probed[i] = c.probed[i - 1];
+                c.probed[0] = s;
+            }
+        }
+        if (now_us >= next_tick) {
+            for (int n = 0; n < EXPIRY_BUDGET; n++) {
+                uint16_t idx = pool_aps->lru_oldest();
+                if (idx == MacTable<PoolAp>::NIL || now - pool_aps->at(idx).value.last_seen <= AP_TTL_MS) break;
+                pool_aps->erase_at(idx);
+            }
+            for (int n = 0; n < EXPIRY_BUDGET; n++) {
+                uint16_t idx = pool_clients->lru_oldest();
+                if (idx == MacTable<PoolClient>::NIL || now - pool_clients->at(idx).value.last_seen <= CLIENT_TTL_MS) break;
+                pool_clients->erase_at(idx);
+            }
+            next_tick = now_us + CHURN_EXPIRY_TICK_US;
+        }
+    });
+    uint32_t pool_flips = arena->flips();
+    size_t pool_bytes = pool_aps->footprint() + pool_clients->footprint() + arena->footprint();
+    delete pool_aps;
+    delete pool_clients;
+    delete arena;
+
+    // default: a heap node per record, heap strings, periodic full scan
+    std::unordered_map<uint64_t, HeapAp*>* heap_aps = new std::unordered_map<uint64_t, HeapAp*>();
+    std::unordered_map<uint64_t, HeapClient*>* heap_clients = new std::unordered_map<uint64_t, HeapClient*>();
+    uint64_t next_scan = 0;
+    ChurnResult heap = run_setup(events, [&](uint64_t now_us, const ChurnEvent& ev) {
+        unsigned long now = millis();
+        if (ev.beacon) {
+            HeapAp*& ap = (*heap_aps)[ev.mac];
+            if (ap == nullptr) ap = new HeapAp();
+            if (ap->ssid != ev.ssid) ap->ssid = ev.ssid;
+            ap->last_seen = now;
+        } else {
+            HeapClient*& c = (*heap_clients)[ev.mac];
+            if (c == nullptr) c = new HeapClient();
+            c->last_seen = now;
+            if (ev.ssid[0] && (c->probed.empty() || c->probed[0] != ev.ssid)) {
+                c->probed.insert(c->probed.begin(), std::string(ev.ssid));
+                if (c->probed.size() > CLIENT_PROBE_SLOTS) c->probed.pop_back();
+            }
+        }
+        if (now_us >= next_scan) {
+            for (auto it = heap_aps->begin(); it != heap_aps->end();) {
+                if (now - it->second->last_seen > AP_TTL_MS) { delete it->second; it = heap_aps->erase(it); }
+                else ++it;
+            }
+            for (auto it = heap_clients->begin(); it != heap_clients->end();) {
+                if (now - it->second->last_seen > CLIENT_TTL_MS) { delete it->second; it = heap_clients->erase(it); }
+                else ++it;
+            }
+            next_scan = now_us + 60000000;
+        }
+    });
+    size_t heap_records = heap_aps->size() + heap_clients->size();
+    for (auto& kv : *heap_aps) delete kv.second;
+    for (auto& kv : *heap_clients) delete kv.second;
+    delete heap_aps;
+    delete heap_clients;
+
+    // sniffer: the real parser, registries, arena and expiry
+    uint8_t beacon_ies[2 + 32 + 3];
+    CapturedFrame* f = new CapturedFrame();
+    next_tick = 0;
+    ChurnResult sniffer = run_setup(events, [&](uint64_t now_us, const ChurnEvent& ev) {
+        memset(f, 0, sizeof(*f));
+        f->pkt_type = WIFI_PKT_MGMT;
+        f->channel = 6;
+        f->rssi = -60;
+        uint8_t* d = f->data;
+        size_t ssid_len = strlen(ev.ssid);
+        MacAddr mac = MacAddr::from_u64(ev.mac);
+        mac.to_bytes(d + 10);
+        size_t ie = ev.beacon ? IE_OFFSET_BEACON : IE_OFFSET_PROBE_REQUEST;
+        d[0] = ev.beacon ? 0x80 : 0x40;
+        if (ev.beacon) mac.to_bytes(d + 16);
+        else memset(d + 4, 0xFF, 6), memset(d + 16, 0xFF, 6);
+        beacon_ies[0] = IE_SSID;
+        beacon_ies[1] = (uint8_t)ssid_len;
+        memcpy(beacon_ies + 2, ev.ssid, ssid_len);
+        memcpy(d + ie, beacon_ies, 2 + ssid_len);
+        f->cap_len = f->sig_len = (uint16_t)(ie + 2 + ssid_len + 4);   // + FCS
+        process_frame(*f);
+        if (now_us >= next_tick) {
+            expire_stale_entries(millis(), EXPIRY_BUDGET);
+            next_tick = now_us + CHURN_EXPIRY_TICK_US;
+        }
+    });
+    delete f;
+
+    double per_event = 1.0 / (double)events;
+    printf("pools         %.0f ns/event  %zu allocations  %zu bytes fixed  arena compactions %u\n",
+           pools.ns * per_event, pools.allocs, pool_bytes, pool_flips);
+    printf("default       %.0f ns/event  %zu allocations  peak %zu bytes live  %zu records at end",
+           heap.ns * per_event, heap.allocs, heap.peak_live, heap_records);
+    if (heap.heap_known) {
+        // Heap the allocator grew into but that no live record uses: free
+        // fragments plus per-block overhead
+        printf("  heap grew %zu bytes for %zu live (%.0f%% overhead and fragmentation)",
+               heap.heap_growth, heap.live_growth,
+               heap.heap_growth > heap.live_growth && heap.heap_growth > 0
+                   ? 100.0 * (heap.heap_growth - heap.live_growth) / heap.heap_growth : 0.0);
+    }
+    printf("\n");
+    printf("sniffer       %.0f ns/event  %zu allocations  APs %zu  clients %zu  expired %u/%u  arena %zu strings, %u compactions\n",
+           sniffer.ns * per_event, sniffer.allocs, ap_registry.size(), client_registry.size(),
+           ap_expired, client_expired, ssid_arena.strings(), ssid_arena.flips());
+    return 0;
+}
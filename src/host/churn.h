@@ -0,0 +1,10 @@
+// Synthetic registry churn benchmark (native host build only)
+
+#ifndef HOST_CHURN_H
+#define HOST_CHURN_H
+
+// Runs hours of virtual time through the pool, default-allocator and full
+// sniffer setups and prints the comparison; returns the process exit code
+int run_churn(double hours);
+
+#endif // HOST_CHURN_H
@@ -0,0 +1,104 @@
+// Synthetic 802.11 frames for the native host build
+
+#include <Arduino.h>
+#include "sniffer.h"
+#include "frame_builder.h"
+
+static uint16_t next_seq = 0;
+
+static void put_mac(RawFrame* f, MacAddr mac) {
+    uint8_t b[6];
+    mac.to_bytes(b);
+    f->insert(f->end(), b, b + 6);
+}
+
+void frame_header(RawFrame* f, uint8_t type, uint8_t subtype, uint8_t flags,
+                  MacAddr a1, MacAddr a2, MacAddr a3, MacAddr a4) {
+    f->push_back((uint8_t)((subtype << 4) | (type << 2)));
+    f->push_back(flags);
+    f->push_back(0);       // Duration
+    f->push_back(0);
+    put_mac(f, a1);
+    put_mac(f, a2);
+    put_mac(f, a3);
+    if (!(flags & FRAME_RETRY)) next_seq = (next_seq + 1) & 0x0FFF;
+    f->push_back((uint8_t)(next_seq << 4));
+    f->push_back((uint8_t)(next_seq >> 4));
+    if ((flags & (FRAME_TO_DS | FRAME_FROM_DS)) == (FRAME_TO_DS | FRAME_FROM_DS)) put_mac(f, a4);
+}
+
+void frame_ie(RawFrame* f, uint8_t id, const void* data, size_t len) {
+    f->push_back(id);
+    f->push_back((uint8_t)len);
+    const uint8_t* p = (const uint8_t*)data;
+    f->insert(f->end(), p, p + len);
+}
+
+RawFrame beacon_frame(MacAddr bssid, const char* ssid, uint8_t channel) {
+    RawFrame f;
+    frame_header(&f, WIFI_MANAGEMENT_FRAME, WIFI_BEACON_FRAME, 0, MacAddr::from_u64(0xFFFFFFFFFFFFULL), bssid, bssid);
+    static const uint8_t FIXED[12] = {0, 0, 0, 0, 0, 0, 0, 0, 0x64, 0x00, 0x01, 0x00};  // TSF, 100 TU, ESS
+    f.insert(f.end(), FIXED, FIXED + sizeof(FIXED));
+    frame_ie(&f, 0, ssid, strlen(ssid));
+    frame_ie(&f, 3, &channel, 1);
+    return f;
+}
+
+RawFrame probe_request_frame(MacAddr sta, const char* ssid) {
+    RawFrame f;
+    MacAddr bcast = MacAddr::from_u64(0xFFFFFFFFFFFFULL);
+    frame_header(&f, WIFI_MANAGEMENT_FRAME, WIFI_PROBE_REQUEST, 0, bcast, sta, bcast);
+    frame_ie(&f, 0, ssid, strlen(ssid));
+    static const uint8_t RATES[4] = {0x82, 0x84, 0x8B, 0x96};
+    frame_ie(&f, 1, RATES, sizeof(RATES));
+    return f;
+}
+
+RawFrame data_frame(uint8_t subtype, uint8_t flags, MacAddr a1, MacAddr a2, MacAddr a3, MacAddr a4) {
+    RawFrame f;
+    frame_header(&f, WIFI_DATA_FRAME, subtype, flags, a1, a2, a3, a4);
+    if (subtype & 0x08) {
+        f.push_back(0);    // QoS control: TID 0
+        f.push_back(0);
+    }
+    if (!(subtype & 0x04)) {
+        static const uint8_t LLC[8] = {0xAA, 0xAA, 0x03, 0x00, 0x00, 0x00, 0x08, 0x00};
+        f.insert(f.end(), LLC, LLC + sizeof(LLC));
+    }
+    return f;
+}
+
+std::vector<uint8_t> driver_packet(const RawFrame& frame, int rssi, int channel) {
+    std::vector<uint8_t> buf(sizeof(wifi_promiscuous_pkt_t) + frame.size() + 4, 0);
+    wifi_promiscuous_pkt_t* pkt = (wifi_promiscuous_pkt_t*)buf.data();
+    pkt->rx_ctrl.rssi = rssi;
+    pkt->rx_ctrl.noise_floor = -95;
+    pkt->rx_ctrl.channel = channel;
+    pkt->rx_ctrl.rate = 0x0B;                  // 6 Mbps
+    pkt->rx_ctrl.sig_len = frame.size() + 4;
+    pkt->rx_ctrl.timestamp = (uint32_t)micros();
+    memcpy(pkt->payload, frame.data(), frame.size());
+    return buf;
+}
+
+wifi_promiscuous_pkt_type_t driver_pkt_type(const RawFrame& frame) {
+    switch ((frame[0] >> 2) & 0x03) {
+        case WIFI_MANAGEMENT_FRAME: return WIFI_PKT_MGMT;
+        case WIFI_CONTROL_FRAME: return WIFI_PKT_CTRL;
+        case WIFI_DATA_FRAME: return WIFI_PKT_DATA;
+        default: return WIFI_PKT_MISC;
+    }
+}
+
+void deliver_frame(const RawFrame& frame, int rssi, int channel) {
+    std::vector<uint8_t> buf = driver_packet(frame, rssi, channel);
+    wifi_sniffer_packet_handler(buf.data(), driver_pkt_type(frame));
+    drain_capture_ring();
+}
+
+void drain_capture_ring() {
+    while (capture_ring.available() > 0) {
+        process_frame(capture_ring.peek(0));
+        capture_ring.consume(1);
+    }
+}
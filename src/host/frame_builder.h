@@ -0,0 +1,55 @@
+// Synthetic 802.11 frames for the unit tests (native host build only)
+//
+// Builds raw frames without FCS and hands them to the sniffer the way the
+// driver does: a wifi_promiscuous_pkt_t with the FCS counted in sig_len,
+// through wifi_sniffer_packet_handler, after which the capture ring is
+// drained through process_frame as the parser task would.
+
+#ifndef HOST_FRAME_BUILDER_H
+#define HOST_FRAME_BUILDER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+#include <esp_wifi.h>
+#include "mac_addr.h"
+
+#define FRAME_TO_DS   0x01
+#define FRAME_FROM_DS 0x02
+#define FRAME_RETRY   0x08
+
+typedef std::vector<uint8_t> RawFrame;
+
+// Header of type (WIFI_*_FRAME) and subtype with flags (FRAME_*) in the second
+// frame control byte. Every header gets the next sequence number unless the
+// frame is a retry, which repeats the last one. FRAME_TO_DS | FRAME_FROM_DS
+// adds the fourth address.
+void frame_header(RawFrame* f, uint8_t type, uint8_t subtype, uint8_t flags,
+                  MacAddr a1, MacAddr a2, MacAddr a3, MacAddr a4 = MacAddr());
+
+// Appends an information element
+void frame_ie(RawFrame* f, uint8_t id, const void* data, size_t len);
+
+// Beacon with SSID and DS parameter elements; callers append security IEs
+RawFrame beacon_frame(MacAddr bssid, const char* ssid, uint8_t channel);
+
+// Probe request from sta for ssid ("" for a wildcard probe)
+RawFrame probe_request_frame(MacAddr sta, const char* ssid);
+
+// Data frame of subtype (0 data, 4 null, 8 QoS data, 12 QoS null); QoS
+// subtypes carry the QoS control field, non-null ones an LLC header
+RawFrame data_frame(uint8_t subtype, uint8_t flags, MacAddr a1, MacAddr a2, MacAddr a3, MacAddr a4 = MacAddr());
+
+// Driver buffer for frame as received on channel, FCS appended
+std::vector<uint8_t> driver_packet(const RawFrame& frame, int rssi, int channel);
+
+// Frame class the driver would report for frame
+wifi_promiscuous_pkt_type_t driver_pkt_type(const RawFrame& frame);
+
+// Runs frame through the RX callback and the parser at the current virtual time
+void deliver_frame(const RawFrame& frame, int rssi = -50, int channel = 1);
+
+// Parses whatever the RX callback left in the capture ring
+void drain_capture_ring();
+
+#endif // HOST_FRAME_BUILDER_H
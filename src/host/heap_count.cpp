@@ -0,0 +1,43 @@
+// Counting allocator for the native host build
+//
+// Replaces the global operator new and delete so the replay report and the
+// unit tests can see live and peak heap use and how many allocations a code
+// path made (host_heap_* in the Arduino stub).
+
+#include <Arduino.h>
+#include <new>
+
+// operator delete frees the malloc block behind the pointer operator new
+// returned; GCC sees free() applied to memory from operator new and warns
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void* operator new(size_t size) {
+    size_t* p = (size_t*)malloc(size + sizeof(size_t) * 2);
+    if (p == nullptr) throw std::bad_alloc();
+    p[0] = size;
+    host_heap_live += size;
+    host_heap_allocs++;
+    if (host_heap_live > host_heap_peak) host_heap_peak = host_heap_live;
+    return p + 2;
+}
+
+void* operator new[](size_t size) { return operator new(size); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    try { return operator new(size); } catch (...) { return nullptr; }
+}
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    try { return operator new(size); } catch (...) { return nullptr; }
+}
+
+void operator delete(void* ptr) noexcept {
+    if (ptr == nullptr) return;
+    size_t* p = (size_t*)ptr - 2;
+    host_heap_live -= p[0];
+    free(p);
+}
+
+void operator delete[](void* ptr) noexcept { operator delete(ptr); }
+void operator delete(void* ptr, size_t) noexcept { operator delete(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { operator delete(ptr); }
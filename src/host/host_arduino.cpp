@@ -0,0 +1,29 @@
+// Host implementations of the Arduino stubs
+
+#include <Arduino.h>
+#include <stdarg.h>
+
+HostSerial Serial;
+size_t host_heap_live = 0;
+size_t host_heap_base = 0;
+size_t host_heap_allocs = 0;
+size_t host_heap_peak = 0;
+
+static uint64_t clock_us = 0;
+
+void host_clock_set_us(uint64_t us) { clock_us = us; }
+unsigned long millis() { return (unsigned long)(clock_us / 1000); }
+unsigned long micros() { return (unsigned long)clock_us; }
+void delay(unsigned long ms) { clock_us += (uint64_t)ms * 1000; }
+
+void HostSerial::println(const char* s) {
+    fprintf(stderr, "%s\n", s);
+}
+
+int HostSerial::printf(const char* fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    int n = vfprintf(stderr, fmt, args);
+    va_end(args);
+    return n;
+}
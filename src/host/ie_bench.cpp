@@ -0,0 +1,169 @@
+// Beacon element parsing microbenchmark
+//
+// Runs what process_frame does with a beacon's tagged parameters: copy the
+// SSID, find the DS parameter set and decode RSN and WPA elements. The
+// built-in corpus covers the layouts seen in the field: open hotspots,
+// WPA2, WPA2/WPA3 transition, WPA3, OWE, enterprise, legacy WPA+WPA2, and a
+// few damaged elements, each padded with the HT, WMM and WPS elements real
+// beacons carry so the walk is as long as on air.
+
+#include <Arduino.h>
+#include <chrono>
+#include <vector>
+#include "sniffer.h"
+#include "ie_parser.h"
+#include "frame_builder.h"
+#include "pcap_reader.h"
+#include "ie_bench.h"
+
+typedef std::chrono::steady_clock Clock;
+
+// One beacon body from the first tagged parameter on
+struct BenchBeacon {
+    uint16_t capability;
+    std::vector<uint8_t> ies;
+};
+
+// Suite count and list, IEEE OUI
+static void add_suites(RawFrame* b, uint8_t count, const uint8_t* types) {
+    b->push_back(count);
+    b->push_back(0);
+    for (uint8_t i = 0; i < count; i++) {
+        uint8_t s[4] = {0x00, 0x0F, 0xAC, types[i]};
+        b->insert(b->end(), s, s + 4);
+    }
+}
+
+// RSN element body; caps < 0 leaves the capabilities out
+static RawFrame rsn_body(uint8_t pairwise, uint8_t akm1, uint8_t akm2, int caps) {
+    RawFrame b = {0x01, 0x00, 0x00, 0x0F, 0xAC, pairwise};
+    uint8_t akms[2] = {akm1, akm2};
+    add_suites(&b, 1, &pairwise);
+    add_suites(&b, akm2 ? 2 : 1, akms);
+    if (caps >= 0) {
+        b.push_back((uint8_t)caps);
+        b.push_back((uint8_t)(caps >> 8));
+    }
+    return b;
+}
+
+static void add_padding(RawFrame* b) {
+    static const uint8_t RATES[8] = {0x82, 0x84, 0x8B, 0x96, 0x0C, 0x12, 0x18, 0x24};
+    static const uint8_t HT_CAPS[26] = {0xEF, 0x01, 0x1B, 0xFF, 0xFF};
+    static const uint8_t HT_OP[22] = {6, 0x05};
+    static const uint8_t WMM[24] = {0x00, 0x50, 0xF2, 0x02, 0x01, 0x01, 0x80};
+    static const uint8_t WPS[14] = {0x00, 0x50, 0xF2, 0x04, 0x10, 0x4A, 0x00, 0x01, 0x10};
+    frame_ie(b, 1, RATES, sizeof(RATES));
+    frame_ie(b, 45, HT_CAPS, sizeof(HT_CAPS));
+    frame_ie(b, 61, HT_OP, sizeof(HT_OP));
+    frame_ie(b, IE_VENDOR, WMM, sizeof(WMM));
+    frame_ie(b, IE_VENDOR, WPS, sizeof(WPS));
+}
+
+static void build_corpus(std::vector<BenchBeacon>* corpus) {
+    static const uint8_t WPA_TKIP_PSK[] = {0x00, 0x50, 0xF2, 0x01, 0x01, 0x00, 0x00, 0x50, 0xF2, 0x02,
+                                           0x01, 0x00, 0x00, 0x50, 0xF2, 0x02, 0x01, 0x00, 0x00, 0x50, 0xF2, 0x02};
+    char ssid[33];
+    for (int i = 0; i < 64; i++) {
+        BenchBeacon bb;
+        bb.capability = 0x0011;
+        RawFrame ies;
+        snprintf(ssid, sizeof(ssid), i % 8 == 7 ? "%032d" : "Network-%d", i);
+        uint8_t channel = 1 + i % 13;
+        frame_ie(&ies, IE_SSID, ssid, strlen(ssid));
+        add_padding(&ies);
+        frame_ie(&ies, IE_DS_PARAMS, &channel, 1);
+        RawFrame rsn;
+        switch (i % 8) {
+            case 0: bb.capability = 0x0001; break;                       // Open
+            case 1: rsn = rsn_body(0x04, 0x02, 0, 0x0000); break;        // WPA2
+            case 2: rsn = rsn_body(0x04, 0x02, 0x08, 0x0080); break;     // WPA2/3
+            case 3: rsn = rsn_body(0x04, 0x08, 0, 0x00C0); break;        // WPA3
+            case 4: rsn = rsn_body(0x04, 18, 0, 0x00C0); break;          // OWE
+            case 5: rsn = rsn_body(0x04, 0x01, 0x03, 0x0080); break;     // Enterprise with FT
+            case 6:                                                       // WPA + WPA2
+                rsn = rsn_body(0x04, 0x02, 0, -1);
+                frame_ie(&ies, IE_VENDOR, WPA_TKIP_PSK, sizeof(WPA_TKIP_PSK));
+                break;
+            case 7:                                                       // RSN cut inside the AKM list
+                rsn = rsn_body(0x04, 0x02, 0x08, -1);
+                rsn.resize(rsn.size() - 3);
+                break;
+        }
+        if (!rsn.empty()) frame_ie(&ies, IE_RSN, rsn.data(), rsn.size());
+        bb.ies.assign(ies.begin(), ies.end());
+        corpus->push_back(bb);
+    }
+}
+
+static bool load_beacons(const char* path, std::vector<BenchBeacon>* corpus) {
+    std::vector<ReplayFrame> frames;
+    if (!load_pcap(path, &frames)) return false;
+    for (const ReplayFrame& rf : frames) {
+        const wifi_promiscuous_pkt_t* pkt = (const wifi_promiscuous_pkt_t*)rf.buf.data();
+        size_t len = rf.buf.size() - sizeof(wifi_promiscuous_pkt_t) - 4;     // Without FCS
+        const uint8_t* d = pkt->payload;
+        if (rf.type != WIFI_PKT_MGMT || len <= IE_OFFSET_BEACON || d[0] != (WIFI_BEACON_FRAME << 4)) continue;
+        BenchBeacon bb;
+        bb.capability = d[CAPABILITY_OFFSET] | (d[CAPABILITY_OFFSET + 1] << 8);
+        bb.ies.assign(d + IE_OFFSET_BEACON, d + len);
+        corpus->push_back(bb);
+    }
+    return true;
+}
+
+int run_ie_bench(int passes, const char* path) {
+    if (passes < 1) passes = 1;
+    std::vector<BenchBeacon> corpus;
+    if (path == nullptr) build_corpus(&corpus);
+    else if (!load_beacons(path, &corpus)) return 1;
+    if (corpus.empty()) {
+        fprintf(stderr, "no beacons to parse\n");
+        return 1;
+    }
+    size_t bytes = 0;
+    for (const BenchBeacon& bb : corpus) bytes += bb.ies.size();
+
+    // Labels once, outside the timing, so the report shows what was parsed
+    static const char* const LABELS[] = {"Open", "WEP", "WPA", "WPA-EAP", "WPA2", "WPA2/3", "WPA3",
+                                         "OWE", "WPA2-EAP", "WPA3-EAP"};
+    const size_t n_labels = sizeof(LABELS) / sizeof(LABELS[0]);
+    size_t by_label[n_labels] = {};
+    size_t malformed = 0;
+    for (const BenchBeacon& bb : corpus) {
+        SecurityInfo sec;
+        parse_security(bb.capability, bb.ies.data(), bb.ies.size(), &sec);
+        malformed += (sec.flags & SEC_MALFORMED) != 0;
+        const char* label = security_label(sec);
+        for (size_t i = 0; i < n_labels; i++) by_label[i] += strcmp(label, LABELS[i]) == 0;
+    }
+
+    uint32_t sink = 0;
+    Clock::time_point t0 = Clock::now();
+    for (int p = 0; p < passes; p++) {
+        for (const BenchBeacon& bb : corpus) {
+            const uint8_t* ies = bb.ies.data();
+            size_t len = bb.ies.size();
+            char ssid[33];
+            if (ie_copy_ssid(ies, len, ssid)) sink += (uint8_t)ssid[0];
+            IeView ds;
+            if (ie_find(ies, len, IE_DS_PARAMS, &ds) && ds.len >= 1) sink += ds.data[0];
+            SecurityInfo sec;
+            parse_security(bb.capability, ies, len, &sec);
+            sink += sec.akm + sec.flags;
+        }
+    }
+    double s = std::chrono::duration<double>(Clock::now() - t0).count();
+    if (sink == 1) printf(" ");          // Keeps the loop from being optimised away
+
+    size_t parsed = corpus.size() * passes;
+    printf("ie bench: %zu beacons from %s, %d passes, %.0f element bytes each on average\n",
+           corpus.size(), path != nullptr ? path : "the built-in corpus", passes, (double)bytes / corpus.size());
+    printf("  %.1f ns/beacon  %.0f MB/s\n", s * 1e9 / parsed, bytes * (double)passes / s / 1e6);
+    printf("  malformed %zu ", malformed);
+    for (size_t i = 0; i < n_labels; i++) {
+        if (by_label[i] > 0) printf(" %s %zu", LABELS[i], by_label[i]);
+    }
+    printf("\n");
+    return 0;
+}
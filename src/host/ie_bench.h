@@ -0,0 +1,11 @@
+// Beacon element parsing microbenchmark (native host build only)
+
+#ifndef HOST_IE_BENCH_H
+#define HOST_IE_BENCH_H
+
+// Times the beacon element work of the parser (SSID, DS channel, security)
+// over the beacons of a capture, or over a built-in corpus when path is null;
+// returns the process exit code
+int run_ie_bench(int passes, const char* path);
+
+#endif // HOST_IE_BENCH_H
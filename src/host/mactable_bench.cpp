@@ -0,0 +1,146 @@
+// Registry table microbenchmark
+//
+// Compares MacTable<ClientInfo> with the std::map<String, ...> the registries
+// used before, here std::map<std::string, ClientInfo> since the host has no
+// Arduino String. The map is keyed by the formatted MAC, so its insert and
+// lookup times include formatting the key as the old parser did on every
+// frame. MACs come from a handful of OUIs, as clients near one another do;
+// a tenth of the lookups miss.
+
+#include <Arduino.h>
+#include <chrono>
+#include <map>
+#include <string>
+#include <vector>
+#include "sniffer.h"
+#include "mactable_bench.h"
+
+typedef std::chrono::steady_clock Clock;
+
+static const uint32_t BENCH_OUIS[8] = {0xACDE48, 0xF01898, 0x2811A5, 0x342EB7, 0x3C0754, 0x001A11, 0x5CCF7F, 0xB827EB};
+
+static uint64_t bench_rng = 0x9E3779B97F4A7C15ULL;
+static uint32_t rnd(uint32_t n) {
+    bench_rng ^= bench_rng << 13;
+    bench_rng ^= bench_rng >> 7;
+    bench_rng ^= bench_rng << 17;
+    return (uint32_t)(bench_rng >> 32) % n;
+}
+
+// Distinct for i below 2^24: an odd multiplier permutes the low 24 bits
+static uint64_t bench_mac(uint32_t i, uint32_t oui) {
+    return ((uint64_t)oui << 24) | ((i * 0x9E3779B1u) & 0xFFFFFF);
+}
+
+static double ns_per(Clock::time_point t0, Clock::time_point t1, size_t ops) {
+    return std::chrono::duration<double, std::nano>(t1 - t0).count() / (ops ? ops : 1);
+}
+
+struct BenchResult {
+    double insert_ns;
+    double lookup_ns;
+    double iterate_ns;         // Per entry visited
+    size_t allocs;             // operator new calls to build the table
+    size_t bytes;              // Heap held once built
+    uint64_t sink;             // Checksum, also keeps the loops from being optimised away
+};
+
+static BenchResult bench_table(const std::vector<uint64_t>& keys, const std::vector<uint64_t>& queries, int passes) {
+    BenchResult r = {};
+    size_t live = host_heap_live;
+    size_t allocs = host_heap_allocs;
+    MacTable<ClientInfo> table;
+    table.begin((uint16_t)keys.size());
+
+    Clock::time_point t0 = Clock::now();
+    for (uint64_t k : keys) table.upsert(k).frame_count = (uint32_t)k;
+    Clock::time_point t1 = Clock::now();
+    r.insert_ns = ns_per(t0, t1, keys.size());
+    r.allocs = host_heap_allocs - allocs;
+    r.bytes = host_heap_live - live;
+
+    t0 = Clock::now();
+    for (uint64_t q : queries) {
+        const ClientInfo* c = table.find(q);
+        if (c != nullptr) r.sink += c->frame_count;
+    }
+    t1 = Clock::now();
+    r.lookup_ns = ns_per(t0, t1, queries.size());
+
+    t0 = Clock::now();
+    for (int p = 0; p < passes; p++) {
+        for (const auto& e : table) r.sink += e.value.frame_count;
+    }
+    t1 = Clock::now();
+    r.iterate_ns = ns_per(t0, t1, (size_t)passes * table.size());
+    return r;
+}
+
+static BenchResult bench_map(const std::vector<uint64_t>& keys, const std::vector<uint64_t>& queries, int passes) {
+    BenchResult r = {};
+    size_t live = host_heap_live;
+    size_t allocs = host_heap_allocs;
+    std::map<std::string, ClientInfo> table;
+    char mac[18];
+
+    Clock::time_point t0 = Clock::now();
+    for (uint64_t k : keys) {
+        MacAddr::from_u64(k).format(mac);
+        table[mac].frame_count = (uint32_t)k;
+    }
+    Clock::time_point t1 = Clock::now();
+    r.insert_ns = ns_per(t0, t1, keys.size());
+    r.allocs = host_heap_allocs - allocs;
+    r.bytes = host_heap_live - live;
+
+    t0 = Clock::now();
+    for (uint64_t q : queries) {
+        MacAddr::from_u64(q).format(mac);
+        auto it = table.find(mac);
+        if (it != table.end()) r.sink += it->second.frame_count;
+    }
+    t1 = Clock::now();
+    r.lookup_ns = ns_per(t0, t1, queries.size());
+
+    t0 = Clock::now();
+    for (int p = 0; p < passes; p++) {
+        for (const auto& e : table) r.sink += e.second.frame_count;
+    }
+    t1 = Clock::now();
+    r.iterate_ns = ns_per(t0, t1, (size_t)passes * table.size());
+    return r;
+}
+
+int run_mactable_bench(int lookups) {
+    static const uint32_t SIZES[3] = {100, 1000, 10000};
+    if (lookups < 1) lookups = 1;
+    int failed = 0;
+
+    printf("mactable bench: %d lookups per size, 10%% misses\n", lookups);
+    printf("  entries  structure    insert ns  lookup ns  iterate ns/entry  allocs  heap bytes\n");
+    for (uint32_t n : SIZES) {
+        std::vector<uint64_t> keys(n);
+        for (uint32_t i = 0; i < n; i++) keys[i] = bench_mac(i, BENCH_OUIS[rnd(8)]);
+        std::vector<uint64_t> queries(lookups);
+        for (int i = 0; i < lookups; i++) {
+            queries[i] = rnd(10) == 0 ? bench_mac(rnd(1 << 24), 0x02BEEF) : keys[rnd(n)];
+        }
+        int passes = std::max(1, lookups / (int)n);
+
+        // Warm both once so neither pays for the first page faults
+        bench_table(keys, queries, 1);
+        bench_map(keys, queries, 1);
+        BenchResult t = bench_table(keys, queries, passes);
+        BenchResult m = bench_map(keys, queries, passes);
+
+        printf("  %-7u  MacTable     %9.1f  %9.1f  %16.2f  %6zu  %10zu\n",
+               n, t.insert_ns, t.lookup_ns, t.iterate_ns, t.allocs, t.bytes);
+        printf("  %-7u  std::map     %9.1f  %9.1f  %16.2f  %6zu  %10zu\n",
+               n, m.insert_ns, m.lookup_ns, m.iterate_ns, m.allocs, m.bytes);
+        if (t.sink != m.sink) {
+            printf("  %u entries: results differ\n", n);
+            failed = 1;
+        }
+    }
+    return failed;
+}
@@ -0,0 +1,11 @@
+// Registry table microbenchmark (native host build only)
+
+#ifndef HOST_MACTABLE_BENCH_H
+#define HOST_MACTABLE_BENCH_H
+
+// Times MacTable insert, lookup and iteration against a std::map keyed by the
+// formatted MAC, as the registries were before, at 100, 1k and 10k entries;
+// returns the process exit code
+int run_mactable_bench(int lookups);
+
+#endif // HOST_MACTABLE_BENCH_H
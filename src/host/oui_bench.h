@@ -0,0 +1,10 @@
+// OUI lookup microbenchmark (native host build only)
+
+#ifndef HOST_OUI_BENCH_H
+#define HOST_OUI_BENCH_H
+
+// Times the generated-table lookup against the old switch over a mix of
+// registered, unregistered and randomised MACs; returns the process exit code
+int run_oui_bench(int lookups);
+
+#endif // HOST_OUI_BENCH_H
@@ -0,0 +1,137 @@
+// pcap loading for the native host build
+
+#include <Arduino.h>
+#include "sniffer.h"
+#include "pcap_reader.h"
+
+static uint16_t le16(const uint8_t* p) { return p[0] | (p[1] << 8); }
+static uint32_t le32(const uint8_t* p) { return le16(p) | ((uint32_t)le16(p + 2) << 16); }
+static uint64_t le64(const uint8_t* p) { return le32(p) | ((uint64_t)le32(p + 4) << 32); }
+
+// Walks the radiotap fields up to dBm antenna noise (present bits 0-6)
+bool parse_radiotap(const uint8_t* p, size_t len, size_t* hdr_len, RadiotapInfo* out) {
+    static const uint8_t ALIGN[7] = {8, 1, 1, 2, 1, 1, 1};
+    static const uint8_t SIZE[7] = {8, 1, 1, 4, 2, 1, 1};
+
+    if (len < 8 || p[0] != 0) return false;
+    *hdr_len = le16(p + 2);
+    if (*hdr_len > len) return false;
+
+    uint32_t present = le32(p + 4);
+    size_t off = 8;
+    for (uint32_t word = present; word & 0x80000000u; off += 4) {
+        if (off + 4 > *hdr_len) return false;
+        word = le32(p + off);
+    }
+
+    for (int bit = 0; bit < 7; bit++) {
+        if (!(present & (1u << bit))) continue;
+        off = (off + ALIGN[bit] - 1) & ~(size_t)(ALIGN[bit] - 1);
+        if (off + SIZE[bit] > *hdr_len) return false;
+        const uint8_t* f = p + off;
+        switch (bit) {
+            case 0: out->tsft = le64(f); out->has_tsft = true; break;
+            case 1: out->has_fcs = f[0] & 0x10; break;
+            case 2: out->rate = f[0]; break;
+            case 3: {
+                uint16_t freq = le16(f);
+                if (freq == 2484) out->channel = 14;
+                else if (freq >= 2412 && freq <= 2472) out->channel = (freq - 2407) / 5;
+                break;
+            }
+            case 5: out->rssi = (int8_t)f[0]; break;
+            case 6: out->noise = (int8_t)f[0]; break;
+        }
+        off += SIZE[bit];
+    }
+    return true;
+}
+
+// radiotap rate (500 kbps units) back to the ESP32 legacy rate index
+static uint8_t esp_rate_index(uint8_t rate_500k) {
+    static const uint8_t TABLE[16] = {2, 4, 11, 22, 0, 4, 11, 22, 96, 48, 24, 12, 108, 72, 36, 18};
+    for (uint8_t i = 0; i < 16; i++) {
+        if (i != 4 && TABLE[i] == rate_500k) return i;
+    }
+    return 0x0B; // 6 Mbps
+}
+
+bool load_pcap(const char* path, std::vector<ReplayFrame>* frames) {
+    FILE* fp = fopen(path, "rb");
+    if (fp == nullptr) {
+        fprintf(stderr, "cannot open %s\n", path);
+        return false;
+    }
+
+    uint8_t gh[24];
+    if (fread(gh, 1, sizeof(gh), fp) != sizeof(gh)) {
+        fprintf(stderr, "%s: short pcap header\n", path);
+        fclose(fp);
+        return false;
+    }
+    uint32_t magic = le32(gh);
+    bool nanos = (magic == 0xA1B23C4D);
+    if (magic != 0xA1B2C3D4 && !nanos) {
+        fprintf(stderr, "%s: not a little-endian pcap file\n", path);
+        fclose(fp);
+        return false;
+    }
+    uint32_t linktype = le32(gh + 20);
+    if (linktype != LINKTYPE_IEEE802_11 && linktype != LINKTYPE_IEEE802_11_RADIOTAP) {
+        fprintf(stderr, "%s: unsupported link type %u\n", path, linktype);
+        fclose(fp);
+        return false;
+    }
+
+    uint8_t rh[16];
+    std::vector<uint8_t> rec;
+    uint64_t first_ts = 0;
+    while (fread(rh, 1, sizeof(rh), fp) == sizeof(rh)) {
+        uint32_t caplen = le32(rh + 8);
+        uint32_t origlen = le32(rh + 12);
+        rec.resize(caplen);
+        if (fread(rec.data(), 1, caplen, fp) != caplen) break;
+
+        uint64_t ts = (uint64_t)le32(rh) * 1000000 + (nanos ? le32(rh + 4) / 1000 : le32(rh + 4));
+        if (frames->empty()) first_ts = ts;
+
+        RadiotapInfo rt = {0, false, false, 0, 1, -50, -95};
+        size_t hdr = 0;
+        if (linktype == LINKTYPE_IEEE802_11_RADIOTAP && !parse_radiotap(rec.data(), caplen, &hdr, &rt)) continue;
+
+        const uint8_t* frame = rec.data() + hdr;
+        size_t frame_len = caplen - hdr;
+        size_t orig_len = origlen - hdr;
+        if (frame_len < 2) continue;
+
+        // The ESP32 driver always delivers the FCS and counts it in sig_len
+        size_t payload_len = rt.has_fcs ? frame_len : frame_len + 4;
+        size_t sig_len = rt.has_fcs ? orig_len : orig_len + 4;
+
+        ReplayFrame rf;
+        rf.ts_us = ts - first_ts;
+        rf.channel = rt.channel;
+        rf.device = -1;
+        switch ((frame[0] >> 2) & 0x03) {
+            case WIFI_MANAGEMENT_FRAME: rf.type = WIFI_PKT_MGMT; break;
+            case WIFI_CONTROL_FRAME: rf.type = WIFI_PKT_CTRL; break;
+            case WIFI_DATA_FRAME: rf.type = WIFI_PKT_DATA; break;
+            default: rf.type = WIFI_PKT_MISC; break;
+        }
+
+        rf.buf.assign(sizeof(wifi_promiscuous_pkt_t) + payload_len, 0);
+        wifi_promiscuous_pkt_t* pkt = (wifi_promiscuous_pkt_t*)rf.buf.data();
+        pkt->rx_ctrl.rssi = rt.rssi;
+        pkt->rx_ctrl.noise_floor = rt.noise;
+        pkt->rx_ctrl.channel = rt.channel;
+        pkt->rx_ctrl.rate = esp_rate_index(rt.rate);
+        pkt->rx_ctrl.sig_len = sig_len > 0xFFF ? 0xFFF : sig_len;
+        pkt->rx_ctrl.timestamp = (uint32_t)(rt.has_tsft ? rt.tsft : rf.ts_us);
+        memcpy(pkt->payload, frame, frame_len);
+
+        frames->push_back(std::move(rf));
+    }
+
+    fclose(fp);
+    return true;
+}
@@ -0,0 +1,44 @@
+// pcap capture loading (native host build only)
+//
+// Reads LINKTYPE_IEEE802_11 and LINKTYPE_IEEE802_11_RADIOTAP files into the
+// wifi_promiscuous_pkt_t buffers the driver would hand to
+// wifi_sniffer_packet_handler.
+
+#ifndef HOST_PCAP_READER_H
+#define HOST_PCAP_READER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+#include <esp_wifi.h>
+
+#define LINKTYPE_IEEE802_11 105
+#define LINKTYPE_IEEE802_11_RADIOTAP 127
+
+struct ReplayFrame {
+    uint64_t ts_us;
+    wifi_promiscuous_pkt_type_t type;
+    int channel;
+    int device;                  // Transmitter index for the hop simulation, -1 if none
+    std::vector<uint8_t> buf;    // wifi_promiscuous_pkt_t followed by the payload
+};
+
+// Values the replay needs from a radiotap header
+struct RadiotapInfo {
+    uint64_t tsft;
+    bool has_tsft;
+    bool has_fcs;
+    uint8_t rate;
+    int channel;
+    int rssi;
+    int noise;
+};
+
+// Walks the radiotap fields up to dBm antenna noise (present bits 0-6);
+// hdr_len receives the radiotap header length
+bool parse_radiotap(const uint8_t* p, size_t len, size_t* hdr_len, RadiotapInfo* out);
+
+// Appends every frame of the capture, timestamps relative to the first
+bool load_pcap(const char* path, std::vector<ReplayFrame>* frames);
+
+#endif // HOST_PCAP_READER_H
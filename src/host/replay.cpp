@@ -0,0 +1,372 @@
+// Frame replay driver for the native host build
+//
+// Reads a pcap file (LINKTYPE_IEEE802_11 or LINKTYPE_IEEE802_11_RADIOTAP),
+// rebuilds the wifi_promiscuous_pkt_t buffers the driver would hand to
+// wifi_sniffer_packet_handler, and pushes every frame through the callback and
+// the parser. Reports throughput, per-frame latency percentiles and heap use.
+//
+// With a hop mode the radio is simulated as well: channel_hopper runs on the
+// capture's clock and only frames on the tuned channel reach the sniffer. The
+// report then adds how long each transmitter took to be heard after its first
+// frame in the capture, so "fixed" and "adaptive" can be compared on one file.
+//
+// The per-channel signal sketches are checked against exact nearest-rank
+// percentiles of the RSSI and noise values that fell inside their window, and
+// the duplicate count of the fixed-size retry filter against the same rule
+// applied with an unbounded map. With one pass (repeat 1) and no hop mode,
+// that reference should also equal Wireshark's count of the capture:
+//   tshark -r capture.pcap -Y wlan.analysis.retransmission | wc -l
+//
+// With a filter profile the frames the driver's hardware filter would drop
+// never reach the callback, and the report gives the callback and parse cost
+// that remain, to compare against a run with "full".
+//
+// Usage: program <capture.pcap> [repeat] [fixed|adaptive] [discovery|hunt|full]
+//        program --churn [hours]      (see churn.cpp)
+//        program --oui [lookups]      (see oui_bench.cpp)
+//        program --mactable [lookups] (see mactable_bench.cpp)
+//        program --ie [passes] [capture.pcap] (see ie_bench.cpp)
+//        program --snapshot [records] [dir]   (see snapshot_bench.cpp)
+//        program --telemetry [records] [baud] (see telemetry_bench.cpp)
+
+#include <Arduino.h>
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <math.h>
+#include <vector>
+#include "sniffer.h"
+#include "latency_probe.h"
+#include "telemetry.h"
+#include "mem_stats.h"
+#include "churn.h"
+#include "oui_bench.h"
+#include "mactable_bench.h"
+#include "ie_bench.h"
+#include "snapshot_bench.h"
+#include "telemetry_bench.h"
+#include "pcap_reader.h"
+
+// Unit tests link the host sources with their own main()
+#ifndef PIO_UNIT_TESTING
+
+// One replayed frame as the channel statistics saw it
+struct SignalSample {
+    uint32_t frame;     // Index into the loaded frames
+    uint32_t ms;
+    uint8_t channel;
+    int8_t rssi;
+    int8_t noise;
+};
+
+// Nearest-rank p quantile; sorts values
+static int exact_quantile(std::vector<int>& values, float p) {
+    std::sort(values.begin(), values.end());
+    size_t rank = (size_t)ceilf(p * values.size());
+    return values[rank > 0 ? rank - 1 : 0];
+}
+
+// Compares each channel's window summary with the exact percentiles of the
+// samples it covers; false when an estimate is off by more than
+// SIGNAL_QUANTILE_TOLERANCE_DB
+static bool report_signal_accuracy(const std::vector<SignalSample>& samples, uint32_t now) {
+    int worst[3] = {0, 0, 0};
+    printf("signal        CH  frames  rssi p50 est/exact  p90 est/exact  noise p50 est/exact\n");
+    for (int ch = 1; ch <= WIFI_CHANNEL_MAX; ch++) {
+        SignalSummary s;
+        channel_stats[ch].signal.summary(now, &s);
+        if (s.frames == 0) continue;
+        std::vector<int> rssi, noise;
+        for (const SignalSample& x : samples) {
+            if (x.channel != ch || (int32_t)(x.ms - s.window_start) < 0) continue;
+            rssi.push_back(x.rssi);
+            noise.push_back(x.noise);
+        }
+        if (rssi.empty()) continue;
+        int exact[3] = {exact_quantile(rssi, 0.5f), exact_quantile(rssi, 0.9f), exact_quantile(noise, 0.5f)};
+        int est[3] = {s.rssi_p50, s.rssi_p90, s.noise_p50};
+        for (int i = 0; i < 3; i++) worst[i] = std::max(worst[i], abs(est[i] - exact[i]));
+        printf("              %2d  %6u%s  %8d/%-4d      %5d/%-4d     %9d/%-4d\n", ch, s.frames,
+               s.frames == rssi.size() ? "" : "!", est[0], exact[0], est[1], exact[1], est[2], exact[2]);
+    }
+    printf("signal error  max dB  rssi p50 %d  p90 %d  noise p50 %d\n", worst[0], worst[1], worst[2]);
+    int max_error = std::max(worst[0], std::max(worst[1], worst[2]));
+    if (max_error > SIGNAL_QUANTILE_TOLERANCE_DB) {
+        fprintf(stderr, "signal percentiles off by %d dB (tolerance %d dB)\n", max_error, SIGNAL_QUANTILE_TOLERANCE_DB);
+        return false;
+    }
+    return true;
+}
+
+#define REPLAY_EXPIRY_TICK_US 30000        // Matches the UI loop period on the device
+
+// Numbers the transmitter (addr2) of every frame that has one and records when
+// each was first on the air
+static size_t index_devices(std::vector<ReplayFrame>* frames, std::vector<uint64_t>* first_tx_us) {
+    std::map<uint64_t, int> ids;
+    for (ReplayFrame& rf : *frames) {
+        const wifi_promiscuous_pkt_t* pkt = (const wifi_promiscuous_pkt_t*)rf.buf.data();
+        size_t len = rf.buf.size() - sizeof(wifi_promiscuous_pkt_t);
+        if (rf.type == WIFI_PKT_MISC || len < 16) continue;
+        uint64_t key = MacAddr::from_bytes(&pkt->payload[10]).value;
+        auto it = ids.find(key);
+        if (it == ids.end()) {
+            it = ids.insert(std::make_pair(key, (int)ids.size())).first;
+            first_tx_us->push_back(rf.ts_us);
+        }
+        rf.device = it->second;
+    }
+    return ids.size();
+}
+
+// Counts duplicates among the replayed frames with one unbounded entry per
+// transmitter and compares with what the sniffer's RetryFilter dropped
+static void report_retry_accuracy(const std::vector<SignalSample>& samples, const std::vector<ReplayFrame>& frames) {
+    std::map<uint64_t, uint16_t> last_seq;
+    size_t retries = 0, duplicates = 0;
+    for (const SignalSample& x : samples) {
+        const ReplayFrame& rf = frames[x.frame];
+        const uint8_t* d = ((const wifi_promiscuous_pkt_t*)rf.buf.data())->payload;
+        size_t len = rf.buf.size() - sizeof(wifi_promiscuous_pkt_t);
+        if ((rf.type != WIFI_PKT_MGMT && rf.type != WIFI_PKT_DATA) || len < 24) continue;
+        bool retry = (d[1] << 8) & FC_RETRY;
+        uint16_t seq = d[22] | (d[23] << 8);
+        uint64_t ta = MacAddr::from_bytes(&d[10]).value;
+        auto it = last_seq.find(ta);
+        retries += retry;
+        if (retry && it != last_seq.end() && it->second == seq) duplicates++;
+        last_seq[ta] = seq;
+    }
+    printf("retries       %d with Retry  %d duplicates dropped (reference %zu / %zu)  %d unique  %u displacements\n",
+           retry_frames, duplicate_frames, retries, duplicates, total_frames, retry_filter.displaced());
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <capture.pcap> [repeat] [fixed|adaptive] [discovery|hunt|full]\n"
+                        "       %s --churn [hours]\n"
+                        "       %s --oui [lookups]\n"
+                        "       %s --mactable [lookups]\n"
+                        "       %s --ie [passes] [capture.pcap]\n"
+                        "       %s --snapshot [records] [dir]\n"
+                        "       %s --telemetry [records] [baud]\n", argv[0], argv[0], argv[0], argv[0], argv[0], argv[0], argv[0]);
+        return 2;
+    }
+    if (strcmp(argv[1], "--churn") == 0) {
+        return run_churn(argc > 2 ? atof(argv[2]) : 24);
+    }
+    if (strcmp(argv[1], "--oui") == 0) {
+        return run_oui_bench(argc > 2 ? atoi(argv[2]) : 3000000);
+    }
+    if (strcmp(argv[1], "--mactable") == 0) {
+        return run_mactable_bench(argc > 2 ? atoi(argv[2]) : 1000000);
+    }
+    if (strcmp(argv[1], "--ie") == 0) {
+        return run_ie_bench(argc > 2 ? atoi(argv[2]) : 20000, argc > 3 ? argv[3] : nullptr);
+    }
+    if (strcmp(argv[1], "--snapshot") == 0) {
+        return run_snapshot_bench(argc > 2 ? atoi(argv[2]) : 5000, argc > 3 ? argv[3] : "/tmp");
+    }
+    if (strcmp(argv[1], "--telemetry") == 0) {
+        return run_telemetry_bench(argc > 2 ? atoi(argv[2]) : 5000, argc > 3 ? atol(argv[3]) : TELEMETRY_MAX_BAUD);
+    }
+    int repeat = argc > 2 ? atoi(argv[2]) : 1;
+    if (repeat < 1) repeat = 1;
+    const char* hop_mode = nullptr;
+    FilterProfile profile = FILTER_FULL;
+    for (int i = 3; i < argc; i++) {
+        if (strcmp(argv[i], "fixed") == 0 || strcmp(argv[i], "adaptive") == 0) {
+            hop_mode = argv[i];
+        } else if (!PromiscFilter::parse(argv[i], &profile)) {
+            fprintf(stderr, "unknown hop mode or filter profile %s\n", argv[i]);
+            return 2;
+        }
+    }
+
+    std::vector<ReplayFrame> frames;
+    if (!load_pcap(argv[1], &frames) || frames.empty()) {
+        fprintf(stderr, "no frames to replay\n");
+        return 1;
+    }
+    uint64_t span_us = frames.back().ts_us + 1;
+
+    std::vector<uint64_t> first_tx_us;
+    std::vector<uint64_t> first_heard_us;
+    size_t devices = 0;
+    if (hop_mode != nullptr) {
+        devices = index_devices(&frames, &first_tx_us);
+        first_heard_us.assign(devices, UINT64_MAX);
+    }
+    size_t frames_off_channel = 0;
+    size_t frames_filtered = 0;
+
+    std::vector<uint32_t> latency_ns;
+    latency_ns.reserve(frames.size() * repeat);
+    std::vector<SignalSample> signal_samples;
+    signal_samples.reserve(frames.size() * repeat);
+
+    // Heap figures below are relative to this point: replay buffers are excluded
+    size_t heap_base = host_heap_live;
+    host_heap_base = heap_base;
+    host_heap_peak = host_heap_live;
+    if (!sniffer_init()) {
+        fprintf(stderr, "sniffer_init failed\n");
+        return 1;
+    }
+    latency_probes_init();
+    host_clock_set_us(1000000);
+    promisc_filter.apply(profile, millis());
+    size_t heap_after_init = host_heap_live;
+    size_t allocs_after_init = host_heap_allocs;
+
+    if (hop_mode != nullptr) {
+        channel_hopper.set_adaptive(strcmp(hop_mode, "adaptive") == 0);
+        channel_hopper.begin(1, millis());
+    }
+
+    typedef std::chrono::steady_clock Clock;
+    Clock::time_point run_start = Clock::now();
+
+    // Expiry runs on the capture's clock at the UI loop's cadence
+    uint64_t next_expiry_us = 0;
+    size_t expiry_ticks = 0;
+    uint64_t expiry_ns_total = 0;
+    uint32_t expiry_ns_max = 0;
+    size_t expiry_max_removed = 0;
+
+    for (int r = 0; r < repeat; r++) {
+        for (const ReplayFrame& rf : frames) {
+            // Virtual clock starts at 1 s so a zero last_seen is never "now"
+            uint64_t now_us = 1000000 + r * span_us + rf.ts_us;
+            host_clock_set_us(now_us);
+
+            if (now_us >= next_expiry_us) {
+                Clock::time_point e0 = Clock::now();
+                size_t removed = expire_stale_entries(millis(), EXPIRY_BUDGET);
+                uint32_t ns = (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - e0).count();
+                expiry_ticks++;
+                expiry_ns_total += ns;
+                if (ns > expiry_ns_max) expiry_ns_max = ns;
+                if (removed > expiry_max_removed) expiry_max_removed = removed;
+                next_expiry_us = now_us + REPLAY_EXPIRY_TICK_US;
+                mem_stats_update();
+            }
+
+            if (hop_mode != nullptr) {
+                int next_channel;
+                while (channel_hopper.poll(millis(), &next_channel)) {
+                    channel_hopper.begin_dwell(next_channel, millis());
+                }
+                if (rf.channel != channel_hopper.channel()) {
+                    frames_off_channel++;
+                    continue;
+                }
+            }
+            if (!PromiscFilter::passes(profile, rf.type)) {
+                frames_filtered++;
+                continue;
+            }
+            if (hop_mode != nullptr && rf.device >= 0 && first_heard_us[rf.device] == UINT64_MAX) {
+                first_heard_us[rf.device] = now_us - 1000000;
+            }
+
+            SignalSample sample;
+            sample.frame = (uint32_t)(&rf - frames.data());
+            sample.ms = millis();
+            sample.channel = (rf.channel >= 1 && rf.channel <= WIFI_CHANNEL_MAX) ? rf.channel : current_channel;
+            const wifi_promiscuous_pkt_t* pkt = (const wifi_promiscuous_pkt_t*)rf.buf.data();
+            sample.rssi = pkt->rx_ctrl.rssi;
+            sample.noise = pkt->rx_ctrl.noise_floor;
+            signal_samples.push_back(sample);
+
+            Clock::time_point t0 = Clock::now();
+            wifi_sniffer_packet_handler((void*)rf.buf.data(), rf.type);
+            while (capture_ring.available() > 0) {
+                process_frame(capture_ring.peek(0));
+                capture_ring.consume(1);
+            }
+            Clock::time_point t1 = Clock::now();
+            latency_ns.push_back((uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count());
+        }
+    }
+
+    double elapsed_s = std::chrono::duration<double>(Clock::now() - run_start).count();
+    size_t hot_path_allocs = host_heap_allocs - allocs_after_init;
+
+    std::sort(latency_ns.begin(), latency_ns.end());
+    size_t n = latency_ns.size();
+
+    printf("frames        %zu (%zu x %d)\n", n, frames.size(), repeat);
+    printf("mgmt/data/ctrl %d / %d / %d\n", mgmt_frames, data_frames, ctrl_frames);
+    printf("throughput    %.0f frames/s\n", n / elapsed_s);
+    printf("latency ns    p50 %u  p90 %u  p99 %u  max %u\n",
+           latency_ns[n / 2], latency_ns[n * 90 / 100], latency_ns[n * 99 / 100], latency_ns[n - 1]);
+    printf("heap bytes    init %zu  peak %zu\n", heap_after_init - heap_base, host_heap_peak - heap_base);
+    printf("hot-path allocations %zu\n", hot_path_allocs);
+    printf("registries    APs %zu/%zu  clients %zu/%zu  evictions %u/%u\n",
+           ap_registry.size(), ap_registry.capacity(), client_registry.size(), client_registry.capacity(),
+           ap_registry.evictions(), client_registry.evictions());
+    printf("capture ring  drops %u  truncated %u\n", capture_ring.dropped(), frames_truncated);
+    printf("expiry        APs %u  clients %u  ticks %zu  ns/tick mean %llu  max %u  (max %zu removed)\n",
+           ap_expired, client_expired, expiry_ticks,
+           (unsigned long long)(expiry_ticks ? expiry_ns_total / expiry_ticks : 0), expiry_ns_max,
+           expiry_max_removed);
+
+    // How each client's AP is known: from frame addresses, guessed, or not at all
+    size_t exact = 0, guessed = 0;
+    for (const auto& e : client_registry) {
+        if (e.value.connected_ap.is_null()) continue;
+        if (e.value.ap_exact) exact++;
+        else guessed++;
+    }
+    printf("attribution   exact %zu  guessed %zu  unknown %zu\n",
+           exact, guessed, client_registry.size() - exact - guessed);
+    uint32_t target_tx = 0, target_rx = 0;
+    size_t targets_found = 0;
+    for (size_t i = 0; i < watchlist.size(); i++) {
+        target_tx += watchlist.at(i).tx_packets;
+        target_rx += watchlist.at(i).rx_packets;
+        targets_found += watchlist.at(i).tx_packets + watchlist.at(i).rx_packets > 0;
+    }
+    printf("watchlist     %zu targets  %zu heard  TX %u  RX %u\n",
+           watchlist.size(), targets_found, target_tx, target_rx);
+    FilterStats fs[FILTER_PROFILES];
+    promisc_filter.snapshot(fs, millis());
+    const FilterStats& f = fs[profile];
+    printf("filter        %s  %zu dropped in hardware  %u callbacks  %.1f/s  rx ns/cb %.0f  parse ns/frame %.0f\n",
+           PromiscFilter::name(profile), frames_filtered, f.callbacks,
+           f.active_ms ? f.callbacks * 1000.0 / f.active_ms : 0.0,
+           f.callbacks ? (double)f.rx_ticks / f.callbacks : 0.0,
+           f.parsed ? (double)f.parse_ticks / f.parsed : 0.0);
+    bool signal_ok = report_signal_accuracy(signal_samples, millis());
+    report_retry_accuracy(signal_samples, frames);
+
+    fflush(stdout);   // Probe and memory tables go to Serial (stderr)
+    print_latency_probes();
+    mem_stats_update();
+    print_mem_stats();
+
+    if (hop_mode != nullptr) {
+        // Discovery latency: first frame heard minus first frame on the air
+        std::vector<uint64_t> discovery_ms;
+        for (size_t d = 0; d < devices; d++) {
+            if (first_heard_us[d] != UINT64_MAX) {
+                discovery_ms.push_back((first_heard_us[d] - first_tx_us[d]) / 1000);
+            }
+        }
+        std::sort(discovery_ms.begin(), discovery_ms.end());
+        size_t found = discovery_ms.size();
+        uint64_t sum = 0;
+        for (uint64_t ms : discovery_ms) sum += ms;
+        printf("hopping       %s  off-channel frames %zu\n", hop_mode, frames_off_channel);
+        printf("discovery     %zu/%zu devices heard", found, devices);
+        if (found > 0) {
+            printf("  latency ms mean %llu  p50 %llu  p90 %llu  max %llu",
+                   (unsigned long long)(sum / found), (unsigned long long)discovery_ms[found / 2],
+                   (unsigned long long)discovery_ms[found * 90 / 100], (unsigned long long)discovery_ms[found - 1]);
+        }
+        printf("\n");
+    }
+    return signal_ok ? 0 : 1;
+}
+#endif // PIO_UNIT_TESTING
@@ -0,0 +1,216 @@
+// Registry snapshot round trip and load benchmark
+//
+// A fifth of the records are APs with names drawn from a mix of shared and
+// unique SSIDs; the rest are clients with up to four probed names, most of
+// them associated with one of the APs. The snapshot is written in the same
+// open/start/encode/write/commit sequence store_task uses, then loaded by a
+// fresh RegistrySnapshot as at boot, with the clock restarted near zero.
+
+#include <Arduino.h>
+#include <chrono>
+#include <vector>
+#include "sniffer.h"
+#include "registry_snapshot.h"
+#include "snapshot_bench.h"
+
+typedef std::chrono::steady_clock Clock;
+
+#define BENCH_SAVE_MS 10000000UL           // Uptime at the save (about 2.8 h)
+#define BENCH_BOOT_MS 2000UL               // Uptime when the snapshot is loaded
+
+static uint64_t bench_rng = 0x2545F4914F6CDD1DULL;
+static uint32_t rnd(uint32_t n) {
+    bench_rng ^= bench_rng << 13;
+    bench_rng ^= bench_rng >> 7;
+    bench_rng ^= bench_rng << 17;
+    return (uint32_t)(bench_rng >> 32) % n;
+}
+
+static const char* bench_ssid(uint32_t id) {
+    static char name[33];
+    if (id % 3 == 0) snprintf(name, sizeof(name), "Common-%u", id % 40);
+    else snprintf(name, sizeof(name), "Network %06u", id);
+    const char* s = ssid_arena.intern(name);
+    return s ? s : "";
+}
+
+// What a record should look like after the round trip
+struct ApRef {
+    MacAddr bssid;
+    char ssid[33];
+    uint32_t age;
+    int channel, rssi, beacons;
+};
+
+struct ClientRef {
+    MacAddr mac, ap;
+    char probed[CLIENT_PROBE_SLOTS][33];
+    int probe_count;
+    uint32_t age;
+    int rssi, frames, retries;
+    bool exact;
+};
+
+static double save_once(RegistrySnapshot& snap, uint32_t now, int* chunks) {
+    Clock::time_point t0 = Clock::now();
+    *chunks = 0;
+    if (!snap.open()) return -1;
+    snap.start(now);
+    size_t n;
+    while ((n = snap.encode(now)) > 0) {
+        if (!snap.write(n)) return -1;
+        (*chunks)++;
+    }
+    if (!snap.commit(now)) return -1;
+    return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+}
+
+// Compares the registries with the reference; returns the number of mismatches
+static size_t verify(const std::vector<ApRef>& aps, const std::vector<ClientRef>& clients, uint32_t now) {
+    size_t bad = 0;
+    for (const ApRef& r : aps) {
+        const APInfo* a = ap_registry.find(r.bssid.value);
+        if (a == nullptr || strcmp(a->ssid, r.ssid) != 0 || now - a->last_seen != r.age ||
+            a->channel != r.channel || a->rssi != r.rssi || a->beacon_count != r.beacons) bad++;
+    }
+    for (const ClientRef& r : clients) {
+        const ClientInfo* c = client_registry.find(r.mac.value);
+        bool ok = c != nullptr && c->connected_ap == r.ap && c->ap_exact == r.exact &&
+                  now - c->last_seen == r.age && c->rssi == r.rssi && c->frame_count == r.frames &&
+                  c->retry_count == r.retries && c->probe_count == r.probe_count;
+        for (int k = 0; ok && k < r.probe_count; k++) ok = strcmp(c->probed[k], r.probed[k]) == 0;
+        // Association lists are rebuilt: the client must be linked into its AP
+        if (ok && !r.ap.is_null()) ok = c->ap_index == ap_registry.find_index(r.ap.value);
+        bad += !ok;
+    }
+    // Least recently heard at the LRU tail, as expiry expects
+    uint32_t last_age = UINT32_MAX;
+    for (uint16_t i = client_registry.lru_oldest(); i != MacTable<ClientInfo>::NIL; i = client_registry.at(i).prev) {
+        uint32_t age = now - client_registry.at(i).value.last_seen;
+        if (age > last_age) {
+            bad++;
+            break;
+        }
+        last_age = age;
+    }
+    return bad;
+}
+
+static bool damage(const char* dir, char slot, long offset) {
+    char path[SNAPSHOT_PATH_MAX + 16];
+    snprintf(path, sizeof(path), "%s/registry_%c.bin", dir, slot - 'A' + 'a');
+    FILE* fp = fopen(path, "r+b");
+    if (fp == nullptr) return false;
+    fseek(fp, offset, SEEK_SET);
+    int c = fgetc(fp);
+    fseek(fp, offset, SEEK_SET);
+    fputc(c ^ 0x40, fp);
+    fclose(fp);
+    return true;
+}
+
+int run_snapshot_bench(int records, const char* dir) {
+    if (records < 10) records = 10;
+    if (records > 60000) records = 60000;
+    uint16_t ap_cap = (uint16_t)(records / 5);
+    uint16_t client_cap = (uint16_t)(records - ap_cap);
+    if (!sniffer_init(ap_cap, client_cap)) {
+        fprintf(stderr, "sniffer_init failed\n");
+        return 1;
+    }
+    client_ttl_ms = ap_ttl_ms = BENCH_SAVE_MS;   // Keep every synthetic record
+
+    // Oldest first, so the LRU order matches last_seen as it does on the device
+    std::vector<ApRef> aps(ap_cap);
+    for (uint16_t i = 0; i < ap_cap; i++) {
+        ApRef& r = aps[i];
+        r.bssid = MacAddr::from_u64(0x00163E000000ULL + i * 7919ULL);
+        r.age = (uint32_t)(ap_cap - i) * 100;
+        r.channel = 1 + rnd(13);
+        r.rssi = -40 - (int)rnd(55);
+        r.beacons = (int)rnd(100000);
+        host_clock_set_us((uint64_t)(BENCH_SAVE_MS - r.age) * 1000);
+        APInfo& a = ap_registry.upsert(r.bssid.value);
+        a.bssid = r.bssid;
+        a.ssid = rnd(10) == 0 ? "" : bench_ssid(rnd(records));
+        snprintf(r.ssid, sizeof(r.ssid), "%s", a.ssid);
+        a.channel = r.channel;
+        a.rssi = r.rssi;
+        a.beacon_count = r.beacons;
+        a.security.flags = SEC_RSN | SEC_PRIVACY;
+        a.last_seen = millis();
+    }
+    std::vector<ClientRef> clients(client_cap);
+    for (uint16_t i = 0; i < client_cap; i++) {
+        ClientRef& r = clients[i];
+        r.mac = MacAddr::from_u64(0x02AB00000000ULL + i * 104729ULL);
+        r.age = (uint32_t)(client_cap - i) * 20;
+        r.rssi = -50 - (int)rnd(45);
+        r.frames = (int)rnd(5000);
+        r.retries = (int)rnd(500);
+        r.ap = rnd(4) == 0 ? MacAddr::from_u64(0) : aps[rnd(ap_cap)].bssid;
+        r.exact = rnd(2) == 0;
+        r.probe_count = (int)rnd(CLIENT_PROBE_SLOTS + 1);
+        host_clock_set_us((uint64_t)(BENCH_SAVE_MS - r.age) * 1000);
+        ClientInfo& c = client_registry.upsert(r.mac.value);
+        c.mac = r.mac;
+        c.rssi = r.rssi;
+        c.frame_count = r.frames;
+        c.retry_count = r.retries;
+        c.last_seen = millis();
+        c.probe_count = r.probe_count;
+        for (int k = 0; k < r.probe_count; k++) {
+            c.probed[k] = bench_ssid(rnd(records));
+            snprintf(r.probed[k], sizeof(r.probed[k]), "%s", c.probed[k]);
+        }
+        if (!r.ap.is_null()) set_client_ap(c, r.ap, r.exact);
+        else r.exact = false;
+    }
+    host_clock_set_us((uint64_t)BENCH_SAVE_MS * 1000);
+
+    // Save twice so both slots hold the same registries
+    RegistrySnapshot saver;
+    if (!saver.begin(dir)) {
+        fprintf(stderr, "snapshot buffers could not be allocated\n");
+        return 1;
+    }
+    int chunks;
+    double first_ms = save_once(saver, millis(), &chunks);
+    double save_ms = save_once(saver, millis(), &chunks);
+    if (first_ms < 0 || save_ms < 0) {
+        fprintf(stderr, "cannot write snapshots to %s\n", dir);
+        return 1;
+    }
+    const SnapshotStats& s = saver.stats();
+    printf("records       %u APs  %u clients  %u names\n", s.last_aps, s.last_clients, s.last_strings);
+    printf("file          %u bytes  %.1f bytes/record  slot %c seq %u\n", s.last_bytes,
+           (double)s.last_bytes / (s.last_aps + s.last_clients), s.slot, s.sequence);
+    printf("save          %.2f ms in %d chunks of <= %d records\n", save_ms, chunks, SNAPSHOT_CHUNK_RECORDS);
+
+    // Boot: empty registries, clock near zero
+    ap_registry.clear();
+    client_registry.clear();
+    host_clock_set_us((uint64_t)BENCH_BOOT_MS * 1000);
+    RegistrySnapshot boot;
+    boot.begin(dir);
+    Clock::time_point t0 = Clock::now();
+    bool loaded = boot.load(millis());
+    double load_ms = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+    size_t bad = loaded ? verify(aps, clients, millis()) : aps.size() + clients.size();
+    printf("load          %.2f ms  %.0f records/s  %zu/%zu records differ\n", load_ms,
+           (boot.stats().loaded_aps + boot.stats().loaded_clients) / (load_ms / 1000), bad,
+           aps.size() + clients.size());
+
+    // A flipped bit in the newest slot's body must be caught by the CRC
+    char newest = s.slot;
+    ap_registry.clear();
+    client_registry.clear();
+    damage(dir, newest, sizeof(SnapshotHeader) + s.last_bytes / 2);
+    RegistrySnapshot fallback;
+    fallback.begin(dir);
+    bool fell_back = fallback.load(millis()) && fallback.stats().load_fallback && fallback.stats().slot != newest;
+    size_t fallback_bad = fell_back ? verify(aps, clients, millis()) : 1;
+    printf("damaged slot  %s, %zu records differ\n", fell_back ? "fell back to the older slot" : "NOT DETECTED",
+           fallback_bad);
+    return bad == 0 && fell_back && fallback_bad == 0 ? 0 : 1;
+}
@@ -0,0 +1,12 @@
+// Registry snapshot round trip and load benchmark (native host build only)
+
+#ifndef HOST_SNAPSHOT_BENCH_H
+#define HOST_SNAPSHOT_BENCH_H
+
+// Fills the registries with records synthetic records, saves them twice to
+// dir, loads them back into empty registries and compares field by field, then
+// damages the newest slot and checks the load falls back to the older one.
+// Returns the process exit code.
+int run_snapshot_bench(int records, const char* dir);
+
+#endif // HOST_SNAPSHOT_BENCH_H
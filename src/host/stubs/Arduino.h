@@ -0,0 +1,42 @@
+// Minimal Arduino API for the native host build
+//
+// Only what the sniffer core uses. The clock is virtual: the replay driver sets
+// it from capture timestamps so TTLs and rates behave as they did on air.
+
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+
+using std::min;
+using std::max;
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+
+// Sets the virtual clock read by millis()/micros()
+void host_clock_set_us(uint64_t us);
+
+// Bytes currently allocated with operator new, kept by the host driver's
+// allocator hooks. Internal heap use is reported relative to host_heap_base so
+// the driver can leave its own buffers out.
+extern size_t host_heap_live;
+extern size_t host_heap_base;
+extern size_t host_heap_allocs;    // operator new calls so far
+extern size_t host_heap_peak;      // Highest host_heap_live; the driver may reset it
+
+class HostSerial {
+public:
+    void println(const char* s);
+    int printf(const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+};
+
+extern HostSerial Serial;
+
+#endif // HOST_ARDUINO_H
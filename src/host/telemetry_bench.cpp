@@ -0,0 +1,253 @@
+// Telemetry stream round trip and throughput benchmark
+//
+// A fifth of the records are APs, the rest clients, heard oldest first up to
+// the first batch. Between the first (full) batch and the second (delta) one
+// every 20th record is heard again, a few channels get frames and the oldest
+// clients expire, so the second batch must carry exactly those changes. The
+// batches are produced with the start/encode sequence telemetry_task uses.
+
+#include <Arduino.h>
+#include <chrono>
+#include <string>
+#include <vector>
+#include "sniffer.h"
+#include "telemetry.h"
+#include "telemetry_decoder.h"
+#include "telemetry_bench.h"
+
+typedef std::chrono::steady_clock Clock;
+
+#define BENCH_START_MS 3600000UL           // Uptime at the first batch
+#define BENCH_EXPIRED 10                   // Clients expired between the batches
+#define BENCH_REPS 50                      // Full batches timed per format
+
+static uint64_t bench_rng = 0x9E3779B97F4A7C15ULL;
+static uint32_t rnd(uint32_t n) {
+    bench_rng ^= bench_rng << 13;
+    bench_rng ^= bench_rng >> 7;
+    bench_rng ^= bench_rng << 17;
+    return (uint32_t)(bench_rng >> 32) % n;
+}
+
+// Counts what arrives and checks AP and client records against the registries
+class BenchHandler : public TelemetryHandler {
+public:
+    uint32_t channels = 0, gone = 0, aps = 0, clients = 0, summaries = 0, mismatched = 0;
+    uint32_t time_ms = 0;
+
+    void on_channel(const TelemetryFrameHeader&, const TelemetryChannel&) override { channels++; }
+    void on_gone(const TelemetryFrameHeader&, const TelemetryGone& g) override {
+        gone++;
+        if (client_registry.find(MacAddr::from_bytes(g.mac).value) != nullptr) mismatched++;
+    }
+    void on_ap(const TelemetryFrameHeader& h, const TelemetryAp& r, const char* ssid) override {
+        aps++;
+        const APInfo* a = ap_registry.find(MacAddr::from_bytes(r.bssid).value);
+        if (a == nullptr || strcmp(a->ssid, ssid) != 0 || a->rssi != r.rssi || a->channel != r.channel ||
+            a->beacon_count != (int)r.beacon_count || h.time_ms - (uint32_t)a->last_seen != r.age_ms) mismatched++;
+    }
+    void on_client(const TelemetryFrameHeader& h, const TelemetryClient& r) override {
+        clients++;
+        const ClientInfo* c = client_registry.find(MacAddr::from_bytes(r.mac).value);
+        if (c == nullptr || c->connected_ap != MacAddr::from_bytes(r.ap) || c->rssi != r.rssi ||
+            c->frame_count != (int)r.frame_count || h.time_ms - (uint32_t)c->last_seen != r.age_ms) mismatched++;
+    }
+    void on_summary(const TelemetryFrameHeader& h, const TelemetrySummary&) override {
+        summaries++;
+        time_ms = h.time_ms;
+    }
+};
+
+static void telemetry_expired(RegistryKind kind, MacAddr mac, void*) {
+    telemetry.on_removed(kind == REGISTRY_CLIENT, mac);
+}
+
+// One batch as telemetry_task produces it; returns the buffers written
+static int run_batch(uint32_t now, std::string* out) {
+    int writes = 0;
+    telemetry.start(now);
+    size_t n;
+    while ((n = telemetry.encode()) > 0) {
+        out->append((const char*)telemetry.data(), n);
+        writes++;
+    }
+    return writes;
+}
+
+static double mb_per_s(size_t bytes, Clock::duration d) {
+    return bytes / std::chrono::duration<double>(d).count() / 1e6;
+}
+
+int run_telemetry_bench(int records, long baud) {
+    if (records < 100) records = 100;
+    if (records > 60000) records = 60000;
+    if (baud < 9600 || baud > TELEMETRY_MAX_BAUD) baud = TELEMETRY_MAX_BAUD;
+    uint16_t ap_cap = (uint16_t)(records / 5);
+    uint16_t client_cap = (uint16_t)(records - ap_cap);
+    if (!sniffer_init(ap_cap, client_cap) || !telemetry.begin()) {
+        fprintf(stderr, "sniffer_init failed\n");
+        return 1;
+    }
+    set_expiry_callback(telemetry_expired, nullptr);
+    client_ttl_ms = ap_ttl_ms = BENCH_START_MS;
+
+    for (uint16_t i = 0; i < ap_cap; i++) {
+        host_clock_set_us((uint64_t)(BENCH_START_MS - (ap_cap - i) * 10) * 1000);
+        MacAddr bssid = MacAddr::from_u64(0x00163E000000ULL + i * 7919ULL);
+        APInfo& a = ap_registry.upsert(bssid.value);
+        a.bssid = bssid;
+        char name[33];
+        snprintf(name, sizeof(name), i % 7 == 0 ? "Caf\xC3\xA9 \"%u\"" : "Network %06u", i);
+        const char* s = rnd(10) == 0 ? "" : ssid_arena.intern(name);
+        a.ssid = s ? s : "";
+        a.channel = 1 + rnd(13);
+        a.rssi = -40 - (int)rnd(55);
+        a.beacon_count = (int)rnd(100000);
+        a.security.flags = SEC_RSN | SEC_PRIVACY;
+        a.last_seen = millis();
+    }
+    for (uint16_t i = 0; i < client_cap; i++) {
+        host_clock_set_us((uint64_t)(BENCH_START_MS - (client_cap - i) * 2) * 1000);
+        MacAddr mac = MacAddr::from_u64(0x02AB00000000ULL + i * 104729ULL);
+        ClientInfo& c = client_registry.upsert(mac.value);
+        c.mac = mac;
+        c.rssi = -50 - (int)rnd(45);
+        c.frame_count = (int)rnd(5000);
+        c.retry_count = (int)rnd(500);
+        c.last_seen = millis();
+        if (rnd(4) != 0) set_client_ap(c, MacAddr::from_u64(0x00163E000000ULL + rnd(ap_cap) * 7919ULL), true);
+    }
+    for (int ch = 1; ch <= WIFI_CHANNEL_MAX; ch++) {
+        for (int k = 0; k < 50; k++) channel_stats[ch].signal.add(-60 - (int)rnd(30), -95, rnd(10) == 0, millis());
+    }
+
+    // Full batch: every record and channel
+    uint32_t now = BENCH_START_MS;
+    host_clock_set_us((uint64_t)now * 1000);
+    telemetry.set_format(TELEMETRY_BINARY);
+    std::string full_stream;
+    int writes = run_batch(now, &full_stream);
+    uint32_t full_frames = telemetry.stats().frames;
+    BenchHandler full;
+    TelemetryDecoder decoder(full);
+    decoder.feed((const uint8_t*)full_stream.data(), full_stream.size());
+    bool full_ok = full.aps == ap_cap && full.clients == client_cap && full.channels == WIFI_CHANNEL_MAX &&
+                   full.summaries == 1 && full.mismatched == 0 && decoder.stats().skipped == 0;
+    printf("full batch    %u APs  %u clients  %u channels  %zu bytes in %u frames, %d writes  %.1f bytes/record  %s\n",
+           full.aps, full.clients, full.channels, full_stream.size(), full_frames, writes,
+           (double)full_stream.size() / (full.aps + full.clients), full_ok ? "ok" : "MISMATCH");
+
+    // Delta batch: every 20th record heard again, three channels busy, the oldest clients expired
+    now += 500;
+    host_clock_set_us((uint64_t)now * 1000);
+    uint32_t touched_aps = 0, touched_clients = 0;
+    for (uint16_t i = 19; i < ap_cap; i += 20, touched_aps++) {
+        APInfo& a = ap_registry.upsert(0x00163E000000ULL + i * 7919ULL);
+        a.beacon_count++;
+        a.last_seen = millis();
+    }
+    for (uint16_t i = 19; i < client_cap; i += 20, touched_clients++) {
+        ClientInfo& c = client_registry.upsert(0x02AB00000000ULL + i * 104729ULL);
+        c.frame_count++;
+        c.last_seen = millis();
+    }
+    for (int ch = 1; ch <= 11; ch += 5) channel_stats[ch].signal.add(-55, -94, false, millis());
+    now += 500;
+    host_clock_set_us((uint64_t)now * 1000);
+    client_ttl_ms = now - (BENCH_START_MS - (client_cap - BENCH_EXPIRED) * 2);
+    size_t removed = expire_stale_entries(now, BENCH_EXPIRED * 2);
+
+    std::string delta_stream;
+    run_batch(now, &delta_stream);
+    BenchHandler delta;
+    TelemetryDecoder delta_decoder(delta);
+    delta_decoder.feed((const uint8_t*)delta_stream.data(), delta_stream.size());
+    bool delta_ok = delta.aps == touched_aps && delta.clients == touched_clients && delta.gone == removed &&
+                    removed == BENCH_EXPIRED && delta.channels >= 3 && delta.summaries == 1 && delta.mismatched == 0;
+    printf("delta batch   %u APs  %u clients  %u channels  %u gone  %zu bytes  %s\n", delta.aps, delta.clients,
+           delta.channels, delta.gone, delta_stream.size(), delta_ok ? "ok" : "MISMATCH");
+
+    // The full batch again with text between the buffers and every 10th frame damaged
+    std::string noisy;
+    uint32_t damaged = 0, frames = 0;
+    for (size_t off = 0; off < full_stream.size(); frames++) {
+        size_t len = (uint8_t)full_stream[off + 2] | (size_t)(uint8_t)full_stream[off + 3] << 8;
+        std::string frame = full_stream.substr(off, TELEMETRY_FRAME_OVERHEAD + len);
+        // Never the last frame: a loss is only seen from the frame after it
+        if (frames % 10 == 5 && off + frame.size() < full_stream.size()) {
+            frame[4 + sizeof(TelemetryFrameHeader) + rnd((uint32_t)(len - sizeof(TelemetryFrameHeader)))] ^= 0x10;
+            damaged++;
+        }
+        if (frames % 4 == 0) noisy += "Channel hopping: adaptive\r\n";
+        noisy += frame;
+        off += frame.size();
+    }
+    BenchHandler noise;
+    TelemetryDecoder noise_decoder(noise);
+    for (size_t off = 0; off < noisy.size(); off += 61) {   // Odd chunks, as a UART read returns them
+        size_t n = noisy.size() - off < 61 ? noisy.size() - off : 61;
+        noise_decoder.feed((const uint8_t*)noisy.data() + off, n);
+    }
+    const TelemetryDecoderStats& ns = noise_decoder.stats();
+    // The registries have moved on since, so only the framing is checked
+    bool noise_ok = ns.frames == frames - damaged && ns.crc_errors == damaged && ns.lost == damaged &&
+                    noise.summaries == 1;
+    printf("resync        %u/%u frames  %u damaged  %u CRC errors  %u lost  %llu bytes skipped  %s\n",
+           ns.frames, frames, damaged, ns.crc_errors, ns.lost, (unsigned long long)ns.skipped,
+           noise_ok ? "ok" : "MISMATCH");
+
+    // Throughput, full batches
+    size_t bytes = 0;
+    Clock::time_point t0 = Clock::now();
+    for (int r = 0; r < BENCH_REPS; r++) {
+        std::string s;
+        telemetry.request_full();
+        run_batch(now, &s);
+        bytes += s.size();
+    }
+    Clock::duration enc = Clock::now() - t0;
+    BenchHandler sink;
+    TelemetryDecoder sink_decoder(sink);
+    t0 = Clock::now();
+    for (int r = 0; r < BENCH_REPS; r++) {
+        sink_decoder.reset();
+        sink_decoder.feed((const uint8_t*)full_stream.data(), full_stream.size());
+    }
+    Clock::duration dec = Clock::now() - t0;
+    double records_per_batch = ap_registry.size() + client_registry.size();
+    printf("binary        encode %.0f MB/s %.1fM records/s  decode %.0f MB/s\n", mb_per_s(bytes, enc),
+           records_per_batch * BENCH_REPS / std::chrono::duration<double>(enc).count() / 1e6,
+           mb_per_s(full_stream.size() * BENCH_REPS, dec));
+
+    telemetry.set_format(TELEMETRY_NDJSON);
+    std::string json;
+    size_t json_records = 0;
+    t0 = Clock::now();
+    for (int r = 0; r < BENCH_REPS; r++) {
+        json.clear();
+        telemetry.request_full();
+        size_t before = telemetry.stats().records;
+        run_batch(now, &json);
+        json_records = telemetry.stats().records - before;
+    }
+    enc = Clock::now() - t0;
+    size_t lines = 0;
+    for (char c : json) lines += c == '\n';
+    bool json_ok = lines == json_records &&
+                   json_records == ap_registry.size() + client_registry.size() + WIFI_CHANNEL_MAX + 1;
+    printf("ndjson        encode %.0f MB/s %.1fM records/s  %zu bytes  %zu lines  %.2fx binary  %s\n",
+           mb_per_s(json.size() * BENCH_REPS, enc),
+           records_per_batch * BENCH_REPS / std::chrono::duration<double>(enc).count() / 1e6, json.size(), lines,
+           (double)json.size() / full_stream.size(), json_ok ? "ok" : "MISMATCH");
+
+    // Link: 10 bits per byte on the UART
+    const long rates[] = {115200, 921600, 2000000, baud};
+    int nrates = baud == 115200 || baud == 921600 || baud == 2000000 ? 3 : 4;
+    for (int i = 0; i < nrates; i++) {
+        double bps = rates[i] / 10.0;
+        printf("%7ld baud  full batch %7.0f ms (ndjson %7.0f ms)  delta %5.0f ms  %6.0f records/s (ndjson %6.0f)\n",
+               rates[i], full_stream.size() / bps * 1000, json.size() / bps * 1000, delta_stream.size() / bps * 1000,
+               bps * (full.aps + full.clients) / full_stream.size(), bps * json_records / json.size());
+    }
+    return full_ok && delta_ok && noise_ok && json_ok ? 0 : 1;
+}
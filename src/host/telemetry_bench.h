@@ -0,0 +1,13 @@
+// Telemetry stream round trip and throughput benchmark (native host build only)
+
+#ifndef HOST_TELEMETRY_BENCH_H
+#define HOST_TELEMETRY_BENCH_H
+
+// Fills the registries with records synthetic records, streams a full batch
+// and a delta batch through the encoder and TelemetryDecoder and checks what
+// arrives, replays the full batch with text and damaged frames mixed in, then
+// times encoding and decoding and gives the link time of a batch at baud and
+// the standard rates. Returns the process exit code.
+int run_telemetry_bench(int records, long baud);
+
+#endif // HOST_TELEMETRY_BENCH_H
@@ -0,0 +1,130 @@
+// Telemetry stream decoder: resynchronising frame parser
+
+#include "telemetry_decoder.h"
+#include <string.h>
+#include "crc32.h"
+
+TelemetryDecoder::TelemetryDecoder(TelemetryHandler& handler) : handler(handler) {
+    reset();
+    memset(&st, 0, sizeof(st));
+}
+
+void TelemetryDecoder::reset() {
+    pending.clear();
+    head = 0;
+    have_sequence = false;
+    next_sequence = 0;
+}
+
+void TelemetryDecoder::feed(const uint8_t* data, size_t len) {
+    st.bytes += len;
+    pending.insert(pending.end(), data, data + len);
+    scan();
+    // Compact once the consumed prefix dominates, keeping feed() amortised O(len)
+    if (head > 4096 && head * 2 > pending.size()) {
+        pending.erase(pending.begin(), pending.begin() + head);
+        head = 0;
+    }
+}
+
+void TelemetryDecoder::scan() {
+    const size_t min_payload = sizeof(TelemetryFrameHeader);
+    while (pending.size() - head >= 4) {
+        const uint8_t* p = pending.data() + head;
+        if (p[0] != TELEMETRY_SYNC0 || p[1] != TELEMETRY_SYNC1) {
+            const uint8_t* sync = (const uint8_t*)memchr(p + 1, TELEMETRY_SYNC0, pending.size() - head - 1);
+            size_t skip = sync ? (size_t)(sync - p) : pending.size() - head;
+            st.skipped += skip;
+            head += skip;
+            continue;
+        }
+        size_t len = p[2] | (size_t)p[3] << 8;
+        if (len < min_payload || len > TELEMETRY_FRAME_MAX) {
+            st.skipped++;
+            head++;
+            continue;
+        }
+        if (pending.size() - head < TELEMETRY_FRAME_OVERHEAD + len) return;   // Wait for the rest
+        uint32_t crc;
+        memcpy(&crc, p + 4 + len, 4);
+        if (crc32_update(CRC32_INIT, p + 4, len) != crc) {
+            st.crc_errors++;
+            st.skipped++;
+            head++;
+            continue;
+        }
+        dispatch(p + 4, len);
+        head += TELEMETRY_FRAME_OVERHEAD + len;
+    }
+}
+
+void TelemetryDecoder::dispatch(const uint8_t* payload, size_t len) {
+    TelemetryFrameHeader h;
+    memcpy(&h, payload, sizeof(h));
+    if (h.version != TELEMETRY_VERSION) {
+        st.malformed++;
+        return;
+    }
+    if (have_sequence && h.sequence != next_sequence) st.lost += h.sequence - next_sequence;
+    have_sequence = true;
+    next_sequence = h.sequence + 1;
+    st.frames++;
+
+    const uint8_t* p = payload + sizeof(h);
+    const uint8_t* end = payload + len;
+    for (uint16_t i = 0; i < h.count; i++) {
+        switch (h.type) {
+        case TELEMETRY_CHANNEL: {
+            TelemetryChannel c;
+            if (end - p < (ptrdiff_t)sizeof(c)) goto malformed;
+            memcpy(&c, p, sizeof(c));
+            p += sizeof(c);
+            handler.on_channel(h, c);
+            break;
+        }
+        case TELEMETRY_GONE: {
+            TelemetryGone g;
+            if (end - p < (ptrdiff_t)sizeof(g)) goto malformed;
+            memcpy(&g, p, sizeof(g));
+            p += sizeof(g);
+            handler.on_gone(h, g);
+            break;
+        }
+        case TELEMETRY_AP: {
+            TelemetryAp a;
+            char ssid[33];
+            if (end - p < (ptrdiff_t)sizeof(a)) goto malformed;
+            memcpy(&a, p, sizeof(a));
+            p += sizeof(a);
+            if (a.ssid_len > 32 || end - p < a.ssid_len) goto malformed;
+            memcpy(ssid, p, a.ssid_len);
+            ssid[a.ssid_len] = '\0';
+            p += a.ssid_len;
+            handler.on_ap(h, a, ssid);
+            break;
+        }
+        case TELEMETRY_CLIENT: {
+            TelemetryClient c;
+            if (end - p < (ptrdiff_t)sizeof(c)) goto malformed;
+            memcpy(&c, p, sizeof(c));
+            p += sizeof(c);
+            handler.on_client(h, c);
+            break;
+        }
+        case TELEMETRY_SUMMARY: {
+            TelemetrySummary s;
+            if (end - p < (ptrdiff_t)sizeof(s)) goto malformed;
+            memcpy(&s, p, sizeof(s));
+            p += sizeof(s);
+            handler.on_summary(h, s);
+            break;
+        }
+        default:
+            goto malformed;
+        }
+        st.records++;
+    }
+    if (p == end) return;
+malformed:
+    st.malformed++;
+}
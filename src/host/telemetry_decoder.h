@@ -0,0 +1,64 @@
+// Telemetry stream decoder for collectors (native host build)
+//
+// Feeds on the raw bytes of the serial link in chunks of any size, finds the
+// binary frames described in telemetry.h among whatever else was written to
+// the port, checks each frame's CRC and hands every record to a handler.
+// A frame whose CRC fails is dropped and the search resumes one byte after its
+// sync bytes; gaps in the frame sequence count as lost frames.
+//
+// The NDJSON encoding needs no decoder: any JSON library reads it line by line.
+
+#ifndef HOST_TELEMETRY_DECODER_H
+#define HOST_TELEMETRY_DECODER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+#include "telemetry.h"
+
+// Receives decoded records; a summary closes each batch
+class TelemetryHandler {
+public:
+    virtual ~TelemetryHandler() {}
+    virtual void on_channel(const TelemetryFrameHeader&, const TelemetryChannel&) {}
+    virtual void on_gone(const TelemetryFrameHeader&, const TelemetryGone&) {}
+    // ssid is NUL-terminated
+    virtual void on_ap(const TelemetryFrameHeader&, const TelemetryAp&, const char* /*ssid*/) {}
+    virtual void on_client(const TelemetryFrameHeader&, const TelemetryClient&) {}
+    virtual void on_summary(const TelemetryFrameHeader&, const TelemetrySummary&) {}
+};
+
+struct TelemetryDecoderStats {
+    uint64_t bytes;            // Fed
+    uint64_t skipped;          // Not part of a valid frame (text, noise, damaged frames)
+    uint32_t frames;           // Valid frames
+    uint32_t records;
+    uint32_t crc_errors;
+    uint32_t malformed;        // CRC valid but records do not fit the length (version mismatch)
+    uint32_t lost;             // Frames missing from the sequence
+};
+
+class TelemetryDecoder {
+public:
+    explicit TelemetryDecoder(TelemetryHandler& handler);
+
+    void feed(const uint8_t* data, size_t len);
+
+    // Forgets buffered bytes and the expected sequence number
+    void reset();
+
+    const TelemetryDecoderStats& stats() const { return st; }
+
+private:
+    void scan();
+    void dispatch(const uint8_t* payload, size_t len);
+
+    TelemetryHandler& handler;
+    std::vector<uint8_t> pending;
+    size_t head;               // First byte of pending not yet consumed
+    bool have_sequence;
+    uint32_t next_sequence;
+    TelemetryDecoderStats st;
+};
+
+#endif // HOST_TELEMETRY_DECODER_H
@@ -0,0 +1,122 @@
+// 802.11 information element parsing: SSID lookup and RSN/WPA decoding
+
+#include "ie_parser.h"
+#include <string.h>
+
+bool ie_find(const uint8_t* buf, size_t len, uint8_t id, IeView* out) {
+    IeIterator it(buf, len);
+    while (it.next(out)) {
+        if (out->id == id) return true;
+    }
+    return false;
+}
+
+bool ie_copy_ssid(const uint8_t* buf, size_t len, char* out) {
+    IeView ie;
+    if (!ie_find(buf, len, IE_SSID, &ie) || ie.len == 0 || ie.len > 32) return false;
+    // Hidden networks often beacon a run of NUL bytes instead of the name
+    if (ie.data[0] == '\0') return false;
+    memcpy(out, ie.data, ie.len);
+    out[ie.len] = '\0';
+    return true;
+}
+
+static const uint8_t OUI_IEEE[3] = {0x00, 0x0F, 0xAC};    // RSN suites
+static const uint8_t OUI_MS[3] = {0x00, 0x50, 0xF2};      // WPA suites
+
+static uint8_t cipher_bit(const uint8_t* suite, const uint8_t* oui) {
+    if (memcmp(suite, oui, 3) != 0) return CIPHER_OTHER;
+    switch (suite[3]) {
+        case 1: return CIPHER_WEP40;
+        case 2: return CIPHER_TKIP;
+        case 4: return CIPHER_CCMP;
+        case 5: return CIPHER_WEP104;
+        case 8: return CIPHER_GCMP;
+        case 9: return CIPHER_GCMP256;
+        case 10: return CIPHER_CCMP256;
+        default: return CIPHER_OTHER;
+    }
+}
+
+static uint8_t akm_bits(const uint8_t* suite, const uint8_t* oui, bool rsn) {
+    if (memcmp(suite, oui, 3) != 0) return AKM_OTHER;
+    if (!rsn) {
+        if (suite[3] == 1) return AKM_8021X;
+        if (suite[3] == 2) return AKM_PSK;
+        return AKM_OTHER;
+    }
+    switch (suite[3]) {
+        case 1: case 5: case 11: case 12: return AKM_8021X;
+        case 3: case 13: return AKM_8021X | AKM_FT;
+        case 2: case 6: return AKM_PSK;
+        case 4: return AKM_PSK | AKM_FT;
+        case 8: case 24: return AKM_SAE;
+        case 9: case 25: return AKM_SAE | AKM_FT;
+        case 18: return AKM_OWE;
+        default: return AKM_OTHER;
+    }
+}
+
+// Shared body of the RSN element and the WPA vendor element (after its OUI/type).
+// Trailing fields are optional; a field that is started but cut short is malformed.
+static bool parse_suites(const uint8_t* p, size_t len, const uint8_t* oui, SecurityInfo* out, bool rsn) {
+    const uint8_t* end = p + len;
+    if (end - p < 2) return false;
+    p += 2; // Version
+
+    if (end - p < 4) return true;
+    out->group_cipher = cipher_bit(p, oui);
+    p += 4;
+
+    if (end - p < 2) return true;
+    uint16_t count = p[0] | (p[1] << 8);
+    p += 2;
+    if ((size_t)(end - p) < (size_t)count * 4) return false;
+    for (uint16_t i = 0; i < count; i++, p += 4) out->pairwise |= cipher_bit(p, oui);
+
+    if (end - p < 2) return true;
+    count = p[0] | (p[1] << 8);
+    p += 2;
+    if ((size_t)(end - p) < (size_t)count * 4) return false;
+    for (uint16_t i = 0; i < count; i++, p += 4) out->akm |= akm_bits(p, oui, rsn);
+
+    if (rsn && end - p >= 2) {
+        uint16_t caps = p[0] | (p[1] << 8);
+        if (caps & 0x0080) out->flags |= SEC_PMF_CAPABLE;
+        if (caps & 0x0040) out->flags |= SEC_PMF_REQUIRED;
+    }
+    return true;
+}
+
+void parse_security(uint16_t capability, const uint8_t* ies, size_t len, SecurityInfo* out) {
+    memset(out, 0, sizeof(*out));
+    if (capability & 0x0010) out->flags |= SEC_PRIVACY;
+
+    IeIterator it(ies, len);
+    IeView ie;
+    while (it.next(&ie)) {
+        if (ie.id == IE_RSN) {
+            out->flags |= SEC_RSN;
+            if (!parse_suites(ie.data, ie.len, OUI_IEEE, out, true)) out->flags |= SEC_MALFORMED;
+        } else if (ie.id == IE_VENDOR && ie.len >= 4 && memcmp(ie.data, OUI_MS, 3) == 0 && ie.data[3] == 1) {
+            out->flags |= SEC_WPA;
+            if (!parse_suites(ie.data + 4, ie.len - 4, OUI_MS, out, false)) out->flags |= SEC_MALFORMED;
+        }
+    }
+}
+
+const char* security_label(const SecurityInfo& sec) {
+    if (sec.flags & SEC_RSN) {
+        bool eap = sec.akm & AKM_8021X;
+        bool sae = sec.akm & AKM_SAE;
+        bool psk = sec.akm & AKM_PSK;
+        if (sec.akm & AKM_OWE) return "OWE";
+        if (eap) return (sec.flags & SEC_PMF_REQUIRED) ? "WPA3-EAP" : "WPA2-EAP";
+        if (sae && psk) return "WPA2/3";
+        if (sae) return "WPA3";
+        return "WPA2";
+    }
+    if (sec.flags & SEC_WPA) return (sec.akm & AKM_8021X) ? "WPA-EAP" : "WPA";
+    if (sec.flags & SEC_PRIVACY) return "WEP";
+    return "Open";
+}
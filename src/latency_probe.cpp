@@ -0,0 +1,82 @@
+// Latency probe histograms and their serial report
+
+#include "latency_probe.h"
+#include <Arduino.h>
+#include <string.h>
+
+uint32_t probe_ticks_per_us() {
+#ifdef ESP_PLATFORM
+    return getCpuFrequencyMhz();
+#else
+    return 1000;
+#endif
+}
+
+#if LATENCY_PROBES
+
+ProbeStats probe_stats[PROBE_COUNT];
+uint32_t probe_budget_ticks[PROBE_COUNT];
+
+static const char* const PROBE_NAMES[PROBE_COUNT] = {
+    "rx", "parse", "batch", "expiry", "ui", "render", "flush"
+};
+
+// Durations above these count as overruns
+static const uint32_t PROBE_BUDGET_US[PROBE_COUNT] = {
+    20,        // rx: the WiFi task must not be held up
+    50,        // parse
+    1000,      // batch: the UI waits this long for registry_mutex
+    200,       // expiry
+    10000,     // ui
+    30000,     // render: one LVGL refresh period
+    5000       // flush
+};
+
+void latency_probes_init() {
+    uint32_t tpu = probe_ticks_per_us();
+    for (int i = 0; i < PROBE_COUNT; i++) probe_budget_ticks[i] = PROBE_BUDGET_US[i] * tpu;
+    latency_probes_reset();
+}
+
+void latency_probes_reset() {
+    memset(probe_stats, 0, sizeof(probe_stats));
+}
+
+float probe_percentile_us(ProbeId id, int pct) {
+    const ProbeStats& s = probe_stats[id];
+    if (s.count == 0) return 0;
+    uint64_t rank = ((uint64_t)s.count * pct + 99) / 100;
+    uint64_t seen = 0;
+    for (int b = 0; b < PROBE_BUCKETS; b++) {
+        seen += s.buckets[b];
+        if (seen >= rank) {
+            // Never report more than the largest sample actually seen
+            uint64_t upper = (2ULL << b) - 1;
+            if (upper > s.max_ticks) upper = s.max_ticks;
+            return (float)upper / probe_ticks_per_us();
+        }
+    }
+    return (float)s.max_ticks / probe_ticks_per_us();
+}
+
+void print_latency_probes() {
+    float tpu = probe_ticks_per_us();
+    Serial.printf("Probe   count      mean us  p50 us   p90 us   p99 us   max us    over\n");
+    for (int i = 0; i < PROBE_COUNT; i++) {
+        const ProbeStats& s = probe_stats[i];
+        ProbeId id = (ProbeId)i;
+        Serial.printf("%-7s %-10u %-8.1f %-8.1f %-8.1f %-8.1f %-9.1f %u\n",
+                      PROBE_NAMES[i], s.count, s.count ? s.total_ticks / tpu / s.count : 0.0f,
+                      probe_percentile_us(id, 50), probe_percentile_us(id, 90),
+                      probe_percentile_us(id, 99), s.max_ticks / tpu, s.overruns);
+    }
+}
+
+#else
+
+void latency_probes_init() {}
+void latency_probes_reset() {}
+float probe_percentile_us(ProbeId id, int pct) { return 0; }
+void print_latency_probes() { Serial.printf("Latency probes disabled (LATENCY_PROBES=0)\n"); }
+
+#endif // LATENCY_PROBES
@@ -4,6 +4,8 @@
 #include <stdint.h>
 
 #define LV_COLOR_DEPTH 16
+/* Draw buffers hold panel byte order so they can be DMA'd to the ST7789 as-is */
+#define LV_COLOR_16_SWAP 1
 #define LV_HOR_RES_MAX 240
 #define LV_VER_RES_MAX 240
 #define LV_DISP_DEF_REFR_PERIOD 30
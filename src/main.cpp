@@ -11,14 +11,29 @@
 #include "esp_event.h"
 #include "esp_log.h"
 #include "nvs_flash.h"
+#include <LittleFS.h>
+#include "esp_heap_caps.h"
 #include <lvgl.h>
 #include <LovyanGFX.hpp>
-#include <map>
-#include <vector>
 #include <algorithm>
-#include <set>
+#include <stdarg.h>
+#include "sniffer.h"
+#include "pcap_export.h"
+#include "latency_probe.h"
+#include "mem_stats.h"
+#include "registry_snapshot.h"
+#include "telemetry.h"
 
 // Display configuration for ST7789VW
+#define DISPLAY_SPI_FREQ 80000000
+
+// LVGL renders into one band buffer while the other is sent by DMA. Taller
+// bands mean fewer transfers per frame at the cost of internal RAM.
+#ifndef DISPLAY_BAND_LINES
+#define DISPLAY_BAND_LINES 20
+#endif
+#define DISPLAY_BAND_PIXELS (240 * DISPLAY_BAND_LINES)
+
 class LGFX : public lgfx::LGFX_Device {
     lgfx::Panel_ST7789 _panel_instance;
     lgfx::Bus_SPI _bus_instance;
@@ -29,11 +44,12 @@ public:
             auto cfg = _bus_instance.config();
             cfg.spi_host = VSPI_HOST;
             cfg.spi_mode = 3;  // CRITICAL for ST7789VW
-            cfg.freq_write = 80000000;
+            cfg.freq_write = DISPLAY_SPI_FREQ;
             cfg.pin_sclk = 18;
             cfg.pin_mosi = 23;
             cfg.pin_miso = -1;
             cfg.pin_dc = 2;
+            cfg.dma_channel = 1;   // Band transfers run by DMA (see my_disp_flush)
             _bus_instance.config(cfg);
             _panel_instance.setBus(&_bus_instance);
         }
@@ -55,81 +71,25 @@ public:
 };
 
 // WiFi sniffer configuration
-#define WIFI_CHANNEL_MAX 13
-#define WIFI_CHANNEL_SWITCH_INTERVAL 3000  // 3 seconds per channel
-#define WIFI_MANAGEMENT_FRAME 0x00
-#define WIFI_CONTROL_FRAME 0x01
-#define WIFI_DATA_FRAME 0x02
-
-// Management frame subtypes
-#define WIFI_BEACON_FRAME 0x08
-#define WIFI_PROBE_REQUEST 0x04
-#define WIFI_PROBE_RESPONSE 0x05
-#define WIFI_ASSOCIATION_REQUEST 0x00
-#define WIFI_ASSOCIATION_RESPONSE 0x01
-#define WIFI_REASSOCIATION_REQUEST 0x02
-#define WIFI_REASSOCIATION_RESPONSE 0x03
-#define WIFI_DISASSOCIATION 0x0A
-#define WIFI_AUTHENTICATION 0x0B
-#define WIFI_DEAUTHENTICATION 0x0C
+#define PARSER_BATCH 16                    // Frames parsed per registry lock
+#define RADIO_TICK_MS 10                   // Hopper and expiry period (core 0)
+#define STATUS_PUBLISH_MS 100              // sniffer_status snapshot period
+#define UI_FRAME_MS 33                     // Input, animation and LVGL period (core 1)
+#define UI_REFRESH_MS 2000                 // Card values are rewritten this often
+#define TARGET_REFRESH_MS 250              // ... and this often on TARGET HUNT, to follow the trend
+#define PCAP_WRITE_CHUNK 1024              // Max bytes per Serial.write in pcap mode
+#define PCAP_FLUSH_MS 20                   // Max time a partial pcap batch waits
+#define STORE_POLL_MS 1000                 // How often the store task checks for a due snapshot
+#define SERIAL_BAUD 115200                 // Console at boot; "telem baud" changes it
 
 // Touch pins (avoiding display pins 18, 23, 2, 4)
 #define PIN_NEXT 32  // PIN 32: Next card
 #define PIN_SCROLL 33  // PIN 33: Scroll within card
 
-// Target phone MAC (your phone's WiFi MAC)
-const char* TARGET_PHONE = "C4:EF:3D:B3:23:BD";
-
-// Data structures
-struct APInfo {
-    String ssid;
-    String bssid;
-    int channel;
-    int rssi;
-    int client_count;
-    String security;
-    unsigned long last_seen;
-    int beacon_count;
-    std::set<String> associated_clients;
-};
-
-struct ClientInfo {
-    String mac;
-    String connected_ap;
-    int rssi;
-    String vendor;
-    unsigned long last_seen;
-    int frame_count;
-    bool is_associated;
-};
-
-struct ChannelStats {
-    int ap_count;
-    int total_frames;
-    int avg_rssi;
-    unsigned long last_activity;
-};
-
-// Add these new structures for target phone tracking
-struct TargetPacketInfo {
-    unsigned long timestamp;
-    String frame_type;
-    int rssi;
-    String direction; // "TX" or "RX"
-    String details;
-};
-
-#define MAX_TARGET_PACKETS 20
-std::vector<TargetPacketInfo> target_packets;
-String target_ip = "Scanning...";
-int target_tx_packets = 0;
-int target_rx_packets = 0;
-String target_ssid = "Unknown";
-
 // Global variables
 LGFX tft;
 static lv_disp_draw_buf_t draw_buf;
-static lv_color_t buf[240 * 20];
+static lv_color_t* band_buf[2] = {nullptr, nullptr};   // DMA-capable internal RAM
 
 // UI State
 enum UICard { AP_HOTSPOTS, CLIENT_ANALYSIS, TARGET_HUNT, SIGNAL_MAP, NETWORK_INTEL, SYSTEM_STATUS };
@@ -137,22 +97,45 @@ UICard current_card = AP_HOTSPOTS;
 int scroll_pos = 0;
 uint32_t frame_count = 0;
 
-// WiFi Data
-std::map<String, APInfo> ap_registry;
-std::map<String, ClientInfo> client_registry;
-ChannelStats channel_stats[14]; // Index 0 unused, 1-13 for channels
-int current_channel = 1;
-uint32_t last_channel_switch = 0;
-int total_frames = 0;
-int mgmt_frames = 0;
-int data_frames = 0;
-int ctrl_frames = 0;
-
-// Target tracking
-bool target_found = false;
-int target_rssi = 0;
-String target_ap = "";
-unsigned long target_last_seen = 0;
+// Registries are written by parser_task and radio_task under registry_mutex
+SemaphoreHandle_t registry_mutex = nullptr;
+
+// pcap export: parser_task -> pcap_ring -> pcap_export_task -> Serial
+PcapRing pcap_ring;
+PcapWriter pcap_writer(pcap_ring);
+
+// Task layout: capture, parsing, hopping and expiry on core 0 next to the WiFi
+// driver; input, card updates and rendering on core 1 with the pcap exporter,
+// the flash snapshot writer and the telemetry stream.
+// Each task adds the time it spends awake to busy_us; the 32-bit counter is
+// written only by its own task, so the sampler on core 1 never reads it torn.
+enum TaskId { TASK_PARSER, TASK_RADIO, TASK_UI, TASK_PCAP, TASK_STORE, TASK_TELEMETRY, TASK_COUNT };
+
+struct TaskStats {
+    const char* name;
+    int core;
+    UBaseType_t priority;
+    uint32_t stack_size;        // Bytes
+    TaskHandle_t handle;
+    volatile uint32_t busy_us;  // Time awake since boot (wraps)
+    uint32_t sampled_busy_us;   // busy_us at the previous sample
+    uint32_t load_permille;     // Share of the last sample window spent awake
+    uint32_t stack_free_min;    // Stack high-water mark: least free stack seen, bytes
+};
+
+TaskStats task_stats[TASK_COUNT] = {
+    {"parser", 0, 2, 8192, nullptr, 0, 0, 0, 0},
+    {"radio", 0, 3, 4096, nullptr, 0, 0, 0, 0},
+    {"ui", 1, 2, 8192, nullptr, 0, 0, 0, 0},
+    {"pcap", 1, 1, 4096, nullptr, 0, 0, 0, 0},
+    {"store", 1, 1, 6144, nullptr, 0, 0, 0, 0},
+    {"telem", 1, 1, 4096, nullptr, 0, 0, 0, 0},
+};
+
+// Credits the time since start_us to a task's busy counter
+inline void task_busy(TaskId id, uint32_t start_us) {
+    task_stats[id].busy_us += micros() - start_us;
+}
 
 // Touch handling
 bool pin32_pressed = false;
@@ -167,12 +150,29 @@ lv_obj_t* main_screen;
 lv_obj_t* title_label;
 lv_obj_t* content_area;
 
-// Enhanced display configuration for cooler UI
-lv_obj_t* signal_bar = nullptr;
-lv_obj_t* progress_arc = nullptr;
-lv_obj_t* status_indicator = nullptr;
+// Cards are built once and kept: each refresh only rewrites the values that changed
 int animation_counter = 0;
 
+// UI cost counters, printed by the "ui" serial command
+struct UiStats {
+    uint32_t objects_created;   // Widgets created since boot
+    uint32_t refreshes;         // update_card_content() calls
+    uint32_t update_us;         // Duration of the last update_card_content()
+    uint32_t render_ms;         // Last LVGL render + flush (from monitor_cb)
+    uint32_t render_px;         // Pixels redrawn by that render
+    uint64_t bytes_flushed;     // Bytes sent to the panel since boot
+    uint32_t flushes;           // Bands sent since boot
+    uint32_t frame_us;          // Last frame: first band queued to last DMA done
+    uint32_t frame_bytes;       // Bytes sent in the last frame
+    uint32_t frame_wait_us;     // CPU time the last frame spent waiting on SPI
+    uint64_t dma_wait_us;       // CPU time spent waiting on SPI since boot
+};
+UiStats ui_stats = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+
+// Copy of sniffer_status taken at the start of each refresh
+SnifferStatus ui_status;
+uint32_t frame_start_us = 0;
+
 // Color scheme
 #define COLOR_PRIMARY    0x00ff88    // Bright green
 #define COLOR_SECONDARY  0x00aaff    // Bright blue  
@@ -183,18 +183,105 @@ int animation_counter = 0;
 #define COLOR_TEXT_DIM   0x888888    // Dim text
 #define COLOR_TEXT_BRIGHT 0xffffff   // Bright text
 
-// Create animated signal strength bars
-void create_signal_bars(lv_obj_t* parent, int x, int y, int rssi) {
-    int bars = 5;
+// Widget creation (counted in ui_stats)
+lv_obj_t* ui_label(lv_obj_t* parent, int x, int y, int width, uint32_t color) {
+    lv_obj_t* label = lv_label_create(parent);
+    ui_stats.objects_created++;
+    lv_obj_set_pos(label, x, y);
+    if (width > 0) lv_obj_set_width(label, width);
+    lv_label_set_text(label, "");
+    lv_obj_set_style_text_color(label, lv_color_hex(color), LV_PART_MAIN);
+    return label;
+}
+
+lv_obj_t* ui_box(lv_obj_t* parent, int x, int y, int w, int h, uint32_t color, int radius) {
+    lv_obj_t* box = lv_obj_create(parent);
+    ui_stats.objects_created++;
+    lv_obj_set_size(box, w, h);
+    lv_obj_set_pos(box, x, y);
+    lv_obj_set_style_bg_color(box, lv_color_hex(color), LV_PART_MAIN);
+    lv_obj_set_style_radius(box, radius, LV_PART_MAIN);
+    lv_obj_set_style_border_width(box, 0, LV_PART_MAIN);
+    return box;
+}
+
+// Transparent full-size container for a card, or for one state of a card
+lv_obj_t* ui_group(lv_obj_t* parent) {
+    lv_obj_t* group = lv_obj_create(parent);
+    ui_stats.objects_created++;
+    lv_obj_remove_style_all(group);
+    lv_obj_set_size(group, LV_PCT(100), LV_PCT(100));
+    lv_obj_clear_flag(group, LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_add_flag(group, LV_OBJ_FLAG_OVERFLOW_VISIBLE);
+    return group;
+}
+
+// Setters that leave the object alone (and undirtied) when nothing changed
+void ui_set_text(lv_obj_t* label, const char* fmt, ...) {
+    char text[96];
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(text, sizeof(text), fmt, args);
+    va_end(args);
+    if (strcmp(lv_label_get_text(label), text) != 0) lv_label_set_text(label, text);
+}
+
+void ui_set_text_color(lv_obj_t* obj, lv_color_t color) {
+    if (lv_obj_get_style_text_color(obj, LV_PART_MAIN).full != color.full) {
+        lv_obj_set_style_text_color(obj, color, LV_PART_MAIN);
+    }
+}
+
+void ui_set_bg_color(lv_obj_t* obj, lv_color_t color) {
+    if (lv_obj_get_style_bg_color(obj, LV_PART_MAIN).full != color.full) {
+        lv_obj_set_style_bg_color(obj, color, LV_PART_MAIN);
+    }
+}
+
+void ui_set_hidden(lv_obj_t* obj, bool hidden) {
+    if (lv_obj_has_flag(obj, LV_OBJ_FLAG_HIDDEN) == hidden) return;
+    if (hidden) lv_obj_add_flag(obj, LV_OBJ_FLAG_HIDDEN);
+    else lv_obj_clear_flag(obj, LV_OBJ_FLAG_HIDDEN);
+}
+
+void ui_set_geometry(lv_obj_t* obj, int x, int y, int w, int h) {
+    if (lv_obj_get_style_x(obj, LV_PART_MAIN) != x || lv_obj_get_style_y(obj, LV_PART_MAIN) != y) {
+        lv_obj_set_pos(obj, x, y);
+    }
+    if (lv_obj_get_style_width(obj, LV_PART_MAIN) != w || lv_obj_get_style_height(obj, LV_PART_MAIN) != h) {
+        lv_obj_set_size(obj, w, h);
+    }
+}
+
+// Formats "Ns ago" / "Nm ago" for a last-seen timestamp
+void format_age(char* out, size_t len, unsigned long last_seen, const char* prefix) {
+    int age_sec = (millis() - last_seen) / 1000;
+    if (age_sec < 60) snprintf(out, len, "%s%ds ago", prefix, age_sec);
+    else snprintf(out, len, "%s%dm ago", prefix, age_sec / 60);
+}
+
+// Share of received frames that were retransmissions, in percent
+int retry_pct(uint32_t retries, uint32_t received) {
+    return received > 0 ? (int)((uint64_t)retries * 100 / received) : 0;
+}
+
+// Signal strength bars
+struct SignalBars {
+    lv_obj_t* bar[5];
+};
+
+void create_signal_bars(SignalBars* bars, lv_obj_t* parent, int x, int y) {
+    for (int i = 0; i < 5; i++) {
+        bars->bar[i] = ui_box(parent, x + (i * 8), y - (i * 4), 6, 8 + (i * 4), COLOR_TEXT_DIM, 2);
+    }
+}
+
+void update_signal_bars(SignalBars* bars, int rssi) {
     int signal_strength = (rssi + 100) / 10; // Convert RSSI to 0-10 scale
     if (signal_strength > 5) signal_strength = 5;
     if (signal_strength < 0) signal_strength = 0;
     
-    for (int i = 0; i < bars; i++) {
-        lv_obj_t* bar = lv_obj_create(parent);
-        lv_obj_set_size(bar, 6, 8 + (i * 4));
-        lv_obj_set_pos(bar, x + (i * 8), y - (i * 4));
-        
+    for (int i = 0; i < 5; i++) {
         // Color based on signal strength
         lv_color_t bar_color;
         if (i < signal_strength) {
@@ -204,20 +291,18 @@ void create_signal_bars(lv_obj_t* parent, int x, int y, int rssi) {
         } else {
             bar_color = lv_color_hex(COLOR_TEXT_DIM);
         }
-        
-        lv_obj_set_style_bg_color(bar, bar_color, LV_PART_MAIN);
-        lv_obj_set_style_border_width(bar, 0, LV_PART_MAIN);
-        lv_obj_set_style_radius(bar, 2, LV_PART_MAIN);
+        ui_set_bg_color(bars->bar[i], bar_color);
     }
 }
 
-// Create animated progress arc
-void create_progress_arc(lv_obj_t* parent, int x, int y, int percentage, lv_color_t color) {
+// Progress arc without a knob
+lv_obj_t* create_progress_arc(lv_obj_t* parent, int x, int y, lv_color_t color) {
     lv_obj_t* arc = lv_arc_create(parent);
+    ui_stats.objects_created++;
     lv_obj_set_size(arc, 60, 60);
     lv_obj_set_pos(arc, x, y);
     lv_arc_set_range(arc, 0, 100);
-    lv_arc_set_value(arc, percentage);
+    lv_arc_set_value(arc, 0);
     
     lv_obj_set_style_arc_color(arc, color, LV_PART_MAIN);
     lv_obj_set_style_arc_color(arc, lv_color_hex(COLOR_TEXT_DIM), LV_PART_INDICATOR);
@@ -227,102 +312,62 @@ void create_progress_arc(lv_obj_t* parent, int x, int y, int percentage, lv_colo
     // Remove knob
     lv_obj_clear_flag(arc, LV_OBJ_FLAG_CLICKABLE);
     lv_obj_set_style_bg_opa(arc, LV_OPA_TRANSP, LV_PART_KNOB);
+    return arc;
 }
 
-// Helper functions
-String mac_to_str(const uint8_t* mac) {
-    char buf[18];
-    sprintf(buf, "%02X:%02X:%02X:%02X:%02X:%02X", mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
-    return String(buf);
-}
-
-String get_vendor_from_mac(const String& mac) {
-    // Simple vendor detection based on OUI
-    if (mac.startsWith("00:16:B6") || mac.startsWith("DC:A6:32")) return "RaspPi";
-    if (mac.startsWith("AC:DE:48") || mac.startsWith("F0:18:98")) return "Apple";
-    if (mac.startsWith("28:11:A5") || mac.startsWith("34:2E:B7")) return "Samsung";
-    if (mac.startsWith("00:50:56")) return "VMware";
-    if (mac.startsWith("08:00:27")) return "VBox";
-    return "Unknown";
+void update_progress_arc(lv_obj_t* arc, int percentage) {
+    if (lv_arc_get_value(arc) != percentage) lv_arc_set_value(arc, percentage);
 }
 
-String get_security_from_beacon(const uint8_t* payload, int len) {
-    // Parse capability info and RSN/WPA information elements
-    if (len > 34) {
-        uint16_t capability = payload[34] | (payload[35] << 8);
-        if (capability & 0x0010) {
-            // Look for RSN/WPA IEs in the rest of the frame
-            for (int i = 36; i < len - 2; i++) {
-                if (payload[i] == 0x30) return "WPA2"; // RSN IE
-                if (payload[i] == 0xDD && i + 4 < len && 
-                    payload[i+2] == 0x00 && payload[i+3] == 0x50 && payload[i+4] == 0xF2) return "WPA"; // WPA IE
-            }
-            return "WEP";
-        }
-    }
-    return "Open";
-}
-
-// Helper function to find closest AP by RSSI and timing
-String find_closest_ap(const String& client_mac, int client_rssi, unsigned long client_time) {
-    String closest_ap = "";
-    int best_score = -999;
-    
-    for (const auto& kv : ap_registry) {
-        const APInfo& ap = kv.second;
-        // AP must be recently active and on same or recent channel
-        if (millis() - ap.last_seen < 10000) {
-            // Score based on RSSI similarity and time proximity
-            int rssi_diff = abs(client_rssi - ap.rssi);
-            int time_diff = abs((long)(client_time - ap.last_seen)) / 1000;
-            int score = -rssi_diff - time_diff;
-            
-            if (score > best_score) {
-                best_score = score;
-                closest_ap = ap.bssid;
-            }
-        }
-    }
-    
-    return closest_ap;
-}
-
-// Update AP client counts based on proximity
-void update_ap_client_associations() {
-    // Reset all client counts
-    for (auto& kv : ap_registry) {
-        kv.second.client_count = 0;
-        kv.second.associated_clients.clear();
-    }
-    
-    // Associate clients to nearest APs
-    for (const auto& kv : client_registry) {
-        const ClientInfo& client = kv.second;
-        
-        // Find the closest AP for this client
-        String closest_ap = find_closest_ap(client.mac, client.rssi, client.last_seen);
-        if (closest_ap.length() > 0) {
-            if (ap_registry.find(closest_ap) != ap_registry.end()) {
-                ap_registry[closest_ap].associated_clients.insert(client.mac);
-                ap_registry[closest_ap].client_count++;
-            }
-        }
-    }
+// Blocks until the band in flight has been sent; the time is counted as SPI stall
+void display_wait_dma() {
+    uint32_t start = micros();
+    tft.waitDMA();
+    uint32_t waited = micros() - start;
+    ui_stats.frame_wait_us += waited;
+    ui_stats.dma_wait_us += waited;
 }
 
-// Display flush callback
+// Display flush callback: queues the band for DMA and returns immediately.
+// Only the band before this one can still be in flight, and it lives in the
+// other buffer, so once it completes LVGL may render into that buffer while
+// this band is transferred.
 void my_disp_flush(lv_disp_drv_t *disp, const lv_area_t *area, lv_color_t *color_p) {
     uint32_t w = (area->x2 - area->x1 + 1);
     uint32_t h = (area->y2 - area->y1 + 1);
+    PROBE_SCOPE(PROBE_FLUSH);
     
-    tft.startWrite();
-    tft.setAddrWindow(area->x1, area->y1, w, h);
-    tft.writePixels((lgfx::rgb565_t *)&color_p->full, w * h);
-    tft.endWrite();
+    if (tft.getStartCount() == 0) {
+        // First band of a frame: the bus stays ours until display_flush_finish()
+        tft.startWrite();
+        frame_start_us = micros();
+        ui_stats.frame_bytes = 0;
+        ui_stats.frame_wait_us = 0;
+    }
+    
+    display_wait_dma();
+    tft.pushImageDMA(area->x1, area->y1, w, h, (const lgfx::swap565_t *)&color_p->full);
     
+    ui_stats.flushes++;
+    ui_stats.frame_bytes += w * h * sizeof(lv_color_t);
+    ui_stats.bytes_flushed += w * h * sizeof(lv_color_t);
     lv_disp_flush_ready(disp);
 }
 
+// Releases the bus once the last band of a frame is on the panel
+void display_flush_finish() {
+    if (tft.getStartCount() == 0) return;
+    display_wait_dma();
+    tft.endWrite();
+    ui_stats.frame_us = micros() - frame_start_us;
+}
+
+// Called by LVGL after each render with its duration and pixel count
+void my_disp_monitor(lv_disp_drv_t * /* disp */, uint32_t time_ms, uint32_t px) {
+    ui_stats.render_ms = time_ms;
+    ui_stats.render_px = px;
+}
+
 // Create main UI structure
 void create_main_ui() {
     main_screen = lv_scr_act();
@@ -346,557 +391,689 @@ void create_main_ui() {
     lv_obj_set_style_bg_opa(content_area, LV_OPA_0, LV_PART_MAIN);
     lv_obj_set_style_border_opa(content_area, LV_OPA_0, LV_PART_MAIN);
     lv_obj_set_style_pad_all(content_area, 5, LV_PART_MAIN);
+    ui_stats.objects_created += 2;
 }
 
-// Update card content with cool animations and better design
-void update_card_content() {
-    lv_obj_clean(content_area);
-    animation_counter = (animation_counter + 1) % 100;
+// Per-card widgets, created on first display of the card
+lv_obj_t* card_roots[6] = {nullptr};
+
+struct ApCard {
+    lv_obj_t* detail;           // Shown while an AP exists at scroll_pos
+    lv_obj_t* name;
+    SignalBars bars;
+    lv_obj_t* channel;
+    lv_obj_t* sec_box;
+    lv_obj_t* sec_label;
+    lv_obj_t* clients;
+    lv_obj_t* rssi;
+    lv_obj_t* age;
+    lv_obj_t* nav;
+    lv_obj_t* scanning;
+} ap_card;
+
+struct ClientCard {
+    lv_obj_t* detail;
+    lv_obj_t* mac;
+    SignalBars bars;
+    lv_obj_t* vendor_box;
+    lv_obj_t* vendor;
+    lv_obj_t* ap_info;
+    lv_obj_t* details;
+    lv_obj_t* probes;
+    lv_obj_t* nav;
+    lv_obj_t* scanning;
+} client_card;
+
+struct TargetCard {
+    lv_obj_t* found;
+    lv_obj_t* status_box;
+    lv_obj_t* status_text;
+    lv_obj_t* mac;
+    lv_obj_t* signal;
+    lv_obj_t* signal_fill;
+    lv_obj_t* network;
+    lv_obj_t* ip;
+    lv_obj_t* activity;
+    lv_obj_t* searching;
+    lv_obj_t* search_box;
+    lv_obj_t* search_text;
+    lv_obj_t* progress_fill;
+    lv_obj_t* search_stats;
+    lv_obj_t* nav;
+} target_card;
+
+struct SignalMapCard {
+    lv_obj_t* bar[WIFI_CHANNEL_MAX + 1];
+    lv_obj_t* label[WIFI_CHANNEL_MAX + 1];
+    lv_obj_t* current;
+} signal_card;
+
+struct IntelCard {
+    lv_obj_t* overview;
+    lv_obj_t* counts;
+    lv_obj_t* frames;
+    lv_obj_t* rate;
+    lv_obj_t* security;
+    lv_obj_t* arc;
+    lv_obj_t* pct;
+    lv_obj_t* sec_stats;
+} intel_card;
+
+struct SystemCard {
+    lv_obj_t* uptime;
+    lv_obj_t* mem_arc;
+    lv_obj_t* mem_pct;
+    lv_obj_t* mem_heap;         // Internal heap free, low-water mark, largest block
+    lv_obj_t* mem_subsystems;   // Left of the arc: sniffer footprints
+    lv_obj_t* mem_pools;        // Right of the arc: PSRAM and LVGL pool
+    lv_obj_t* queue;
+    lv_obj_t* latency;
+} system_card;
+
+void build_ap_card(lv_obj_t* root) {
+    ApCard& c = ap_card;
+    c.detail = ui_group(root);
     
-    // Update AP-client associations before displaying
-    update_ap_client_associations();
+    // Main AP name - BIG FONT
+    c.name = ui_label(c.detail, 10, 20, 220, COLOR_PRIMARY);
+    lv_obj_set_style_text_font(c.name, &lv_font_montserrat_14, LV_PART_MAIN);
+    lv_label_set_long_mode(c.name, LV_LABEL_LONG_SCROLL_CIRCULAR);
     
-    switch(current_card) {
-        case AP_HOTSPOTS: {
-            lv_label_set_text(title_label, "🔥 ACCESS POINTS");
-            
-            // Single AP per screen
-            int count = 0;
-            bool found_ap = false;
-            
-            for (const auto& kv : ap_registry) {
-                const APInfo& ap = kv.second;
-                if (count < scroll_pos) { count++; continue; }
-                
-                found_ap = true;
-                bool is_active = (millis() - ap.last_seen < 30000);
-                
-                // Main AP name - BIG FONT
-                lv_obj_t* ap_name = lv_label_create(content_area);
-                lv_obj_set_pos(ap_name, 10, 20);
-                lv_obj_set_width(ap_name, 220);
-                lv_label_set_text_fmt(ap_name, "\"%s\"", 
-                                     ap.ssid.length() > 0 ? ap.ssid.c_str() : "Hidden Network");
-                lv_obj_set_style_text_color(ap_name, is_active ? 
-                    lv_color_hex(COLOR_PRIMARY) : lv_color_hex(COLOR_TEXT_DIM), LV_PART_MAIN);
-                lv_obj_set_style_text_font(ap_name, &lv_font_montserrat_14, LV_PART_MAIN);
-                lv_label_set_long_mode(ap_name, LV_LABEL_LONG_SCROLL_CIRCULAR);
-                
-                // Signal strength bars
-                create_signal_bars(content_area, 180, 65, ap.rssi);
-                
-                // Channel indicator with animation
-                lv_obj_t* channel_box = lv_obj_create(content_area);
-                lv_obj_set_size(channel_box, 40, 30);
-                lv_obj_set_pos(channel_box, 10, 60);
-                lv_obj_set_style_bg_color(channel_box, lv_color_hex(COLOR_SECONDARY), LV_PART_MAIN);
-                lv_obj_set_style_radius(channel_box, 8, LV_PART_MAIN);
-                lv_obj_set_style_border_width(channel_box, 0, LV_PART_MAIN);
-                
-                lv_obj_t* ch_label = lv_label_create(channel_box);
-                lv_obj_center(ch_label);
-                lv_label_set_text_fmt(ch_label, "CH%d", ap.channel);
-                lv_obj_set_style_text_color(ch_label, lv_color_hex(COLOR_TEXT_BRIGHT), LV_PART_MAIN);
-                
-                // Security badge
-                lv_obj_t* sec_box = lv_obj_create(content_area);
-                lv_obj_set_size(sec_box, 80, 30);
-                lv_obj_set_pos(sec_box, 60, 60);
-                lv_color_t sec_color = ap.security == "Open" ? 
-                    lv_color_hex(COLOR_DANGER) : lv_color_hex(COLOR_PRIMARY);
-                lv_obj_set_style_bg_color(sec_box, sec_color, LV_PART_MAIN);
-                lv_obj_set_style_radius(sec_box, 8, LV_PART_MAIN);
-                lv_obj_set_style_border_width(sec_box, 0, LV_PART_MAIN);
-                
-                lv_obj_t* sec_label = lv_label_create(sec_box);
-                lv_obj_center(sec_label);
-                lv_label_set_text(sec_label, ap.security.c_str());
-                lv_obj_set_style_text_color(sec_label, lv_color_hex(COLOR_TEXT_BRIGHT), LV_PART_MAIN);
-                
-                // Client count with animated icon
-                lv_obj_t* client_info = lv_label_create(content_area);
-                lv_obj_set_pos(client_info, 10, 110);
-                float pulse = sin(animation_counter * 0.1) * 0.3 + 0.7;
-                lv_label_set_text_fmt(client_info, "Devices: %d", ap.client_count);
-                lv_obj_set_style_text_color(client_info, lv_color_hex((int)(COLOR_ACCENT * pulse)), LV_PART_MAIN);
-                lv_obj_set_style_text_font(client_info, &lv_font_montserrat_14, LV_PART_MAIN);
-                
-                // RSSI value
-                lv_obj_t* rssi_label = lv_label_create(content_area);
-                lv_obj_set_pos(rssi_label, 10, 140);
-                lv_label_set_text_fmt(rssi_label, "Signal: %d dBm", ap.rssi);
-                lv_obj_set_style_text_color(rssi_label, lv_color_hex(COLOR_TEXT_DIM), LV_PART_MAIN);
-                
-                // Age indicator
-                char age_str[20];
-                int age_sec = (millis() - ap.last_seen) / 1000;
-                if (age_sec < 60) sprintf(age_str, "Active %ds ago", age_sec);
-                else sprintf(age_str, "Active %dm ago", age_sec/60);
-                
-                lv_obj_t* age_label = lv_label_create(content_area);
-                lv_obj_set_pos(age_label, 10, 165);
-                lv_label_set_text(age_label, age_str);
-                lv_obj_set_style_text_color(age_label, lv_color_hex(COLOR_TEXT_DIM), LV_PART_MAIN);
-                
-                // Navigation indicator
-                lv_obj_t* nav_label = lv_label_create(content_area);
-                lv_obj_set_pos(nav_label, 150, 200);
-                lv_label_set_text_fmt(nav_label, "%d/%d", scroll_pos + 1, ap_registry.size());
-                lv_obj_set_style_text_color(nav_label, lv_color_hex(COLOR_TEXT_DIM), LV_PART_MAIN);
-                
-                break;
-            }
-            
-            if (!found_ap) {
-                lv_obj_t* scanning = lv_label_create(content_area);
-                lv_obj_set_pos(scanning, 10, 60);
-                lv_obj_set_width(scanning, 220);
-                float pulse = sin(animation_counter * 0.2) * 0.5 + 0.5;
-                lv_label_set_text_fmt(scanning, "SCANNING...\n\nChannel: %d\nAPs found: %d", 
-                                     current_channel, ap_registry.size());
-                lv_obj_set_style_text_color(scanning, lv_color_hex((int)(COLOR_WARNING * pulse)), LV_PART_MAIN);
-                lv_obj_set_style_text_font(scanning, &lv_font_montserrat_14, LV_PART_MAIN);
-                lv_obj_set_style_text_align(scanning, LV_TEXT_ALIGN_CENTER, LV_PART_MAIN);
-            }
-            break;
+    create_signal_bars(&c.bars, c.detail, 180, 65);
+    
+    // Channel indicator
+    lv_obj_t* channel_box = ui_box(c.detail, 10, 60, 40, 30, COLOR_SECONDARY, 8);
+    c.channel = ui_label(channel_box, 0, 0, 0, COLOR_TEXT_BRIGHT);
+    lv_obj_center(c.channel);
+    
+    // Security badge
+    c.sec_box = ui_box(c.detail, 60, 60, 80, 30, COLOR_PRIMARY, 8);
+    c.sec_label = ui_label(c.sec_box, 0, 0, 0, COLOR_TEXT_BRIGHT);
+    lv_obj_center(c.sec_label);
+    
+    c.clients = ui_label(c.detail, 10, 110, 0, COLOR_ACCENT);
+    lv_obj_set_style_text_font(c.clients, &lv_font_montserrat_14, LV_PART_MAIN);
+    c.rssi = ui_label(c.detail, 10, 140, 0, COLOR_TEXT_DIM);
+    c.age = ui_label(c.detail, 10, 165, 0, COLOR_TEXT_DIM);
+    c.nav = ui_label(c.detail, 150, 200, 0, COLOR_TEXT_DIM);
+    
+    c.scanning = ui_label(root, 10, 60, 220, COLOR_WARNING);
+    lv_obj_set_style_text_font(c.scanning, &lv_font_montserrat_14, LV_PART_MAIN);
+    lv_obj_set_style_text_align(c.scanning, LV_TEXT_ALIGN_CENTER, LV_PART_MAIN);
+}
+
+void update_ap_card() {
+    ApCard& c = ap_card;
+    
+    // Single AP per screen
+    const APInfo* ap = nullptr;
+    int count = 0;
+    for (const auto& e : ap_registry) {
+        if (count++ == scroll_pos) { ap = &e.value; break; }
+    }
+    ui_set_hidden(c.detail, ap == nullptr);
+    ui_set_hidden(c.scanning, ap != nullptr);
+    
+    if (ap == nullptr) {
+        float pulse = sin(animation_counter * 0.2) * 0.5 + 0.5;
+        ui_set_text(c.scanning, "SCANNING...\n\nChannel: %d\nAPs found: %d", 
+                    ui_status.current_channel, (int)ap_registry.size());
+        ui_set_text_color(c.scanning, lv_color_hex((int)(COLOR_WARNING * pulse)));
+        return;
+    }
+    
+    bool is_active = (millis() - ap->last_seen < 30000);
+    ui_set_text(c.name, "\"%s\"", ap->ssid[0] ? ap->ssid : "Hidden Network");
+    ui_set_text_color(c.name, is_active ? lv_color_hex(COLOR_PRIMARY) : lv_color_hex(COLOR_TEXT_DIM));
+    
+    update_signal_bars(&c.bars, ap->rssi);
+    ui_set_text(c.channel, "CH%d", ap->channel);
+    
+    ui_set_bg_color(c.sec_box, security_is_open(ap->security) ? 
+                    lv_color_hex(COLOR_DANGER) : lv_color_hex(COLOR_PRIMARY));
+    ui_set_text(c.sec_label, "%s", security_label(ap->security));
+    
+    // Client count with animated color
+    float pulse = sin(animation_counter * 0.1) * 0.3 + 0.7;
+    ui_set_text(c.clients, "Devices: %d", ap->client_count);
+    ui_set_text_color(c.clients, lv_color_hex((int)(COLOR_ACCENT * pulse)));
+    
+    ui_set_text(c.rssi, "Signal: %d dBm", ap->rssi);
+    
+    char age_str[24];
+    format_age(age_str, sizeof(age_str), ap->last_seen, "Active ");
+    ui_set_text(c.age, "%s", age_str);
+    
+    ui_set_text(c.nav, "%d/%d", scroll_pos + 1, (int)ap_registry.size());
+}
+
+void build_client_card(lv_obj_t* root) {
+    ClientCard& c = client_card;
+    c.detail = ui_group(root);
+    
+    // Device MAC - BIG FONT
+    c.mac = ui_label(c.detail, 10, 20, 220, COLOR_SECONDARY);
+    lv_obj_set_style_text_font(c.mac, &lv_font_montserrat_14, LV_PART_MAIN);
+    lv_obj_set_style_text_align(c.mac, LV_TEXT_ALIGN_CENTER, LV_PART_MAIN);
+    
+    create_signal_bars(&c.bars, c.detail, 90, 75);
+    
+    // Vendor badge
+    c.vendor_box = ui_box(c.detail, 65, 85, 100, 35, COLOR_ACCENT, 10);
+    c.vendor = ui_label(c.vendor_box, 0, 0, 0, COLOR_TEXT_BRIGHT);
+    lv_obj_center(c.vendor);
+    
+    c.ap_info = ui_label(c.detail, 10, 135, 220, COLOR_PRIMARY);
+    lv_obj_set_style_text_font(c.ap_info, &lv_font_montserrat_14, LV_PART_MAIN);
+    lv_label_set_long_mode(c.ap_info, LV_LABEL_LONG_SCROLL_CIRCULAR);
+    
+    c.details = ui_label(c.detail, 10, 165, 0, COLOR_TEXT_DIM);
+    c.probes = ui_label(c.detail, 10, 182, 220, COLOR_TEXT_DIM);
+    lv_label_set_long_mode(c.probes, LV_LABEL_LONG_SCROLL_CIRCULAR);
+    c.nav = ui_label(c.detail, 150, 200, 0, COLOR_TEXT_DIM);
+    
+    c.scanning = ui_label(root, 10, 60, 220, COLOR_SECONDARY);
+    lv_obj_set_style_text_font(c.scanning, &lv_font_montserrat_14, LV_PART_MAIN);
+    lv_obj_set_style_text_align(c.scanning, LV_TEXT_ALIGN_CENTER, LV_PART_MAIN);
+}
+
+void update_client_card() {
+    ClientCard& c = client_card;
+    
+    // Single client per screen
+    const ClientInfo* client = nullptr;
+    int count = 0;
+    for (const auto& e : client_registry) {
+        if (count++ == scroll_pos) { client = &e.value; break; }
+    }
+    ui_set_hidden(c.detail, client == nullptr);
+    ui_set_hidden(c.scanning, client != nullptr);
+    
+    if (client == nullptr) {
+        float pulse = sin(animation_counter * 0.2) * 0.5 + 0.5;
+        ui_set_text(c.scanning, "DETECTING...\n\nDevices found: %d\nListening for probes", 
+                    (int)client_registry.size());
+        ui_set_text_color(c.scanning, lv_color_hex((int)(COLOR_SECONDARY * pulse)));
+        return;
+    }
+    
+    bool is_active = (millis() - client->last_seen < 20000);
+    char mac_str[18];
+    client->mac.format(mac_str);
+    ui_set_text(c.mac, "%s", mac_str + 9);
+    ui_set_text_color(c.mac, is_active ? lv_color_hex(COLOR_SECONDARY) : lv_color_hex(COLOR_TEXT_DIM));
+    
+    int rssi = client->rssi_track.empty() ? client->rssi : client->rssi_track.smoothed();
+    update_signal_bars(&c.bars, rssi);
+    
+    const char* vendor = client->vendor ? client->vendor : VENDOR_UNKNOWN;
+    lv_color_t vendor_color;
+    if (strcmp(vendor, "Apple") == 0) vendor_color = lv_color_hex(0x666666);
+    else if (strcmp(vendor, "Samsung") == 0) vendor_color = lv_color_hex(0x1f4788);
+    else if (strcmp(vendor, "RaspPi") == 0) vendor_color = lv_color_hex(0x8cc04b);
+    else if (strcmp(vendor, VENDOR_RANDOM) == 0) vendor_color = lv_color_hex(0x444444);
+    else vendor_color = lv_color_hex(COLOR_ACCENT);
+    ui_set_bg_color(c.vendor_box, vendor_color);
+    ui_set_text(c.vendor, "%s", vendor);
+    
+    // Connected AP
+    const char* ap_name = "Scanning...";
+    const APInfo* connected_ap = ap_registry.find(client->connected_ap.value);
+    if (connected_ap != nullptr) {
+        ap_name = connected_ap->ssid[0] ? connected_ap->ssid : "Hidden AP";
+    }
+    ui_set_text(c.ap_info, "Connected: %s", ap_name);
+    
+    char age_str[20];
+    format_age(age_str, sizeof(age_str), client->last_seen, "");
+    ui_set_text(c.details, "%d dBm • %s • retry %d%%", rssi, age_str,
+                retry_pct(client->retry_count, client->frame_count + client->duplicate_count));
+    
+    // Networks the device asked for by name
+    char probes[96] = "";
+    size_t used = 0;
+    for (int i = 0; i < client->probe_count && used < sizeof(probes); i++) {
+        used += snprintf(probes + used, sizeof(probes) - used, "%s%s", i ? ", " : "Probes: ", client->probed[i]);
+    }
+    ui_set_text(c.probes, "%s", probes);
+    
+    ui_set_text(c.nav, "%d/%d", scroll_pos + 1, (int)client_registry.size());
+}
+
+void build_target_card(lv_obj_t* root) {
+    TargetCard& c = target_card;
+    
+    // Target acquired page
+    c.found = ui_group(root);
+    c.status_box = ui_box(c.found, 10, 20, 220, 40, COLOR_PRIMARY, 10);
+    c.status_text = ui_label(c.status_box, 0, 0, 0, COLOR_TEXT_BRIGHT);
+    lv_obj_center(c.status_text);
+    lv_obj_set_style_text_font(c.status_text, &lv_font_montserrat_14, LV_PART_MAIN);
+    
+    c.mac = ui_label(c.found, 10, 75, 220, COLOR_SECONDARY);
+    lv_obj_set_style_text_font(c.mac, &lv_font_montserrat_14, LV_PART_MAIN);
+    lv_obj_set_style_text_align(c.mac, LV_TEXT_ALIGN_CENTER, LV_PART_MAIN);
+    
+    // Signal strength with visual bar
+    c.signal = ui_label(c.found, 10, 100, 0, COLOR_TEXT_BRIGHT);
+    ui_box(c.found, 120, 105, 180, 8, 0x333333, 4);
+    c.signal_fill = ui_box(c.found, 120, 105, 0, 8, COLOR_DANGER, 4);
+    
+    c.network = ui_label(c.found, 10, 125, 220, COLOR_ACCENT);
+    lv_obj_set_style_text_align(c.network, LV_TEXT_ALIGN_CENTER, LV_PART_MAIN);
+    c.ip = ui_label(c.found, 10, 145, 220, COLOR_SECONDARY);
+    lv_obj_set_style_text_align(c.ip, LV_TEXT_ALIGN_CENTER, LV_PART_MAIN);
+    
+    // Activity counters
+    lv_obj_t* activity_box = ui_box(c.found, 10, 170, 220, 30, 0x2a2a2a, 8);
+    c.activity = ui_label(activity_box, 0, 0, 0, COLOR_TEXT_DIM);
+    lv_obj_center(c.activity);
+    
+    // Searching page
+    c.searching = ui_group(root);
+    c.search_box = ui_box(c.searching, 10, 60, 220, 80, COLOR_WARNING, 15);
+    c.search_text = ui_label(c.search_box, 0, 0, 0, COLOR_TEXT_BRIGHT);
+    lv_obj_center(c.search_text);
+    lv_obj_set_style_text_font(c.search_text, &lv_font_montserrat_14, LV_PART_MAIN);
+    lv_obj_set_style_text_align(c.search_text, LV_TEXT_ALIGN_CENTER, LV_PART_MAIN);
+    
+    ui_box(c.searching, 20, 160, 200, 10, 0x333333, 5);
+    c.progress_fill = ui_box(c.searching, 20, 160, 0, 10, COLOR_WARNING, 5);
+    
+    c.search_stats = ui_label(c.searching, 10, 185, 220, COLOR_TEXT_DIM);
+    lv_obj_set_style_text_align(c.search_stats, LV_TEXT_ALIGN_CENTER, LV_PART_MAIN);
+    
+    // Which watched target is shown; the scroll button pages through them
+    c.nav = ui_label(root, 150, 205, 0, COLOR_TEXT_DIM);
+}
+
+// Newest history record for the device a target last matched, looking back
+// at most TARGET_CARD_LOOKBACK frames
+#define TARGET_CARD_LOOKBACK 64
+bool last_target_packet(const WatchTarget& t, TargetPacket* out) {
+    uint8_t mac[6];
+    t.last_mac.to_bytes(mac);
+    HistoryRing<TargetPacket>::Snapshot snap = target_history.snapshot();
+    for (uint32_t seq = snap.end; seq != snap.begin && snap.end - seq < TARGET_CARD_LOOKBACK;) {
+        const TargetPacket* p = target_history.at(--seq);
+        if (p != nullptr && memcmp(p->mac, mac, 6) == 0) {
+            *out = *p;
+            return true;
+        }
+    }
+    return false;
+}
+
+void update_target_card() {
+    TargetCard& c = target_card;
+    int count = (int)watchlist.size();
+    int shown = count > 0 ? scroll_pos % count : 0;
+    const WatchTarget* t = count > 0 ? &watchlist.at(shown) : nullptr;
+    bool found = t != nullptr && t->found;
+    ui_set_hidden(c.found, !found);
+    ui_set_hidden(c.searching, found);
+    if (count > 0) ui_set_text(c.nav, "%d/%d", shown + 1, count);
+    else ui_set_text(c.nav, "");
+    
+    if (found) {
+        // Smoothed level and trend: the banner says whether walking this way helps
+        RssiReading r;
+        t->rssi_track.read(&r);
+        float pulse = sin(animation_counter * 0.3) * 0.3 + 0.7;
+        int banner = r.trend == RSSI_APPROACHING ? COLOR_PRIMARY : r.trend == RSSI_RECEDING ? COLOR_DANGER : COLOR_SECONDARY;
+        ui_set_bg_color(c.status_box, lv_color_hex((int)(banner * pulse)));
+        if (r.trend == RSSI_APPROACHING) {
+            ui_set_text(c.status_text, LV_SYMBOL_UP " CLOSER %+.1f dB/s", r.slope);
+        } else if (r.trend == RSSI_RECEDING) {
+            ui_set_text(c.status_text, LV_SYMBOL_DOWN " FARTHER %+.1f dB/s", r.slope);
+        } else {
+            ui_set_text(c.status_text, "TARGET ACQUIRED");
         }
         
-        case CLIENT_ANALYSIS: {
-            lv_label_set_text(title_label, "📱 DEVICES");
-            
-            // Single client per screen
-            int count = 0;
-            bool found_client = false;
-            
-            for (const auto& kv : client_registry) {
-                const ClientInfo& client = kv.second;
-                if (count < scroll_pos) { count++; continue; }
-                
-                found_client = true;
-                bool is_active = (millis() - client.last_seen < 20000);
-                
-                // Device MAC - BIG FONT
-                lv_obj_t* mac_label = lv_label_create(content_area);
-                lv_obj_set_pos(mac_label, 10, 20);
-                lv_obj_set_width(mac_label, 220);
-                lv_label_set_text_fmt(mac_label, "%s", client.mac.substring(9).c_str());
-                lv_obj_set_style_text_color(mac_label, is_active ? 
-                    lv_color_hex(COLOR_SECONDARY) : lv_color_hex(COLOR_TEXT_DIM), LV_PART_MAIN);
-                lv_obj_set_style_text_font(mac_label, &lv_font_montserrat_14, LV_PART_MAIN);
-                lv_obj_set_style_text_align(mac_label, LV_TEXT_ALIGN_CENTER, LV_PART_MAIN);
-                
-                // Signal strength bars
-                create_signal_bars(content_area, 90, 75, client.rssi);
-                
-                // Vendor badge
-                lv_obj_t* vendor_box = lv_obj_create(content_area);
-                lv_obj_set_size(vendor_box, 100, 35);
-                lv_obj_set_pos(vendor_box, 65, 85);
-                lv_color_t vendor_color;
-                if (client.vendor == "Apple") vendor_color = lv_color_hex(0x666666);
-                else if (client.vendor == "Samsung") vendor_color = lv_color_hex(0x1f4788);
-                else if (client.vendor == "RaspPi") vendor_color = lv_color_hex(0x8cc04b);
-                else vendor_color = lv_color_hex(COLOR_ACCENT);
-                
-                lv_obj_set_style_bg_color(vendor_box, vendor_color, LV_PART_MAIN);
-                lv_obj_set_style_radius(vendor_box, 10, LV_PART_MAIN);
-                lv_obj_set_style_border_width(vendor_box, 0, LV_PART_MAIN);
-                
-                lv_obj_t* vendor_label = lv_label_create(vendor_box);
-                lv_obj_center(vendor_label);
-                lv_label_set_text(vendor_label, client.vendor.c_str());
-                lv_obj_set_style_text_color(vendor_label, lv_color_hex(COLOR_TEXT_BRIGHT), LV_PART_MAIN);
-                
-                // Connected AP
-                String ap_name = "Scanning...";
-                String closest_ap = find_closest_ap(client.mac, client.rssi, client.last_seen);
-                if (closest_ap.length() > 0 && ap_registry.find(closest_ap) != ap_registry.end()) {
-                    ap_name = ap_registry[closest_ap].ssid;
-                    if (ap_name.length() == 0) ap_name = "Hidden AP";
-                }
-                
-                lv_obj_t* ap_info = lv_label_create(content_area);
-                lv_obj_set_pos(ap_info, 10, 135);
-                lv_obj_set_width(ap_info, 220);
-                lv_label_set_text_fmt(ap_info, "Connected: %s", ap_name.c_str());
-                lv_obj_set_style_text_color(ap_info, lv_color_hex(COLOR_PRIMARY), LV_PART_MAIN);
-                lv_obj_set_style_text_font(ap_info, &lv_font_montserrat_14, LV_PART_MAIN);
-                lv_label_set_long_mode(ap_info, LV_LABEL_LONG_SCROLL_CIRCULAR);
-                
-                // RSSI and age
-                char age_str[20];
-                int age_sec = (millis() - client.last_seen) / 1000;
-                if (age_sec < 60) sprintf(age_str, "%ds ago", age_sec);
-                else sprintf(age_str, "%dm ago", age_sec/60);
-                
-                lv_obj_t* details = lv_label_create(content_area);
-                lv_obj_set_pos(details, 10, 165);
-                lv_label_set_text_fmt(details, "%d dBm • %s", client.rssi, age_str);
-                lv_obj_set_style_text_color(details, lv_color_hex(COLOR_TEXT_DIM), LV_PART_MAIN);
-                
-                // Navigation indicator
-                lv_obj_t* nav_label = lv_label_create(content_area);
-                lv_obj_set_pos(nav_label, 150, 200);
-                lv_label_set_text_fmt(nav_label, "%d/%d", scroll_pos + 1, client_registry.size());
-                lv_obj_set_style_text_color(nav_label, lv_color_hex(COLOR_TEXT_DIM), LV_PART_MAIN);
-                
-                break;
-            }
-            
-            if (!found_client) {
-                lv_obj_t* scanning = lv_label_create(content_area);
-                lv_obj_set_pos(scanning, 10, 60);
-                lv_obj_set_width(scanning, 220);
-                float pulse = sin(animation_counter * 0.2) * 0.5 + 0.5;
-                lv_label_set_text_fmt(scanning, "DETECTING...\n\nDevices found: %d\nListening for probes", 
-                                     client_registry.size());
-                lv_obj_set_style_text_color(scanning, lv_color_hex((int)(COLOR_SECONDARY * pulse)), LV_PART_MAIN);
-                lv_obj_set_style_text_font(scanning, &lv_font_montserrat_14, LV_PART_MAIN);
-                lv_obj_set_style_text_align(scanning, LV_TEXT_ALIGN_CENTER, LV_PART_MAIN);
-            }
-            break;
+        // For a prefix target this is the device that matched
+        char mac_str[18];
+        t->last_mac.format(mac_str);
+        ui_set_text(c.mac, "%s", mac_str);
+        int rssi = (int)lroundf(r.smoothed);
+        if (t->rssi_track.empty()) {
+            ui_set_text(c.signal, "Signal: -- dBm");
+        } else {
+            ui_set_text(c.signal, "%d dBm +/-%d", rssi, (int)lroundf(sqrtf(r.variance)));
         }
         
-        case TARGET_HUNT: {
-            lv_label_set_text(title_label, "🎯 TARGET HUNT");
-            
-            // Single clean page with all target info
-            if (target_found) {
-                // Status box at top
-                lv_obj_t* status_box = lv_obj_create(content_area);
-                lv_obj_set_size(status_box, 220, 40);
-                lv_obj_set_pos(status_box, 10, 20);
-                float pulse = sin(animation_counter * 0.3) * 0.3 + 0.7;
-                lv_obj_set_style_bg_color(status_box, lv_color_hex((int)(COLOR_PRIMARY * pulse)), LV_PART_MAIN);
-                lv_obj_set_style_radius(status_box, 10, LV_PART_MAIN);
-                lv_obj_set_style_border_width(status_box, 0, LV_PART_MAIN);
-                
-                lv_obj_t* status_text = lv_label_create(status_box);
-                lv_obj_center(status_text);
-                lv_label_set_text(status_text, "TARGET ACQUIRED");
-                lv_obj_set_style_text_color(status_text, lv_color_hex(COLOR_TEXT_BRIGHT), LV_PART_MAIN);
-                lv_obj_set_style_text_font(status_text, &lv_font_montserrat_14, LV_PART_MAIN);
-                
-                // MAC address
-                lv_obj_t* mac_info = lv_label_create(content_area);
-                lv_obj_set_pos(mac_info, 10, 75);
-                lv_obj_set_width(mac_info, 220);
-                lv_label_set_text_fmt(mac_info, "MAC: %s", String(TARGET_PHONE).substring(9).c_str());
-                lv_obj_set_style_text_color(mac_info, lv_color_hex(COLOR_SECONDARY), LV_PART_MAIN);
-                lv_obj_set_style_text_font(mac_info, &lv_font_montserrat_14, LV_PART_MAIN);
-                lv_obj_set_style_text_align(mac_info, LV_TEXT_ALIGN_CENTER, LV_PART_MAIN);
-                
-                // Signal strength with visual bar
-                lv_obj_t* signal_label = lv_label_create(content_area);
-                lv_obj_set_pos(signal_label, 10, 100);
-                lv_label_set_text_fmt(signal_label, "Signal: %d dBm", target_rssi);
-                lv_obj_set_style_text_color(signal_label, lv_color_hex(COLOR_TEXT_BRIGHT), LV_PART_MAIN);
-                
-                // Signal strength bar
-                lv_obj_t* signal_bg = lv_obj_create(content_area);
-                lv_obj_set_size(signal_bg, 180, 8);
-                lv_obj_set_pos(signal_bg, 120, 105);
-                lv_obj_set_style_bg_color(signal_bg, lv_color_hex(0x333333), LV_PART_MAIN);
-                lv_obj_set_style_radius(signal_bg, 4, LV_PART_MAIN);
-                lv_obj_set_style_border_width(signal_bg, 0, LV_PART_MAIN);
-                
-                int signal_width = (target_rssi + 100) * 180 / 100;
-                if (signal_width < 0) signal_width = 0;
-                if (signal_width > 180) signal_width = 180;
-                
-                lv_obj_t* signal_fill = lv_obj_create(content_area);
-                lv_obj_set_size(signal_fill, signal_width, 8);
-                lv_obj_set_pos(signal_fill, 120, 105);
-                lv_color_t signal_color = signal_width > 120 ? lv_color_hex(COLOR_PRIMARY) :
-                                         signal_width > 60 ? lv_color_hex(COLOR_WARNING) : lv_color_hex(COLOR_DANGER);
-                lv_obj_set_style_bg_color(signal_fill, signal_color, LV_PART_MAIN);
-                lv_obj_set_style_radius(signal_fill, 4, LV_PART_MAIN);
-                lv_obj_set_style_border_width(signal_fill, 0, LV_PART_MAIN);
-                
-                // Network info
-                lv_obj_t* network_info = lv_label_create(content_area);
-                lv_obj_set_pos(network_info, 10, 125);
-                lv_obj_set_width(network_info, 220);
-                String network_text = target_ssid.length() > 0 ? target_ssid : "Unknown Network";
-                lv_label_set_text_fmt(network_info, "Network: %s", network_text.c_str());
-                lv_obj_set_style_text_color(network_info, lv_color_hex(COLOR_ACCENT), LV_PART_MAIN);
-                lv_obj_set_style_text_align(network_info, LV_TEXT_ALIGN_CENTER, LV_PART_MAIN);
-                
-                // IP address
-                lv_obj_t* ip_info = lv_label_create(content_area);
-                lv_obj_set_pos(ip_info, 10, 145);
-                lv_obj_set_width(ip_info, 220);
-                lv_label_set_text_fmt(ip_info, "IP: %s", target_ip.c_str());
-                lv_obj_set_style_text_color(ip_info, lv_color_hex(COLOR_SECONDARY), LV_PART_MAIN);
-                lv_obj_set_style_text_align(ip_info, LV_TEXT_ALIGN_CENTER, LV_PART_MAIN);
-                
-                // Activity counters
-                lv_obj_t* activity_box = lv_obj_create(content_area);
-                lv_obj_set_size(activity_box, 220, 30);
-                lv_obj_set_pos(activity_box, 10, 170);
-                lv_obj_set_style_bg_color(activity_box, lv_color_hex(0x2a2a2a), LV_PART_MAIN);
-                lv_obj_set_style_radius(activity_box, 8, LV_PART_MAIN);
-                lv_obj_set_style_border_width(activity_box, 0, LV_PART_MAIN);
-                
-                lv_obj_t* activity_text = lv_label_create(activity_box);
-                lv_obj_center(activity_text);
-                char age_str[10];
-                int age_sec = (millis() - target_last_seen) / 1000;
-                if (age_sec < 60) sprintf(age_str, "%ds ago", age_sec);
-                else sprintf(age_str, "%dm ago", age_sec/60);
-                lv_label_set_text_fmt(activity_text, "TX: %d | RX: %d | Last: %s", 
-                                     target_tx_packets, target_rx_packets, age_str);
-                lv_obj_set_style_text_color(activity_text, lv_color_hex(COLOR_TEXT_DIM), LV_PART_MAIN);
-                
-            } else {
-                // Not found - clean searching display
-                lv_obj_t* search_box = lv_obj_create(content_area);
-                lv_obj_set_size(search_box, 220, 80);
-                lv_obj_set_pos(search_box, 10, 60);
-                float pulse = sin(animation_counter * 0.4) * 0.5 + 0.5;
-                lv_obj_set_style_bg_color(search_box, lv_color_hex((int)(COLOR_WARNING * pulse)), LV_PART_MAIN);
-                lv_obj_set_style_radius(search_box, 15, LV_PART_MAIN);
-                lv_obj_set_style_border_width(search_box, 0, LV_PART_MAIN);
-                
-                lv_obj_t* search_text = lv_label_create(search_box);
-                lv_obj_center(search_text);
-                lv_label_set_text_fmt(search_text, "SCANNING...\n\nChannel: %d\nTargeting: %s", 
-                                     current_channel, String(TARGET_PHONE).substring(9).c_str());
-                lv_obj_set_style_text_color(search_text, lv_color_hex(COLOR_TEXT_BRIGHT), LV_PART_MAIN);
-                lv_obj_set_style_text_font(search_text, &lv_font_montserrat_14, LV_PART_MAIN);
-                lv_obj_set_style_text_align(search_text, LV_TEXT_ALIGN_CENTER, LV_PART_MAIN);
-                
-                // Scanning progress bar
-                lv_obj_t* progress_bg = lv_obj_create(content_area);
-                lv_obj_set_size(progress_bg, 200, 10);
-                lv_obj_set_pos(progress_bg, 20, 160);
-                lv_obj_set_style_bg_color(progress_bg, lv_color_hex(0x333333), LV_PART_MAIN);
-                lv_obj_set_style_radius(progress_bg, 5, LV_PART_MAIN);
-                lv_obj_set_style_border_width(progress_bg, 0, LV_PART_MAIN);
-                
-                int progress_width = ((animation_counter * 4) % 200);
-                lv_obj_t* progress_fill = lv_obj_create(content_area);
-                lv_obj_set_size(progress_fill, progress_width, 10);
-                lv_obj_set_pos(progress_fill, 20, 160);
-                lv_obj_set_style_bg_color(progress_fill, lv_color_hex(COLOR_WARNING), LV_PART_MAIN);
-                lv_obj_set_style_radius(progress_fill, 5, LV_PART_MAIN);
-                lv_obj_set_style_border_width(progress_fill, 0, LV_PART_MAIN);
-                
-                // Search stats
-                lv_obj_t* stats_text = lv_label_create(content_area);
-                lv_obj_set_pos(stats_text, 10, 185);
-                lv_obj_set_width(stats_text, 220);
-                lv_label_set_text_fmt(stats_text, "Packets seen: TX %d | RX %d", target_tx_packets, target_rx_packets);
-                lv_obj_set_style_text_color(stats_text, lv_color_hex(COLOR_TEXT_DIM), LV_PART_MAIN);
-                lv_obj_set_style_text_align(stats_text, LV_TEXT_ALIGN_CENTER, LV_PART_MAIN);
-            }
-            break;
+        int signal_width = t->rssi_track.empty() ? 0 : (rssi + 100) * 180 / 100;
+        if (signal_width < 0) signal_width = 0;
+        if (signal_width > 180) signal_width = 180;
+        ui_set_geometry(c.signal_fill, 120, 105, signal_width, 8);
+        ui_set_bg_color(c.signal_fill, signal_width > 120 ? lv_color_hex(COLOR_PRIMARY) :
+                        signal_width > 60 ? lv_color_hex(COLOR_WARNING) : lv_color_hex(COLOR_DANGER));
+        
+        ui_set_text(c.network, "Network: %s", t->ssid[0] ? t->ssid : "Unknown Network");
+        ui_set_text(c.ip, "IP: %s", t->ip[0] ? t->ip : "Scanning...");
+        
+        char age_str[12];
+        format_age(age_str, sizeof(age_str), t->last_seen, "");
+        TargetPacket last;
+        if (last_target_packet(*t, &last)) {
+            ui_set_text(c.activity, "TX: %u | RX: %u | %s %s %s", t->tx_packets, t->rx_packets,
+                        (last.flags & TARGET_PACKET_TX) ? "TX" : "RX", target_frame_name(last.type), age_str);
+        } else {
+            ui_set_text(c.activity, "TX: %u | RX: %u | Last: %s", 
+                        t->tx_packets, t->rx_packets, age_str);
         }
+    } else {
+        float pulse = sin(animation_counter * 0.4) * 0.5 + 0.5;
+        ui_set_bg_color(c.search_box, lv_color_hex((int)(COLOR_WARNING * pulse)));
+        ui_set_geometry(c.progress_fill, 20, 160, (animation_counter * 4) % 200, 10);
+        if (t == nullptr) {
+            ui_set_text(c.search_text, "NO TARGETS\n\nwatch add <mac>");
+            ui_set_text(c.search_stats, "");
+            return;
+        }
+        char key_str[18];
+        Watchlist::format(t->key, t->prefix, key_str);
+        ui_set_text(c.search_text, "SCANNING...\n\nChannel: %d\nTargeting: %s", 
+                    ui_status.current_channel, key_str);
+        ui_set_text(c.search_stats, "Packets seen: TX %u | RX %u", t->tx_packets, t->rx_packets);
+    }
+}
+
+// Channel graph layout
+#define GRAPH_BAR_WIDTH 15
+#define GRAPH_BAR_SPACING 2
+#define GRAPH_START_X 15
+#define GRAPH_MAX_HEIGHT 100
+
+void build_signal_card(lv_obj_t* root) {
+    SignalMapCard& c = signal_card;
+    
+    lv_obj_t* graph_title = ui_label(root, 10, 25, 0, COLOR_SECONDARY);
+    lv_label_set_text_fmt(graph_title, "Frames / %ds, color = SNR:", SIGNAL_WINDOW_MS / 1000);
+    lv_obj_set_style_text_font(graph_title, &lv_font_montserrat_14, LV_PART_MAIN);
+    
+    // Graph background
+    lv_obj_t* graph_bg = ui_box(root, 10, 50, 220, 120, 0x1a1a1a, 8);
+    lv_obj_set_style_border_width(graph_bg, 1, LV_PART_MAIN);
+    lv_obj_set_style_border_color(graph_bg, lv_color_hex(0x444444), LV_PART_MAIN);
+    
+    // One bar per channel; only heights and colors change afterwards
+    for (int ch = 1; ch <= WIFI_CHANNEL_MAX; ch++) {
+        int x_pos = GRAPH_START_X + (ch - 1) * (GRAPH_BAR_WIDTH + GRAPH_BAR_SPACING);
+        ui_box(graph_bg, x_pos - 10, 110 - GRAPH_MAX_HEIGHT, GRAPH_BAR_WIDTH, GRAPH_MAX_HEIGHT, 0x333333, 2);
+        c.bar[ch] = ui_box(graph_bg, x_pos - 10, 110, GRAPH_BAR_WIDTH, 0, COLOR_SECONDARY, 2);
+        lv_obj_add_flag(c.bar[ch], LV_OBJ_FLAG_HIDDEN);
         
-        case SIGNAL_MAP: {
-            lv_label_set_text(title_label, "📊 SIGNAL MAP");
-            
-            // Channel activity graph
-            lv_obj_t* graph_title = lv_label_create(content_area);
-            lv_obj_set_pos(graph_title, 10, 25);
-            lv_label_set_text(graph_title, "Channel Activity:");
-            lv_obj_set_style_text_color(graph_title, lv_color_hex(COLOR_SECONDARY), LV_PART_MAIN);
-            lv_obj_set_style_text_font(graph_title, &lv_font_montserrat_14, LV_PART_MAIN);
-            
-            // Graph background
-            lv_obj_t* graph_bg = lv_obj_create(content_area);
-            lv_obj_set_size(graph_bg, 220, 120);
-            lv_obj_set_pos(graph_bg, 10, 50);
-            lv_obj_set_style_bg_color(graph_bg, lv_color_hex(0x1a1a1a), LV_PART_MAIN);
-            lv_obj_set_style_radius(graph_bg, 8, LV_PART_MAIN);
-            lv_obj_set_style_border_width(graph_bg, 1, LV_PART_MAIN);
-            lv_obj_set_style_border_color(graph_bg, lv_color_hex(0x444444), LV_PART_MAIN);
-            
-            // Draw channel bars (channels 1-13)
-            int bar_width = 15;
-            int bar_spacing = 2;
-            int start_x = 15;
-            int max_height = 100;
-            
-            // Find max activity for scaling
-            int max_activity = 1;
-            for (int ch = 1; ch <= 13; ch++) {
-                if (channel_stats[ch].total_frames > max_activity) {
-                    max_activity = channel_stats[ch].total_frames;
-                }
-            }
-            
-            for (int ch = 1; ch <= 13; ch++) {
-                int x_pos = start_x + (ch - 1) * (bar_width + bar_spacing);
-                int activity = channel_stats[ch].total_frames;
-                int bar_height = max_activity > 0 ? (activity * max_height / max_activity) : 0;
-                if (bar_height < 2 && activity > 0) bar_height = 2; // Minimum visible height
-                
-                // Bar background
-                lv_obj_t* bar_bg = lv_obj_create(graph_bg);
-                lv_obj_set_size(bar_bg, bar_width, max_height);
-                lv_obj_set_pos(bar_bg, x_pos - 10, 110 - max_height);
-                lv_obj_set_style_bg_color(bar_bg, lv_color_hex(0x333333), LV_PART_MAIN);
-                lv_obj_set_style_radius(bar_bg, 2, LV_PART_MAIN);
-                lv_obj_set_style_border_width(bar_bg, 0, LV_PART_MAIN);
-                
-                // Activity bar
-                if (bar_height > 0) {
-                    lv_obj_t* bar = lv_obj_create(graph_bg);
-                    lv_obj_set_size(bar, bar_width, bar_height);
-                    lv_obj_set_pos(bar, x_pos - 10, 110 - bar_height);
-                    
-                    // Color based on current channel and activity level
-                    lv_color_t bar_color;
-                    if (ch == current_channel) {
-                        bar_color = lv_color_hex(COLOR_PRIMARY); // Current channel
-                    } else if (activity > max_activity * 0.7) {
-                        bar_color = lv_color_hex(COLOR_DANGER); // High activity
-                    } else if (activity > max_activity * 0.3) {
-                        bar_color = lv_color_hex(COLOR_WARNING); // Medium activity
-                    } else {
-                        bar_color = lv_color_hex(COLOR_SECONDARY); // Low activity
-                    }
-                    
-                    lv_obj_set_style_bg_color(bar, bar_color, LV_PART_MAIN);
-                    lv_obj_set_style_radius(bar, 2, LV_PART_MAIN);
-                    lv_obj_set_style_border_width(bar, 0, LV_PART_MAIN);
-                }
-                
-                // Channel number label
-                lv_obj_t* ch_label = lv_label_create(content_area);
-                lv_obj_set_pos(ch_label, x_pos + 8, 175);
-                lv_label_set_text_fmt(ch_label, "%d", ch);
-                lv_color_t label_color = (ch == current_channel) ? 
-                    lv_color_hex(COLOR_PRIMARY) : lv_color_hex(COLOR_TEXT_DIM);
-                lv_obj_set_style_text_color(ch_label, label_color, LV_PART_MAIN);
-            }
-            
-            // Current channel indicator
-            lv_obj_t* current_info = lv_label_create(content_area);
-            lv_obj_set_pos(current_info, 10, 195);
-            lv_obj_set_width(current_info, 220);
-            lv_label_set_text_fmt(current_info, "Current: CH%d | Max Activity: %d frames", 
-                                 current_channel, max_activity);
-            lv_obj_set_style_text_color(current_info, lv_color_hex(COLOR_TEXT_DIM), LV_PART_MAIN);
-            lv_obj_set_style_text_align(current_info, LV_TEXT_ALIGN_CENTER, LV_PART_MAIN);
-            
-            break;
+        c.label[ch] = ui_label(root, x_pos + 8, 175, 0, COLOR_TEXT_DIM);
+        lv_label_set_text_fmt(c.label[ch], "%d", ch);
+    }
+    
+    c.current = ui_label(root, 10, 195, 220, COLOR_TEXT_DIM);
+    lv_obj_set_style_text_align(c.current, LV_TEXT_ALIGN_CENTER, LV_PART_MAIN);
+}
+
+#define SNR_GOOD_DB 25                      // Bar turns green at this median SNR
+#define SNR_FAIR_DB 15                      // Yellow below SNR_GOOD_DB, red below this
+
+void update_signal_card() {
+    SignalMapCard& c = signal_card;
+    
+    // Scale bars to the busiest channel in the window
+    uint32_t max_activity = 1;
+    for (int ch = 1; ch <= WIFI_CHANNEL_MAX; ch++) {
+        if (ui_status.channels[ch].frames > max_activity) {
+            max_activity = ui_status.channels[ch].frames;
         }
+    }
+    
+    // Scrolling picks the channel described below the graph; 0 follows the radio
+    int selected = scroll_pos == 0 ? ui_status.current_channel : (scroll_pos - 1) % WIFI_CHANNEL_MAX + 1;
+    
+    for (int ch = 1; ch <= WIFI_CHANNEL_MAX; ch++) {
+        const SignalSummary& s = ui_status.channels[ch];
+        int x_pos = GRAPH_START_X + (ch - 1) * (GRAPH_BAR_WIDTH + GRAPH_BAR_SPACING);
+        int bar_height = (int)(s.frames * GRAPH_MAX_HEIGHT / max_activity);
+        if (bar_height < 2 && s.frames > 0) bar_height = 2; // Minimum visible height
         
-        case NETWORK_INTEL: {
-            lv_label_set_text(title_label, "🧠 INTEL");
+        ui_set_hidden(c.bar[ch], bar_height == 0);
+        if (bar_height > 0) {
+            ui_set_geometry(c.bar[ch], x_pos - 10, 110 - bar_height, GRAPH_BAR_WIDTH, bar_height);
             
-            if (scroll_pos == 0) {
-                // Main stats with big numbers
-                lv_obj_t* stats_grid = lv_label_create(content_area);
-                lv_obj_set_pos(stats_grid, 10, 20);
-                lv_obj_set_width(stats_grid, 220);
-                lv_label_set_text_fmt(stats_grid, "APs: %d\nDevices: %d\nFrames: %d", 
-                                     ap_registry.size(), client_registry.size(), total_frames);
-                lv_obj_set_style_text_color(stats_grid, lv_color_hex(COLOR_PRIMARY), LV_PART_MAIN);
-                lv_obj_set_style_text_font(stats_grid, &lv_font_montserrat_14, LV_PART_MAIN);
-                lv_obj_set_style_text_align(stats_grid, LV_TEXT_ALIGN_CENTER, LV_PART_MAIN);
-                
-                // Frame type breakdown
-                lv_obj_t* frames_info = lv_label_create(content_area);
-                lv_obj_set_pos(frames_info, 10, 130);
-                lv_obj_set_width(frames_info, 220);
-                lv_label_set_text_fmt(frames_info, "MGMT: %d | DATA: %d | CTRL: %d", 
-                                     mgmt_frames, data_frames, ctrl_frames);
-                lv_obj_set_style_text_color(frames_info, lv_color_hex(COLOR_SECONDARY), LV_PART_MAIN);
-                lv_obj_set_style_text_align(frames_info, LV_TEXT_ALIGN_CENTER, LV_PART_MAIN);
-                
-                // Frame rate
-                float fps = (float)total_frames / max(1.0f, (float)(millis()/1000));
-                lv_obj_t* fps_label = lv_label_create(content_area);
-                lv_obj_set_pos(fps_label, 10, 160);
-                lv_obj_set_width(fps_label, 220);
-                lv_label_set_text_fmt(fps_label, "Rate: %.1f frames/sec", fps);
-                lv_obj_set_style_text_color(fps_label, lv_color_hex(COLOR_ACCENT), LV_PART_MAIN);
-                lv_obj_set_style_text_font(fps_label, &lv_font_montserrat_14, LV_PART_MAIN);
-                lv_obj_set_style_text_align(fps_label, LV_TEXT_ALIGN_CENTER, LV_PART_MAIN);
-                
-            } else if (scroll_pos == 1) {
-                // Security analysis
-                int secure = 0, open = 0;
-                for (const auto& kv : ap_registry) {
-                    if (kv.second.security == "Open") open++;
-                    else secure++;
-                }
-                
-                lv_obj_t* sec_header = lv_label_create(content_area);
-                lv_obj_set_pos(sec_header, 10, 20);
-                lv_label_set_text(sec_header, "SECURITY");
-                lv_obj_set_style_text_color(sec_header, lv_color_hex(COLOR_SECONDARY), LV_PART_MAIN);
-                lv_obj_set_style_text_font(sec_header, &lv_font_montserrat_14, LV_PART_MAIN);
-                
-                // Security pie chart representation
-                if (secure + open > 0) {
-                    int secure_pct = (secure * 100) / (secure + open);
-                    create_progress_arc(content_area, 85, 60, secure_pct, lv_color_hex(COLOR_PRIMARY));
-                    
-                    lv_obj_t* pct_label = lv_label_create(content_area);
-                    lv_obj_set_pos(pct_label, 105, 85);
-                    lv_label_set_text_fmt(pct_label, "%d%%", secure_pct);
-                    lv_obj_set_style_text_color(pct_label, lv_color_hex(COLOR_TEXT_BRIGHT), LV_PART_MAIN);
-                    lv_obj_set_style_text_font(pct_label, &lv_font_montserrat_14, LV_PART_MAIN);
-                }
-                
-                lv_obj_t* sec_stats = lv_label_create(content_area);
-                lv_obj_set_pos(sec_stats, 10, 140);
-                lv_obj_set_width(sec_stats, 220);
-                lv_label_set_text_fmt(sec_stats, "Secure: %d\nOpen: %d", secure, open);
-                lv_obj_set_style_text_color(sec_stats, lv_color_hex(COLOR_TEXT_BRIGHT), LV_PART_MAIN);
-                lv_obj_set_style_text_font(sec_stats, &lv_font_montserrat_14, LV_PART_MAIN);
-                lv_obj_set_style_text_align(sec_stats, LV_TEXT_ALIGN_CENTER, LV_PART_MAIN);
+            // Color by median signal-to-noise ratio
+            lv_color_t bar_color;
+            if (s.snr >= SNR_GOOD_DB) {
+                bar_color = lv_color_hex(COLOR_PRIMARY);
+            } else if (s.snr >= SNR_FAIR_DB) {
+                bar_color = lv_color_hex(COLOR_WARNING);
+            } else {
+                bar_color = lv_color_hex(COLOR_DANGER);
             }
-            break;
+            ui_set_bg_color(c.bar[ch], bar_color);
         }
         
-        case SYSTEM_STATUS: {
-            lv_label_set_text(title_label, "⚙️ SYSTEM");
-            
-            // System status with animated elements
-            unsigned long uptime = millis() / 1000;
-            int hours = uptime / 3600;
-            int minutes = (uptime % 3600) / 60;
-            int seconds = uptime % 60;
-            
-            lv_obj_t* uptime_label = lv_label_create(content_area);
-            lv_obj_set_pos(uptime_label, 10, 30);
-            lv_obj_set_width(uptime_label, 220);
-            lv_label_set_text_fmt(uptime_label, "UPTIME\n%02d:%02d:%02d", hours, minutes, seconds);
-            lv_obj_set_style_text_color(uptime_label, lv_color_hex(COLOR_PRIMARY), LV_PART_MAIN);
-            lv_obj_set_style_text_font(uptime_label, &lv_font_montserrat_14, LV_PART_MAIN);
-            lv_obj_set_style_text_align(uptime_label, LV_TEXT_ALIGN_CENTER, LV_PART_MAIN);
-            
-            // Memory usage (simulated)
-            int memory_used = 45; // Approximate
-            create_progress_arc(content_area, 85, 100, memory_used, lv_color_hex(COLOR_SECONDARY));
-            
-            lv_obj_t* mem_label = lv_label_create(content_area);
-            lv_obj_set_pos(mem_label, 105, 125);
-            lv_label_set_text_fmt(mem_label, "%d%%", memory_used);
-            lv_obj_set_style_text_color(mem_label, lv_color_hex(COLOR_TEXT_BRIGHT), LV_PART_MAIN);
-            
-            lv_obj_t* mem_text = lv_label_create(content_area);
-            lv_obj_set_pos(mem_text, 10, 170);
-            lv_obj_set_width(mem_text, 220);
-            lv_label_set_text(mem_text, "Memory Usage");
-            lv_obj_set_style_text_color(mem_text, lv_color_hex(COLOR_TEXT_DIM), LV_PART_MAIN);
-            lv_obj_set_style_text_align(mem_text, LV_TEXT_ALIGN_CENTER, LV_PART_MAIN);
-            
-            // Version info
-            lv_obj_t* version = lv_label_create(content_area);
-            lv_obj_set_pos(version, 10, 200);
-            lv_obj_set_width(version, 220);
-            lv_label_set_text(version, "ESP32 Sniffer v2.0");
-            lv_obj_set_style_text_color(version, lv_color_hex(COLOR_ACCENT), LV_PART_MAIN);
-            lv_obj_set_style_text_align(version, LV_TEXT_ALIGN_CENTER, LV_PART_MAIN);
-            break;
+        lv_color_t label_color = lv_color_hex(COLOR_TEXT_DIM);
+        if (ch == selected) label_color = lv_color_hex(COLOR_TEXT_BRIGHT);
+        else if (ch == ui_status.current_channel) label_color = lv_color_hex(COLOR_PRIMARY);
+        ui_set_text_color(c.label[ch], label_color);
+    }
+    
+    const SignalSummary& s = ui_status.channels[selected];
+    if (s.frames == 0) {
+        ui_set_text(c.current, "CH%d: nothing heard", selected);
+    } else {
+        ui_set_text(c.current, "CH%d SNR %d dB | p90 %d | retry %d%%", selected, s.snr, s.rssi_p90,
+                    retry_pct(s.retries, s.frames));
+    }
+}
+
+void build_intel_card(lv_obj_t* root) {
+    IntelCard& c = intel_card;
+    
+    // Page 0: main stats with big numbers
+    c.overview = ui_group(root);
+    c.counts = ui_label(c.overview, 10, 20, 220, COLOR_PRIMARY);
+    lv_obj_set_style_text_font(c.counts, &lv_font_montserrat_14, LV_PART_MAIN);
+    lv_obj_set_style_text_align(c.counts, LV_TEXT_ALIGN_CENTER, LV_PART_MAIN);
+    c.frames = ui_label(c.overview, 10, 130, 220, COLOR_SECONDARY);
+    lv_obj_set_style_text_align(c.frames, LV_TEXT_ALIGN_CENTER, LV_PART_MAIN);
+    c.rate = ui_label(c.overview, 10, 160, 220, COLOR_ACCENT);
+    lv_obj_set_style_text_font(c.rate, &lv_font_montserrat_14, LV_PART_MAIN);
+    lv_obj_set_style_text_align(c.rate, LV_TEXT_ALIGN_CENTER, LV_PART_MAIN);
+    
+    // Page 1: security analysis
+    c.security = ui_group(root);
+    lv_obj_t* sec_header = ui_label(c.security, 10, 20, 0, COLOR_SECONDARY);
+    lv_label_set_text(sec_header, "SECURITY");
+    lv_obj_set_style_text_font(sec_header, &lv_font_montserrat_14, LV_PART_MAIN);
+    c.arc = create_progress_arc(c.security, 85, 60, lv_color_hex(COLOR_PRIMARY));
+    c.pct = ui_label(c.security, 105, 85, 0, COLOR_TEXT_BRIGHT);
+    lv_obj_set_style_text_font(c.pct, &lv_font_montserrat_14, LV_PART_MAIN);
+    c.sec_stats = ui_label(c.security, 10, 140, 220, COLOR_TEXT_BRIGHT);
+    lv_obj_set_style_text_font(c.sec_stats, &lv_font_montserrat_14, LV_PART_MAIN);
+    lv_obj_set_style_text_align(c.sec_stats, LV_TEXT_ALIGN_CENTER, LV_PART_MAIN);
+}
+
+void update_intel_card() {
+    IntelCard& c = intel_card;
+    ui_set_hidden(c.overview, scroll_pos != 0);
+    ui_set_hidden(c.security, scroll_pos != 1);
+    
+    if (scroll_pos == 0) {
+        ui_set_text(c.counts, "APs: %d\nDevices: %d\nFrames: %d", 
+                    ui_status.ap_count, ui_status.client_count, ui_status.total_frames);
+        ui_set_text(c.frames, "MGMT: %d | DATA: %d | CTRL: %d\nRetry: %d%% | Duplicates: %d",
+                    ui_status.mgmt_frames, ui_status.data_frames, ui_status.ctrl_frames,
+                    retry_pct(ui_status.retry_frames, ui_status.total_frames + ui_status.duplicate_frames),
+                    ui_status.duplicate_frames);
+        float fps = (float)ui_status.total_frames / max(1.0f, (float)(millis()/1000));
+        ui_set_text(c.rate, "Rate: %.1f frames/sec", fps);
+    } else if (scroll_pos == 1) {
+        int secure = ui_status.secure_aps, open = ui_status.open_aps;
+        
+        // Security pie chart representation
+        bool any = secure + open > 0;
+        ui_set_hidden(c.arc, !any);
+        ui_set_hidden(c.pct, !any);
+        if (any) {
+            int secure_pct = (secure * 100) / (secure + open);
+            update_progress_arc(c.arc, secure_pct);
+            ui_set_text(c.pct, "%d%%", secure_pct);
         }
+        ui_set_text(c.sec_stats, "Secure: %d\nOpen: %d", secure, open);
+    }
+}
+
+void build_system_card(lv_obj_t* root) {
+    SystemCard& c = system_card;
+    
+    // Everything ends above y=175 so the card fits the content area's 190 px
+    lv_obj_t* version = ui_label(root, 10, 0, 220, COLOR_ACCENT);
+    lv_label_set_text(version, "ESP32 Sniffer v2.0");
+    lv_obj_set_style_text_align(version, LV_TEXT_ALIGN_CENTER, LV_PART_MAIN);
+    
+    c.uptime = ui_label(root, 10, 16, 220, COLOR_PRIMARY);
+    lv_obj_set_style_text_font(c.uptime, &lv_font_montserrat_14, LV_PART_MAIN);
+    lv_obj_set_style_text_align(c.uptime, LV_TEXT_ALIGN_CENTER, LV_PART_MAIN);
+    
+    c.mem_arc = create_progress_arc(root, 85, 38, lv_color_hex(COLOR_SECONDARY));
+    c.mem_pct = ui_label(root, 105, 63, 0, COLOR_TEXT_BRIGHT);
+    
+    c.mem_subsystems = ui_label(root, 10, 38, 75, COLOR_TEXT_DIM);
+    c.mem_pools = ui_label(root, 155, 38, 80, COLOR_TEXT_DIM);
+    
+    c.mem_heap = ui_label(root, 10, 106, 220, COLOR_TEXT_DIM);
+    lv_obj_set_style_text_align(c.mem_heap, LV_TEXT_ALIGN_CENTER, LV_PART_MAIN);
+    
+    // Capture queue health
+    c.queue = ui_label(root, 10, 124, 220, COLOR_TEXT_DIM);
+    lv_obj_set_style_text_align(c.queue, LV_TEXT_ALIGN_CENTER, LV_PART_MAIN);
+    
+    // Worst-case (p99) latencies from the probes
+    c.latency = ui_label(root, 10, 142, 220, COLOR_TEXT_DIM);
+    lv_obj_set_style_text_align(c.latency, LV_TEXT_ALIGN_CENTER, LV_PART_MAIN);
+#if !LATENCY_PROBES
+    lv_obj_add_flag(c.latency, LV_OBJ_FLAG_HIDDEN);
+#endif
+}
+
+void update_system_card() {
+    SystemCard& c = system_card;
+    
+    unsigned long uptime = millis() / 1000;
+    ui_set_text(c.uptime, "UPTIME %02d:%02d:%02d", 
+                (int)(uptime / 3600), (int)((uptime % 3600) / 60), (int)(uptime % 60));
+    
+    // Internal heap; sampled once a second by ui_task
+    const MemPoolStats& heap = mem_stats.pools[MEM_POOL_INTERNAL];
+    int memory_used = mem_pool_used_pct(MEM_POOL_INTERNAL);
+    update_progress_arc(c.mem_arc, memory_used);
+    ui_set_text(c.mem_pct, "%d%%", memory_used);
+    ui_set_text(c.mem_heap, "Heap %uK free | low %uK | blk %uK",
+                (unsigned)(heap.free / 1024), (unsigned)(heap.min_free / 1024),
+                (unsigned)(heap.largest_free / 1024));
+    ui_set_text_color(c.mem_heap, lv_color_hex(mem_stats.pressure ? COLOR_DANGER : COLOR_TEXT_DIM));
+    
+    const MemSubsystemStats* sub = mem_stats.subsystems;
+    ui_set_text(c.mem_subsystems, "AP %uK\nCli %uK\nTgt %uK\nRing %uK",
+                (unsigned)(sub[MEM_AP_REGISTRY].used / 1024), (unsigned)(sub[MEM_CLIENT_REGISTRY].used / 1024),
+                (unsigned)(sub[MEM_TARGET_PACKETS].used / 1024),
+                (unsigned)((sub[MEM_CAPTURE_RING].reserved + sub[MEM_PCAP_RING].reserved) / 1024));
+    
+    const MemPoolStats& psram = mem_stats.pools[MEM_POOL_PSRAM];
+    if (psram.total > 0) {
+        ui_set_text(c.mem_pools, "PSRAM\n%uK free\nLVGL %d%%\nlow %uK",
+                    (unsigned)(psram.free / 1024), mem_pool_used_pct(MEM_POOL_LVGL),
+                    (unsigned)(mem_stats.pools[MEM_POOL_LVGL].min_free / 1024));
+    } else {
+        ui_set_text(c.mem_pools, "No PSRAM\n\nLVGL %d%%\nlow %uK",
+                    mem_pool_used_pct(MEM_POOL_LVGL),
+                    (unsigned)(mem_stats.pools[MEM_POOL_LVGL].min_free / 1024));
+    }
+    
+    if (pcap_writer.is_enabled()) {
+        ui_set_text(c.queue, "PCAP: %u sent | %u dropped", 
+                    pcap_writer.frames_queued(), pcap_writer.frames_dropped());
+    } else {
+        ui_set_text(c.queue, "Drops: %u | Peak: %u/%u", 
+                    capture_ring.dropped(), capture_ring.peak(), capture_ring.capacity());
     }
+    
+#if LATENCY_PROBES
+    ui_set_text(c.latency, "p99 RX %.0fus | parse %.0fus | UI %.1fms",
+                probe_percentile_us(PROBE_RX, 99), probe_percentile_us(PROBE_PARSE, 99),
+                probe_percentile_us(PROBE_UI, 99) / 1000);
+#endif
+}
+
+// Refreshes the visible card. Widgets are created the first time a card is
+// shown; afterwards only changed values reach LVGL, so unchanged regions are
+// never invalidated or re-flushed.
+void update_card_content() {
+    PROBE_SCOPE(PROBE_UI);
+    uint32_t start_us = micros();
+    
+    // Counter cards draw from the published snapshot. Cards that show a registry
+    // record hold registry_mutex while they set widget values; rendering happens
+    // later in lv_timer_handler() without the lock.
+    sniffer_status.read(&ui_status);
+    bool needs_registry = current_card == AP_HOTSPOTS || current_card == CLIENT_ANALYSIS ||
+                          current_card == TARGET_HUNT;
+    if (needs_registry) {
+        xSemaphoreTake(registry_mutex, portMAX_DELAY);
+        // Expiry may have shrunk the registry under the selected entry
+        size_t n = current_card == AP_HOTSPOTS ? ap_registry.size() :
+                   current_card == CLIENT_ANALYSIS ? client_registry.size() : 0;
+        if (n > 0 && (size_t)scroll_pos >= n) scroll_pos = n - 1;
+    }
+    
+    animation_counter = (animation_counter + 1) % 100;
+    
+    if (card_roots[current_card] == nullptr) {
+        lv_obj_t* root = ui_group(content_area);
+        card_roots[current_card] = root;
+        switch(current_card) {
+            case AP_HOTSPOTS: build_ap_card(root); break;
+            case CLIENT_ANALYSIS: build_client_card(root); break;
+            case TARGET_HUNT: build_target_card(root); break;
+            case SIGNAL_MAP: build_signal_card(root); break;
+            case NETWORK_INTEL: build_intel_card(root); break;
+            case SYSTEM_STATUS: build_system_card(root); break;
+        }
+    }
+    for (int i = 0; i < 6; i++) {
+        if (card_roots[i] != nullptr) ui_set_hidden(card_roots[i], i != current_card);
+    }
+    
+    switch(current_card) {
+        case AP_HOTSPOTS:
+            ui_set_text(title_label, "🔥 ACCESS POINTS");
+            update_ap_card();
+            break;
+        case CLIENT_ANALYSIS:
+            ui_set_text(title_label, "📱 DEVICES");
+            update_client_card();
+            break;
+        case TARGET_HUNT:
+            ui_set_text(title_label, "🎯 TARGET HUNT");
+            update_target_card();
+            break;
+        case SIGNAL_MAP:
+            ui_set_text(title_label, "📊 SIGNAL MAP");
+            update_signal_card();
+            break;
+        case NETWORK_INTEL:
+            ui_set_text(title_label, "🧠 INTEL");
+            update_intel_card();
+            break;
+        case SYSTEM_STATUS:
+            ui_set_text(title_label, "⚙️ SYSTEM");
+            update_system_card();
+            break;
+    }
+    
+    if (needs_registry) xSemaphoreGive(registry_mutex);
+    
+    ui_stats.refreshes++;
+    ui_stats.update_us = micros() - start_us;
 }
 
 // Handle touch inputs
@@ -944,271 +1121,659 @@ void handle_touch_input() {
     }
 }
 
-// Enhanced packet handler with target phone analysis
-void wifi_sniffer_packet_handler(void* buff, wifi_promiscuous_pkt_type_t type) {
-    wifi_promiscuous_pkt_t* pkt = (wifi_promiscuous_pkt_t*)buff;
-    wifi_pkt_rx_ctrl_t ctrl = pkt->rx_ctrl;
-    
-    total_frames++;
-    channel_stats[current_channel].total_frames++;
-    channel_stats[current_channel].last_activity = millis();
-    
-    if (type == WIFI_PKT_MGMT) {
-        mgmt_frames++;
+// Drains capture_ring in batches, holding registry_mutex once per batch
+void parser_task(void* /* arg */) {
+    for (;;) {
+        size_t ready = capture_ring.available();
+        if (ready == 0) {
+            vTaskDelay(1);
+            continue;
+        }
+        if (ready > PARSER_BATCH) ready = PARSER_BATCH;
+        uint32_t start_us = micros();
         
-    uint16_t frame_control = pkt->payload[0] | (pkt->payload[1] << 8);
-    uint8_t frame_type = (frame_control >> 2) & 0x03;
-    uint8_t frame_subtype = (frame_control >> 4) & 0x0F;
-    
-        uint8_t* addr1 = &pkt->payload[4];  // Destination
-        uint8_t* addr2 = &pkt->payload[10]; // Source  
-        uint8_t* addr3 = &pkt->payload[16]; // BSSID
+        xSemaphoreTake(registry_mutex, portMAX_DELAY);
+        {
+            PROBE_SCOPE(PROBE_BATCH);
+            for (size_t i = 0; i < ready; i++) {
+                process_frame(capture_ring.peek(i));
+            }
+        }
+        xSemaphoreGive(registry_mutex);
+        
+        if (pcap_writer.is_enabled()) {
+            for (size_t i = 0; i < ready; i++) {
+                pcap_writer.on_frame(capture_ring.peek(i));
+            }
+        }
+        capture_ring.consume(ready);
+        task_busy(TASK_PARSER, start_us);
+    }
+}
+
+// Core 0: channel hopping, registry expiry and the status snapshot for the UI.
+// Runs above the parser so a hop is never late behind a backlog of frames.
+void radio_task(void* /* arg */) {
+    TickType_t last_wake = xTaskGetTickCount();
+    unsigned long last_publish = 0;
+    unsigned long last_cleanup = millis();
+    for (;;) {
+        uint32_t start_us = micros();
+        unsigned long now = millis();
         
-        String src_mac = mac_to_str(addr2);
-        String dst_mac = mac_to_str(addr1);
-        String bssid = mac_to_str(addr3);
+        // Channel hopping: the radio is retuned before the new dwell opens
+        int next_channel;
+        if (channel_hopper.poll(now, &next_channel)) {
+            esp_wifi_set_channel(next_channel, WIFI_SECOND_CHAN_NONE);
+            current_channel = next_channel;
+            channel_hopper.begin_dwell(next_channel, millis());
+        }
         
-        // Enhanced target phone detection and analysis
-        bool is_target_involved = false;
-        String frame_type_str = "";
-        String direction = "";
+        xSemaphoreTake(registry_mutex, portMAX_DELAY);
         
-        if (src_mac.equals(TARGET_PHONE) || dst_mac.equals(TARGET_PHONE)) {
-            is_target_involved = true;
-            target_found = true;
-            target_rssi = ctrl.rssi;
-            target_last_seen = millis();
-            
-            // Determine direction and frame type
-            if (src_mac.equals(TARGET_PHONE)) {
-                direction = "TX";
-                target_tx_packets++;
-            } else {
-                direction = "RX";
-                target_rx_packets++;
-            }
-            
-            // Get frame type description
-            switch (frame_subtype) {
-                case WIFI_BEACON_FRAME: frame_type_str = "BEACON"; break;
-                case WIFI_PROBE_REQUEST: frame_type_str = "PROBE"; break;
-                case WIFI_PROBE_RESPONSE: frame_type_str = "PROBE_R"; break;
-                case WIFI_ASSOCIATION_REQUEST: frame_type_str = "ASSOC"; break;
-                case WIFI_ASSOCIATION_RESPONSE: frame_type_str = "ASSOC_R"; break;
-                case WIFI_DISASSOCIATION: frame_type_str = "DISASSOC"; break;
-                case WIFI_AUTHENTICATION: frame_type_str = "AUTH"; break;
-                case WIFI_DEAUTHENTICATION: frame_type_str = "DEAUTH"; break;
-                default: frame_type_str = "MGMT"; break;
-            }
-            
-            // Try to extract SSID from probe requests
-            if (frame_subtype == WIFI_PROBE_REQUEST && src_mac.equals(TARGET_PHONE)) {
-                if (pkt->rx_ctrl.sig_len > 24) {
-                    uint8_t ssid_len = pkt->payload[25];
-                    if (ssid_len > 0 && ssid_len <= 32) {
-                        char ssid[33] = {0};
-                        memcpy(ssid, &pkt->payload[26], ssid_len);
-                        target_ssid = String(ssid);
-                    }
-                }
-            }
-            
-            // Try to extract IP from data frames (simplified approach)
-            if (frame_subtype == WIFI_ASSOCIATION_REQUEST && src_mac.equals(TARGET_PHONE)) {
-                target_ap = bssid;
-                // Try to guess IP based on common patterns
-                target_ip = "192.168.1.x"; // Placeholder - would need DHCP analysis
-            }
-            
-            // Store packet info for display
-            if (target_packets.size() >= MAX_TARGET_PACKETS) {
-                target_packets.erase(target_packets.begin());
-            }
-            
-            TargetPacketInfo packet_info;
-            packet_info.timestamp = millis();
-            packet_info.frame_type = frame_type_str;
-            packet_info.rssi = ctrl.rssi;
-            packet_info.direction = direction;
-            packet_info.details = "";
-            target_packets.push_back(packet_info);
+        // Registry expiry: a few stale entries per tick, oldest first
+        expire_stale_entries(now, EXPIRY_BUDGET);
+        
+        // Targets not heard for a while go back to searching. Channel statistics
+        // need no sweep: their window slides as frames arrive.
+        if (now - last_cleanup > 60000) {
+            watchlist.expire(now, WATCH_TIMEOUT_MS);
+            last_cleanup = now;
         }
         
-        // Process different management frame types (existing code)
-      if (frame_subtype == WIFI_BEACON_FRAME) {
-            // Update AP registry
-            APInfo& ap = ap_registry[bssid];
-            ap.bssid = bssid;
-            ap.channel = current_channel;
-            ap.rssi = ctrl.rssi;
-            ap.last_seen = millis();
-            ap.beacon_count++;
-            
-            // Parse SSID
-        if (pkt->rx_ctrl.sig_len > 36) {
-          uint8_t ssid_len = pkt->payload[37];
-          if (ssid_len > 0 && ssid_len <= 32) {
-                    char ssid[33] = {0};
-                    memcpy(ssid, &pkt->payload[38], ssid_len);
-                    ap.ssid = String(ssid);
-                }
-            }
-            
-            // Parse security
-            ap.security = get_security_from_beacon(pkt->payload, pkt->rx_ctrl.sig_len);
-            
-            // Update channel stats
-            channel_stats[current_channel].ap_count++;
-            
-        } else if (frame_subtype == WIFI_PROBE_REQUEST) {
-            // Track client devices
-            ClientInfo& client = client_registry[src_mac];
-            client.mac = src_mac;
-            client.rssi = ctrl.rssi;
-            client.last_seen = millis();
-            client.frame_count++;
-            client.vendor = get_vendor_from_mac(src_mac);
-            client.is_associated = false;
-            
-            // Try to associate with nearby APs based on timing and signal strength
-            String nearest_ap = find_closest_ap(src_mac, ctrl.rssi, millis());
-            if (nearest_ap.length() > 0) {
-                client.connected_ap = nearest_ap;
-            }
-            
-        } else if (frame_subtype == WIFI_ASSOCIATION_REQUEST || frame_subtype == WIFI_REASSOCIATION_REQUEST) {
-            // Client associating to AP
-            ClientInfo& client = client_registry[src_mac];
-            client.mac = src_mac;
-            client.connected_ap = bssid;
-            client.rssi = ctrl.rssi;
-            client.last_seen = millis();
-            client.frame_count++;
-            client.vendor = get_vendor_from_mac(src_mac);
-            client.is_associated = true;
-            
-        } else if (frame_subtype == WIFI_ASSOCIATION_RESPONSE || frame_subtype == WIFI_REASSOCIATION_RESPONSE) {
-            // AP responding to association
-            if (client_registry.find(dst_mac) != client_registry.end()) {
-                client_registry[dst_mac].connected_ap = src_mac;
-                client_registry[dst_mac].is_associated = true;
-            }
-            
-        } else if (frame_subtype == WIFI_DISASSOCIATION) {
-            // Client disconnecting
-            if (client_registry.find(src_mac) != client_registry.end()) {
-                client_registry[src_mac].is_associated = false;
-                client_registry[src_mac].connected_ap = "";
-            }
+        if (now - last_publish >= STATUS_PUBLISH_MS) {
+            publish_sniffer_status(now);
+            last_publish = now;
         }
         
-    } else if (type == WIFI_PKT_DATA) {
-        data_frames++;
+        xSemaphoreGive(registry_mutex);
+        task_busy(TASK_RADIO, start_us);
+        vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(RADIO_TICK_MS));
+    }
+}
+
+// Streams queued pcap bytes to the serial port in large writes. Only this task
+// ever blocks on the UART; when it falls behind, PcapWriter drops records.
+void pcap_export_task(void* /* arg */) {
+    unsigned long batch_start = millis();
+    for (;;) {
+        size_t ready = pcap_ring.available();
+        if (ready == 0) batch_start = millis();
+        if (ready == 0 || (ready < PCAP_WRITE_CHUNK && millis() - batch_start < PCAP_FLUSH_MS)) {
+            vTaskDelay(pdMS_TO_TICKS(5));
+            continue;
+        }
         
-        // Track data frame activity
-        uint8_t* addr1 = &pkt->payload[4];  // Destination
-        uint8_t* addr2 = &pkt->payload[10]; // Source
+        const uint8_t* data;
+        size_t n = pcap_ring.peek(&data);
+        if (n > PCAP_WRITE_CHUNK) n = PCAP_WRITE_CHUNK;
+        uint32_t start_us = micros();
+        Serial.write(data, n);
+        pcap_ring.consume(n);
+        batch_start = millis();
+        task_busy(TASK_PCAP, start_us);
+    }
+}
+
+// Saves the registry snapshot to flash when one is due or was asked for with
+// "snap save". Records are encoded a batch at a time under registry_mutex and
+// written without it, so the parser waits for at most one batch.
+volatile bool snapshot_requested = false;
+
+void store_task(void* /* arg */) {
+    for (;;) {
+        vTaskDelay(pdMS_TO_TICKS(STORE_POLL_MS));
+        if (!snapshot_requested && !registry_snapshot.due(millis())) continue;
+        snapshot_requested = false;
         
-        String src_mac = mac_to_str(addr2);
-        String dst_mac = mac_to_str(addr1);
+        uint32_t start_us = micros();
+        if (!registry_snapshot.open()) {
+            task_busy(TASK_STORE, start_us);
+            continue;
+        }
+        xSemaphoreTake(registry_mutex, portMAX_DELAY);
+        registry_snapshot.start(millis());
+        xSemaphoreGive(registry_mutex);
+        for (;;) {
+            xSemaphoreTake(registry_mutex, portMAX_DELAY);
+            size_t n = registry_snapshot.encode(millis());
+            xSemaphoreGive(registry_mutex);
+            if (n == 0 || !registry_snapshot.write(n)) break;
+            // Spread the flash writes out
+            task_busy(TASK_STORE, start_us);
+            vTaskDelay(1);
+            start_us = micros();
+        }
+        registry_snapshot.commit(millis());
+        task_busy(TASK_STORE, start_us);
+    }
+}
+
+// Streams a telemetry batch every interval while a format is selected with
+// "telem". Like the snapshot, each buffer is encoded under registry_mutex and
+// written without it; the UART write is where this task spends its time, so
+// the batch takes what the link allows and the next one starts late rather
+// than queueing. Baud and format changes are applied between batches. When
+// "pcap on" takes the port mid-batch the rest of the batch is dropped, and the
+// next one lists every record so the collector catches up.
+volatile TelemetryFormat telemetry_format = TELEMETRY_OFF;
+volatile uint32_t telemetry_interval_ms = TELEMETRY_INTERVAL_MS;
+volatile uint32_t telemetry_baud = SERIAL_BAUD;
+volatile bool telemetry_full_requested = false;
+
+struct TelemetryLink {
+    uint32_t baud;
+    uint32_t encode_us;        // Last batch, with the lock held
+    uint32_t batch_ms;         // Last batch, encode and write
+    uint32_t late;             // Batches that took longer than the interval
+};
+TelemetryLink telemetry_link = {SERIAL_BAUD, 0, 0, 0};
+
+void telemetry_expired(RegistryKind kind, MacAddr mac, void* /* ctx */) {
+    telemetry.on_removed(kind == REGISTRY_CLIENT, mac);
+}
+
+void telemetry_task(void* /* arg */) {
+    TickType_t last_wake = xTaskGetTickCount();
+    for (;;) {
+        vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(telemetry_interval_ms));
+        if (telemetry_baud != telemetry_link.baud) {
+            Serial.flush();
+            Serial.updateBaudRate(telemetry_baud);
+            telemetry_link.baud = telemetry_baud;
+        }
+        // The pcap stream owns the port while it runs
+        telemetry.set_format(pcap_writer.is_enabled() ? TELEMETRY_OFF : telemetry_format);
+        if (telemetry.get_format() == TELEMETRY_OFF) continue;
+        if (telemetry_full_requested) {
+            telemetry_full_requested = false;
+            telemetry.request_full();
+        }
         
-        // Enhanced target phone data frame analysis
-        if (src_mac.equals(TARGET_PHONE) || dst_mac.equals(TARGET_PHONE)) {
-            target_found = true;
-            target_rssi = ctrl.rssi;
-            target_last_seen = millis();
-            
-            String direction = src_mac.equals(TARGET_PHONE) ? "TX" : "RX";
-            if (src_mac.equals(TARGET_PHONE)) {
-                target_tx_packets++;
-            } else {
-                target_rx_packets++;
-            }
-            
-            // Try to extract IP from data frame payload
-            if (pkt->rx_ctrl.sig_len > 30) {
-                // Look for IP patterns in payload (simplified)
-                // This is a basic approach - real IP extraction would need more sophisticated parsing
-                for (int i = 30; i < min(pkt->rx_ctrl.sig_len - 4, 50); i++) {
-                    // Look for common IP patterns
-                    if (pkt->payload[i] == 192 && pkt->payload[i+1] == 168) {
-                        char ip_str[16];
-                        sprintf(ip_str, "%d.%d.%d.%d", 
-                                pkt->payload[i], pkt->payload[i+1], 
-                                pkt->payload[i+2], pkt->payload[i+3]);
-                        target_ip = String(ip_str);
-                        break;
-                    }
-                }
-            }
-            
-            // Store data packet info
-            if (target_packets.size() >= MAX_TARGET_PACKETS) {
-                target_packets.erase(target_packets.begin());
+        uint32_t start_us = micros();
+        uint32_t encode_us = 0;
+        xSemaphoreTake(registry_mutex, portMAX_DELAY);
+        telemetry.start(millis());
+        xSemaphoreGive(registry_mutex);
+        for (;;) {
+            uint32_t t0 = micros();
+            xSemaphoreTake(registry_mutex, portMAX_DELAY);
+            size_t n = telemetry.encode();
+            xSemaphoreGive(registry_mutex);
+            encode_us += micros() - t0;
+            if (n == 0) break;
+            if (pcap_writer.is_enabled()) {
+                telemetry.request_full();
+                break;
             }
-            
-            TargetPacketInfo packet_info;
-            packet_info.timestamp = millis();
-            packet_info.frame_type = "DATA";
-            packet_info.rssi = ctrl.rssi;
-            packet_info.direction = direction;
-            packet_info.details = "";
-            target_packets.push_back(packet_info);
+            Serial.write(telemetry.data(), n);
         }
+        telemetry_link.encode_us = encode_us;
+        telemetry_link.batch_ms = (micros() - start_us) / 1000;
+        if (telemetry_link.batch_ms > telemetry_interval_ms) {
+            // Start the next interval now instead of catching up with back-to-back batches
+            telemetry_link.late++;
+            last_wake = xTaskGetTickCount();
+        }
+        task_busy(TASK_TELEMETRY, start_us);
+    }
+}
+
+// Samples the heaps plus the memory owned by the UI and the pcap exporter
+void sample_memory() {
+    xSemaphoreTake(registry_mutex, portMAX_DELAY);
+    mem_stats_update();
+    xSemaphoreGive(registry_mutex);
+    
+    lv_mem_monitor_t mon;
+    lv_mem_monitor(&mon);
+    mem_set_pool(MEM_POOL_LVGL, mon.total_size, mon.free_size, mon.free_biggest_size);
+    mem_set_subsystem(MEM_PCAP_RING, pcap_ring.available(), sizeof(pcap_ring));
+    mem_set_subsystem(MEM_DISPLAY, 2 * DISPLAY_BAND_PIXELS * sizeof(lv_color_t),
+                      2 * DISPLAY_BAND_PIXELS * sizeof(lv_color_t));
+}
+
+// Load over the last window and stack headroom of each task; called once a second
+void sample_tasks() {
+    static uint32_t last_sample_us = 0;
+    uint32_t now_us = micros();
+    uint32_t window_us = now_us - last_sample_us;
+    if (window_us == 0) return;
+    for (int i = 0; i < TASK_COUNT; i++) {
+        TaskStats& t = task_stats[i];
+        uint32_t busy = t.busy_us;
+        t.load_permille = (uint32_t)((uint64_t)(busy - t.sampled_busy_us) * 1000 / window_us);
+        t.sampled_busy_us = busy;
+        // ESP-IDF reports the high-water mark in bytes
+        if (t.handle != nullptr) t.stack_free_min = uxTaskGetStackHighWaterMark(t.handle);
+    }
+    last_sample_us = now_us;
+}
+
+// Per-task load and stack headroom for the "tasks" command
+void print_task_stats() {
+    uint32_t core_load[2] = {0, 0};
+    Serial.println("Task     core  prio  load    stack free (min) / size");
+    for (int i = 0; i < TASK_COUNT; i++) {
+        const TaskStats& t = task_stats[i];
+        core_load[t.core] += t.load_permille;
+        Serial.printf("%-8s %4d  %4u  %3u.%u%%  %6u / %u bytes\n", t.name, t.core, (unsigned)t.priority,
+                      t.load_permille / 10, t.load_permille % 10, t.stack_free_min, t.stack_size);
+    }
+    Serial.printf("Core 0: %u.%u%% in sniffer tasks | core 1: %u.%u%% in UI and export\n",
+                  core_load[0] / 10, core_load[0] % 10, core_load[1] / 10, core_load[1] % 10);
+    SnifferStatus st;
+    uint32_t version = sniffer_status.read(&st);
+    Serial.printf("Status snapshot v%u, %lu ms old\n", version, millis() - st.published_at);
+}
+
+// Per-channel hopper state for the "hop" command
+void print_hop_stats() {
+    // radio_task owns the hopper; read its last published state
+    SnifferStatus st;
+    sniffer_status.read(&st);
+    uint32_t now = millis();
+    Serial.printf("Hopping %s%s | CH%d for %u ms\n", st.hop_adaptive ? "adaptive" : "fixed",
+                  st.hop_locked ? " (target lock)" : "", st.hop_channel, st.hop_dwell_ms);
+    for (int ch = 1; ch <= HOP_CHANNEL_MAX; ch++) {
+        const HopChannelStats& s = st.hop[ch];
+        Serial.printf("CH%2d  %7.1f fps  %5.2f new/s  %4u visits  %7u ms total  last %u ms ago\n",
+                      ch, s.frame_rate, s.discovery_rate, s.visits, s.dwell_ms_total, now - s.last_visit);
+    }
+}
+
+// Per-channel signal statistics over the sliding window for the "chan" command
+void print_channel_stats() {
+    SnifferStatus st;
+    sniffer_status.read(&st);
+    Serial.printf("Signal over the last %d s (dBm) | tuned to CH%d\n", SIGNAL_WINDOW_MS / 1000, st.current_channel);
+    Serial.printf("Since boot: %d unique frames, %d with Retry (%d%%), %d duplicates dropped, %u filter displacements\n",
+                  st.total_frames, st.retry_frames, retry_pct(st.retry_frames, st.total_frames + st.duplicate_frames),
+                  st.duplicate_frames, st.retry_displaced);
+    Serial.println("CH   frames  span   ewma   min   max   p50   p90 | noise p50  min  max | SNR    | retry");
+    for (int ch = 1; ch <= WIFI_CHANNEL_MAX; ch++) {
+        const SignalSummary& s = st.channels[ch];
+        if (s.frames == 0) {
+            Serial.printf("%2d  %7u     -\n", ch, 0u);
+            continue;
+        }
+        Serial.printf("%2d  %7u  %3lus  %5d  %4d  %4d  %4d  %4d | %9d %4d %4d | %3d dB | %3d%%\n",
+                      ch, s.frames, (millis() - s.window_start) / 1000, s.rssi_ewma, s.rssi_min,
+                      s.rssi_max, s.rssi_p50, s.rssi_p90, s.noise_p50, s.noise_min, s.noise_max, s.snr,
+                      retry_pct(s.retries, s.frames));
+    }
+}
+
+// Flash snapshot state for the "snap" command
+void print_snapshot_stats() {
+    const SnapshotStats& s = registry_snapshot.stats();
+    if (s.sequence == 0) {
+        Serial.printf("Snapshot: none saved | %u saves, %u failed\n", s.saves, s.failures);
+    } else {
+        Serial.printf("Snapshot: slot %c seq %u | %u APs, %u clients, %u names, %u bytes",
+                      s.slot, s.sequence, s.last_aps, s.last_clients, s.last_strings, s.last_bytes);
+        if (s.saves > 0) Serial.printf(" in %u ms, %lu s ago", s.last_save_ms, (millis() - s.last_saved_at) / 1000);
+        Serial.printf(" | %u saves, %u failed\n", s.saves, s.failures);
+    }
+    Serial.printf("Boot: loaded %u APs, %u clients (%u past their TTL skipped) in %u us%s\n",
+                  s.loaded_aps, s.loaded_clients, s.load_stale, s.load_us,
+                  s.load_fallback ? " | newest slot damaged" : "");
+}
+
+// Telemetry stream state for the "telem" command
+void print_telemetry_stats() {
+    static const char* const format_names[] = {"off", "binary", "ndjson"};
+    const TelemetryStats& s = telemetry.stats();
+    // A UART byte takes 10 bit times
+    uint32_t link_bytes = telemetry_link.baud / 10 * telemetry_interval_ms / 1000;
+    Serial.printf("Telemetry: %s every %u ms at %u baud%s\n", format_names[telemetry_format],
+                  telemetry_interval_ms, telemetry_link.baud, pcap_writer.is_enabled() ? " (paused for pcap)" : "");
+    Serial.printf("Sent %u batches, %u frames, %u records, %llu bytes | gone dropped %u\n", s.batches, s.frames,
+                  s.records, (unsigned long long)s.bytes, s.gone_dropped);
+    Serial.printf("Last batch: %u records, %u bytes (%u%% of the link) | encode %u us | %u ms | %u late\n",
+                  s.last_records, s.last_bytes, link_bytes ? (uint32_t)((uint64_t)s.last_bytes * 100 / link_bytes) : 0,
+                  telemetry_link.encode_us, telemetry_link.batch_ms, telemetry_link.late);
+}
+
+// Hardware filter: follows the active card and export mode unless pinned with
+// "filter <profile>". Cards that count airtime or retries and the pcap stream
+// need every frame class. Every other card shows counts that data frames feed
+// (clients per AP, associations, hopper rates), so discovery is only ever pinned,
+// and the telemetry stream, which reports the same counts, overrides even that.
+bool filter_auto = true;
+FilterProfile filter_pinned = FILTER_FULL;
+
+FilterProfile wanted_filter_profile() {
+    FilterProfile profile;
+    if (!filter_auto) {
+        profile = filter_pinned;
+    } else if (pcap_writer.is_enabled()) {
+        profile = FILTER_FULL;
+    } else {
+        switch (current_card) {
+            case AP_HOTSPOTS:
+            case CLIENT_ANALYSIS:
+            case TARGET_HUNT:
+            case SYSTEM_STATUS:
+                profile = FILTER_HUNT;
+                break;
+            default:
+                profile = FILTER_FULL;
+                break;
+        }
+    }
+    if (telemetry_format != TELEMETRY_OFF && profile < FILTER_HUNT) profile = FILTER_HUNT;
+    return profile;
+}
+
+// Per-profile callback rate and CPU cost for the "filter" command
+void print_filter_stats() {
+    FilterStats stats[FILTER_PROFILES];
+    promisc_filter.snapshot(stats, millis());
+    float tpu = probe_ticks_per_us();
+    Serial.printf("Filter: %s (%s)\n", PromiscFilter::name(promisc_filter.active()),
+                  filter_auto ? "auto" : "pinned");
+    Serial.println("Profile    active s  applied  callbacks/s  rx us/cb  parse us/fr  CPU %");
+    for (int i = 0; i < FILTER_PROFILES; i++) {
+        const FilterStats& s = stats[i];
+        if (s.active_ms == 0) {
+            Serial.printf("%-9s  %8s\n", PromiscFilter::name((FilterProfile)i), "-");
+            continue;
+        }
+        // CPU share of one core taken by the callback and the parser together
+        float busy_us = (s.rx_ticks + s.parse_ticks) / tpu;
+        Serial.printf("%-9s  %8.1f  %7u  %11.1f  %8.2f  %11.2f  %5.2f\n",
+                      PromiscFilter::name((FilterProfile)i), s.active_ms / 1000.0f, s.activations,
+                      s.callbacks * 1000.0f / s.active_ms,
+                      s.callbacks ? s.rx_ticks / tpu / s.callbacks : 0.0f,
+                      s.parsed ? s.parse_ticks / tpu / s.parsed : 0.0f,
+                      busy_us / (s.active_ms * 10.0f));
+    }
+}
+
+// Watched targets and their counters for the "watch" command
+void print_watchlist() {
+    static WatchTarget targets[WATCHLIST_MAX];
+    
+    // Copy under the lock, print without it
+    xSemaphoreTake(registry_mutex, portMAX_DELAY);
+    size_t n = watchlist.size();
+    for (size_t i = 0; i < n; i++) targets[i] = watchlist.at(i);
+    xSemaphoreGive(registry_mutex);
+    
+    Serial.printf("Watchlist: %u/%u targets\n", (unsigned)n, WATCHLIST_MAX);
+    for (size_t i = 0; i < n; i++) {
+        const WatchTarget& t = targets[i];
+        char key_str[18], mac_str[18];
+        Watchlist::format(t.key, t.prefix, key_str);
+        t.last_mac.format(mac_str);
+        if (t.tx_packets + t.rx_packets == 0) {
+            Serial.printf("%2u  %-17s  not seen\n", (unsigned)i + 1, key_str);
+            continue;
+        }
+        // Smoothed level, jitter and trend of the frames the target sent
+        RssiReading r;
+        t.rssi_track.read(&r);
+        static const char* const trend_names[] = {"receding", "steady", "approaching"};
+        Serial.printf("%2u  %-17s  %s  %4d dBm (last %d, +/-%.1f, %+.1f dB/s %s)  CH%-2d  TX %u (retry %d%%)  RX %u  last %lu ms ago%s\n",
+                      (unsigned)i + 1, key_str, mac_str, (int)lroundf(r.smoothed), t.rssi, sqrtf(r.variance),
+                      r.slope, trend_names[r.trend + 1], t.channel, t.tx_packets,
+                      retry_pct(t.tx_retries, t.tx_packets + t.tx_duplicates), t.rx_packets,
+                      millis() - t.last_seen, t.found ? "" : " (lost)");
+    }
+}
+
+// Newest frames in the target history for "watch log"
+#define WATCH_LOG_MAX 64
+void print_target_history(int count) {
+    static TargetPacket recent[WATCH_LOG_MAX];
+    if (count < 1) count = 1;
+    if (count > WATCH_LOG_MAX) count = WATCH_LOG_MAX;
+    
+    // Copy under the lock, print without it
+    xSemaphoreTake(registry_mutex, portMAX_DELAY);
+    size_t n = target_history.copy_newest(recent, count);
+    uint32_t held = target_history.size(), pushed = target_history.total_pushed();
+    xSemaphoreGive(registry_mutex);
+    
+    unsigned long now = millis();
+    Serial.printf("Target history: %u of %u frames held (%u total)\n", held, target_history.capacity(), pushed);
+    for (size_t i = n; i-- > 0;) {
+        const TargetPacket& p = recent[i];
+        char mac_str[18];
+        MacAddr::from_bytes(p.mac).format(mac_str);
+        Serial.printf("%8lu ms ago  %s  %s %-8s %4d dBm  CH%d\n", now - p.timestamp, mac_str,
+                      (p.flags & TARGET_PACKET_TX) ? "TX" : "RX", target_frame_name(p.type), p.rssi, p.channel);
+    }
+}
+
+// Serial console commands (one per line)
+void run_serial_command(const char* cmd) {
+    if (strcmp(cmd, "pcap on") == 0) {
+        // Anything written after this point is pcap data until "pcap off". The
+        // stream cannot resync, so core and driver log lines are muted too.
+        Serial.flush();
+        Serial.setDebugOutput(false);
+        esp_log_level_set("*", ESP_LOG_NONE);
+        pcap_writer.set_enabled(true);
+    } else if (strcmp(cmd, "pcap off") == 0) {
+        pcap_writer.set_enabled(false);
+        esp_log_level_set("*", (esp_log_level_t)CONFIG_LOG_DEFAULT_LEVEL);
+        Serial.setDebugOutput(true);
+    } else if (pcap_writer.is_enabled()) {
+        // Serial carries pcap data; text replies would corrupt the stream
+    } else if (strcmp(cmd, "hop fixed") == 0 || strcmp(cmd, "hop adaptive") == 0) {
+        channel_hopper.set_adaptive(strcmp(cmd, "hop adaptive") == 0);
+        Serial.printf("Channel hopping: %s\n", channel_hopper.is_adaptive() ? "adaptive" : "fixed");
+    } else if (strcmp(cmd, "hop") == 0) {
+        print_hop_stats();
+    } else if (strcmp(cmd, "chan") == 0) {
+        print_channel_stats();
+    } else if (strcmp(cmd, "snap") == 0) {
+        print_snapshot_stats();
+    } else if (strcmp(cmd, "snap save") == 0) {
+        snapshot_requested = true;
+        Serial.println("Snapshot requested");
+    } else if (strncmp(cmd, "telem", 5) == 0) {
+        // "telem", "telem <off|bin|json>", "telem full", "telem baud <n>" or "telem interval <ms>"
+        char arg[12];
+        unsigned long value;
+        int n = sscanf(cmd + 5, "%11s %lu", arg, &value);
+        if (n == 1 && strcmp(arg, "off") == 0) telemetry_format = TELEMETRY_OFF;
+        else if (n == 1 && strcmp(arg, "bin") == 0) telemetry_format = TELEMETRY_BINARY;
+        else if (n == 1 && strcmp(arg, "json") == 0) telemetry_format = TELEMETRY_NDJSON;
+        else if (n == 1 && strcmp(arg, "full") == 0) telemetry_full_requested = true;
+        else if (n == 2 && strcmp(arg, "baud") == 0 && value >= 9600 && value <= TELEMETRY_MAX_BAUD) telemetry_baud = value;
+        else if (n == 2 && strcmp(arg, "interval") == 0 && value >= 100 && value <= 60000) telemetry_interval_ms = value;
+        else if (n >= 1) Serial.println("Usage: telem [off | bin | json | full | baud <9600-2000000> | interval <100-60000 ms>]");
+        print_telemetry_stats();
+    } else if (strncmp(cmd, "filter", 6) == 0) {
+        // "filter", "filter reset", "filter auto" or "filter <discovery|hunt|full>"
+        char arg[12];
+        if (sscanf(cmd + 6, "%11s", arg) == 1) {
+            if (strcmp(arg, "auto") == 0) filter_auto = true;
+            else if (strcmp(arg, "reset") == 0) promisc_filter.reset(millis());
+            else if (PromiscFilter::parse(arg, &filter_pinned)) filter_auto = false;
+            else Serial.println("Usage: filter [auto | reset | discovery | hunt | full]");
+            promisc_filter.apply(wanted_filter_profile(), millis());
+        }
+        print_filter_stats();
+    } else if (strncmp(cmd, "ttl", 3) == 0) {
+        // "ttl", "ttl ap <seconds>" or "ttl client <seconds>"
+        char which[8];
+        unsigned long seconds;
+        if (sscanf(cmd + 3, "%7s %lu", which, &seconds) == 2 && seconds > 0) {
+            xSemaphoreTake(registry_mutex, portMAX_DELAY);
+            if (strcmp(which, "ap") == 0) ap_ttl_ms = seconds * 1000;
+            else if (strcmp(which, "client") == 0) client_ttl_ms = seconds * 1000;
+            xSemaphoreGive(registry_mutex);
+        }
+        Serial.printf("TTL: AP %u s, client %u s | expired AP %u, client %u\n",
+                      ap_ttl_ms / 1000, client_ttl_ms / 1000, ap_expired, client_expired);
+    } else if (strncmp(cmd, "mem", 3) == 0) {
+        // "mem" or "mem evict <free bytes>"
+        unsigned long threshold;
+        if (sscanf(cmd + 3, " evict %lu", &threshold) == 1) mem_evict_threshold = threshold;
+        sample_memory();
+        print_mem_stats();
+    } else if (strncmp(cmd, "watch", 5) == 0) {
+        // "watch", "watch add <mac|oui>", "watch del <mac|oui>", "watch clear" or "watch log [n]"
+        char action[8], arg[20];
+        int n = sscanf(cmd + 5, "%7s %19s", action, arg);
+        if (n >= 1 && strcmp(action, "log") == 0) {
+            print_target_history(n == 2 ? atoi(arg) : 20);
+            return;
+        }
+        MacAddr key;
+        bool prefix;
+        bool is_add = n == 2 && strcmp(action, "add") == 0;
+        bool is_del = n == 2 && strcmp(action, "del") == 0;
+        bool is_clear = n == 1 && strcmp(action, "clear") == 0;
+        if ((is_add || is_del) && !Watchlist::parse(arg, &key, &prefix)) is_add = is_del = false;
         
-        // Update or create client entry for source
-        ClientInfo& src_client = client_registry[src_mac];
-        src_client.mac = src_mac;
-        src_client.frame_count++;
-        src_client.last_seen = millis();
-        src_client.rssi = ctrl.rssi;
-        if (src_client.vendor.length() == 0) {
-            src_client.vendor = get_vendor_from_mac(src_mac);
+        if (is_add || is_del || is_clear) {
+            xSemaphoreTake(registry_mutex, portMAX_DELAY);
+            bool changed = true;
+            if (is_add) changed = watchlist.add(key, prefix);
+            else if (is_del) changed = watchlist.remove(key, prefix);
+            else watchlist.clear();
+            xSemaphoreGive(registry_mutex);
+            // Only this task changes the keys, so the flash write needs no lock
+            if (changed && !watchlist_save(watchlist)) Serial.println("Watchlist not saved to NVS");
+            if (!changed) Serial.println(is_add ? "Already watched or list full" : "Not watched");
+        } else if (n >= 1) {
+            Serial.println("Usage: watch [add <mac|oui> | del <mac|oui> | clear]");
+        }
+        print_watchlist();
+    } else if (strcmp(cmd, "tasks") == 0) {
+        print_task_stats();
+    } else if (strcmp(cmd, "lat") == 0) {
+        print_latency_probes();
+        Serial.printf("Capture ring: %u dropped | peak %u/%u | %u truncated\n",
+                      capture_ring.dropped(), capture_ring.peak(), capture_ring.capacity(), frames_truncated);
+    } else if (strcmp(cmd, "lat reset") == 0) {
+        latency_probes_reset();
+        Serial.println("Latency probes reset");
+    } else if (strcmp(cmd, "ui") == 0) {
+        Serial.printf("UI: %u objects | %u refreshes | update %u us | render %u ms, %u px | flushed %llu bytes\n",
+                      ui_stats.objects_created, ui_stats.refreshes, ui_stats.update_us,
+                      ui_stats.render_ms, ui_stats.render_px, (unsigned long long)ui_stats.bytes_flushed);
+        // Bus time is what the bytes cost at the SPI clock; wait is how much of it the CPU saw
+        Serial.printf("Display: %d-line bands x2 | %u flushes | frame %u us, %u bytes | bus %u us | CPU wait %u us (%llu total)\n",
+                      DISPLAY_BAND_LINES, ui_stats.flushes, ui_stats.frame_us, ui_stats.frame_bytes,
+                      (uint32_t)((uint64_t)ui_stats.frame_bytes * 8 * 1000000 / DISPLAY_SPI_FREQ),
+                      ui_stats.frame_wait_us, (unsigned long long)ui_stats.dma_wait_us);
+    } else {
+        Serial.printf("Unknown command: %s\n", cmd);
+    }
+}
+
+void handle_serial_commands() {
+    static char line[48];
+    static size_t len = 0;
+    
+    while (Serial.available() > 0) {
+        int c = Serial.read();
+        if (c == '\r' || c == '\n') {
+            line[len] = '\0';
+            if (len > 0) run_serial_command(line);
+            len = 0;
+        } else if (len < sizeof(line) - 1) {
+            line[len++] = (char)c;
         }
+    }
+}
+
+// Core 1: touch and serial input, card refreshes and LVGL rendering. The only
+// task that calls into LVGL.
+void ui_task(void* /* arg */) {
+    TickType_t last_wake = xTaskGetTickCount();
+    unsigned long last_sample = 0;
+    for (;;) {
+        uint32_t start_us = micros();
+        frame_count++;
         
-        // Associate with nearby AP if not already associated
-        if (src_client.connected_ap.length() == 0) {
-            String nearest_ap = find_closest_ap(src_mac, ctrl.rssi, millis());
-            if (nearest_ap.length() > 0) {
-                src_client.connected_ap = nearest_ap;
-            }
+        // Handle touch and serial inputs
+        handle_touch_input();
+        handle_serial_commands();
+        
+        unsigned long refresh_ms = current_card == TARGET_HUNT ? TARGET_REFRESH_MS : UI_REFRESH_MS;
+        if (millis() - last_display_update > refresh_ms) {
+            update_card_content();
+            last_display_update = millis();
         }
+        promisc_filter.apply(wanted_filter_profile(), millis());
         
-    } else if (type == WIFI_PKT_CTRL) {
-        ctrl_frames++;
-        // Control frames don't have standard 802.11 header, just count them
+        // Animate title
+        float pulse = sin(frame_count * 0.05) * 0.3 + 0.7;
+        lv_color_t color = lv_color_make(0, (uint8_t)(pulse * 255), (uint8_t)(pulse * 255));
+        lv_obj_set_style_text_color(title_label, color, LV_PART_MAIN);
         
-    } else {
-        // Catch any other packet types
-        ctrl_frames++; // Count as control for now
+        // Memory and task accounting once a second; memory pressure shortens the TTLs
+        if (millis() - last_sample > 1000) {
+            sample_memory();
+            sample_tasks();
+            last_sample = millis();
+        }
+        
+        {
+            PROBE_SCOPE(PROBE_RENDER);
+            lv_timer_handler();
+            display_flush_finish();
+        }
+        task_busy(TASK_UI, start_us);
+        vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(UI_FRAME_MS));
     }
 }
 
+void start_task(TaskId id, TaskFunction_t fn) {
+    TaskStats& t = task_stats[id];
+    xTaskCreatePinnedToCore(fn, t.name, t.stack_size, NULL, t.priority, &t.handle, t.core);
+}
+
 void setup() {
-    Serial.begin(115200);
+    Serial.begin(SERIAL_BAUD);
     delay(2000);
+    latency_probes_init();
     
     Serial.println("WiFi Sniffer + Display starting...");
     
+    // Created first: the first card refresh below already takes it
+    registry_mutex = xSemaphoreCreateMutex();
+    
     // Initialize display
     if (!tft.begin()) {
         Serial.println("Display failed!");
         while(1) delay(100);
     }
     
+    tft.initDMA();
+    
+    // Two band buffers so rendering overlaps the SPI transfer
+    for (int i = 0; i < 2; i++) {
+        band_buf[i] = (lv_color_t*)heap_caps_malloc(DISPLAY_BAND_PIXELS * sizeof(lv_color_t),
+                                                     MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+        if (band_buf[i] == nullptr) {
+            Serial.println("Display buffer allocation failed!");
+            while(1) delay(100);
+        }
+    }
+    
     // Initialize LVGL
     lv_init();
-    lv_disp_draw_buf_init(&draw_buf, buf, NULL, 240 * 20);
+    lv_disp_draw_buf_init(&draw_buf, band_buf[0], band_buf[1], DISPLAY_BAND_PIXELS);
     
     static lv_disp_drv_t disp_drv;
     lv_disp_drv_init(&disp_drv);
     disp_drv.hor_res = 240;
     disp_drv.ver_res = 240;
     disp_drv.flush_cb = my_disp_flush;
+    disp_drv.monitor_cb = my_disp_monitor;
     disp_drv.draw_buf = &draw_buf;
     lv_disp_drv_register(&disp_drv);
     
     create_main_ui();
+    sample_memory();
     update_card_content();
     
     // Initialize WiFi sniffer
@@ -1219,89 +1784,52 @@ void setup() {
     }
     ESP_ERROR_CHECK(ret);
     
+    // Registries are preallocated so the parser never grows the heap
+    if (!sniffer_init()) {
+        Serial.println("Registry allocation failed!");
+        while(1) delay(100);
+    }
+    
+    // Warm start from the newest registry snapshot, before any frame arrives
+    if (LittleFS.begin(true) && registry_snapshot.begin(SNAPSHOT_DIR)) {
+        if (registry_snapshot.load(millis())) {
+            const SnapshotStats& s = registry_snapshot.stats();
+            Serial.printf("Snapshot %c loaded: %u APs, %u clients in %u us\n",
+                          s.slot, s.loaded_aps, s.loaded_clients, s.load_us);
+        }
+    } else {
+        Serial.println("LittleFS unavailable, registry snapshots off");
+    }
+    
+    // Parser task drains capture_ring; it must exist before frames arrive
+    start_task(TASK_PARSER, parser_task);
+    start_task(TASK_PCAP, pcap_export_task);
+    start_task(TASK_STORE, store_task);
+    
+    // Removals reach the stream through expiry; the buffer is taken once, up front
+    if (telemetry.begin()) {
+        set_expiry_callback(telemetry_expired, nullptr);
+        start_task(TASK_TELEMETRY, telemetry_task);
+    } else {
+        Serial.println("Telemetry buffer allocation failed, telemetry off");
+    }
+    
     wifi_init_config_t cfg = WIFI_INIT_CONFIG_DEFAULT();
     ESP_ERROR_CHECK(esp_wifi_init(&cfg));
     ESP_ERROR_CHECK(esp_wifi_set_mode(WIFI_MODE_NULL));
     ESP_ERROR_CHECK(esp_wifi_start());
     ESP_ERROR_CHECK(esp_wifi_set_promiscuous(true));
     ESP_ERROR_CHECK(esp_wifi_set_promiscuous_rx_cb(&wifi_sniffer_packet_handler));
+    promisc_filter.apply(wanted_filter_profile(), millis());
     ESP_ERROR_CHECK(esp_wifi_set_channel(current_channel, WIFI_SECOND_CHAN_NONE));
+    channel_hopper.begin(current_channel, millis());
     
-    // Initialize channel stats
-    for (int i = 1; i <= 13; i++) {
-        channel_stats[i].ap_count = 0;
-        channel_stats[i].total_frames = 0;
-        channel_stats[i].avg_rssi = 0;
-        channel_stats[i].last_activity = 0;
-    }
-    
+    start_task(TASK_RADIO, radio_task);
+    start_task(TASK_UI, ui_task);
     Serial.println("System ready!");
 }
 
+// Everything runs in the tasks started by setup()
 void loop() {
-    frame_count++;
-    
-    // Handle touch inputs
-    handle_touch_input();
-    
-    // Channel hopping
-    if (millis() - last_channel_switch > WIFI_CHANNEL_SWITCH_INTERVAL) {
-  current_channel = (current_channel % WIFI_CHANNEL_MAX) + 1;
-  esp_wifi_set_channel(current_channel, WIFI_SECOND_CHAN_NONE);
-  last_channel_switch = millis();
-        Serial.printf("Switched to channel %d\n", current_channel);
-    }
-    
-    // Update display every 2 seconds
-    if (millis() - last_display_update > 2000) {
-        update_card_content();
-        last_display_update = millis();
-    }
-    
-    // Animate title
-    float pulse = sin(frame_count * 0.05) * 0.3 + 0.7;
-    lv_color_t color;
-    color.ch.red = 0;
-    color.ch.green = (uint8_t)(pulse * 255);
-    color.ch.blue = (uint8_t)(pulse * 255);
-    lv_obj_set_style_text_color(title_label, color, LV_PART_MAIN);
-    
-    // Clean up only very old entries every 60 seconds (KEEP MORE HISTORY)
-    static unsigned long last_cleanup = 0;
-    if (millis() - last_cleanup > 60000) {
-        // Remove only very old APs (5 minutes)
-        for (auto it = ap_registry.begin(); it != ap_registry.end();) {
-            if (millis() - it->second.last_seen > 300000) {
-                it = ap_registry.erase(it);
-            } else {
-                ++it;
-            }
-        }
-        // Remove only very old clients (2 minutes)  
-        for (auto it = client_registry.begin(); it != client_registry.end();) {
-            if (millis() - it->second.last_seen > 120000) {
-                it = client_registry.erase(it);
-            } else {
-                ++it;
-            }
-        }
-        
-        // Reset channel stats only if very old
-        for (int i = 1; i <= 13; i++) {
-            if (millis() - channel_stats[i].last_activity > 60000) {
-                channel_stats[i].ap_count = 0;
-                channel_stats[i].total_frames = 0;
-            }
-        }
-        
-        // Check if target is still active (longer timeout)
-        if (target_found && millis() - target_last_seen > 60000) {
-            target_found = false;
-        }
-        
-        last_cleanup = millis();
-    }
-    
-    lv_timer_handler();
-    delay(30);
-} 
\ No newline at end of file
+    vTaskDelete(NULL);
+}
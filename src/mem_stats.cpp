@@ -0,0 +1,107 @@
+// Memory accounting for the SYSTEM card and the "mem" command
+
+#include "mem_stats.h"
+#include "sniffer.h"
+#include "pool_alloc.h"
+#include "registry_snapshot.h"
+#include "telemetry.h"
+#ifdef ESP_PLATFORM
+#include "esp_heap_caps.h"
+#endif
+
+MemStats mem_stats;
+size_t mem_evict_threshold = MEM_EVICT_THRESHOLD;
+
+static const char* const POOL_NAMES[MEM_POOLS] = { "heap", "psram", "lvgl" };
+static const char* const SUBSYSTEM_NAMES[MEM_SUBSYSTEMS] = {
+    "AP registry", "client registry", "SSID arena", "target packets", "capture ring", "pcap ring", "display", "snapshot",
+    "telemetry"
+};
+
+void mem_set_pool(MemPoolId id, size_t total, size_t free, size_t largest_free, size_t min_free) {
+    MemPoolStats& p = mem_stats.pools[id];
+    // A pool that appears (or grows) resets its low-water mark
+    if (total != p.total) p.min_free = free;
+    p.total = total;
+    p.free = free;
+    p.largest_free = largest_free;
+    if (min_free != MEM_MIN_FREE_SAMPLED) p.min_free = min_free;
+    else if (free < p.min_free) p.min_free = free;
+}
+
+void mem_set_subsystem(MemSubsystem id, size_t used, size_t reserved) {
+    MemSubsystemStats& s = mem_stats.subsystems[id];
+    s.used = used;
+    s.reserved = reserved;
+    if (used > s.peak_used) s.peak_used = used;
+}
+
+int mem_pool_used_pct(MemPoolId id) {
+    const MemPoolStats& p = mem_stats.pools[id];
+    if (p.total == 0) return 0;
+    return (int)((p.total - p.free) * 100 / p.total);
+}
+
+void mem_stats_update() {
+#ifdef ESP_PLATFORM
+    mem_set_pool(MEM_POOL_INTERNAL, heap_caps_get_total_size(MALLOC_CAP_INTERNAL),
+                 heap_caps_get_free_size(MALLOC_CAP_INTERNAL),
+                 heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL),
+                 heap_caps_get_minimum_free_size(MALLOC_CAP_INTERNAL));
+    mem_set_pool(MEM_POOL_PSRAM, heap_caps_get_total_size(MALLOC_CAP_SPIRAM),
+                 heap_caps_get_free_size(MALLOC_CAP_SPIRAM),
+                 heap_caps_get_largest_free_block(MALLOC_CAP_SPIRAM),
+                 heap_caps_get_minimum_free_size(MALLOC_CAP_SPIRAM));
+#else
+    size_t live = host_heap_live - host_heap_base;
+    if (live > HOST_HEAP_SIZE) live = HOST_HEAP_SIZE;
+    mem_set_pool(MEM_POOL_INTERNAL, HOST_HEAP_SIZE, HOST_HEAP_SIZE - live, HOST_HEAP_SIZE - live);
+#endif
+    
+    mem_set_subsystem(MEM_AP_REGISTRY, ap_registry.size() * sizeof(MacTable<APInfo>::Entry),
+                      ap_registry.footprint());
+    mem_set_subsystem(MEM_CLIENT_REGISTRY, client_registry.size() * sizeof(MacTable<ClientInfo>::Entry),
+                      client_registry.footprint());
+    mem_set_subsystem(MEM_SSID_ARENA, ssid_arena.used(), ssid_arena.footprint());
+    mem_set_subsystem(MEM_TARGET_PACKETS, target_history.size() * sizeof(TargetPacket),
+                      target_history.footprint());
+    mem_set_subsystem(MEM_CAPTURE_RING, capture_ring.available() * sizeof(CapturedFrame),
+                      sizeof(capture_ring));
+    mem_set_subsystem(MEM_SNAPSHOT, registry_snapshot.saving() ? registry_snapshot.footprint() : 0,
+                      registry_snapshot.footprint());
+    mem_set_subsystem(MEM_TELEMETRY, telemetry.get_format() != TELEMETRY_OFF ? telemetry.footprint() : 0,
+                      telemetry.footprint());
+    
+    // Enter pressure below the threshold, leave it a quarter above to avoid flapping
+    size_t free = mem_stats.pools[MEM_POOL_INTERNAL].free;
+    if (!mem_stats.pressure && free < mem_evict_threshold) {
+        mem_stats.pressure = true;
+        mem_stats.pressure_events++;
+    } else if (mem_stats.pressure && free > mem_evict_threshold + mem_evict_threshold / 4) {
+        mem_stats.pressure = false;
+    }
+}
+
+void print_mem_stats() {
+    for (int i = 0; i < MEM_POOLS; i++) {
+        const MemPoolStats& p = mem_stats.pools[i];
+        if (p.total == 0) {
+            Serial.printf("%-6s none\n", POOL_NAMES[i]);
+            continue;
+        }
+        Serial.printf("%-6s %u/%u bytes free (%d%% used) | low %u | largest block %u\n",
+                      POOL_NAMES[i], (unsigned)p.free, (unsigned)p.total, mem_pool_used_pct((MemPoolId)i),
+                      (unsigned)p.min_free, (unsigned)p.largest_free);
+    }
+    for (int i = 0; i < MEM_SUBSYSTEMS; i++) {
+        const MemSubsystemStats& s = mem_stats.subsystems[i];
+        Serial.printf("  %-16s %7u used | %7u reserved | %7u peak\n",
+                      SUBSYSTEM_NAMES[i], (unsigned)s.used, (unsigned)s.reserved, (unsigned)s.peak_used);
+    }
+    Serial.printf("Pools: %u bytes in PSRAM, %u in internal RAM | SSID arena %u strings, %u compactions\n",
+                  (unsigned)pool_psram_bytes, (unsigned)pool_internal_bytes,
+                  (unsigned)ssid_arena.strings(), ssid_arena.flips());
+    Serial.printf("Pressure: %s (threshold %u bytes free, %u events)\n",
+                  mem_stats.pressure ? "YES, TTLs shortened" : "no",
+                  (unsigned)mem_evict_threshold, mem_stats.pressure_events);
+}
@@ -0,0 +1,36 @@
+// OUI vendor lookup over the generated table
+
+#include "oui.h"
+#include "oui_table.h"
+
+// Index of key in a sorted, power-of-two sized array, or -1. The loop has no
+// data-dependent branch: each step is a compare and a select.
+template <typename K>
+static int find_key(const K* keys, unsigned size, K key) {
+    const K* base = keys;
+    for (unsigned n = size; n > 1; n >>= 1) {
+        base = (base[n >> 1] <= key) ? base + (n >> 1) : base;
+    }
+    return *base == key ? (int)(base - keys) : -1;
+}
+
+const char* oui_vendor(MacAddr mac) {
+    // Most specific registry first: MA-M and MA-S blocks sit inside MA-L
+    // prefixes assigned to the IEEE itself. Empty tables fold away.
+    int i;
+    if (OUI_MAS_COUNT > 0) {
+        i = find_key<uint64_t>(OUI_MAS_KEYS, OUI_MAS_SIZE, mac.value >> 12);
+        if (i >= 0) return OUI_NAMES + OUI_MAS_NAMES[i];
+    }
+    if (OUI_MAM_COUNT > 0) {
+        i = find_key<uint32_t>(OUI_MAM_KEYS, OUI_MAM_SIZE, (uint32_t)(mac.value >> 20));
+        if (i >= 0) return OUI_NAMES + OUI_MAM_NAMES[i];
+    }
+    i = find_key<uint32_t>(OUI_MAL_KEYS, OUI_MAL_SIZE, mac.oui());
+    if (i >= 0) return OUI_NAMES + OUI_MAL_NAMES[i];
+    return nullptr;
+}
+
+unsigned oui_table_size() {
+    return OUI_MAL_COUNT + OUI_MAM_COUNT + OUI_MAS_COUNT;
+}
@@ -0,0 +1,195 @@
+// Generated by tools/gen_oui.py from: tools/oui_seed.csv. Do not edit.
+// Keys are sorted and padded with all-ones keys to a power of two; each value
+// is an offset into OUI_NAMES.
+
+#ifndef OUI_TABLE_H
+#define OUI_TABLE_H
+
+#include <stdint.h>
+
+static constexpr char OUI_NAMES[] =
+    "AVM\0"
+    "Amazon\0"
+    "Apple\0"
+    "Arduino\0"
+    "Cisco\0"
+    "Dell\0"
+    "Espressif\0"
+    "Google\0"
+    "HP\0"
+    "HUAWEI\0"
+    "Intel\0"
+    "Linksys\0"
+    "Meraki\0"
+    "Microsoft\0"
+    "NETGEAR\0"
+    "Nest Labs\0"
+    "Nintendo\0"
+    "OnePlus\0"
+    "RaspPi\0"
+    "Realtek\0"
+    "Roku\0"
+    "Samsung\0"
+    "Sonos\0"
+    "TP-LINK\0"
+    "Ubiquiti\0"
+    "VBox\0"
+    "VMware\0"
+    "Xensource\0"
+    ;
+
+static constexpr unsigned OUI_MAL_COUNT = 320;      // Real entries
+static constexpr unsigned OUI_MAL_SIZE = 512;       // Padded length
+static constexpr uint32_t OUI_MAL_KEYS[OUI_MAL_SIZE] = {
+    0x00000C, 0x0001E6, 0x0002A5, 0x0002B3, 0x000347, 0x000393,
+    0x0003FF, 0x00040E, 0x000423, 0x000569, 0x00065B, 0x0007E9,
+    0x000874, 0x00095B, 0x0009BF, 0x000A27, 0x000A95, 0x000BCD,
+    0x000BDB, 0x000C29, 0x000C41, 0x000CF1, 0x000D3A, 0x000D56,
+    0x000D93, 0x000D9D, 0x000E0C, 0x000E35, 0x000E58, 0x000E7F,
+    0x000F1F, 0x000F20, 0x000F66, 0x000FB5, 0x001083, 0x0010FA,
+    0x00110A, 0x001111, 0x001124, 0x001143, 0x001185, 0x001217,
+    0x00123F, 0x001247, 0x00125A, 0x001279, 0x0012F0, 0x001302,
+    0x001310, 0x001320, 0x001321, 0x001372, 0x0013CE, 0x0013E8,
+    0x001422, 0x001438, 0x001451, 0x00146C, 0x0014BF, 0x0014C2,
+    0x001500, 0x00150C, 0x00155D, 0x001560, 0x00156D, 0x001599,
+    0x0015C5, 0x001632, 0x001635, 0x00163E, 0x001656, 0x00166F,
+    0x001676, 0x0016B6, 0x0016CB, 0x0016EA, 0x0016EB, 0x001708,
+    0x0017A4, 0x0017AB, 0x0017F2, 0x0017FA, 0x00180A, 0x001839,
+    0x00184D, 0x001871, 0x001882, 0x00188B, 0x0018DE, 0x0018F8,
+    0x0018FE, 0x00191D, 0x0019B9, 0x0019BB, 0x0019D1, 0x0019D2,
+    0x0019E3, 0x001A4B, 0x001A70, 0x001AA0, 0x001AE9, 0x001B21,
+    0x001B2F, 0x001B63, 0x001B77, 0x001B78, 0x001B7A, 0x001C10,
+    0x001C14, 0x001C23, 0x001C4A, 0x001CB3, 0x001CBF, 0x001CC4,
+    0x001D09, 0x001D25, 0x001D4F, 0x001D7E, 0x001DE0, 0x001DE1,
+    0x001E0B, 0x001E10, 0x001E2A, 0x001E4F, 0x001E52, 0x001E64,
+    0x001E65, 0x001EC2, 0x001EE5, 0x001F29, 0x001F32, 0x001F33,
+    0x001F3B, 0x001F3C, 0x001F3F, 0x001F5B, 0x001FF3, 0x002119,
+    0x002129, 0x002147, 0x00215A, 0x00215C, 0x00215D, 0x00216A,
+    0x00216B, 0x002170, 0x00219B, 0x0021E9, 0x002219, 0x00223F,
+    0x002241, 0x00224C, 0x002264, 0x00226B, 0x0022AA, 0x0022FA,
+    0x0022FB, 0x002312, 0x002332, 0x002339, 0x002369, 0x00236C,
+    0x00237D, 0x0023AE, 0x0023DF, 0x00241E, 0x002436, 0x002444,
+    0x002481, 0x0024B2, 0x0024D6, 0x0024D7, 0x0024E8, 0x0024FE,
+    0x002500, 0x00254B, 0x002564, 0x00259C, 0x00259E, 0x0025A0,
+    0x0025B3, 0x0025BC, 0x002608, 0x00264A, 0x002655, 0x0026B0,
+    0x0026B9, 0x0026BB, 0x0026C6, 0x0026C7, 0x0026F2, 0x002722,
+    0x005056, 0x0050F2, 0x00E04C, 0x00E0FC, 0x0418D6, 0x080027,
+    0x080581, 0x083AF2, 0x0896D7, 0x10521C, 0x14CC20, 0x14FEB5,
+    0x180373, 0x18B430, 0x18FE34, 0x20E52A, 0x240AC4, 0x2462AB,
+    0x246511, 0x246F28, 0x24A43C, 0x2811A5, 0x281878, 0x286ED4,
+    0x28CDC1, 0x2C91AB, 0x2CCF67, 0x30AEA4, 0x30C6F7, 0x342EB7,
+    0x347E5C, 0x3810D5, 0x3C5AB4, 0x3C71BF, 0x3CA62F, 0x40F407,
+    0x444E6D, 0x44650D, 0x44D9E7, 0x4846FB, 0x48A6B8, 0x50C7BF,
+    0x546009, 0x58BF25, 0x5C0A5B, 0x5C4979, 0x5CAAFD, 0x5CCF7F,
+    0x600194, 0x6045BD, 0x641666, 0x647002, 0x64A2F9, 0x6837E9,
+    0x687251, 0x74427F, 0x7483C2, 0x74C246, 0x7828CA, 0x788A20,
+    0x78E36D, 0x7C1E52, 0x7C9EBD, 0x7CBB8A, 0x7CFF4D, 0x802AA8,
+    0x840D8E, 0x84CCA8, 0x84D6D0, 0x881544, 0x8C7712, 0x8CAAB5,
+    0x94652D, 0x949F3E, 0x94B97E, 0x989BCB, 0x98B6E9, 0x98DAC4,
+    0x98F4AB, 0x9CC7A6, 0x9CD36D, 0xA040A0, 0xA47B9D, 0xA4CF12,
+    0xA8610A, 0xAC17C8, 0xAC3A7A, 0xAC67B2, 0xACDE48, 0xB0A737,
+    0xB4FBE4, 0xB827EB, 0xB8AC6F, 0xB8E937, 0xBC0543, 0xBCDDC2,
+    0xC02506, 0xC04A00, 0xC0EEFB, 0xC40415, 0xC80E14, 0xC82B96,
+    0xCC50E3, 0xCC6DA0, 0xD4BED9, 0xD83134, 0xD83ADD, 0xD8A01D,
+    0xDC396F, 0xDC3A5E, 0xDC9FDB, 0xDCA632, 0xE0286D, 0xE0553D,
+    0xE063DA, 0xE45F01, 0xE8DB84, 0xEC086B, 0xECFABC, 0xF01898,
+    0xF0272D, 0xF09FC2, 0xF4F26D, 0xF4F5D8, 0xF4F5E8, 0xF8B156,
+    0xFC65DE, 0xFCECDA, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu,
+    0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu,
+    0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu,
+    0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu,
+    0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu,
+    0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu,
+    0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu,
+    0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu,
+    0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu,
+    0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu,
+    0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu,
+    0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu,
+    0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu,
+    0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu,
+    0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu,
+    0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu,
+    0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu,
+    0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu,
+    0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu,
+    0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu,
+    0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu,
+    0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu,
+    0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu,
+    0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu,
+    0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu,
+    0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu,
+    0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu,
+    0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu,
+    0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu,
+    0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu,
+    0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu,
+    0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu,
+    0xFFFFFFFFu, 0xFFFFFFFFu,
+};
+static constexpr uint16_t OUI_MAL_NAMES[OUI_MAL_SIZE] = {
+    25, 53, 53, 63, 63, 11, 84, 0, 63, 185, 31, 63,
+    31, 94, 112, 11, 11, 53, 31, 185, 69, 63, 84, 31,
+    11, 53, 63, 63, 157, 53, 31, 53, 69, 94, 53, 11,
+    53, 63, 11, 31, 53, 69, 31, 149, 84, 53, 63, 63,
+    69, 63, 53, 31, 63, 63, 31, 53, 11, 94, 69, 53,
+    63, 0, 84, 53, 171, 149, 31, 149, 53, 192, 112, 63,
+    63, 69, 11, 63, 63, 53, 53, 112, 11, 84, 77, 69,
+    94, 53, 56, 31, 63, 69, 53, 112, 31, 53, 63, 63,
+    11, 53, 69, 31, 112, 63, 94, 11, 63, 53, 112, 69,
+    185, 31, 0, 11, 63, 53, 31, 149, 11, 69, 63, 63,
+    53, 56, 94, 31, 11, 63, 63, 11, 69, 53, 112, 94,
+    63, 63, 0, 11, 11, 149, 69, 112, 53, 63, 63, 63,
+    63, 31, 31, 11, 31, 94, 11, 112, 53, 69, 112, 63,
+    63, 11, 11, 149, 69, 11, 53, 31, 11, 112, 11, 112,
+    53, 94, 63, 63, 31, 0, 11, 11, 31, 69, 56, 112,
+    53, 11, 11, 11, 53, 11, 31, 11, 63, 63, 94, 171,
+    185, 84, 136, 56, 171, 180, 144, 36, 0, 36, 163, 31,
+    31, 102, 36, 94, 36, 36, 0, 36, 171, 149, 84, 56,
+    129, 0, 129, 36, 36, 149, 157, 0, 46, 36, 0, 112,
+    0, 4, 171, 56, 157, 163, 46, 36, 149, 0, 157, 36,
+    36, 84, 102, 163, 121, 4, 171, 0, 171, 4, 157, 171,
+    36, 84, 36, 112, 0, 171, 36, 36, 4, 77, 149, 36,
+    121, 157, 36, 0, 112, 163, 36, 0, 94, 94, 36, 36,
+    17, 77, 144, 36, 11, 144, 171, 129, 31, 157, 0, 36,
+    0, 163, 121, 94, 0, 36, 36, 144, 31, 144, 129, 36,
+    0, 144, 171, 129, 0, 77, 171, 129, 36, 163, 36, 11,
+    4, 171, 163, 46, 46, 31, 4, 171, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0,
+};
+
+static constexpr unsigned OUI_MAM_COUNT = 0;      // Real entries
+static constexpr unsigned OUI_MAM_SIZE = 1;       // Padded length
+static constexpr uint32_t OUI_MAM_KEYS[OUI_MAM_SIZE] = {
+    0xFFFFFFFFu,
+};
+static constexpr uint16_t OUI_MAM_NAMES[OUI_MAM_SIZE] = {
+    0,
+};
+
+static constexpr unsigned OUI_MAS_COUNT = 0;      // Real entries
+static constexpr unsigned OUI_MAS_SIZE = 1;       // Padded length
+static constexpr uint64_t OUI_MAS_KEYS[OUI_MAS_SIZE] = {
+    0xFFFFFFFFFFFFFFFFull,
+};
+static constexpr uint16_t OUI_MAS_NAMES[OUI_MAS_SIZE] = {
+    0,
+};
+
+#endif // OUI_TABLE_H
@@ -0,0 +1,112 @@
+// pcap + radiotap encoding of captured frames
+
+#include "pcap_export.h"
+#include <string.h>
+
+#define LINKTYPE_IEEE802_11_RADIOTAP 127
+
+// Radiotap present bits
+#define RT_TSFT         (1u << 0)
+#define RT_FLAGS        (1u << 1)
+#define RT_RATE         (1u << 2)
+#define RT_CHANNEL      (1u << 3)
+#define RT_DBM_SIGNAL   (1u << 5)
+#define RT_DBM_NOISE    (1u << 6)
+#define RT_MCS          (1u << 19)
+
+#define RT_FLAG_FCS     0x10         // Frame includes FCS
+#define RT_CHAN_CCK     0x0020
+#define RT_CHAN_OFDM    0x0040
+#define RT_CHAN_2GHZ    0x0080
+
+// rx_ctrl.rate (wifi_phy_rate_t) to radiotap rate in 500 kbps units
+static const uint8_t PHY_RATE_500K[16] = {
+    2, 4, 11, 22, 0, 4, 11, 22,       // 1M 2M 5.5M 11M long, -, 2M 5.5M 11M short
+    96, 48, 24, 12, 108, 72, 36, 18   // 48M 24M 12M 6M 54M 36M 18M 9M
+};
+
+static inline void put_le16(uint8_t* p, uint16_t v) { p[0] = v; p[1] = v >> 8; }
+static inline void put_le32(uint8_t* p, uint32_t v) { put_le16(p, v); put_le16(p + 2, v >> 16); }
+static inline void put_le64(uint8_t* p, uint64_t v) { put_le32(p, v); put_le32(p + 4, v >> 32); }
+
+size_t pcap_global_header(uint8_t* out) {
+    put_le32(out, 0xA1B2C3D4);        // Microsecond timestamps
+    put_le16(out + 4, 2);
+    put_le16(out + 6, 4);
+    put_le32(out + 8, 0);             // thiszone
+    put_le32(out + 12, 0);            // sigfigs
+    put_le32(out + 16, RADIOTAP_MAX_LEN + CAPTURE_SNAP_LEN);
+    put_le32(out + 20, LINKTYPE_IEEE802_11_RADIOTAP);
+    return PCAP_GLOBAL_HEADER_LEN;
+}
+
+size_t radiotap_header(uint8_t* out, const CapturedFrame& f, uint64_t tsf_us) {
+    bool ht = f.sig_mode != 0;
+    uint8_t rate = PHY_RATE_500K[f.rate & 0x0F];
+    bool cck = !ht && f.rate <= 7;
+
+    uint32_t present = RT_TSFT | RT_FLAGS | RT_CHANNEL | RT_DBM_SIGNAL | RT_DBM_NOISE;
+    if (ht) present |= RT_MCS;
+    else if (rate != 0) present |= RT_RATE;
+
+    // Fields in present-bit order, each aligned to its natural size
+    size_t p = 8;
+    put_le64(out + p, tsf_us);
+    p += 8;
+    out[p++] = (f.cap_len == f.sig_len) ? RT_FLAG_FCS : 0;
+    if (present & RT_RATE) out[p++] = rate;
+    if (p & 1) out[p++] = 0;
+    uint16_t freq = (f.channel == 14) ? 2484 : 2407 + 5 * f.channel;
+    put_le16(out + p, freq);
+    put_le16(out + p + 2, RT_CHAN_2GHZ | (cck ? RT_CHAN_CCK : RT_CHAN_OFDM));
+    p += 4;
+    out[p++] = (uint8_t)f.rssi;
+    out[p++] = (uint8_t)f.noise_floor;
+    if (ht) {
+        out[p++] = 0x07;              // Known: bandwidth, MCS index, guard interval
+        out[p++] = ((f.ht_flags & CAPTURE_HT_40MHZ) ? 0x01 : 0x00) |
+                   ((f.ht_flags & CAPTURE_HT_SGI) ? 0x04 : 0x00);
+        out[p++] = f.mcs;
+    }
+
+    out[0] = 0;                       // Version
+    out[1] = 0;                       // Pad
+    put_le16(out + 2, p);
+    put_le32(out + 4, present);
+    return p;
+}
+
+size_t pcap_record(uint8_t* out, const CapturedFrame& f, uint64_t ts_us) {
+    size_t rt_len = radiotap_header(out + PCAP_RECORD_HEADER_LEN, f, ts_us);
+    memcpy(out + PCAP_RECORD_HEADER_LEN + rt_len, f.data, f.cap_len);
+
+    put_le32(out, (uint32_t)(ts_us / 1000000));
+    put_le32(out + 4, (uint32_t)(ts_us % 1000000));
+    put_le32(out + 8, rt_len + f.cap_len);
+    put_le32(out + 12, rt_len + f.sig_len);
+    return PCAP_RECORD_HEADER_LEN + rt_len + f.cap_len;
+}
+
+void PcapWriter::on_frame(const CapturedFrame& f) {
+    if (!enabled.load(std::memory_order_relaxed)) return;
+
+    if (header_pending.load()) {
+        uint8_t hdr[PCAP_GLOBAL_HEADER_LEN];
+        pcap_global_header(hdr);
+        if (!ring.write(hdr, sizeof(hdr))) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        header_pending.store(false);
+    }
+
+    if (f.timestamp < ts_last) ts_high += 1ULL << 32;
+    ts_last = f.timestamp;
+
+    size_t len = pcap_record(scratch, f, ts_high | f.timestamp);
+    if (ring.write(scratch, len)) {
+        frames.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,58 @@
+// PSRAM-first allocation of the registry slabs and arenas
+
+#include "pool_alloc.h"
+#include <string.h>
+#include <new>
+#ifdef ESP_PLATFORM
+#include "esp_heap_caps.h"
+#endif
+
+size_t pool_psram_bytes = 0;
+size_t pool_internal_bytes = 0;
+
+// Each block is prefixed with its size so pool_free() can keep the totals right.
+// Slab entries start with a uint64_t key, so blocks are 8-byte aligned and the
+// header is padded to a multiple of 8 to keep the payload aligned too.
+#define POOL_ALIGN 8
+
+struct alignas(POOL_ALIGN) PoolHeader {
+    size_t bytes;
+    bool psram;
+};
+static_assert(sizeof(PoolHeader) % POOL_ALIGN == 0, "pool payload alignment");
+
+void* pool_calloc(size_t bytes, PoolPlacement where) {
+    size_t total = bytes + sizeof(PoolHeader);
+    PoolHeader* h = nullptr;
+    bool psram = false;
+#ifdef ESP_PLATFORM
+    if (where == POOL_PSRAM) {
+        h = (PoolHeader*)heap_caps_aligned_calloc(POOL_ALIGN, 1, total, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+        psram = h != nullptr;
+    }
+    if (h == nullptr) h = (PoolHeader*)heap_caps_aligned_calloc(POOL_ALIGN, 1, total, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+#else
+    (void)where;       // One heap on the host; new[] aligns for any scalar
+    h = (PoolHeader*)new (std::nothrow) uint8_t[total];
+    if (h != nullptr) memset(h, 0, total);
+#endif
+    if (h == nullptr) return nullptr;
+
+    h->bytes = bytes;
+    h->psram = psram;
+    if (psram) pool_psram_bytes += bytes;
+    else pool_internal_bytes += bytes;
+    return h + 1;
+}
+
+void pool_free(void* p) {
+    if (p == nullptr) return;
+    PoolHeader* h = (PoolHeader*)p - 1;
+    if (h->psram) pool_psram_bytes -= h->bytes;
+    else pool_internal_bytes -= h->bytes;
+#ifdef ESP_PLATFORM
+    heap_caps_free(h);
+#else
+    delete[] (uint8_t*)h;
+#endif
+}
@@ -0,0 +1,423 @@
+// Registry snapshot: save in chunks, load in one pass
+
+#include "registry_snapshot.h"
+#include <string.h>
+#include "sniffer.h"
+#include "pool_alloc.h"
+#include "crc32.h"
+
+RegistrySnapshot registry_snapshot;
+
+RegistrySnapshot::RegistrySnapshot()
+    : buf_len(0), file(nullptr), slot(0), started_at(0), body_len(0), body_crc(CRC32_INIT),
+      ap_order(nullptr), client_order(nullptr), ap_count(0), client_count(0), next_ap(0), next_client(0),
+      aps_written(0), clients_written(0), strings_defined(0), arena_flips(0), names(nullptr), names_used(0),
+      newest(-1), frames_at_save(0) {
+    dir[0] = '\0';
+    slot_sequence[0] = slot_sequence[1] = 0;
+    memset(&st, 0, sizeof(st));
+}
+
+RegistrySnapshot::~RegistrySnapshot() {
+    if (file != nullptr) fclose(file);
+    pool_free(ap_order);
+    pool_free(client_order);
+    pool_free(names);
+}
+
+bool RegistrySnapshot::begin(const char* path) {
+    strncpy(dir, path, sizeof(dir) - 1);
+    dir[sizeof(dir) - 1] = '\0';
+    ap_order = (uint16_t*)pool_calloc(ap_registry.capacity() * sizeof(uint16_t), POOL_PSRAM);
+    client_order = (uint16_t*)pool_calloc(client_registry.capacity() * sizeof(uint16_t), POOL_PSRAM);
+    names = (StringSlot*)pool_calloc(SNAPSHOT_STRING_SLOTS * sizeof(StringSlot), POOL_PSRAM);
+    if (ap_order == nullptr || client_order == nullptr || names == nullptr) return false;
+
+    SnapshotHeader h;
+    for (int i = 0; i < 2; i++) {
+        slot_sequence[i] = read_header(i, &h) ? h.sequence : 0;
+        if (slot_sequence[i] != 0 && (newest < 0 || slot_sequence[i] > slot_sequence[newest])) newest = i;
+    }
+    return true;
+}
+
+size_t RegistrySnapshot::footprint() const {
+    if (names == nullptr) return 0;
+    return sizeof(buf) + (ap_registry.capacity() + client_registry.capacity()) * sizeof(uint16_t) +
+           SNAPSHOT_STRING_SLOTS * sizeof(StringSlot);
+}
+
+void RegistrySnapshot::slot_path(int i, char* out) const {
+    snprintf(out, SNAPSHOT_PATH_MAX + 16, "%s/registry_%c.bin", dir, 'a' + i);
+}
+
+bool RegistrySnapshot::read_header(int i, SnapshotHeader* out) {
+    char path[SNAPSHOT_PATH_MAX + 16];
+    slot_path(i, path);
+    FILE* fp = fopen(path, "rb");
+    if (fp == nullptr) return false;
+    bool ok = fread(out, 1, sizeof(*out), fp) == sizeof(*out);
+    fclose(fp);
+    return ok && out->magic == SNAPSHOT_MAGIC && out->version == SNAPSHOT_VERSION &&
+           out->header_len == sizeof(SnapshotHeader) && out->sequence != 0;
+}
+
+// ---- Load ----
+
+bool RegistrySnapshot::load(uint32_t now) {
+    uint32_t t0 = micros();
+    SnapshotHeader h;
+    int order[2] = {newest, newest == 0 ? 1 : 0};
+    for (int n = 0; n < 2 && order[0] >= 0; n++) {
+        int i = order[n];
+        if (!read_header(i, &h)) continue;
+        if (load_slot(i, h, now)) {
+            st.sequence = h.sequence;
+            st.slot = 'A' + i;
+            st.load_us = micros() - t0;
+            newest = i;
+            return true;
+        }
+        // Partly applied before the CRC mismatch showed: start from empty
+        ap_registry.clear();
+        client_registry.clear();
+        st.load_fallback = true;
+    }
+    st.loaded_aps = st.loaded_clients = st.load_stale = 0;
+    st.load_us = micros() - t0;
+    return false;
+}
+
+bool RegistrySnapshot::load_slot(int i, const SnapshotHeader& h, uint32_t now) {
+    char path[SNAPSHOT_PATH_MAX + 16];
+    slot_path(i, path);
+    FILE* fp = fopen(path, "rb");
+    if (fp == nullptr) return false;
+    if (fseek(fp, h.header_len, SEEK_SET) != 0) {
+        fclose(fp);
+        return false;
+    }
+    const char** strings = (const char**)pool_calloc((h.string_count + 1) * sizeof(const char*), POOL_PSRAM);
+    if (strings == nullptr) {
+        fclose(fp);
+        return false;
+    }
+
+    uint32_t remaining = h.body_len;
+    uint32_t crc = CRC32_INIT;
+    uint16_t defined = 0, aps = 0, clients = 0, kept_aps = 0, kept_clients = 0;
+    bool ok = true;
+    buf_len = 0;
+    while (ok && (remaining > 0 || buf_len > 0)) {
+        size_t space = sizeof(buf) - buf_len;
+        size_t want = remaining < space ? remaining : space;
+        if (want > 0) {
+            size_t got = fread(buf + buf_len, 1, want, fp);
+            if (got == 0) break;
+            crc = crc32_update(crc, buf + buf_len, got);
+            buf_len += got;
+            remaining -= got;
+        }
+
+        // Apply every complete record; a partial one waits for the next read
+        size_t pos = 0;
+        while (ok && pos < buf_len) {
+            uint8_t tag = buf[pos];
+            size_t len = tag == SNAPSHOT_TAG_AP ? 1 + sizeof(SnapshotAp) :
+                         tag == SNAPSHOT_TAG_CLIENT ? 1 + sizeof(SnapshotClient) :
+                         tag == SNAPSHOT_TAG_STRING ? (pos + 1 < buf_len ? 2 + buf[pos + 1] : 2) : 0;
+            if (len == 0) {
+                ok = false;
+                break;
+            }
+            if (pos + len > buf_len || (tag == SNAPSHOT_TAG_STRING && pos + 1 >= buf_len)) break;
+            const uint8_t* p = buf + pos + 1;
+            pos += len;
+
+            if (tag == SNAPSHOT_TAG_STRING) {
+                if (defined >= h.string_count) {
+                    ok = false;
+                    break;
+                }
+                const char* s = ssid_arena.intern((const char*)p + 1, p[0]);
+                strings[defined++] = s ? s : "";
+                continue;
+            }
+
+            // String numbers refer to earlier definitions only
+            auto name = [&](uint16_t id, const char** out) {
+                if (id == SNAPSHOT_NO_STRING) *out = "";
+                else if (id < defined) *out = strings[id];
+                else ok = false;
+            };
+            if (tag == SNAPSHOT_TAG_AP) {
+                SnapshotAp r;
+                memcpy(&r, p, sizeof(r));
+                const char* ssid;
+                name(r.ssid, &ssid);
+                if (!ok) break;
+                aps++;
+                if (r.age_ms > ap_ttl_ms) continue;
+                kept_aps++;
+                MacAddr bssid = MacAddr::from_bytes(r.bssid);
+                APInfo& ap = ap_registry.upsert(bssid.value);
+                ap.ssid = ssid;
+                ap.bssid = bssid;
+                ap.channel = r.channel;
+                ap.rssi = r.rssi;
+                ap.security = r.security;
+                ap.beacon_count = r.beacon_count;
+                ap.last_seen = (unsigned long)now - r.age_ms;   // Wraps like millis() does early after boot
+            } else {
+                SnapshotClient r;
+                memcpy(&r, p, sizeof(r));
+                const char* probed[CLIENT_PROBE_SLOTS];
+                int probe_count = r.probe_count < CLIENT_PROBE_SLOTS ? r.probe_count : CLIENT_PROBE_SLOTS;
+                for (int k = 0; k < probe_count; k++) name(r.probed[k], &probed[k]);
+                if (!ok) break;
+                clients++;
+                if (r.age_ms > client_ttl_ms) continue;
+                kept_clients++;
+                MacAddr mac = MacAddr::from_bytes(r.mac);
+                ClientInfo& c = client_registry.upsert(mac.value);
+                c.mac = mac;
+                c.rssi = r.rssi;
+                c.vendor = get_vendor_from_mac(mac);
+                c.last_seen = (unsigned long)now - r.age_ms;
+                c.frame_count = r.frame_count;
+                c.retry_count = r.retry_count;
+                c.duplicate_count = r.duplicate_count;
+                c.is_associated = (r.flags & SNAPSHOT_CLIENT_ASSOCIATED) != 0;
+                c.probe_count = probe_count;
+                for (int k = 0; k < probe_count; k++) c.probed[k] = probed[k];
+                set_client_ap(c, MacAddr::from_bytes(r.ap), (r.flags & SNAPSHOT_CLIENT_AP_EXACT) != 0);
+            }
+        }
+        memmove(buf, buf + pos, buf_len - pos);
+        buf_len -= pos;
+        if (remaining == 0 && buf_len > 0 && pos == 0) ok = false;   // Truncated record
+    }
+    fclose(fp);
+    pool_free(strings);
+    buf_len = 0;
+
+    if (!ok || remaining != 0 || crc != h.body_crc || aps != h.ap_count || clients != h.client_count) return false;
+    st.loaded_aps = kept_aps;
+    st.loaded_clients = kept_clients;
+    st.load_stale = aps + clients - kept_aps - kept_clients;
+    return true;
+}
+
+// ---- Save ----
+
+bool RegistrySnapshot::due(uint32_t now) const {
+    return names != nullptr && file == nullptr && (int32_t)(now - started_at) >= SNAPSHOT_INTERVAL_MS &&
+           (uint32_t)total_frames != frames_at_save;
+}
+
+bool RegistrySnapshot::open() {
+    if (file != nullptr) return false;
+    // Overwrite the older slot (or an empty one); the newest stays intact
+    slot = newest == 0 ? 1 : 0;
+    char path[SNAPSHOT_PATH_MAX + 16];
+    slot_path(slot, path);
+    slot_sequence[slot] = 0;
+    file = fopen(path, "wb");
+    if (file == nullptr) {
+        st.failures++;
+        return false;
+    }
+    // Placeholder header: the slot reads as invalid until commit()
+    SnapshotHeader blank;
+    memset(&blank, 0, sizeof(blank));
+    if (fwrite(&blank, 1, sizeof(blank), file) != sizeof(blank)) {
+        abort();
+        return false;
+    }
+    body_len = 0;
+    body_crc = CRC32_INIT;
+    return true;
+}
+
+void RegistrySnapshot::start(uint32_t now) {
+    started_at = now;
+    frames_at_save = total_frames;
+    ap_count = client_count = 0;
+    for (uint16_t i = ap_registry.lru_oldest(); i != MacTable<APInfo>::NIL; i = ap_registry.at(i).prev) {
+        ap_order[ap_count++] = i;
+    }
+    for (uint16_t i = client_registry.lru_oldest(); i != MacTable<ClientInfo>::NIL; i = client_registry.at(i).prev) {
+        client_order[client_count++] = i;
+    }
+    next_ap = next_client = 0;
+    aps_written = clients_written = 0;
+    strings_defined = 0;
+    memset(names, 0, SNAPSHOT_STRING_SLOTS * sizeof(StringSlot));
+    names_used = 0;
+    arena_flips = ssid_arena.flips();
+}
+
+// Number of s in this save. With define false it only adds the bytes a new
+// definition would take to *need; with define true it appends the definition.
+uint16_t RegistrySnapshot::string_ref(const char* s, size_t* need, bool define) {
+    if (*s == '\0') return SNAPSHOT_NO_STRING;
+    size_t mask = SNAPSHOT_STRING_SLOTS - 1;
+    size_t b = (size_t)(((uint64_t)(uintptr_t)s * 0x9E3779B97F4A7C15ULL) >> 40) & mask;
+    for (; names[b].s != nullptr; b = (b + 1) & mask) {
+        if (names[b].s == s) return names[b].id;
+    }
+    size_t len = strlen(s);
+    if (!define) {
+        *need += 2 + len;
+        return 0;
+    }
+    if (strings_defined == SNAPSHOT_NO_STRING) return SNAPSHOT_NO_STRING;   // Out of numbers: saved as ""
+    buf[buf_len++] = SNAPSHOT_TAG_STRING;
+    buf[buf_len++] = (uint8_t)len;
+    memcpy(buf + buf_len, s, len);
+    buf_len += len;
+    // Past half full the index stops remembering; later uses repeat the definition
+    uint16_t id = strings_defined++;
+    if (names_used < SNAPSHOT_STRING_SLOTS / 2) {
+        names[b].s = s;
+        names[b].id = id;
+        names_used++;
+    }
+    return id;
+}
+
+bool RegistrySnapshot::room_for(size_t record_len, const char* const* strs, int n) {
+    size_t need = 1 + record_len;
+    for (int i = 0; i < n; i++) string_ref(strs[i], &need, false);
+    return buf_len + need <= sizeof(buf);
+}
+
+static inline int8_t clamp_dbm(int v) {
+    return (int8_t)(v < -128 ? -128 : v > 127 ? 127 : v);
+}
+
+static inline uint32_t age_of(uint32_t now, unsigned long last_seen) {
+    // The parser may stamp a record a little after this task read the clock
+    int32_t age = (int32_t)(now - last_seen);
+    return age < 0 ? 0 : (uint32_t)age;
+}
+
+size_t RegistrySnapshot::encode(uint32_t now) {
+    buf_len = 0;
+    if (file == nullptr) return 0;
+    if (ssid_arena.flips() != arena_flips) {
+        memset(names, 0, SNAPSHOT_STRING_SLOTS * sizeof(StringSlot));
+        names_used = 0;
+        arena_flips = ssid_arena.flips();
+    }
+
+    for (int records = 0; records < SNAPSHOT_CHUNK_RECORDS;) {
+        if (next_ap < ap_count) {
+            uint16_t idx = ap_order[next_ap];
+            if (!ap_registry.used(idx)) {
+                next_ap++;
+                continue;
+            }
+            const APInfo& a = ap_registry.at(idx).value;
+            if (!room_for(sizeof(SnapshotAp), &a.ssid, 1)) break;
+            SnapshotAp r;
+            memset(&r, 0, sizeof(r));
+            a.bssid.to_bytes(r.bssid);
+            r.ssid = string_ref(a.ssid, nullptr, true);
+            r.age_ms = age_of(now, a.last_seen);
+            r.beacon_count = a.beacon_count;
+            r.security = a.security;
+            r.rssi = clamp_dbm(a.rssi);
+            r.channel = (uint8_t)a.channel;
+            buf[buf_len++] = SNAPSHOT_TAG_AP;
+            memcpy(buf + buf_len, &r, sizeof(r));
+            buf_len += sizeof(r);
+            next_ap++;
+            aps_written++;
+        } else if (next_client < client_count) {
+            uint16_t idx = client_order[next_client];
+            if (!client_registry.used(idx)) {
+                next_client++;
+                continue;
+            }
+            const ClientInfo& c = client_registry.at(idx).value;
+            if (!room_for(sizeof(SnapshotClient), c.probed, c.probe_count)) break;
+            SnapshotClient r;
+            memset(&r, 0, sizeof(r));
+            c.mac.to_bytes(r.mac);
+            c.connected_ap.to_bytes(r.ap);
+            r.age_ms = age_of(now, c.last_seen);
+            r.frame_count = c.frame_count;
+            r.retry_count = c.retry_count;
+            r.duplicate_count = c.duplicate_count;
+            for (int k = 0; k < c.probe_count; k++) r.probed[k] = string_ref(c.probed[k], nullptr, true);
+            r.probe_count = c.probe_count;
+            r.rssi = clamp_dbm(c.rssi);
+            r.flags = (c.is_associated ? SNAPSHOT_CLIENT_ASSOCIATED : 0) |
+                      (c.ap_exact ? SNAPSHOT_CLIENT_AP_EXACT : 0);
+            buf[buf_len++] = SNAPSHOT_TAG_CLIENT;
+            memcpy(buf + buf_len, &r, sizeof(r));
+            buf_len += sizeof(r);
+            next_client++;
+            clients_written++;
+        } else {
+            break;
+        }
+        records++;
+    }
+    return buf_len;
+}
+
+bool RegistrySnapshot::write(size_t len) {
+    if (file == nullptr) return false;
+    if (fwrite(buf, 1, len, file) != len) {
+        st.failures++;
+        abort();
+        return false;
+    }
+    body_crc = crc32_update(body_crc, buf, len);
+    body_len += len;
+    return true;
+}
+
+bool RegistrySnapshot::commit(uint32_t now) {
+    if (file == nullptr) return false;
+    SnapshotHeader h;
+    memset(&h, 0, sizeof(h));
+    h.magic = SNAPSHOT_MAGIC;
+    h.version = SNAPSHOT_VERSION;
+    h.header_len = sizeof(h);
+    h.sequence = (slot_sequence[0] > slot_sequence[1] ? slot_sequence[0] : slot_sequence[1]) + 1;
+    h.saved_ms = started_at;
+    h.body_len = body_len;
+    h.body_crc = body_crc;
+    h.ap_count = aps_written;
+    h.client_count = clients_written;
+    h.string_count = strings_defined;
+    bool ok = fflush(file) == 0 && fseek(file, 0, SEEK_SET) == 0 &&
+              fwrite(&h, 1, sizeof(h), file) == sizeof(h);
+    ok = (fclose(file) == 0) && ok;
+    file = nullptr;
+    if (!ok) {
+        st.failures++;
+        return false;
+    }
+
+    slot_sequence[slot] = h.sequence;
+    newest = slot;
+    st.saves++;
+    st.sequence = h.sequence;
+    st.slot = 'A' + slot;
+    st.last_bytes = sizeof(h) + body_len;
+    st.last_aps = aps_written;
+    st.last_clients = clients_written;
+    st.last_strings = strings_defined;
+    st.last_save_ms = now - started_at;
+    st.last_saved_at = now;
+    return true;
+}
+
+void RegistrySnapshot::abort() {
+    if (file != nullptr) fclose(file);
+    file = nullptr;
+}
@@ -0,0 +1,87 @@
+// Smoothed per-device RSSI with outlier rejection and trend
+
+#include "rssi_track.h"
+#include <math.h>
+#include <string.h>
+
+#define LEVEL_SCALE 16.0f                  // Ring levels are stored in 1/16 dB
+
+void RssiTrack::reset() {
+    memset(this, 0, sizeof(*this));
+}
+
+void RssiTrack::add(int8_t rssi, uint32_t now) {
+    if (count > 0 && now - last_update > RSSI_TRACK_STALE_MS) reset();
+    if (count == 0) {
+        estimate = rssi;
+        error_var = RSSI_MEAS_VAR;
+        jitter_var = 0;
+        outliers = 0;
+        last_update = now;
+        time[0] = now;
+        level[0] = (int16_t)lroundf(estimate * LEVEL_SCALE);
+        head = 1;
+        count = 1;
+        return;
+    }
+
+    // Predict: the true level may have drifted since the last accepted reading
+    float predicted_var = error_var + RSSI_DRIFT_VAR * (now - last_update) / 1000.0f;
+    float residual = rssi - estimate;
+    float total_var = predicted_var + RSSI_MEAS_VAR;
+    if (residual * residual > RSSI_GATE * RSSI_GATE * total_var && outliers < RSSI_MAX_OUTLIERS) {
+        outliers++;
+        return;
+    }
+    outliers = 0;
+
+    // Correct
+    float gain = predicted_var / total_var;
+    estimate += gain * residual;
+    error_var = (1 - gain) * predicted_var;
+    jitter_var += RSSI_JITTER_ALPHA * (residual * residual - jitter_var);
+    last_update = now;
+
+    // Ring samples stay RSSI_TRACK_SPACING_MS apart; until the next one is due
+    // the newest slot follows the estimate
+    int newest = (head + RSSI_TRACK_SAMPLES - 1) % RSSI_TRACK_SAMPLES;
+    int previous = (head + RSSI_TRACK_SAMPLES - 2) % RSSI_TRACK_SAMPLES;
+    int slot = newest;
+    if (count == 1 || now - time[previous] >= RSSI_TRACK_SPACING_MS) {
+        slot = head;
+        head = (head + 1) % RSSI_TRACK_SAMPLES;
+        if (count < RSSI_TRACK_SAMPLES) count++;
+    }
+    time[slot] = now;
+    level[slot] = (int16_t)lroundf(estimate * LEVEL_SCALE);
+}
+
+int RssiTrack::smoothed() const {
+    return count > 0 ? (int)lroundf(estimate) : 0;
+}
+
+void RssiTrack::read(RssiReading* out) const {
+    out->smoothed = count > 0 ? estimate : 0;
+    out->variance = jitter_var;
+    out->slope = 0;
+    out->trend = RSSI_STEADY;
+    if (count < 3) return;
+
+    // Least-squares slope of level over time, times relative to the newest sample
+    int newest = (head + RSSI_TRACK_SAMPLES - 1) % RSSI_TRACK_SAMPLES;
+    float st = 0, sl = 0, stt = 0, stl = 0;
+    for (int i = 0; i < count; i++) {
+        int slot = (head + RSSI_TRACK_SAMPLES - 1 - i) % RSSI_TRACK_SAMPLES;
+        float t = -(float)(time[newest] - time[slot]) / 1000.0f;
+        float l = level[slot] / LEVEL_SCALE;
+        st += t;
+        sl += l;
+        stt += t * t;
+        stl += t * l;
+    }
+    float denom = count * stt - st * st;
+    if (denom <= 1e-6f) return;
+    out->slope = (count * stl - st * sl) / denom;
+    if (out->slope >= RSSI_TREND_DB_S) out->trend = RSSI_APPROACHING;
+    else if (out->slope <= -RSSI_TREND_DB_S) out->trend = RSSI_RECEDING;
+}
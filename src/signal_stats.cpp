@@ -0,0 +1,184 @@
+// Per-channel signal statistics over a sliding time window
+
+#include "signal_stats.h"
+#include <math.h>
+#include <string.h>
+
+void P2Quantile::reset(float quantile) {
+    p = quantile;
+    n = 0;
+    for (int i = 0; i < 5; i++) {
+        q[i] = 0;
+        pos[i] = i;
+    }
+}
+
+void P2Quantile::add(float x) {
+    if (n < 5) {
+        // Warm-up: keep the samples sorted; marker i sits at rank i
+        int i = (int)n;
+        while (i > 0 && q[i - 1] > x) {
+            q[i] = q[i - 1];
+            i--;
+        }
+        q[i] = x;
+        n++;
+        return;
+    }
+
+    // Cell k holds x (q[k] <= x < q[k + 1]); the extremes move with new samples
+    if (x < q[0]) q[0] = x;
+    if (x > q[4]) q[4] = x;
+    int k = (x >= q[1]) + (x >= q[2]) + (x >= q[3]);
+    for (int i = k + 1; i < 5; i++) pos[i]++;
+    n++;
+
+    // Nudge the middle markers toward their desired ranks, moving each by at
+    // most one position with a piecewise-parabolic height estimate
+    const float want[5] = {0, p / 2, p, (1 + p) / 2, 1};
+    float last = (float)(n - 1);
+    for (int i = 1; i <= 3; i++) {
+        float d = last * want[i] - pos[i];
+        if ((d >= 1.0f && pos[i + 1] - pos[i] > 1) || (d <= -1.0f && pos[i - 1] - pos[i] < -1)) {
+            int s = d > 0 ? 1 : -1;
+            float span = (float)(pos[i + 1] - pos[i - 1]);
+            float qp = q[i] + s / span *
+                ((pos[i] - pos[i - 1] + s) * (q[i + 1] - q[i]) / (pos[i + 1] - pos[i]) +
+                 (pos[i + 1] - pos[i] - s) * (q[i] - q[i - 1]) / (pos[i] - pos[i - 1]));
+            if (q[i - 1] < qp && qp < q[i + 1]) q[i] = qp;
+            else q[i] += s * (q[i + s] - q[i]) / (pos[i + s] - pos[i]);
+            pos[i] += s;
+        }
+    }
+}
+
+float P2Quantile::value() const {
+    if (n == 0) return 0;
+    if (n > 5) return q[2];
+    // Exact nearest rank over the warm-up samples
+    int idx = (int)ceilf(p * n) - 1;
+    if (idx < 0) idx = 0;
+    if (idx >= (int)n) idx = (int)n - 1;
+    return q[idx];
+}
+
+float P2Quantile::rank_at(float x) const {
+    int m = n < 5 ? (int)n : 5;
+    if (m == 0 || x < q[0]) return 0;
+    if (x >= q[m - 1]) return (float)(pos[m - 1] + 1);
+    int i = 0;
+    while (x >= q[i + 1]) i++;
+    return pos[i] + 1 + (x - q[i]) / (q[i + 1] - q[i]) * (pos[i + 1] - pos[i]);
+}
+
+float P2Quantile::merge(const P2Quantile& a, const P2Quantile& b) {
+    if (a.n == 0) return b.value();
+    if (b.n == 0) return a.value();
+    float target = a.p * (float)(a.n + b.n);
+    float lo = fminf(a.q[0], b.q[0]);
+    float hi = fmaxf(a.q[a.n < 5 ? a.n - 1 : 4], b.q[b.n < 5 ? b.n - 1 : 4]);
+    // The summed rank function is monotonic, so bisect for where it reaches target
+    for (int iter = 0; iter < 20 && hi - lo > 0.01f; iter++) {
+        float mid = (lo + hi) / 2;
+        if (a.rank_at(mid) + b.rank_at(mid) >= target) hi = mid;
+        else lo = mid;
+    }
+    return hi;
+}
+
+void SignalPane::reset(uint32_t now) {
+    start = now;
+    frames = 0;
+    retries = 0;
+    rssi_min = noise_min = INT8_MAX;
+    rssi_max = noise_max = INT8_MIN;
+    rssi_p50.reset(0.5f);
+    rssi_p90.reset(0.9f);
+    noise_p50.reset(0.5f);
+}
+
+void SignalPane::add(int8_t rssi, int8_t noise, bool retry) {
+    frames++;
+    retries += retry;
+    if (rssi < rssi_min) rssi_min = rssi;
+    if (rssi > rssi_max) rssi_max = rssi;
+    if (noise < noise_min) noise_min = noise;
+    if (noise > noise_max) noise_max = noise;
+    rssi_p50.add(rssi);
+    rssi_p90.add(rssi);
+    noise_p50.add(noise);
+}
+
+void ChannelSignal::reset() {
+    panes[0].reset(0);
+    panes[1].reset(0);
+    newest = 0;
+    started = false;
+    rssi_ewma = 0;
+    noise_ewma = 0;
+}
+
+void ChannelSignal::add(int8_t rssi, int8_t noise, bool retry, uint32_t now) {
+    SignalPane* cur = &panes[newest];
+    if (cur->frames == 0) {
+        cur->start = now;
+    } else if ((int32_t)(now - cur->start) >= SIGNAL_WINDOW_MS / 2) {
+        // Recycle the older pane; it has left the window
+        newest ^= 1;
+        cur = &panes[newest];
+        cur->reset(now);
+    }
+    cur->add(rssi, noise, retry);
+
+    if (!started) {
+        rssi_ewma = rssi;
+        noise_ewma = noise;
+        started = true;
+    } else {
+        rssi_ewma += SIGNAL_EWMA_ALPHA * (rssi - rssi_ewma);
+        noise_ewma += SIGNAL_EWMA_ALPHA * (noise - noise_ewma);
+    }
+}
+
+static inline int8_t round_dbm(float v) {
+    return (int8_t)lroundf(fmaxf(-128.0f, fminf(127.0f, v)));
+}
+
+void ChannelSignal::summary(uint32_t now, SignalSummary* out) const {
+    memset(out, 0, sizeof(*out));
+    out->rssi_ewma = (int16_t)lroundf(rssi_ewma);
+    out->noise_ewma = (int16_t)lroundf(noise_ewma);
+
+    // The publisher's clock may read a little behind the parser's, hence signed ages
+    const SignalPane& cur = panes[newest];
+    const SignalPane& old = panes[newest ^ 1];
+    bool use_cur = cur.frames > 0 && (int32_t)(now - cur.start) < SIGNAL_WINDOW_MS;
+    bool use_old = old.frames > 0 && (int32_t)(now - old.start) < SIGNAL_WINDOW_MS;
+    if (!use_cur && !use_old) return;
+
+    if (use_cur && use_old) {
+        out->frames = cur.frames + old.frames;
+        out->retries = cur.retries + old.retries;
+        out->window_start = old.start;
+        out->rssi_min = cur.rssi_min < old.rssi_min ? cur.rssi_min : old.rssi_min;
+        out->rssi_max = cur.rssi_max > old.rssi_max ? cur.rssi_max : old.rssi_max;
+        out->noise_min = cur.noise_min < old.noise_min ? cur.noise_min : old.noise_min;
+        out->noise_max = cur.noise_max > old.noise_max ? cur.noise_max : old.noise_max;
+        out->rssi_p50 = round_dbm(P2Quantile::merge(cur.rssi_p50, old.rssi_p50));
+        out->rssi_p90 = round_dbm(P2Quantile::merge(cur.rssi_p90, old.rssi_p90));
+        out->noise_p50 = round_dbm(P2Quantile::merge(cur.noise_p50, old.noise_p50));
+    } else {
+        const SignalPane& pane = use_cur ? cur : old;
+        out->frames = pane.frames;
+        out->retries = pane.retries;
+        out->window_start = pane.start;
+        out->rssi_min = pane.rssi_min;
+        out->rssi_max = pane.rssi_max;
+        out->noise_min = pane.noise_min;
+        out->noise_max = pane.noise_max;
+        out->rssi_p50 = round_dbm(pane.rssi_p50.value());
+        out->rssi_p90 = round_dbm(pane.rssi_p90.value());
+        out->noise_p50 = round_dbm(pane.noise_p50.value());
+    }
+    out->snr = (int8_t)(out->rssi_p50 - out->noise_p50);
+}
@@ -0,0 +1,599 @@
+// WiFi sniffer core: capture callback, frame parser and device registries
+
+#include "sniffer.h"
+#include "latency_probe.h"
+#include "mem_stats.h"
+#include "oui.h"
+
+// Target phone MAC (your phone's WiFi MAC)
+const char* TARGET_PHONE = "C4:EF:3D:B3:23:BD";
+
+// Target tracking
+Watchlist watchlist;
+HistoryRing<TargetPacket> target_history;      // Allocated in sniffer_init(), never grows
+
+// WiFi Data
+MacTable<APInfo> ap_registry;          // Keyed by packed BSSID
+MacTable<ClientInfo> client_registry;  // Keyed by packed station MAC
+StringArena ssid_arena;                // AP names and client probe lists
+ChannelStats channel_stats[14]; // Index 0 unused, 1-13 for channels
+int current_channel = 1;
+ChannelHopper channel_hopper;   // Driven by radio_task; fed by process_frame()
+int total_frames = 0;
+int mgmt_frames = 0;
+int data_frames = 0;
+int ctrl_frames = 0;
+int retry_frames = 0;
+int duplicate_frames = 0;
+RetryFilter retry_filter;
+PromiscFilter promisc_filter;
+
+Seqlock<SnifferStatus> sniffer_status;
+
+// Registry expiry
+uint32_t ap_ttl_ms = AP_TTL_MS;
+uint32_t client_ttl_ms = CLIENT_TTL_MS;
+uint32_t ap_expired = 0;
+uint32_t client_expired = 0;
+static ExpiryCallback expiry_cb = nullptr;
+static void* expiry_ctx = nullptr;
+
+// Capture path: RX callback -> capture_ring -> process_frame
+SpscRing<CapturedFrame, CAPTURE_RING_SLOTS> capture_ring;
+uint32_t frames_truncated = 0;
+
+// Association index: unlinks a client from its AP's list
+static void assoc_unlink(uint16_t /* client_idx */, ClientInfo& client) {
+    if (client.ap_index == ASSOC_NIL) return;
+    APInfo& ap = ap_registry.at(client.ap_index).value;
+    if (client.ap_prev != ASSOC_NIL) client_registry.at(client.ap_prev).value.ap_next = client.ap_next;
+    else ap.first_client = client.ap_next;
+    if (client.ap_next != ASSOC_NIL) client_registry.at(client.ap_next).value.ap_prev = client.ap_prev;
+    ap.client_count--;
+    client.ap_index = client.ap_prev = client.ap_next = ASSOC_NIL;
+}
+
+static void on_client_removed(uint16_t idx, ClientInfo& client, void* /* ctx */) {
+    assoc_unlink(idx, client);
+}
+
+// An AP leaving the registry orphans its clients; they keep connected_ap and
+// relink if the AP comes back and they are heard again
+static void on_ap_removed(uint16_t /* idx */, APInfo& ap, void* /* ctx */) {
+    for (uint16_t c = ap.first_client; c != ASSOC_NIL;) {
+        ClientInfo& client = client_registry.at(c).value;
+        c = client.ap_next;
+        client.ap_index = client.ap_prev = client.ap_next = ASSOC_NIL;
+    }
+    ap.first_client = ASSOC_NIL;
+    ap.client_count = 0;
+}
+
+void set_client_ap(ClientInfo& client, MacAddr ap, bool exact) {
+    client.ap_exact = exact;
+    if (client.connected_ap == ap && client.ap_index != ASSOC_NIL) return;
+    
+    uint16_t client_idx = client_registry.index_of_value(client);
+    assoc_unlink(client_idx, client);
+    client.connected_ap = ap;
+    if (ap.is_null()) return;
+    
+    uint16_t ap_idx = ap_registry.find_index(ap.value);
+    if (ap_idx == ASSOC_NIL) return; // AP not heard yet; linked on a later frame
+    
+    APInfo& info = ap_registry.at(ap_idx).value;
+    client.ap_index = ap_idx;
+    client.ap_next = info.first_client;
+    if (info.first_client != ASSOC_NIL) client_registry.at(info.first_client).value.ap_prev = client_idx;
+    info.first_client = client_idx;
+    info.client_count++;
+}
+
+bool sniffer_init(uint16_t ap_capacity, uint16_t client_capacity) {
+    // Target matching compares packed MACs, never strings
+    if (!watchlist_load(watchlist)) {
+        MacAddr phone;
+        if (MacAddr::parse(TARGET_PHONE, &phone)) watchlist.add(phone, false);
+        else Serial.println("Invalid TARGET_PHONE MAC!");
+    }
+    
+    // Initialize channel stats
+    for (int i = 1; i <= 13; i++) {
+        channel_stats[i].ap_count = 0;
+        channel_stats[i].total_frames = 0;
+        channel_stats[i].duplicate_frames = 0;
+        channel_stats[i].last_activity = 0;
+        channel_stats[i].signal.reset();
+    }
+    
+    if (!ap_registry.begin(ap_capacity) || !client_registry.begin(client_capacity) ||
+        !ssid_arena.begin(SSID_ARENA_BYTES) || !target_history.begin(TARGET_HISTORY_LEN)) return false;
+    ap_registry.set_remove_hook(on_ap_removed, nullptr);
+    client_registry.set_remove_hook(on_client_removed, nullptr);
+    return true;
+}
+
+// Moves every SSID still referenced by a record into the other arena half;
+// names of expired and evicted records are left behind
+static void compact_ssid_arena() {
+    ssid_arena.flip();
+    for (auto& e : ap_registry) {
+        const char* s = ssid_arena.intern(e.value.ssid);
+        e.value.ssid = s ? s : "";
+    }
+    for (auto& e : client_registry) {
+        ClientInfo& c = e.value;
+        for (int i = 0; i < c.probe_count; i++) {
+            const char* s = ssid_arena.intern(c.probed[i]);
+            c.probed[i] = s ? s : "";
+        }
+    }
+}
+
+static const char* intern_ssid(const char* ssid) {
+    const char* s = ssid_arena.intern(ssid);
+    if (s == nullptr) {
+        compact_ssid_arena();
+        s = ssid_arena.intern(ssid);
+    }
+    return s ? s : "";
+}
+
+// Puts ssid at the front of the client's probe list, dropping the oldest entry
+static void client_add_probe(ClientInfo& client, const char* ssid) {
+    int pos = 0;
+    while (pos < client.probe_count && strcmp(client.probed[pos], ssid) != 0) pos++;
+    if (pos == 0 && client.probe_count > 0) return;   // Already newest
+    if (pos == client.probe_count) {
+        // Intern only names not yet on the list; compaction may move the others
+        ssid = intern_ssid(ssid);
+        if (ssid[0] == '\0') return;
+        if (client.probe_count < CLIENT_PROBE_SLOTS) client.probe_count++;
+        pos = client.probe_count - 1;
+    } else {
+        ssid = client.probed[pos];
+    }
+    for (int i = pos; i > 0; i--) client.probed[i] = client.probed[i - 1];
+    client.probed[0] = ssid;
+}
+
+void set_expiry_callback(ExpiryCallback cb, void* ctx) {
+    expiry_cb = cb;
+    expiry_ctx = ctx;
+}
+
+size_t expire_stale_entries(unsigned long now, size_t budget) {
+    PROBE_SCOPE(PROBE_EXPIRY);
+    size_t removed = 0;
+    
+    // Low on heap: let records go well before their normal TTL
+    uint32_t div = mem_stats.pressure ? MEM_PRESSURE_TTL_DIV : 1;
+    uint32_t ap_ttl = ap_ttl_ms / div;
+    uint32_t client_ttl = client_ttl_ms / div;
+    
+    for (size_t n = 0; n < budget; n++) {
+        uint16_t idx = ap_registry.lru_oldest();
+        if (idx == ASSOC_NIL || now - ap_registry.at(idx).value.last_seen <= ap_ttl) break;
+        if (expiry_cb != nullptr) expiry_cb(REGISTRY_AP, ap_registry.at(idx).value.bssid, expiry_ctx);
+        ap_registry.erase_at(idx);
+        ap_expired++;
+        removed++;
+    }
+    
+    for (size_t n = 0; n < budget; n++) {
+        uint16_t idx = client_registry.lru_oldest();
+        if (idx == ASSOC_NIL || now - client_registry.at(idx).value.last_seen <= client_ttl) break;
+        if (expiry_cb != nullptr) expiry_cb(REGISTRY_CLIENT, client_registry.at(idx).value.mac, expiry_ctx);
+        client_registry.erase_at(idx);
+        client_expired++;
+        removed++;
+    }
+    
+    return removed;
+}
+
+void publish_sniffer_status(unsigned long now) {
+    SnifferStatus s;
+    s.published_at = now;
+    s.current_channel = current_channel;
+    s.total_frames = total_frames;
+    s.mgmt_frames = mgmt_frames;
+    s.data_frames = data_frames;
+    s.ctrl_frames = ctrl_frames;
+    s.retry_frames = retry_frames;
+    s.duplicate_frames = duplicate_frames;
+    s.ap_count = (uint16_t)ap_registry.size();
+    s.client_count = (uint16_t)client_registry.size();
+    s.open_aps = 0;
+    for (const auto& e : ap_registry) {
+        if (security_is_open(e.value.security)) s.open_aps++;
+    }
+    s.secure_aps = s.ap_count - s.open_aps;
+    s.retry_displaced = retry_filter.displaced();
+    memset(&s.channels[0], 0, sizeof(s.channels[0]));
+    for (int ch = 1; ch <= WIFI_CHANNEL_MAX; ch++) channel_stats[ch].signal.summary(now, &s.channels[ch]);
+    s.hop_adaptive = channel_hopper.is_adaptive();
+    s.hop_locked = channel_hopper.is_locked(now);
+    s.hop_channel = channel_hopper.channel();
+    s.hop_dwell_ms = channel_hopper.dwell_ms();
+    memset(&s.hop[0], 0, sizeof(s.hop[0]));
+    for (int ch = 1; ch <= HOP_CHANNEL_MAX; ch++) s.hop[ch] = channel_hopper.stats(ch);
+    sniffer_status.publish(s);
+}
+
+// Helper functions
+const char* get_vendor_from_mac(MacAddr mac) {
+    // Locally administered addresses (randomised by phones) carry no OUI
+    if (mac.is_local()) return VENDOR_RANDOM;
+    const char* vendor = oui_vendor(mac);
+    return vendor != nullptr ? vendor : VENDOR_UNKNOWN;
+}
+
+// Helper function to find closest AP by RSSI and timing (returns its registry key, 0 if none)
+uint64_t find_closest_ap(MacAddr /* client_mac */, int client_rssi, unsigned long client_time) {
+    uint64_t closest_ap = 0;
+    int best_score = -999;
+    
+    for (const auto& e : ap_registry) {
+        const APInfo& ap = e.value;
+        // AP must be recently active and on same or recent channel
+        if (millis() - ap.last_seen < 10000) {
+            // Score based on RSSI similarity and time proximity
+            int rssi_diff = abs(client_rssi - ap.rssi);
+            int time_diff = abs((long)(client_time - ap.last_seen)) / 1000;
+            int score = -rssi_diff - time_diff;
+            
+            if (score > best_score) {
+                best_score = score;
+                closest_ap = e.key;
+            }
+        }
+    }
+    
+    return closest_ap;
+}
+
+// Promiscuous RX callback: runs in the WiFi driver task, so it only copies the
+// frame into capture_ring and leaves all parsing to parser_task
+void wifi_sniffer_packet_handler(void* buff, wifi_promiscuous_pkt_type_t type) {
+    PROBE_SCOPE(PROBE_RX);
+    FilterCostScope cost(promisc_filter, true);
+    const wifi_promiscuous_pkt_t* pkt = (const wifi_promiscuous_pkt_t*)buff;
+    
+    CapturedFrame* f = capture_ring.acquire();
+    if (f == nullptr) return; // Ring full, counted as a drop
+    
+    uint16_t len = pkt->rx_ctrl.sig_len;
+    f->timestamp = pkt->rx_ctrl.timestamp;
+    f->sig_len = len;
+    f->cap_len = len < CAPTURE_SNAP_LEN ? len : CAPTURE_SNAP_LEN;
+    f->rssi = pkt->rx_ctrl.rssi;
+    f->noise_floor = pkt->rx_ctrl.noise_floor;
+    f->channel = pkt->rx_ctrl.channel;
+    f->rate = pkt->rx_ctrl.rate;
+    f->sig_mode = pkt->rx_ctrl.sig_mode;
+    f->mcs = pkt->rx_ctrl.mcs;
+    f->ht_flags = (pkt->rx_ctrl.cwb ? CAPTURE_HT_40MHZ : 0) | (pkt->rx_ctrl.sgi ? CAPTURE_HT_SGI : 0);
+    f->pkt_type = (uint8_t)type;
+    f->hop_epoch = channel_hopper.epoch();
+    memcpy(f->data, pkt->payload, f->cap_len);
+    
+    // Management and data frames carry sequence control after the third address
+    f->seq_flags = 0;
+    if ((type == WIFI_PKT_MGMT || type == WIFI_PKT_DATA) && f->cap_len >= 24) {
+        uint16_t fc = f->data[0] | (f->data[1] << 8);
+        f->seq_ctrl = f->data[22] | (f->data[23] << 8);
+        f->seq_flags = CAPTURE_SEQ_VALID | ((fc & FC_RETRY) ? CAPTURE_RETRY : 0);
+    }
+    
+    capture_ring.publish();
+}
+
+const char* target_frame_name(uint8_t type) {
+    static const char* const names[TARGET_FRAME_TYPES] = {
+        "BEACON", "PROBE", "PROBE_R", "ASSOC", "ASSOC_R", "DISASSOC", "AUTH", "DEAUTH", "MGMT", "DATA"
+    };
+    return type < TARGET_FRAME_TYPES ? names[type] : "?";
+}
+
+// Updates a watched target's record for a frame it sent (tx) or received
+static WatchTarget& note_target(int idx, MacAddr mac, bool tx, const CapturedFrame& f, int channel,
+                                TargetFrameType frame_type) {
+    WatchTarget& t = watchlist.at(idx);
+    t.found = true;
+    // Only the target's own frames say how far away it is; a prefix target
+    // starts a new track when a different device matches
+    if (tx) {
+        if (mac != t.last_mac) t.rssi_track.reset();
+        t.rssi = f.rssi;
+        t.rssi_track.add(f.rssi, millis());
+    }
+    t.last_mac = mac;
+    t.channel = channel;
+    t.last_seen = millis();
+    if (tx) t.tx_packets++;
+    else t.rx_packets++;
+    channel_hopper.on_target(channel, millis());
+    
+    // Store packet info for display; the ring overwrites its oldest record
+    TargetPacket packet;
+    packet.timestamp = millis();
+    mac.to_bytes(packet.mac);
+    packet.type = frame_type;
+    packet.flags = tx ? TARGET_PACKET_TX : 0;
+    packet.rssi = f.rssi;
+    packet.channel = (uint8_t)channel;
+    target_history.push(packet);
+    return t;
+}
+
+// Watchlist index of an address, -1 for none; group addresses are never targets
+static inline int match_target(MacAddr mac) {
+    return mac.is_multicast() ? -1 : watchlist.match(mac);
+}
+
+// Counts a Retry frame against the client or target that sent it
+static void note_retry(MacAddr ta, bool duplicate) {
+    ClientInfo* client = client_registry.find(ta.value);
+    if (client != nullptr) {
+        client->retry_count++;
+        if (duplicate) client->duplicate_count++;
+    }
+    int idx = match_target(ta);
+    if (idx >= 0) {
+        WatchTarget& t = watchlist.at(idx);
+        t.tx_retries++;
+        if (duplicate) t.tx_duplicates++;
+    }
+}
+
+// Enhanced frame parser with target phone analysis (called from parser_task)
+void process_frame(const CapturedFrame& f) {
+    PROBE_SCOPE(PROBE_PARSE);
+    FilterCostScope cost(promisc_filter, false);
+    int channel = (f.channel >= 1 && f.channel <= WIFI_CHANNEL_MAX) ? f.channel : current_channel;
+    
+    if (f.sig_len > f.cap_len) frames_truncated++;
+    unsigned long now = millis();
+    bool retry = (f.seq_flags & CAPTURE_RETRY) != 0;
+    channel_stats[channel].last_activity = now;
+    channel_stats[channel].signal.add(f.rssi, f.noise_floor, retry, now);
+    
+    // A retransmission of a frame already heard is counted here and goes no
+    // further, so every count below is of unique frames
+    if (f.seq_flags & CAPTURE_SEQ_VALID) {
+        MacAddr ta = MacAddr::from_bytes(&f.data[10]);
+        bool duplicate = retry_filter.is_duplicate(ta, f.seq_ctrl, retry);
+        if (retry) {
+            retry_frames++;
+            note_retry(ta, duplicate);
+        }
+        if (duplicate) {
+            duplicate_frames++;
+            channel_stats[channel].duplicate_frames++;
+            return;
+        }
+    }
+    
+    total_frames++;
+    channel_stats[channel].total_frames++;
+    channel_hopper.on_frame(channel, f.hop_epoch);
+    
+    if (f.pkt_type == WIFI_PKT_MGMT) {
+        mgmt_frames++;
+        if (f.cap_len < 24) return; // Shorter than a management header
+        
+    uint16_t frame_control = f.data[0] | (f.data[1] << 8);
+    uint8_t frame_subtype = (frame_control >> 4) & 0x0F;
+    
+        // Fully captured frames end with the 4-byte FCS, which is not part of the body
+        size_t frame_len = (f.cap_len == f.sig_len && f.cap_len >= 28) ? f.cap_len - 4 : f.cap_len;
+    
+        MacAddr dst_mac = MacAddr::from_bytes(&f.data[4]);  // Destination
+        MacAddr src_mac = MacAddr::from_bytes(&f.data[10]); // Source  
+        MacAddr bssid = MacAddr::from_bytes(&f.data[16]);   // BSSID
+        
+        // Watched targets: both ends of the frame are looked up in the watchlist
+        int tx_target = match_target(src_mac);
+        int rx_target = match_target(dst_mac);
+        
+        if (tx_target >= 0 || rx_target >= 0) {
+            // Get frame type
+            TargetFrameType frame_type;
+            switch (frame_subtype) {
+                case WIFI_BEACON_FRAME: frame_type = TARGET_FRAME_BEACON; break;
+                case WIFI_PROBE_REQUEST: frame_type = TARGET_FRAME_PROBE; break;
+                case WIFI_PROBE_RESPONSE: frame_type = TARGET_FRAME_PROBE_RESP; break;
+                case WIFI_ASSOCIATION_REQUEST: frame_type = TARGET_FRAME_ASSOC; break;
+                case WIFI_ASSOCIATION_RESPONSE: frame_type = TARGET_FRAME_ASSOC_RESP; break;
+                case WIFI_DISASSOCIATION: frame_type = TARGET_FRAME_DISASSOC; break;
+                case WIFI_AUTHENTICATION: frame_type = TARGET_FRAME_AUTH; break;
+                case WIFI_DEAUTHENTICATION: frame_type = TARGET_FRAME_DEAUTH; break;
+                default: frame_type = TARGET_FRAME_MGMT; break;
+            }
+            
+            if (rx_target >= 0) note_target(rx_target, dst_mac, false, f, channel, frame_type);
+            if (tx_target >= 0) {
+                WatchTarget& t = note_target(tx_target, src_mac, true, f, channel, frame_type);
+                
+                // Try to extract SSID from probe requests
+                if (frame_subtype == WIFI_PROBE_REQUEST && frame_len > IE_OFFSET_PROBE_REQUEST) {
+                    ie_copy_ssid(&f.data[IE_OFFSET_PROBE_REQUEST], frame_len - IE_OFFSET_PROBE_REQUEST, t.ssid);
+                }
+                
+                // Try to extract IP from data frames (simplified approach)
+                if (frame_subtype == WIFI_ASSOCIATION_REQUEST) {
+                    t.ap = bssid;
+                    // Try to guess IP based on common patterns
+                    strcpy(t.ip, "192.168.1.x"); // Placeholder - would need DHCP analysis
+                }
+            }
+        }
+        
+        // Process different management frame types (existing code)
+      if (frame_subtype == WIFI_BEACON_FRAME) {
+            // Update AP registry
+            bool inserted = false;
+            APInfo& ap = ap_registry.upsert(bssid.value, &inserted);
+            if (inserted) channel_hopper.on_discovery(channel, f.hop_epoch);
+            ap.bssid = bssid;
+            ap.channel = channel;
+            ap.rssi = f.rssi;
+            ap.last_seen = millis();
+            ap.beacon_count++;
+            
+            // Parse tagged parameters: SSID, DS channel and RSN/WPA security
+            if (frame_len > IE_OFFSET_BEACON) {
+                const uint8_t* ies = &f.data[IE_OFFSET_BEACON];
+                size_t ies_len = frame_len - IE_OFFSET_BEACON;
+                
+                char ssid[33];
+                if (ie_copy_ssid(ies, ies_len, ssid) && strcmp(ssid, ap.ssid) != 0) {
+                    ap.ssid = intern_ssid(ssid);
+                }
+                
+                // Beacons leak onto adjacent channels; trust the advertised one
+                IeView ds;
+                if (ie_find(ies, ies_len, IE_DS_PARAMS, &ds) && ds.len >= 1 &&
+                    ds.data[0] >= 1 && ds.data[0] <= WIFI_CHANNEL_MAX) {
+                    ap.channel = ds.data[0];
+                }
+                
+                uint16_t capability = f.data[CAPABILITY_OFFSET] | (f.data[CAPABILITY_OFFSET + 1] << 8);
+                parse_security(capability, ies, ies_len, &ap.security);
+            }
+            
+            // Update channel stats
+            channel_stats[channel].ap_count++;
+            
+        } else if (frame_subtype == WIFI_PROBE_REQUEST) {
+            // Track client devices
+            bool inserted = false;
+            ClientInfo& client = client_registry.upsert(src_mac.value, &inserted);
+            if (inserted) channel_hopper.on_discovery(channel, f.hop_epoch);
+            client.mac = src_mac;
+            client.rssi = f.rssi;
+            client.rssi_track.add(f.rssi, now);
+            client.last_seen = millis();
+            client.frame_count++;
+            client.vendor = get_vendor_from_mac(src_mac);
+            client.is_associated = false;
+            
+            // Directed probes name networks the device has joined before
+            char probed[33];
+            if (frame_len > IE_OFFSET_PROBE_REQUEST &&
+                ie_copy_ssid(&f.data[IE_OFFSET_PROBE_REQUEST], frame_len - IE_OFFSET_PROBE_REQUEST, probed)) {
+                client_add_probe(client, probed);
+            }
+            
+            // Probe-only clients: guess the AP from timing and signal strength
+            // unless a data or association frame has already named it
+            if (!client.ap_exact) {
+                const APInfo* nearest_ap = ap_registry.find(find_closest_ap(src_mac, f.rssi, millis()));
+                if (nearest_ap != nullptr) {
+                    set_client_ap(client, nearest_ap->bssid, false);
+                }
+            }
+            
+        } else if (frame_subtype == WIFI_ASSOCIATION_REQUEST || frame_subtype == WIFI_REASSOCIATION_REQUEST) {
+            // Client associating to AP
+            bool inserted = false;
+            ClientInfo& client = client_registry.upsert(src_mac.value, &inserted);
+            if (inserted) channel_hopper.on_discovery(channel, f.hop_epoch);
+            client.mac = src_mac;
+            set_client_ap(client, bssid, true);
+            client.rssi = f.rssi;
+            client.rssi_track.add(f.rssi, now);
+            client.last_seen = millis();
+            client.frame_count++;
+            client.vendor = get_vendor_from_mac(src_mac);
+            client.is_associated = true;
+            
+        } else if (frame_subtype == WIFI_ASSOCIATION_RESPONSE || frame_subtype == WIFI_REASSOCIATION_RESPONSE) {
+            // AP responding to association
+            ClientInfo* client = client_registry.find(dst_mac.value);
+            if (client != nullptr) {
+                set_client_ap(*client, src_mac, true);
+                client->is_associated = true;
+            }
+            
+        } else if (frame_subtype == WIFI_DISASSOCIATION) {
+            // Client disconnecting
+            ClientInfo* client = client_registry.find(src_mac.value);
+            if (client != nullptr) {
+                client->is_associated = false;
+                set_client_ap(*client, MacAddr{0}, false);
+            }
+        }
+        
+    } else if (f.pkt_type == WIFI_PKT_DATA) {
+        data_frames++;
+        
+        // ToDS/FromDS say which address is the BSSID and which the station
+        DataFrameAddrs addrs;
+        if (!decode_data_addrs(f.data, f.cap_len, &addrs)) return; // Truncated header
+        MacAddr dst_mac = addrs.receiver;
+        MacAddr src_mac = addrs.transmitter;
+        
+        // Watched targets in data frames
+        int tx_target = match_target(src_mac);
+        int rx_target = match_target(dst_mac);
+        
+        if (tx_target >= 0 || rx_target >= 0) {
+            WatchTarget* t = nullptr;
+            if (rx_target >= 0) t = &note_target(rx_target, dst_mac, false, f, channel, TARGET_FRAME_DATA);
+            if (tx_target >= 0) t = &note_target(tx_target, src_mac, true, f, channel, TARGET_FRAME_DATA);
+            
+            // Try to extract IP from data frame payload
+            if (f.cap_len > 30) {
+                // Look for IP patterns in payload (simplified)
+                // This is a basic approach - real IP extraction would need more sophisticated parsing
+                for (int i = 30; i < min(f.cap_len - 4, 50); i++) {
+                    // Look for common IP patterns
+                    if (f.data[i] == 192 && f.data[i+1] == 168) {
+                        snprintf(t->ip, sizeof(t->ip), "%d.%d.%d.%d", 
+                                 f.data[i], f.data[i+1], 
+                                 f.data[i+2], f.data[i+3]);
+                        break;
+                    }
+                }
+            }
+        }
+        
+        // WDS/mesh frames link two APs and group-addressed frames name no
+        // station, so neither says anything about a client
+        if (addrs.wds || addrs.station.is_null() || addrs.station.is_multicast()) return;
+        
+        if (addrs.station_is_transmitter) {
+            // Station -> AP (or IBSS peer): the frame's RSSI is the station's
+            bool inserted = false;
+            ClientInfo& client = client_registry.upsert(addrs.station.value, &inserted);
+            if (inserted) channel_hopper.on_discovery(channel, f.hop_epoch);
+            client.mac = addrs.station;
+            client.frame_count++;
+            client.last_seen = millis();
+            client.rssi = f.rssi;
+            client.rssi_track.add(f.rssi, now);
+            client.is_associated = true;
+            if (client.vendor == nullptr) {
+                client.vendor = get_vendor_from_mac(addrs.station);
+            }
+            set_client_ap(client, addrs.bssid, true);
+        } else {
+            // AP -> station: the station was not heard, but its BSS is now known
+            ClientInfo* client = client_registry.find(addrs.station.value);
+            if (client != nullptr) {
+                client->is_associated = true;
+                set_client_ap(*client, addrs.bssid, true);
+            }
+        }
+        
+    } else if (f.pkt_type == WIFI_PKT_CTRL) {
+        ctrl_frames++;
+        // Control frames don't have standard 802.11 header, just count them
+        
+    } else {
+        // Catch any other packet types
+        ctrl_frames++; // Count as control for now
+    }
+}
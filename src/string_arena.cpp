@@ -0,0 +1,69 @@
+// Interning bump arena for SSIDs
+
+#include "string_arena.h"
+#include "pool_alloc.h"
+
+StringArena::StringArena()
+    : active(nullptr), half_bytes(0), top(0), index(nullptr), index_mask(0), count(0), flip_count(0) {
+    halves[0] = halves[1] = nullptr;
+}
+
+StringArena::~StringArena() {
+    pool_free(halves[0]);
+    pool_free(index);
+}
+
+bool StringArena::begin(size_t bytes) {
+    half_bytes = bytes / 2;
+    // One index slot per 16 bytes of text keeps the load factor low for short names
+    size_t slots = 64;
+    while (slots < half_bytes / 16) slots <<= 1;
+
+    halves[0] = (uint8_t*)pool_calloc(2 * half_bytes, POOL_PSRAM);
+    index = (uint32_t*)pool_calloc(slots * sizeof(uint32_t), POOL_INTERNAL);
+    if (halves[0] == nullptr || index == nullptr || half_bytes == 0) return false;
+
+    halves[1] = halves[0] + half_bytes;
+    active = halves[0];
+    index_mask = slots - 1;
+    top = 0;
+    count = 0;
+    return true;
+}
+
+static uint32_t fnv1a(const char* s, size_t len) {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < len; i++) h = (h ^ (uint8_t)s[i]) * 16777619u;
+    return h;
+}
+
+const char* StringArena::intern(const char* s, size_t len) {
+    if (len == 0) return "";
+    if (len > STRING_ARENA_MAX_LEN || active == nullptr) return nullptr;
+
+    size_t slot = fnv1a(s, len) & index_mask;
+    for (; index[slot] != 0; slot = (slot + 1) & index_mask) {
+        const uint8_t* rec = active + index[slot] - 1;
+        if (rec[0] == len && memcmp(rec + 1, s, len) == 0) return (const char*)rec + 1;
+    }
+
+    // Length byte + text + NUL; the index is kept under 3/4 full
+    if (top + len + 2 > half_bytes || (count + 1) * 4 > (index_mask + 1) * 3) return nullptr;
+
+    uint8_t* rec = active + top;
+    rec[0] = (uint8_t)len;
+    memcpy(rec + 1, s, len);
+    rec[len + 1] = '\0';
+    index[slot] = (uint32_t)top + 1;
+    top += len + 2;
+    count++;
+    return (const char*)rec + 1;
+}
+
+void StringArena::flip() {
+    active = (active == halves[0]) ? halves[1] : halves[0];
+    memset(index, 0, (index_mask + 1) * sizeof(uint32_t));
+    top = 0;
+    count = 0;
+    flip_count++;
+}
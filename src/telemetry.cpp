@@ -0,0 +1,334 @@
+// Telemetry stream: batch encoding in binary frames or NDJSON
+
+#include "telemetry.h"
+#include <string.h>
+#include <stdio.h>
+#include "sniffer.h"
+#include "pool_alloc.h"
+#include "crc32.h"
+
+#define FRAME_NONE ((size_t)-1)
+
+TelemetryEncoder telemetry;
+
+TelemetryEncoder::TelemetryEncoder()
+    : buf(nullptr), len(0), format(TELEMETRY_OFF), phase(PHASE_DONE), cursor(0), batch(0),
+      batch_start(0), since(0), full(false), full_pending(true), sequence(0),
+      frame_start(FRAME_NONE), frame_type(0), frame_count(0), gone_head(0), gone_tail(0) {
+    memset(channels, 0, sizeof(channels));
+    memset(sent, 0, sizeof(sent));
+    memset(&summary, 0, sizeof(summary));
+    memset(&st, 0, sizeof(st));
+}
+
+bool TelemetryEncoder::begin() {
+    if (buf == nullptr) buf = (uint8_t*)pool_calloc(TELEMETRY_BUF_BYTES, POOL_INTERNAL);
+    return buf != nullptr;
+}
+
+void TelemetryEncoder::on_removed(bool client, MacAddr mac) {
+    if (gone_head - gone_tail >= TELEMETRY_GONE_MAX) {
+        st.gone_dropped++;
+        return;
+    }
+    gone_mac[gone_head % TELEMETRY_GONE_MAX] = mac;
+    gone_kind[gone_head % TELEMETRY_GONE_MAX] = client ? TELEMETRY_GONE_CLIENT : TELEMETRY_GONE_AP;
+    gone_head++;
+}
+
+static inline int8_t clamp_dbm(int v) {
+    return (int8_t)(v < -128 ? -128 : v > 127 ? 127 : v);
+}
+
+static inline uint32_t age_of(uint32_t now, unsigned long last_seen) {
+    // The parser may stamp a record a little after the batch started
+    int32_t age = (int32_t)(now - last_seen);
+    return age < 0 ? 0 : (uint32_t)age;
+}
+
+void TelemetryEncoder::start(uint32_t now) {
+    batch++;
+    full = full_pending || batch % TELEMETRY_FULL_EVERY == 1;
+    full_pending = false;
+    // Changes since the previous batch started, so a record touched while that
+    // batch was being encoded is sent again rather than missed
+    since = batch_start;
+    batch_start = now;
+    phase = PHASE_CHANNELS;
+    cursor = 1;
+    frame_start = FRAME_NONE;
+    st.batches++;
+    st.last_bytes = 0;
+    st.last_records = 0;
+
+    for (int ch = 1; ch <= WIFI_CHANNEL_MAX; ch++) {
+        SignalSummary s;
+        channel_stats[ch].signal.summary(now, &s);
+        TelemetryChannel& c = channels[ch];
+        memset(&c, 0, sizeof(c));
+        c.channel = (uint8_t)ch;
+        c.snr = s.snr;
+        c.rssi_p50 = s.rssi_p50;
+        c.rssi_p90 = s.rssi_p90;
+        c.noise_p50 = s.noise_p50;
+        c.frames = s.frames;
+        c.retries = s.retries;
+    }
+
+    memset(&summary, 0, sizeof(summary));
+    summary.total_frames = total_frames;
+    summary.mgmt_frames = mgmt_frames;
+    summary.data_frames = data_frames;
+    summary.ctrl_frames = ctrl_frames;
+    summary.retry_frames = retry_frames;
+    summary.duplicate_frames = duplicate_frames;
+    summary.capture_drops = capture_ring.dropped();
+    summary.ap_count = (uint16_t)ap_registry.size();
+    summary.client_count = (uint16_t)client_registry.size();
+    summary.channel = (uint8_t)current_channel;
+    summary.filter = promisc_filter.active();
+    summary.gone_dropped = (uint16_t)st.gone_dropped;
+}
+
+// ---- Binary frames ----
+
+bool TelemetryEncoder::open_frame(TelemetryType type) {
+    if (len + TELEMETRY_FRAME_OVERHEAD + sizeof(TelemetryFrameHeader) > TELEMETRY_BUF_BYTES) return false;
+    frame_start = len;
+    frame_type = type;
+    frame_count = 0;
+    len += 4 + sizeof(TelemetryFrameHeader);
+    return true;
+}
+
+void TelemetryEncoder::close_frame() {
+    if (frame_start == FRAME_NONE) return;
+    if (frame_count == 0) {
+        len = frame_start;
+        frame_start = FRAME_NONE;
+        return;
+    }
+    uint8_t* f = buf + frame_start;
+    size_t payload = len - frame_start - 4;
+    TelemetryFrameHeader h;
+    memset(&h, 0, sizeof(h));
+    h.type = frame_type;
+    h.version = TELEMETRY_VERSION;
+    h.flags = full ? TELEMETRY_FLAG_FULL : 0;
+    h.count = frame_count;
+    h.batch = batch;
+    h.sequence = sequence++;
+    h.time_ms = batch_start;
+    f[0] = TELEMETRY_SYNC0;
+    f[1] = TELEMETRY_SYNC1;
+    f[2] = (uint8_t)payload;
+    f[3] = (uint8_t)(payload >> 8);
+    memcpy(f + 4, &h, sizeof(h));
+    uint32_t crc = crc32_update(CRC32_INIT, f + 4, payload);
+    memcpy(buf + len, &crc, 4);
+    len += 4;
+    frame_start = FRAME_NONE;
+    st.frames++;
+}
+
+bool TelemetryEncoder::put(TelemetryType type, const void* rec, size_t rec_len, const char* tail, size_t tail_len) {
+    if (format == TELEMETRY_NDJSON) return put_json(type, rec, tail, tail_len);
+    size_t need = rec_len + tail_len;
+    if (frame_start != FRAME_NONE &&
+        (frame_type != type || len - frame_start - 4 + need > TELEMETRY_FRAME_MAX)) {
+        close_frame();
+    }
+    if (frame_start == FRAME_NONE && !open_frame(type)) return false;
+    if (len + need + 4 > TELEMETRY_BUF_BYTES) return false;
+    memcpy(buf + len, rec, rec_len);
+    memcpy(buf + len + rec_len, tail, tail_len);
+    len += need;
+    frame_count++;
+    st.records++;
+    st.last_records++;
+    return true;
+}
+
+// ---- NDJSON ----
+
+// Writes s as the body of a JSON string; out must hold 6 * n + 1 bytes
+static void json_escape(const char* s, size_t n, char* out) {
+    static const char hex[] = "0123456789abcdef";
+    for (size_t i = 0; i < n; i++) {
+        uint8_t c = (uint8_t)s[i];
+        if (c == '"' || c == '\\') {
+            *out++ = '\\';
+            *out++ = (char)c;
+        } else if (c < 0x20 || c >= 0x7F) {
+            memcpy(out, "\\u00", 4);
+            out[4] = hex[c >> 4];
+            out[5] = hex[c & 0x0F];
+            out += 6;
+        } else {
+            *out++ = (char)c;
+        }
+    }
+    *out = '\0';
+}
+
+bool TelemetryEncoder::put_json(TelemetryType type, const void* rec, const char* tail, size_t tail_len) {
+    char* out = (char*)buf + len;
+    size_t room = TELEMETRY_BUF_BYTES - len;
+    char mac[18], ap[18];
+    int n = 0;
+    switch (type) {
+    case TELEMETRY_CHANNEL: {
+        const TelemetryChannel* c = (const TelemetryChannel*)rec;
+        n = snprintf(out, room,
+                     "{\"type\":\"channel\",\"batch\":%lu,\"ch\":%u,\"frames\":%lu,\"retries\":%lu,"
+                     "\"rssi_p50\":%d,\"rssi_p90\":%d,\"noise_p50\":%d,\"snr\":%d}\n",
+                     (unsigned long)batch, c->channel, (unsigned long)c->frames, (unsigned long)c->retries,
+                     c->rssi_p50, c->rssi_p90, c->noise_p50, c->snr);
+        break;
+    }
+    case TELEMETRY_GONE: {
+        const TelemetryGone* g = (const TelemetryGone*)rec;
+        MacAddr::from_bytes(g->mac).format(mac);
+        n = snprintf(out, room, "{\"type\":\"gone\",\"batch\":%lu,\"kind\":\"%s\",\"mac\":\"%s\"}\n",
+                     (unsigned long)batch, g->kind == TELEMETRY_GONE_CLIENT ? "client" : "ap", mac);
+        break;
+    }
+    case TELEMETRY_AP: {
+        const TelemetryAp* a = (const TelemetryAp*)rec;
+        char ssid[32 * 6 + 1];
+        json_escape(tail, tail_len, ssid);
+        MacAddr::from_bytes(a->bssid).format(mac);
+        n = snprintf(out, room,
+                     "{\"type\":\"ap\",\"batch\":%lu,\"bssid\":\"%s\",\"ssid\":\"%s\",\"ch\":%u,\"rssi\":%d,"
+                     "\"age_ms\":%lu,\"beacons\":%lu,\"clients\":%u,\"security\":\"%s\"}\n",
+                     (unsigned long)batch, mac, ssid, a->channel, a->rssi, (unsigned long)a->age_ms,
+                     (unsigned long)a->beacon_count, a->client_count, security_label(a->security));
+        break;
+    }
+    case TELEMETRY_CLIENT: {
+        const TelemetryClient* c = (const TelemetryClient*)rec;
+        MacAddr::from_bytes(c->mac).format(mac);
+        MacAddr::from_bytes(c->ap).format(ap);
+        n = snprintf(out, room,
+                     "{\"type\":\"client\",\"batch\":%lu,\"mac\":\"%s\",\"ap\":\"%s\",\"associated\":%s,"
+                     "\"ap_exact\":%s,\"rssi\":%d,\"age_ms\":%lu,\"frames\":%lu,\"retries\":%lu,\"probes\":%u}\n",
+                     (unsigned long)batch, mac, ap, (c->flags & TELEMETRY_CLIENT_ASSOCIATED) ? "true" : "false",
+                     (c->flags & TELEMETRY_CLIENT_AP_EXACT) ? "true" : "false", c->rssi,
+                     (unsigned long)c->age_ms, (unsigned long)c->frame_count, (unsigned long)c->retry_count,
+                     c->probe_count);
+        break;
+    }
+    case TELEMETRY_SUMMARY: {
+        const TelemetrySummary* s = (const TelemetrySummary*)rec;
+        n = snprintf(out, room,
+                     "{\"type\":\"summary\",\"batch\":%lu,\"time_ms\":%lu,\"full\":%s,\"frames\":%lu,"
+                     "\"mgmt\":%lu,\"data\":%lu,\"ctrl\":%lu,\"retry\":%lu,\"duplicate\":%lu,\"drops\":%lu,"
+                     "\"aps\":%u,\"clients\":%u,\"ch\":%u,\"filter\":\"%s\",\"gone_dropped\":%u}\n",
+                     (unsigned long)batch, (unsigned long)batch_start, full ? "true" : "false",
+                     (unsigned long)s->total_frames, (unsigned long)s->mgmt_frames, (unsigned long)s->data_frames,
+                     (unsigned long)s->ctrl_frames, (unsigned long)s->retry_frames,
+                     (unsigned long)s->duplicate_frames, (unsigned long)s->capture_drops, s->ap_count,
+                     s->client_count, s->channel, PromiscFilter::name((FilterProfile)s->filter), s->gone_dropped);
+        break;
+    }
+    }
+    // A line that does not fit is dropped and retried in the next buffer
+    if (n <= 0 || (size_t)n >= room) return false;
+    len += n;
+    st.frames++;
+    st.records++;
+    st.last_records++;
+    return true;
+}
+
+// ---- Batch walk ----
+
+// Emits the next record or moves to the next phase; false when the buffer is full
+bool TelemetryEncoder::step() {
+    switch (phase) {
+    case PHASE_CHANNELS:
+        if (cursor > WIFI_CHANNEL_MAX) break;
+        if (full || channels[cursor].frames != sent[cursor].frames || channels[cursor].snr != sent[cursor].snr) {
+            if (!put(TELEMETRY_CHANNEL, &channels[cursor], sizeof(TelemetryChannel), nullptr, 0)) return false;
+            sent[cursor] = channels[cursor];
+        }
+        cursor++;
+        return true;
+
+    case PHASE_GONE:
+        if (gone_tail == gone_head) break;
+        {
+            TelemetryGone g;
+            memset(&g, 0, sizeof(g));
+            gone_mac[gone_tail % TELEMETRY_GONE_MAX].to_bytes(g.mac);
+            g.kind = gone_kind[gone_tail % TELEMETRY_GONE_MAX];
+            if (!put(TELEMETRY_GONE, &g, sizeof(g), nullptr, 0)) return false;
+        }
+        gone_tail++;
+        return true;
+
+    case PHASE_APS:
+        if (cursor >= ap_registry.capacity()) break;
+        if (ap_registry.used((uint16_t)cursor)) {
+            const APInfo& a = ap_registry.at((uint16_t)cursor).value;
+            if (full || (int32_t)((uint32_t)a.last_seen - since) >= 0) {
+                TelemetryAp r;
+                memset(&r, 0, sizeof(r));
+                a.bssid.to_bytes(r.bssid);
+                r.rssi = clamp_dbm(a.rssi);
+                r.channel = (uint8_t)a.channel;
+                r.age_ms = age_of(batch_start, a.last_seen);
+                r.beacon_count = a.beacon_count;
+                r.security = a.security;
+                r.client_count = (uint16_t)a.client_count;
+                size_t n = strlen(a.ssid);
+                r.ssid_len = (uint8_t)(n > 32 ? 32 : n);
+                if (!put(TELEMETRY_AP, &r, sizeof(r), a.ssid, r.ssid_len)) return false;
+            }
+        }
+        cursor++;
+        return true;
+
+    case PHASE_CLIENTS:
+        if (cursor >= client_registry.capacity()) break;
+        if (client_registry.used((uint16_t)cursor)) {
+            const ClientInfo& c = client_registry.at((uint16_t)cursor).value;
+            if (full || (int32_t)((uint32_t)c.last_seen - since) >= 0) {
+                TelemetryClient r;
+                memset(&r, 0, sizeof(r));
+                c.mac.to_bytes(r.mac);
+                c.connected_ap.to_bytes(r.ap);
+                r.age_ms = age_of(batch_start, c.last_seen);
+                r.frame_count = c.frame_count;
+                r.retry_count = c.retry_count;
+                r.rssi = clamp_dbm(c.rssi_track.empty() ? c.rssi : c.rssi_track.smoothed());
+                r.flags = (c.is_associated ? TELEMETRY_CLIENT_ASSOCIATED : 0) |
+                          (c.ap_exact ? TELEMETRY_CLIENT_AP_EXACT : 0);
+                r.probe_count = c.probe_count;
+                if (!put(TELEMETRY_CLIENT, &r, sizeof(r), nullptr, 0)) return false;
+            }
+        }
+        cursor++;
+        return true;
+
+    case PHASE_SUMMARY:
+        if (!put(TELEMETRY_SUMMARY, &summary, sizeof(summary), nullptr, 0)) return false;
+        break;
+
+    case PHASE_DONE:
+        return false;
+    }
+    phase = (Phase)(phase + 1);
+    cursor = phase == PHASE_CHANNELS ? 1 : 0;
+    return true;
+}
+
+size_t TelemetryEncoder::encode() {
+    len = 0;
+    if (buf == nullptr || format == TELEMETRY_OFF) return 0;
+    while (phase != PHASE_DONE && step()) {}
+    close_frame();
+    st.bytes += len;
+    st.last_bytes += len;
+    return len;
+}
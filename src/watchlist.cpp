@@ -0,0 +1,130 @@
+// Target watchlist and its NVS persistence
+
+#include "watchlist.h"
+#include <string.h>
+#ifdef ESP_PLATFORM
+#include "nvs.h"
+#endif
+
+#define WATCH_NVS_NAMESPACE "sniffer"
+#define WATCH_NVS_KEY "watchlist"
+#define WATCH_NVS_VERSION 1                // First word of the blob; an empty list is still stored
+
+Watchlist::Watchlist() : count(0) {
+    rebuild();
+}
+
+void Watchlist::rebuild() {
+    memset(slot_key, 0, sizeof(slot_key));
+    for (size_t i = 0; i < count; i++) {
+        uint64_t k = set_key(targets[i].key, targets[i].prefix);
+        size_t s = slot_of(k);
+        while (slot_key[s] != 0) s = (s + 1) & (WATCH_SET_SLOTS - 1);
+        slot_key[s] = k;
+        slot_target[s] = (uint8_t)i;
+    }
+}
+
+int Watchlist::find(MacAddr key, bool prefix) const {
+    uint64_t k = set_key(key, prefix);
+    for (size_t i = 0; i < count; i++) {
+        if (set_key(targets[i].key, targets[i].prefix) == k) return (int)i;
+    }
+    return -1;
+}
+
+bool Watchlist::add(MacAddr key, bool prefix) {
+    if (count >= WATCHLIST_MAX || find(key, prefix) >= 0) return false;
+    WatchTarget& t = targets[count++];
+    memset(&t, 0, sizeof(t));
+    t.key = prefix ? MacAddr::from_u64((uint64_t)key.oui() << 24) : key;
+    t.prefix = prefix;
+    rebuild();
+    return true;
+}
+
+bool Watchlist::remove(MacAddr key, bool prefix) {
+    int i = find(key, prefix);
+    if (i < 0) return false;
+    // Later targets move down one slot and keep their stats
+    for (size_t j = i + 1; j < count; j++) targets[j - 1] = targets[j];
+    count--;
+    rebuild();
+    return true;
+}
+
+void Watchlist::clear() {
+    count = 0;
+    rebuild();
+}
+
+void Watchlist::expire(unsigned long now, unsigned long timeout_ms) {
+    for (size_t i = 0; i < count; i++) {
+        if (targets[i].found && now - targets[i].last_seen > timeout_ms) targets[i].found = false;
+    }
+}
+
+size_t Watchlist::export_keys(uint64_t* out, size_t max) const {
+    size_t n = count < max ? count : max;
+    for (size_t i = 0; i < n; i++) out[i] = set_key(targets[i].key, targets[i].prefix);
+    return n;
+}
+
+void Watchlist::import_keys(const uint64_t* keys, size_t n) {
+    clear();
+    for (size_t i = 0; i < n; i++) {
+        bool prefix = (keys[i] & KEY_PREFIX) != 0;
+        MacAddr key = prefix ? MacAddr::from_u64((keys[i] & 0xFFFFFF) << 24) : MacAddr::from_u64(keys[i]);
+        add(key, prefix);
+    }
+}
+
+bool Watchlist::parse(const char* str, MacAddr* key, bool* prefix) {
+    if (MacAddr::parse(str, key)) {
+        *prefix = false;
+        return true;
+    }
+    // "AA:BB:CC" is parsed as AA:BB:CC:00:00:00
+    char padded[18];
+    if (strlen(str) != 8) return false;
+    memcpy(padded, str, 8);
+    memcpy(padded + 8, ":00:00:00", 10);
+    if (!MacAddr::parse(padded, key)) return false;
+    *prefix = true;
+    return true;
+}
+
+void Watchlist::format(MacAddr key, bool prefix, char* out) {
+    key.format(out);
+    if (prefix) strcpy(out + 8, ":*");
+}
+
+#ifdef ESP_PLATFORM
+bool watchlist_load(Watchlist& list) {
+    nvs_handle_t h;
+    if (nvs_open(WATCH_NVS_NAMESPACE, NVS_READONLY, &h) != ESP_OK) return false;
+    uint64_t blob[WATCHLIST_MAX + 1];
+    size_t len = sizeof(blob);
+    esp_err_t err = nvs_get_blob(h, WATCH_NVS_KEY, blob, &len);
+    nvs_close(h);
+    if (err != ESP_OK || len < sizeof(uint64_t) || len % sizeof(uint64_t) != 0 ||
+        blob[0] != WATCH_NVS_VERSION) return false;
+    list.import_keys(blob + 1, len / sizeof(uint64_t) - 1);
+    return true;
+}
+
+bool watchlist_save(const Watchlist& list) {
+    nvs_handle_t h;
+    if (nvs_open(WATCH_NVS_NAMESPACE, NVS_READWRITE, &h) != ESP_OK) return false;
+    uint64_t blob[WATCHLIST_MAX + 1];
+    blob[0] = WATCH_NVS_VERSION;
+    size_t n = list.export_keys(blob + 1, WATCHLIST_MAX);
+    esp_err_t err = nvs_set_blob(h, WATCH_NVS_KEY, blob, (n + 1) * sizeof(uint64_t));
+    if (err == ESP_OK) err = nvs_commit(h);
+    nvs_close(h);
+    return err == ESP_OK;
+}
+#else
+bool watchlist_load(Watchlist& /* list */) { return false; }
+bool watchlist_save(const Watchlist& /* list */) { return false; }
+#endif
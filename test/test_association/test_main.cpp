@@ -0,0 +1,166 @@
+// Association index: after a long random mix of beacons, (re)associations,
+// data in both directions, disassociations, probes, expiry and LRU eviction,
+// every AP's client list and count must match a full recount of the client
+// registry, and every client's AP must match what its frames last said
+
+#include <Arduino.h>
+#include <unity.h>
+#include <map>
+#include "sniffer.h"
+#include "frame_builder.h"
+
+#define TEST_APS 40
+#define TEST_CLIENTS 300
+#define TEST_STEPS 60000
+#define TEST_STEP_US 20000             // 20 ms between frames
+#define TEST_PHASE_STEPS 2000          // Devices come and go in 40 s phases
+
+// What a client's frames last said about its AP; unknown once a guess may apply
+struct Truth {
+    uint64_t ap;
+    bool known;
+};
+
+static std::map<uint64_t, Truth> truth;
+static uint64_t rng_state;
+
+void setUp() {
+    truth.clear();
+    rng_state = 0x9E3779B97F4A7C15ULL;
+    ap_ttl_ms = 10000;
+    client_ttl_ms = 8000;
+}
+
+void tearDown() {
+    ap_ttl_ms = AP_TTL_MS;
+    client_ttl_ms = CLIENT_TTL_MS;
+}
+
+static uint32_t rnd(uint32_t n) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return (uint32_t)(rng_state >> 32) % n;
+}
+
+static MacAddr ap_mac(uint32_t i) { return MacAddr::from_u64(0x00A0C9000000ULL + i); }
+static MacAddr client_mac(uint32_t i) { return MacAddr::from_u64(0x3C0754000000ULL + i); }
+
+// Lists walked from each AP against a recount by ap_index; returns the number of links
+static size_t check_consistency() {
+    std::map<uint16_t, int> counts;
+    size_t linked = 0;
+    for (const auto& e : client_registry) {
+        const ClientInfo& c = e.value;
+        if (c.ap_index == ASSOC_NIL) continue;
+        linked++;
+        TEST_ASSERT_TRUE(ap_registry.used(c.ap_index));
+        TEST_ASSERT_EQUAL_UINT64(c.connected_ap.value, ap_registry.at(c.ap_index).key);
+        counts[c.ap_index]++;
+    }
+    for (const auto& e : ap_registry) {
+        uint16_t idx = ap_registry.index_of(e);
+        int n = 0;
+        uint16_t prev = ASSOC_NIL;
+        for (uint16_t c = e.value.first_client; c != ASSOC_NIL; c = client_registry.at(c).value.ap_next) {
+            TEST_ASSERT_TRUE(client_registry.used(c));
+            TEST_ASSERT_EQUAL_UINT16(prev, client_registry.at(c).value.ap_prev);
+            TEST_ASSERT_EQUAL_UINT16(idx, client_registry.at(c).value.ap_index);
+            prev = c;
+            n++;
+            TEST_ASSERT_LESS_OR_EQUAL(TEST_CLIENTS, n);
+        }
+        TEST_ASSERT_EQUAL_INT(counts[idx], n);
+        TEST_ASSERT_EQUAL_INT(n, e.value.client_count);
+    }
+    for (const auto& e : client_registry) {
+        auto t = truth.find(e.key);
+        if (t != truth.end() && t->second.known) {
+            TEST_ASSERT_EQUAL_UINT64(t->second.ap, e.value.connected_ap.value);
+        }
+    }
+    return linked;
+}
+
+static void run_scenario(uint16_t ap_capacity, uint16_t client_capacity) {
+    TEST_ASSERT_TRUE(sniffer_init(ap_capacity, client_capacity));
+    uint32_t expired = ap_expired + client_expired;
+    uint32_t evicted = ap_registry.evictions() + client_registry.evictions();
+    size_t max_linked = 0;
+
+    for (uint32_t step = 0; step < TEST_STEPS; step++) {
+        host_clock_set_us(1000000 + (uint64_t)step * TEST_STEP_US);
+        uint32_t phase = step / TEST_PHASE_STEPS;
+        uint32_t a = rnd(TEST_APS);
+        uint32_t c = rnd(TEST_CLIENTS);
+        // A fifth of the devices are silent in each phase, long enough to expire
+        if ((phase + a) % 5 == 0 || (phase + c) % 5 == 0) continue;
+
+        MacAddr ap = ap_mac(a), sta = client_mac(c);
+        bool present = client_registry.find(sta.value) != nullptr;
+        Truth& t = truth[sta.value];
+        uint32_t kind = rnd(100);
+        if (kind < 30) {
+            deliver_frame(beacon_frame(ap, "assoc", 6));
+        } else if (kind < 45) {
+            RawFrame f;
+            uint8_t subtype = kind < 40 ? WIFI_ASSOCIATION_REQUEST : WIFI_REASSOCIATION_REQUEST;
+            frame_header(&f, WIFI_MANAGEMENT_FRAME, subtype, 0, ap, sta, ap);
+            deliver_frame(f);
+            t.ap = ap.value;
+            t.known = true;
+        } else if (kind < 70) {
+            deliver_frame(data_frame(8, FRAME_TO_DS, ap, sta, MacAddr::from_u64(0xFFFFFFFFFFFFULL)));
+            t.ap = ap.value;
+            t.known = true;
+        } else if (kind < 85) {
+            deliver_frame(data_frame(0, FRAME_FROM_DS, sta, ap, ap));
+            if (present) {
+                t.ap = ap.value;
+                t.known = true;
+            }
+        } else if (kind < 95) {
+            deliver_frame(probe_request_frame(sta, ""));
+            if (!present || t.ap == 0) t.known = false;
+        } else {
+            RawFrame f;
+            frame_header(&f, WIFI_MANAGEMENT_FRAME, WIFI_DISASSOCIATION, 0, ap, sta, ap);
+            deliver_frame(f);
+            if (present) {
+                t.ap = 0;
+                t.known = true;
+            }
+        }
+
+        if (step % 2 == 0) expire_stale_entries(millis(), EXPIRY_BUDGET);
+        if (step % 500 == 0) {
+            size_t linked = check_consistency();
+            if (linked > max_linked) max_linked = linked;
+        }
+    }
+    check_consistency();
+
+    // The run exercised what it is meant to: expiry with room to spare,
+    // eviction of linked records when the tables are small
+    TEST_ASSERT_GREATER_THAN(std::min<size_t>(TEST_CLIENTS, client_capacity) / 4, max_linked);
+    if (client_capacity >= TEST_CLIENTS) {
+        TEST_ASSERT_GREATER_THAN(expired, ap_expired + client_expired);
+    } else {
+        TEST_ASSERT_GREATER_THAN(evicted, ap_registry.evictions() + client_registry.evictions());
+    }
+}
+
+static void test_lists_match_recount() {
+    run_scenario(AP_TABLE_CAPACITY, CLIENT_TABLE_CAPACITY);
+}
+
+static void test_lists_match_recount_with_eviction() {
+    run_scenario(8, 16);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_lists_match_recount);
+    RUN_TEST(test_lists_match_recount_with_eviction);
+    return UNITY_END();
+}
@@ -0,0 +1,90 @@
+// Client-to-AP attribution from data frame addresses: 300 clients spread over
+// 40 APs, heard through QoS ToDS and FromDS data, QoS Null and plain Null
+// frames, with WDS frames between the APs and wildcard probes mixed in. Every
+// client must end up on its own AP, exactly, and no AP may appear as a client.
+
+#include <Arduino.h>
+#include <unity.h>
+#include <vector>
+#include "sniffer.h"
+#include "frame_builder.h"
+
+#define TEST_APS 40
+#define TEST_CLIENTS 300
+#define TEST_FRAMES 30000
+
+static uint64_t rng_state = 0x2545F4914F6CDD1DULL;
+
+void setUp() {}
+void tearDown() {}
+
+static uint32_t rnd(uint32_t n) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return (uint32_t)(rng_state >> 32) % n;
+}
+
+static void test_every_client_on_its_own_ap() {
+    TEST_ASSERT_TRUE(sniffer_init());
+    std::vector<MacAddr> aps, clients;
+    std::vector<uint32_t> home;
+    for (uint32_t i = 0; i < TEST_APS; i++) aps.push_back(MacAddr::from_u64(0x240AC4000000ULL + i));
+    for (uint32_t i = 0; i < TEST_CLIENTS; i++) {
+        clients.push_back(MacAddr::from_u64(0x021122000007ULL + ((uint64_t)i << 8)));
+        home.push_back(rnd(TEST_APS));
+    }
+    MacAddr group = MacAddr::from_u64(0x333300000001ULL);
+    MacAddr gateway = MacAddr::from_u64(0x100000000001ULL);
+
+    uint64_t now_us = 1000000;
+    for (int i = 0; i < TEST_FRAMES; i++) {
+        now_us += 100 + rnd(2900);
+        host_clock_set_us(now_us);
+        uint32_t c = rnd(TEST_CLIENTS);
+        MacAddr sta = clients[c], ap = aps[home[c]];
+        int rssi = -30 - (int)rnd(60);
+        uint32_t kind = rnd(100);
+        if (kind < 30) {
+            uint32_t a = rnd(TEST_APS);
+            deliver_frame(beacon_frame(aps[a], "attr", 1 + a % 13), rssi, 1 + a % 13);
+        } else if (kind < 40) {
+            deliver_frame(probe_request_frame(sta, ""), rssi, 1);
+        } else if (kind < 64) {
+            deliver_frame(data_frame(8, FRAME_TO_DS, ap, sta, group), rssi);             // QoS ToDS
+        } else if (kind < 88) {
+            deliver_frame(data_frame(8, FRAME_FROM_DS, sta, ap, gateway), rssi);         // QoS FromDS
+        } else if (kind < 94) {
+            deliver_frame(data_frame(8, FRAME_TO_DS | FRAME_FROM_DS, ap, aps[rnd(TEST_APS)], sta, sta), rssi);  // WDS
+        } else if (kind < 97) {
+            deliver_frame(data_frame(12, FRAME_TO_DS, ap, sta, ap), rssi);               // QoS Null
+        } else {
+            deliver_frame(data_frame(4, FRAME_TO_DS, ap, sta, ap), rssi);                // Null
+        }
+    }
+
+    size_t correct = 0, exact = 0;
+    for (uint32_t c = 0; c < TEST_CLIENTS; c++) {
+        const ClientInfo* info = client_registry.find(clients[c].value);
+        TEST_ASSERT_NOT_NULL(info);
+        correct += info->connected_ap == aps[home[c]];
+        exact += info->ap_exact;
+    }
+    TEST_ASSERT_EQUAL(TEST_CLIENTS, correct);
+    TEST_ASSERT_EQUAL(TEST_CLIENTS, exact);
+    TEST_ASSERT_EQUAL(TEST_CLIENTS, client_registry.size());
+    for (uint32_t a = 0; a < TEST_APS; a++) TEST_ASSERT_NULL(client_registry.find(aps[a].value));
+    TEST_ASSERT_NULL(client_registry.find(group.value));
+    TEST_ASSERT_NULL(client_registry.find(gateway.value));
+
+    // Association lists agree with the attribution
+    int linked = 0;
+    for (const auto& e : ap_registry) linked += e.value.client_count;
+    TEST_ASSERT_EQUAL_INT(TEST_CLIENTS, linked);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_every_client_on_its_own_ap);
+    return UNITY_END();
+}
@@ -0,0 +1,108 @@
+// Capture ring and RX path under overload: drop, push and peak counters, and
+// frames reaching the parser in arrival order
+
+#include <Arduino.h>
+#include <unity.h>
+#include <vector>
+#include "sniffer.h"
+#include "frame_builder.h"
+
+static SpscRing<uint32_t, 8> ring;
+
+void setUp() {}
+void tearDown() {}
+
+static void push(uint32_t v) {
+    uint32_t* slot = ring.acquire();
+    if (slot == nullptr) return;
+    *slot = v;
+    ring.publish();
+}
+
+static void test_ring_flood_counts_drops() {
+    for (uint32_t v = 0; v < 20; v++) push(v);
+    TEST_ASSERT_EQUAL_UINT32(8, ring.pushed());
+    TEST_ASSERT_EQUAL_UINT32(12, ring.dropped());
+    TEST_ASSERT_EQUAL_UINT32(8, ring.peak());
+    TEST_ASSERT_EQUAL(8, ring.available());
+    for (uint32_t i = 0; i < 8; i++) TEST_ASSERT_EQUAL_UINT32(i, ring.peek(i));
+
+    // Freed slots take new frames behind the ones still queued
+    ring.consume(3);
+    for (uint32_t v = 100; v < 105; v++) push(v);
+    TEST_ASSERT_EQUAL_UINT32(11, ring.pushed());
+    TEST_ASSERT_EQUAL_UINT32(14, ring.dropped());
+    static const uint32_t EXPECT[8] = {3, 4, 5, 6, 7, 100, 101, 102};
+    for (uint32_t i = 0; i < 8; i++) TEST_ASSERT_EQUAL_UINT32(EXPECT[i], ring.peek(i));
+    ring.consume(8);
+    TEST_ASSERT_EQUAL(0, ring.available());
+}
+
+static void test_ring_keeps_order_across_wrap() {
+    uint32_t dropped = ring.dropped();
+    uint32_t next_in = 1000, next_out = 1000;
+    // Bursts of 1..7 frames, drained by a consumer that lags one frame behind
+    for (int round = 0; round < 500; round++) {
+        for (int i = 0; i < 1 + round % 7; i++) push(next_in++);
+        size_t n = ring.available();
+        for (size_t i = 0; i + 1 < n; i++) TEST_ASSERT_EQUAL_UINT32(next_out++, ring.peek(i));
+        ring.consume(n > 0 ? n - 1 : 0);
+    }
+    TEST_ASSERT_EQUAL_UINT32(dropped, ring.dropped());
+    TEST_ASSERT_EQUAL_UINT32(8, ring.peak());
+    TEST_ASSERT_EQUAL(1, ring.available());
+    TEST_ASSERT_EQUAL_UINT32(next_out, ring.peek(0));
+    TEST_ASSERT_EQUAL_UINT32(next_in - 1, next_out);
+}
+
+static void test_rx_flood_drops_newest_and_parses_in_order() {
+    TEST_ASSERT_TRUE(sniffer_init());
+    host_clock_set_us(1000000);
+
+    const size_t BURST = CAPTURE_RING_SLOTS * 3;
+    std::vector<std::vector<uint8_t>> packets;
+    for (size_t i = 0; i < BURST; i++) {
+        MacAddr bssid = MacAddr::from_u64(0x02AA00000000ULL + i);
+        packets.push_back(driver_packet(beacon_frame(bssid, "flood", 6), -60, 6));
+    }
+
+    uint32_t dropped = capture_ring.dropped();
+    uint32_t pushed = capture_ring.pushed();
+    int frames = total_frames;
+
+    // The parser is stalled: the ring fills and every later frame is dropped
+    for (const auto& p : packets) wifi_sniffer_packet_handler((void*)p.data(), WIFI_PKT_MGMT);
+    TEST_ASSERT_EQUAL_UINT32(pushed + CAPTURE_RING_SLOTS, capture_ring.pushed());
+    TEST_ASSERT_EQUAL_UINT32(dropped + BURST - CAPTURE_RING_SLOTS, capture_ring.dropped());
+    TEST_ASSERT_EQUAL_UINT32(CAPTURE_RING_SLOTS, capture_ring.peak());
+    TEST_ASSERT_EQUAL(CAPTURE_RING_SLOTS, capture_ring.available());
+    for (size_t i = 0; i < CAPTURE_RING_SLOTS; i++) {
+        const CapturedFrame& f = capture_ring.peek(i);
+        TEST_ASSERT_EQUAL_UINT64(0x02AA00000000ULL + i, MacAddr::from_bytes(&f.data[10]).value);
+        TEST_ASSERT_TRUE(f.seq_flags & CAPTURE_SEQ_VALID);
+    }
+
+    drain_capture_ring();
+    TEST_ASSERT_EQUAL_INT(frames + CAPTURE_RING_SLOTS, total_frames);
+    TEST_ASSERT_EQUAL(CAPTURE_RING_SLOTS, ap_registry.size());
+    TEST_ASSERT_NULL(ap_registry.find(0x02AA00000000ULL + CAPTURE_RING_SLOTS));
+
+    // A parser that keeps up loses nothing
+    dropped = capture_ring.dropped();
+    for (size_t i = 0; i < BURST; i += CAPTURE_RING_SLOTS / 2) {
+        for (size_t j = i; j < i + CAPTURE_RING_SLOTS / 2 && j < BURST; j++) {
+            wifi_sniffer_packet_handler((void*)packets[j].data(), WIFI_PKT_MGMT);
+        }
+        drain_capture_ring();
+    }
+    TEST_ASSERT_EQUAL_UINT32(dropped, capture_ring.dropped());
+    TEST_ASSERT_EQUAL(BURST, ap_registry.size());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_ring_flood_counts_drops);
+    RUN_TEST(test_ring_keeps_order_across_wrap);
+    RUN_TEST(test_rx_flood_drops_newest_and_parses_in_order);
+    return UNITY_END();
+}
@@ -0,0 +1,133 @@
+// Registry expiry at full scale: with 10k clients and 1k APs, more than half
+// of them stale, every call removes at most EXPIRY_BUDGET records per
+// registry, stops at the first fresh record, and repeated calls remove
+// exactly the stale set, reporting each removal once
+
+#include <Arduino.h>
+#include <unity.h>
+#include <set>
+#include "sniffer.h"
+#include "frame_builder.h"
+
+#define TEST_APS 1000
+#define TEST_CLIENTS 10000
+#define TEST_STALE_APS 640             // Not a multiple of EXPIRY_BUDGET...
+#define TEST_STALE_CLIENTS 6003        // ... so the last call stops short of the budget
+#define TEST_AP_TTL_MS 60000
+#define TEST_CLIENT_TTL_MS 30000
+#define TEST_NOW_MS 200000
+
+static std::set<uint64_t> removed_aps, removed_clients;
+static size_t repeated;
+
+void setUp() {
+    removed_aps.clear();
+    removed_clients.clear();
+    repeated = 0;
+    ap_ttl_ms = TEST_AP_TTL_MS;
+    client_ttl_ms = TEST_CLIENT_TTL_MS;
+}
+
+void tearDown() {
+    set_expiry_callback(nullptr, nullptr);
+    ap_ttl_ms = AP_TTL_MS;
+    client_ttl_ms = CLIENT_TTL_MS;
+}
+
+static MacAddr ap_mac(uint32_t i) { return MacAddr::from_u64(0x00A0C9000000ULL + i); }
+static MacAddr client_mac(uint32_t i) { return MacAddr::from_u64(0x3C0754000000ULL + i); }
+
+static void on_expired(RegistryKind kind, MacAddr mac, void* /* ctx */) {
+    std::set<uint64_t>& removed = kind == REGISTRY_AP ? removed_aps : removed_clients;
+    if (!removed.insert(mac.value).second) repeated++;
+}
+
+// Stale records are heard first, in index order, 1 ms apart; fresh ones later.
+// The first fresh client is exactly client_ttl_ms old at TEST_NOW_MS, which
+// is not yet stale.
+static void fill_registries() {
+    TEST_ASSERT_TRUE(sniffer_init(TEST_APS + 24, TEST_CLIENTS + 240));
+    for (uint32_t i = 0; i < TEST_STALE_APS; i++) {
+        host_clock_set_us((1000ULL + i) * 1000);
+        deliver_frame(beacon_frame(ap_mac(i), "Stale", 6), -70, 6);
+    }
+    for (uint32_t i = 0; i < TEST_STALE_CLIENTS; i++) {
+        host_clock_set_us((2000ULL + i) * 1000);
+        deliver_frame(probe_request_frame(client_mac(i), ""), -60, 6);
+    }
+    uint64_t fresh_ms = TEST_NOW_MS - TEST_CLIENT_TTL_MS;
+    for (uint32_t i = TEST_STALE_CLIENTS; i < TEST_CLIENTS; i++) {
+        host_clock_set_us((fresh_ms * 1000) + (uint64_t)(i - TEST_STALE_CLIENTS) * 1000);
+        deliver_frame(probe_request_frame(client_mac(i), ""), -60, 6);
+    }
+    for (uint32_t i = TEST_STALE_APS; i < TEST_APS; i++) {
+        host_clock_set_us((fresh_ms + TEST_CLIENTS + i) * 1000);
+        deliver_frame(beacon_frame(ap_mac(i), "Fresh", 6), -70, 6);
+    }
+    TEST_ASSERT_EQUAL(TEST_APS, ap_registry.size());
+    TEST_ASSERT_EQUAL(TEST_CLIENTS, client_registry.size());
+    TEST_ASSERT_EQUAL(0, ap_registry.evictions());
+    TEST_ASSERT_EQUAL(0, client_registry.evictions());
+}
+
+static void test_each_call_is_bounded() {
+    fill_registries();
+    set_expiry_callback(on_expired, nullptr);
+    host_clock_set_us((uint64_t)TEST_NOW_MS * 1000);
+
+    size_t calls = 0;
+    for (;;) {
+        size_t aps = ap_registry.size(), clients = client_registry.size();
+        size_t ap_reports = removed_aps.size(), client_reports = removed_clients.size();
+        size_t removed = expire_stale_entries(millis(), EXPIRY_BUDGET);
+        size_t ap_removed = aps - ap_registry.size();
+        size_t client_removed = clients - client_registry.size();
+
+        TEST_ASSERT_LESS_OR_EQUAL(EXPIRY_BUDGET, ap_removed);
+        TEST_ASSERT_LESS_OR_EQUAL(EXPIRY_BUDGET, client_removed);
+        TEST_ASSERT_EQUAL(ap_removed + client_removed, removed);
+        TEST_ASSERT_EQUAL(ap_removed, removed_aps.size() - ap_reports);
+        TEST_ASSERT_EQUAL(client_removed, removed_clients.size() - client_reports);
+        if (removed == 0) break;
+        calls++;
+    }
+
+    // The client registry is the longer tail: one full budget per call until the last
+    TEST_ASSERT_EQUAL((TEST_STALE_CLIENTS + EXPIRY_BUDGET - 1) / EXPIRY_BUDGET, calls);
+}
+
+static void test_drains_exactly_the_stale_set() {
+    fill_registries();
+    set_expiry_callback(on_expired, nullptr);
+    host_clock_set_us((uint64_t)TEST_NOW_MS * 1000);
+    unsigned long now = millis();
+    uint32_t ap_before = ap_expired, client_before = client_expired;
+
+    while (expire_stale_entries(now, EXPIRY_BUDGET) > 0) {}
+
+    TEST_ASSERT_EQUAL(0, repeated);
+    TEST_ASSERT_EQUAL(TEST_STALE_APS, removed_aps.size());
+    TEST_ASSERT_EQUAL(TEST_STALE_CLIENTS, removed_clients.size());
+    TEST_ASSERT_EQUAL(TEST_STALE_APS, ap_expired - ap_before);
+    TEST_ASSERT_EQUAL(TEST_STALE_CLIENTS, client_expired - client_before);
+    for (uint32_t i = 0; i < TEST_APS; i++) {
+        TEST_ASSERT_EQUAL(i < TEST_STALE_APS, removed_aps.count(ap_mac(i).value) == 1);
+        TEST_ASSERT_EQUAL(i >= TEST_STALE_APS, ap_registry.find(ap_mac(i).value) != nullptr);
+    }
+    for (uint32_t i = 0; i < TEST_CLIENTS; i++) {
+        TEST_ASSERT_EQUAL(i < TEST_STALE_CLIENTS, removed_clients.count(client_mac(i).value) == 1);
+        TEST_ASSERT_EQUAL(i >= TEST_STALE_CLIENTS, client_registry.find(client_mac(i).value) != nullptr);
+    }
+
+    // The record exactly at its TTL goes one millisecond later, alone
+    removed_clients.clear();
+    TEST_ASSERT_EQUAL(1, expire_stale_entries(now + 1, EXPIRY_BUDGET));
+    TEST_ASSERT_EQUAL(1, removed_clients.count(client_mac(TEST_STALE_CLIENTS).value));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_each_call_is_bounded);
+    RUN_TEST(test_drains_exactly_the_stale_set);
+    return UNITY_END();
+}
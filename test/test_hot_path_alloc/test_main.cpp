@@ -0,0 +1,122 @@
+// The RX callback, the parser and expiry must not touch the heap once
+// sniffer_init() has allocated the registries. The corpus is built first and
+// then replayed with small registries and many distinct SSIDs, so LRU
+// eviction, association relinking and SSID arena compaction all run too.
+
+#include <Arduino.h>
+#include <unity.h>
+#include <vector>
+#include "sniffer.h"
+#include "frame_builder.h"
+
+#define TEST_APS 48
+#define TEST_CLIENTS 1500
+#define TEST_AP_CAPACITY 16
+#define TEST_CLIENT_CAPACITY 64
+
+struct Packet {
+    std::vector<uint8_t> buf;
+    wifi_promiscuous_pkt_type_t type;
+};
+
+static std::vector<Packet> corpus;
+
+void setUp() {}
+void tearDown() {}
+
+static void add(const RawFrame& frame, int rssi) {
+    Packet p;
+    p.buf = driver_packet(frame, rssi, 6);
+    p.type = driver_pkt_type(frame);
+    corpus.push_back(p);
+}
+
+static void build_corpus() {
+    static const uint8_t RSN[] = {0x01, 0x00, 0x00, 0x0F, 0xAC, 0x04, 0x01, 0x00, 0x00, 0x0F, 0xAC, 0x04,
+                                  0x01, 0x00, 0x00, 0x0F, 0xAC, 0x08, 0x80, 0x00};
+    static const uint8_t IP[] = {0x45, 0x00, 0x00, 0x54, 0x00, 0x00, 0x40, 0x00, 0x40, 0x01, 0x00, 0x00,
+                                 192, 168, 1, 23, 192, 168, 1, 1};
+    MacAddr target;
+    MacAddr::parse(TARGET_PHONE, &target);
+    char name[33];
+
+    for (uint32_t c = 0; c < TEST_CLIENTS; c++) {
+        MacAddr ap = MacAddr::from_u64(0x00A0C9000000ULL + c % TEST_APS);
+        MacAddr sta = MacAddr::from_u64(0x3C0754000000ULL + c);
+        MacAddr other = MacAddr::from_u64(0x3C0754000000ULL + (c + 1) % TEST_CLIENTS);
+
+        snprintf(name, sizeof(name), "Network %u %s", c % TEST_APS, c % 2 ? "5G" : "Home");
+        RawFrame beacon = beacon_frame(ap, name, 6);
+        frame_ie(&beacon, 48, RSN, sizeof(RSN));
+        add(beacon, -70);
+
+        // Every probe names a network not heard before, filling the arena
+        snprintf(name, sizeof(name), "Probed network %06u", c);
+        add(probe_request_frame(sta, name), -60);
+
+        RawFrame assoc;
+        frame_header(&assoc, WIFI_MANAGEMENT_FRAME, WIFI_ASSOCIATION_REQUEST, 0, ap, sta, ap);
+        add(assoc, -60);
+        add(data_frame(8, FRAME_TO_DS, ap, sta, MacAddr::from_u64(0xFFFFFFFFFFFFULL)), -58);
+        add(data_frame(8, FRAME_TO_DS | FRAME_RETRY, ap, sta, MacAddr::from_u64(0xFFFFFFFFFFFFULL)), -58);
+        add(data_frame(0, FRAME_FROM_DS, sta, ap, ap), -70);
+        add(data_frame(12, FRAME_TO_DS, ap, sta, ap), -59);
+        add(data_frame(8, FRAME_TO_DS | FRAME_FROM_DS, ap, MacAddr::from_u64(0x00A0C9FF0000ULL), ap, sta), -75);
+
+        if (c % 10 == 0) {
+            add(probe_request_frame(target, "Target home"), -50);
+            RawFrame data = data_frame(8, FRAME_TO_DS, ap, target, ap);
+            data.insert(data.end(), IP, IP + sizeof(IP));
+            add(data, -49);
+        }
+        if (c % 7 == 0) {
+            RawFrame disassoc;
+            frame_header(&disassoc, WIFI_MANAGEMENT_FRAME, WIFI_DISASSOCIATION, 0, ap, other, ap);
+            add(disassoc, -65);
+        }
+    }
+}
+
+static void test_rx_and_parse_do_not_allocate() {
+    build_corpus();
+    TEST_ASSERT_TRUE(sniffer_init(TEST_AP_CAPACITY, TEST_CLIENT_CAPACITY));
+    size_t allocs = host_heap_allocs;
+    size_t live = host_heap_live;
+    int frames = total_frames;
+
+    uint64_t now_us = 1000000;
+    for (int pass = 0; pass < 2; pass++) {
+        for (const Packet& p : corpus) {
+            host_clock_set_us(now_us);
+            now_us += 2000;
+            wifi_sniffer_packet_handler((void*)p.buf.data(), p.type);
+            drain_capture_ring();
+            if (now_us % 30000 == 0) {
+                expire_stale_entries(millis(), EXPIRY_BUDGET);
+                publish_sniffer_status(millis());
+            }
+        }
+        // Long enough for every record to expire
+        now_us += (uint64_t)AP_TTL_MS * 1000;
+        host_clock_set_us(now_us);
+        while (expire_stale_entries(millis(), EXPIRY_BUDGET) > 0) {}
+    }
+
+    TEST_ASSERT_EQUAL_UINT32(0, host_heap_allocs - allocs);
+    TEST_ASSERT_EQUAL_UINT32(live, host_heap_live);
+
+    // The paths the corpus is meant to reach were reached
+    TEST_ASSERT_GREATER_THAN(0, ap_registry.evictions());
+    TEST_ASSERT_GREATER_THAN(0, client_registry.evictions());
+    TEST_ASSERT_GREATER_THAN(0, ssid_arena.flips());
+    TEST_ASSERT_GREATER_THAN(0, ap_expired);
+    TEST_ASSERT_GREATER_THAN(0, duplicate_frames);
+    TEST_ASSERT_GREATER_THAN(0, watchlist.at(0).tx_packets);
+    TEST_ASSERT_GREATER_THAN(frames, total_frames);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_rx_and_parse_do_not_allocate);
+    return UNITY_END();
+}
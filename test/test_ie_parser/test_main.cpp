@@ -0,0 +1,201 @@
+// IeIterator and parse_security on well-formed and damaged elements
+
+#include <unity.h>
+#include <string.h>
+#include <vector>
+#include "ie_parser.h"
+
+typedef std::vector<uint8_t> Bytes;
+
+void setUp() {}
+void tearDown() {}
+
+static void ie(Bytes* b, uint8_t id, const Bytes& body) {
+    b->push_back(id);
+    b->push_back((uint8_t)body.size());
+    b->insert(b->end(), body.begin(), body.end());
+}
+
+// RSN body: version 1, group CCMP, then the given pairwise and AKM suite types
+static Bytes rsn(const Bytes& pairwise, const Bytes& akms, int caps = -1) {
+    Bytes b = {0x01, 0x00, 0x00, 0x0F, 0xAC, 0x04, (uint8_t)pairwise.size(), 0x00};
+    for (uint8_t s : pairwise) b.insert(b.end(), {0x00, 0x0F, 0xAC, s});
+    b.insert(b.end(), {(uint8_t)akms.size(), 0x00});
+    for (uint8_t s : akms) b.insert(b.end(), {0x00, 0x0F, 0xAC, s});
+    if (caps >= 0) b.insert(b.end(), {(uint8_t)caps, (uint8_t)(caps >> 8)});
+    return b;
+}
+
+static SecurityInfo parse(uint16_t capability, const Bytes& ies) {
+    SecurityInfo sec;
+    parse_security(capability, ies.data(), ies.size(), &sec);
+    return sec;
+}
+
+static void test_iterator_walks_elements() {
+    Bytes b;
+    ie(&b, IE_SSID, {'a', 'b'});
+    ie(&b, 1, {0x82, 0x84});
+    ie(&b, IE_DS_PARAMS, {6});
+    IeIterator it(b.data(), b.size());
+    IeView v;
+    TEST_ASSERT_TRUE(it.next(&v));
+    TEST_ASSERT_EQUAL_UINT8(IE_SSID, v.id);
+    TEST_ASSERT_EQUAL_UINT8(2, v.len);
+    TEST_ASSERT_EQUAL_PTR(b.data() + 2, v.data);
+    TEST_ASSERT_TRUE(it.next(&v));
+    TEST_ASSERT_TRUE(it.next(&v));
+    TEST_ASSERT_EQUAL_UINT8(IE_DS_PARAMS, v.id);
+    TEST_ASSERT_EQUAL_UINT8(6, v.data[0]);
+    TEST_ASSERT_FALSE(it.next(&v));
+    TEST_ASSERT_FALSE(it.was_truncated());
+}
+
+static void test_iterator_stops_at_truncated_tlv() {
+    Bytes b;
+    ie(&b, IE_SSID, {'x'});
+    b.insert(b.end(), {IE_DS_PARAMS, 5, 6, 7});   // Claims 5 bytes, has 2
+    IeIterator it(b.data(), b.size());
+    IeView v;
+    TEST_ASSERT_TRUE(it.next(&v));
+    TEST_ASSERT_FALSE(it.next(&v));
+    TEST_ASSERT_TRUE(it.was_truncated());
+    TEST_ASSERT_FALSE(ie_find(b.data(), b.size(), IE_DS_PARAMS, &v));
+
+    // A lone id byte ends the list without counting as truncated
+    Bytes tail;
+    ie(&tail, IE_SSID, {'x'});
+    tail.push_back(IE_RSN);
+    IeIterator it2(tail.data(), tail.size());
+    TEST_ASSERT_TRUE(it2.next(&v));
+    TEST_ASSERT_FALSE(it2.next(&v));
+    TEST_ASSERT_FALSE(it2.was_truncated());
+}
+
+static void test_ssid_lengths() {
+    char out[33];
+    Bytes empty;
+    ie(&empty, IE_SSID, {});
+    TEST_ASSERT_FALSE(ie_copy_ssid(empty.data(), empty.size(), out));
+
+    Bytes hidden;
+    ie(&hidden, IE_SSID, Bytes(8, 0));
+    TEST_ASSERT_FALSE(ie_copy_ssid(hidden.data(), hidden.size(), out));
+
+    Bytes longest;
+    ie(&longest, IE_SSID, Bytes(32, 'Z'));
+    TEST_ASSERT_TRUE(ie_copy_ssid(longest.data(), longest.size(), out));
+    TEST_ASSERT_EQUAL(32, strlen(out));
+    TEST_ASSERT_EQUAL('Z', out[31]);
+
+    Bytes too_long;
+    ie(&too_long, IE_SSID, Bytes(33, 'Z'));
+    TEST_ASSERT_FALSE(ie_copy_ssid(too_long.data(), too_long.size(), out));
+}
+
+static void test_rsn_cut_in_pairwise_list() {
+    Bytes body = rsn({0x04, 0x02}, {0x02});
+    body.resize(8 + 6);                 // Two pairwise suites announced, one and a half present
+    Bytes b;
+    ie(&b, IE_RSN, body);
+    SecurityInfo sec = parse(0x0011, b);
+    TEST_ASSERT_TRUE(sec.flags & SEC_RSN);
+    TEST_ASSERT_TRUE(sec.flags & SEC_MALFORMED);
+    TEST_ASSERT_EQUAL_UINT8(CIPHER_CCMP, sec.group_cipher);
+    TEST_ASSERT_EQUAL_UINT8(0, sec.pairwise);
+    TEST_ASSERT_EQUAL_UINT8(0, sec.akm);
+}
+
+static void test_rsn_cut_in_akm_list() {
+    Bytes body = rsn({0x04}, {0x02, 0x08});
+    body.resize(body.size() - 2);
+    Bytes b;
+    ie(&b, IE_RSN, body);
+    SecurityInfo sec = parse(0x0011, b);
+    TEST_ASSERT_TRUE(sec.flags & SEC_MALFORMED);
+    TEST_ASSERT_EQUAL_UINT8(CIPHER_CCMP, sec.pairwise);
+    TEST_ASSERT_EQUAL_UINT8(0, sec.akm);
+
+    // Optional trailing fields may be left out altogether
+    Bytes short_body = rsn({0x04}, {});
+    short_body.resize(short_body.size() - 2);
+    Bytes b2;
+    ie(&b2, IE_RSN, short_body);
+    sec = parse(0x0011, b2);
+    TEST_ASSERT_FALSE(sec.flags & SEC_MALFORMED);
+    TEST_ASSERT_EQUAL_UINT8(CIPHER_CCMP, sec.pairwise);
+}
+
+static void test_wpa_vendor_element() {
+    Bytes b;
+    ie(&b, IE_VENDOR, {0x00, 0x50, 0xF2, 0x02, 0x01, 0x01});     // WMM, not WPA
+    ie(&b, IE_VENDOR, {0x00, 0x50, 0xF2, 0x01, 0x01, 0x00,
+                       0x00, 0x50, 0xF2, 0x02,
+                       0x01, 0x00, 0x00, 0x50, 0xF2, 0x02,
+                       0x01, 0x00, 0x00, 0x50, 0xF2, 0x02});
+    SecurityInfo sec = parse(0x0011, b);
+    TEST_ASSERT_EQUAL_UINT8(SEC_PRIVACY | SEC_WPA, sec.flags);
+    TEST_ASSERT_EQUAL_UINT8(CIPHER_TKIP, sec.group_cipher);
+    TEST_ASSERT_EQUAL_UINT8(CIPHER_TKIP, sec.pairwise);
+    TEST_ASSERT_EQUAL_UINT8(AKM_PSK, sec.akm);
+    TEST_ASSERT_EQUAL_STRING("WPA", security_label(sec));
+}
+
+static void test_pmf_bits() {
+    Bytes capable, required, none;
+    ie(&capable, IE_RSN, rsn({0x04}, {0x02}, 0x0080));
+    ie(&required, IE_RSN, rsn({0x04}, {0x08}, 0x00C0));
+    ie(&none, IE_RSN, rsn({0x04}, {0x02}, 0x0000));
+    SecurityInfo sec = parse(0x0011, capable);
+    TEST_ASSERT_TRUE(sec.flags & SEC_PMF_CAPABLE);
+    TEST_ASSERT_FALSE(sec.flags & SEC_PMF_REQUIRED);
+    sec = parse(0x0011, required);
+    TEST_ASSERT_TRUE(sec.flags & SEC_PMF_CAPABLE);
+    TEST_ASSERT_TRUE(sec.flags & SEC_PMF_REQUIRED);
+    TEST_ASSERT_EQUAL_STRING("WPA3", security_label(sec));
+    sec = parse(0x0011, none);
+    TEST_ASSERT_FALSE(sec.flags & (SEC_PMF_CAPABLE | SEC_PMF_REQUIRED));
+}
+
+static void test_sae_psk_transition() {
+    Bytes b;
+    ie(&b, IE_RSN, rsn({0x04}, {0x02, 0x08}, 0x0080));
+    SecurityInfo sec = parse(0x0011, b);
+    TEST_ASSERT_EQUAL_UINT8(AKM_PSK | AKM_SAE, sec.akm);
+    TEST_ASSERT_FALSE(sec.flags & SEC_MALFORMED);
+    TEST_ASSERT_EQUAL_STRING("WPA2/3", security_label(sec));
+}
+
+static void test_owe() {
+    Bytes b;
+    ie(&b, IE_RSN, rsn({0x04}, {18}, 0x00C0));
+    SecurityInfo sec = parse(0x0011, b);
+    TEST_ASSERT_EQUAL_UINT8(AKM_OWE, sec.akm);
+    TEST_ASSERT_EQUAL_STRING("OWE", security_label(sec));
+    TEST_ASSERT_FALSE(security_is_open(sec));
+}
+
+static void test_open_and_wep() {
+    Bytes b;
+    ie(&b, IE_SSID, {'c', 'a', 'f', 'e'});
+    SecurityInfo sec = parse(0x0001, b);
+    TEST_ASSERT_TRUE(security_is_open(sec));
+    TEST_ASSERT_EQUAL_STRING("Open", security_label(sec));
+    sec = parse(0x0011, b);
+    TEST_ASSERT_EQUAL_STRING("WEP", security_label(sec));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_iterator_walks_elements);
+    RUN_TEST(test_iterator_stops_at_truncated_tlv);
+    RUN_TEST(test_ssid_lengths);
+    RUN_TEST(test_rsn_cut_in_pairwise_list);
+    RUN_TEST(test_rsn_cut_in_akm_list);
+    RUN_TEST(test_wpa_vendor_element);
+    RUN_TEST(test_pmf_bits);
+    RUN_TEST(test_sae_psk_transition);
+    RUN_TEST(test_owe);
+    RUN_TEST(test_open_and_wep);
+    return UNITY_END();
+}
@@ -0,0 +1,179 @@
+// pcap export round trip: frames go through PcapWriter into the byte ring,
+// the ring is drained to a file as pcap_export_task drains it to the serial
+// port, and the file is read back with the replay driver's pcap reader
+
+#include <Arduino.h>
+#include <unity.h>
+#include <vector>
+#include "pcap_export.h"
+#include "frame_builder.h"
+#include "pcap_reader.h"
+
+static PcapRing ring;
+static PcapWriter writer(ring);
+static char path[256];
+
+void setUp() {}
+void tearDown() {}
+
+static CapturedFrame make_frame(const RawFrame& raw, uint32_t timestamp, uint8_t channel) {
+    CapturedFrame f;
+    memset(&f, 0, sizeof(f));
+    f.timestamp = timestamp;
+    f.sig_len = raw.size() + 4;
+    f.cap_len = f.sig_len;                     // FCS included, as the driver delivers it
+    f.rssi = -61;
+    f.noise_floor = -94;
+    f.channel = channel;
+    f.rate = 0x0B;                             // 6 Mbps OFDM
+    f.pkt_type = driver_pkt_type(raw);
+    memcpy(f.data, raw.data(), raw.size());
+    return f;
+}
+
+static size_t drain_to_file() {
+    FILE* fp = fopen(path, "wb");
+    TEST_ASSERT_NOT_NULL(fp);
+    size_t total = 0;
+    const uint8_t* p;
+    size_t n;
+    while ((n = ring.peek(&p)) > 0) {
+        fwrite(p, 1, n, fp);
+        ring.consume(n);
+        total += n;
+    }
+    fclose(fp);
+    return total;
+}
+
+static std::vector<uint8_t> read_file() {
+    std::vector<uint8_t> bytes;
+    FILE* fp = fopen(path, "rb");
+    TEST_ASSERT_NOT_NULL(fp);
+    uint8_t buf[4096];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), fp)) > 0) bytes.insert(bytes.end(), buf, buf + n);
+    fclose(fp);
+    return bytes;
+}
+
+static uint32_t le32(const uint8_t* p) { return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24); }
+
+// Offsets of each record's radiotap header in the file
+static std::vector<size_t> record_offsets(const std::vector<uint8_t>& file) {
+    std::vector<size_t> out;
+    for (size_t off = PCAP_GLOBAL_HEADER_LEN; off + PCAP_RECORD_HEADER_LEN <= file.size();) {
+        out.push_back(off + PCAP_RECORD_HEADER_LEN);
+        off += PCAP_RECORD_HEADER_LEN + le32(&file[off + 8]);
+    }
+    return out;
+}
+
+static void test_round_trip() {
+    MacAddr ap = MacAddr::from_u64(0x00A0C9000001ULL);
+    MacAddr sta = MacAddr::from_u64(0x3C0754000001ULL);
+    std::vector<CapturedFrame> sent;
+
+    // Legacy OFDM beacon just before the 32-bit microsecond counter wraps
+    sent.push_back(make_frame(beacon_frame(ap, "roundtrip", 6), 0xFFFFFF00u, 6));
+    // CCK 1 Mbps probe on channel 14
+    sent.push_back(make_frame(probe_request_frame(sta, ""), 0xFFFFFFF0u, 14));
+    sent.back().rate = 0;
+    // HT MCS 7, 40 MHz, short GI, after the wrap
+    sent.push_back(make_frame(data_frame(8, FRAME_TO_DS, ap, sta, ap), 0x00000010u, 1));
+    sent.back().sig_mode = 1;
+    sent.back().mcs = 7;
+    sent.back().ht_flags = CAPTURE_HT_40MHZ | CAPTURE_HT_SGI;
+    // Longer on air than the snap length: no FCS in the record
+    sent.push_back(make_frame(data_frame(0, FRAME_FROM_DS, sta, ap, ap), 0x00000100u, 11));
+    sent.back().sig_len = 1500;
+    sent.back().cap_len = CAPTURE_SNAP_LEN;
+
+    writer.set_enabled(true);
+    for (const CapturedFrame& f : sent) writer.on_frame(f);
+    TEST_ASSERT_EQUAL_UINT32(sent.size(), writer.frames_queued());
+    TEST_ASSERT_EQUAL_UINT32(0, writer.frames_dropped());
+    drain_to_file();
+
+    std::vector<uint8_t> file = read_file();
+    TEST_ASSERT_EQUAL_HEX32(0xA1B2C3D4, le32(&file[0]));
+    TEST_ASSERT_EQUAL_UINT32(LINKTYPE_IEEE802_11_RADIOTAP, le32(&file[20]));
+    TEST_ASSERT_EQUAL_UINT32(RADIOTAP_MAX_LEN + CAPTURE_SNAP_LEN, le32(&file[16]));
+
+    std::vector<size_t> rt = record_offsets(file);
+    TEST_ASSERT_EQUAL(sent.size(), rt.size());
+    // TSFT at offset 8, channel 2-byte aligned after flags (and rate), MCS last
+    static const size_t RT_LEN[4] = {24, 24, 27, 24};
+    for (size_t i = 0; i < rt.size(); i++) {
+        size_t hdr_len = 0;
+        RadiotapInfo info = {0, false, false, 0, 0, 0, 0};
+        TEST_ASSERT_TRUE(parse_radiotap(&file[rt[i]], file.size() - rt[i], &hdr_len, &info));
+        TEST_ASSERT_EQUAL(RT_LEN[i], hdr_len);
+        TEST_ASSERT_TRUE(info.has_tsft);
+        TEST_ASSERT_EQUAL(sent[i].channel, info.channel);
+        TEST_ASSERT_EQUAL(sent[i].rssi, info.rssi);
+        TEST_ASSERT_EQUAL(sent[i].noise_floor, info.noise);
+        TEST_ASSERT_EQUAL(i != 3, info.has_fcs);
+        const uint8_t* rec = &file[rt[i] - PCAP_RECORD_HEADER_LEN];
+        TEST_ASSERT_EQUAL_UINT32(hdr_len + sent[i].cap_len, le32(rec + 8));
+        TEST_ASSERT_EQUAL_UINT32(hdr_len + sent[i].sig_len, le32(rec + 12));
+        TEST_ASSERT_EQUAL_MEMORY(sent[i].data, &file[rt[i] + hdr_len], sent[i].cap_len);
+    }
+    TEST_ASSERT_EQUAL_UINT8(12, file[rt[0] + 17]);      // 6 Mbps in 500 kbps units
+    TEST_ASSERT_EQUAL_UINT8(2, file[rt[1] + 17]);       // 1 Mbps
+    TEST_ASSERT_EQUAL_UINT8(0, file[rt[2] + 17]);       // Pad before the channel field
+    TEST_ASSERT_EQUAL_UINT8(0x07, file[rt[2] + 24]);
+    TEST_ASSERT_EQUAL_UINT8(0x05, file[rt[2] + 25]);
+    TEST_ASSERT_EQUAL_UINT8(7, file[rt[2] + 26]);
+
+    // The timestamp keeps counting past 2^32 us
+    uint64_t wrapped = (1ULL << 32) | 0x10;
+    const uint8_t* rec2 = &file[rt[2] - PCAP_RECORD_HEADER_LEN];
+    TEST_ASSERT_EQUAL_UINT32(wrapped / 1000000, le32(rec2));
+    TEST_ASSERT_EQUAL_UINT32(wrapped % 1000000, le32(rec2 + 4));
+
+    std::vector<ReplayFrame> frames;
+    TEST_ASSERT_TRUE(load_pcap(path, &frames));
+    TEST_ASSERT_EQUAL(sent.size(), frames.size());
+    TEST_ASSERT_EQUAL_UINT64(0xF0, frames[1].ts_us);
+    TEST_ASSERT_EQUAL_UINT64(wrapped - 0xFFFFFF00u, frames[2].ts_us);
+    TEST_ASSERT_EQUAL_UINT64(0x100 + (1ULL << 32) - 0xFFFFFF00u, frames[3].ts_us);
+    TEST_ASSERT_EQUAL(WIFI_PKT_MGMT, frames[0].type);
+    TEST_ASSERT_EQUAL(WIFI_PKT_DATA, frames[2].type);
+    TEST_ASSERT_EQUAL(14, frames[1].channel);
+}
+
+static void test_full_ring_drops_whole_records() {
+    drain_to_file();
+    writer.set_enabled(false);
+    writer.set_enabled(true);                  // New stream: global header first
+    uint32_t queued = writer.frames_queued();
+    MacAddr ap = MacAddr::from_u64(0x00A0C9000002ULL);
+    RawFrame raw = beacon_frame(ap, "overflow", 6);
+    raw.resize(200, 0xDD);
+    const int offered = 2 * PCAP_EXPORT_BUFFER / 200;
+    for (int i = 0; i < offered; i++) writer.on_frame(make_frame(raw, 1000 + i, 6));
+
+    uint32_t kept = writer.frames_queued() - queued;
+    TEST_ASSERT_GREATER_THAN(0, writer.frames_dropped());
+    TEST_ASSERT_EQUAL_UINT32(offered, kept + writer.frames_dropped());
+    drain_to_file();
+
+    std::vector<ReplayFrame> frames;
+    TEST_ASSERT_TRUE(load_pcap(path, &frames));
+    TEST_ASSERT_EQUAL(kept, frames.size());
+    for (const ReplayFrame& rf : frames) {
+        TEST_ASSERT_EQUAL(sizeof(wifi_promiscuous_pkt_t) + raw.size() + 4, rf.buf.size());
+    }
+}
+
+int main() {
+    const char* tmp = getenv("TMPDIR");
+    snprintf(path, sizeof(path), "%s/test_pcap_export.pcap", tmp != nullptr ? tmp : "/tmp");
+    UNITY_BEGIN();
+    RUN_TEST(test_round_trip);
+    RUN_TEST(test_full_ring_drops_whole_records);
+    int failures = UNITY_END();
+    remove(path);
+    return failures;
+}
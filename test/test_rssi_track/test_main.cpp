@@ -0,0 +1,149 @@
+// RssiTrack on a simulated walk: steady at -80 dBm, approaching at 2 dB/s to
+// -50 dBm, steady, then receding, with 5 dB Gaussian jitter and a tenth of
+// the readings 15 dB low (body shadowing), at 2, 10 and 50 frames per second.
+// Each rate walks WALK_RUNS times with different noise; the error bounds hold
+// for the mean and the detection delays for the slowest run.
+
+#include <unity.h>
+#include <math.h>
+#include <algorithm>
+#include "rssi_track.h"
+
+#define WALK_APPROACH_S 10.0f
+#define WALK_NEAR_S 25.0f
+#define WALK_RECEDE_S 30.0f
+#define WALK_END_S 40.0f
+#define WALK_RUNS 8
+
+struct WalkResult {
+    float raw_rms;             // Readings against the true level, after a 3 s warm-up
+    float smoothed_rms;
+    int approach_ms;           // From the start of the approach to the first APPROACHING, -1 if never
+    int recede_ms;
+    float approaching_share;   // Of readings 3 s into the approach flagged APPROACHING
+};
+
+static uint64_t rng_state;
+
+void setUp() {}
+void tearDown() {}
+
+static float uniform() {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return ((rng_state >> 40) + 0.5f) / (float)(1 << 24);
+}
+
+static float gaussian(float sd) {
+    return sd * sqrtf(-2.0f * logf(uniform())) * cosf(6.2831853f * uniform());
+}
+
+static float true_level(float s) {
+    if (s < WALK_APPROACH_S) return -80;
+    if (s < WALK_NEAR_S) return -80 + (s - WALK_APPROACH_S) * 2;
+    if (s < WALK_RECEDE_S) return -50;
+    return -50 - (s - WALK_RECEDE_S) * 2;
+}
+
+static WalkResult walk(int hz, uint64_t seed) {
+    WalkResult r = {0, 0, -1, -1, 0};
+    rng_state = seed;
+    RssiTrack t;
+    t.reset();
+    double raw_se = 0, smoothed_se = 0;
+    int n = 0, approach_n = 0, approach_hits = 0;
+    uint32_t now = 1000;
+    for (int i = 0; i < hz * (int)WALK_END_S; i++) {
+        now += 1000 / hz;
+        float s = (now - 1000) / 1000.0f;
+        float truth = true_level(s);
+        float z = truth + gaussian(5);
+        if (uniform() < 0.1f) z -= 15;
+        int8_t rssi = (int8_t)lroundf(z);
+        t.add(rssi, now);
+        RssiReading rd;
+        t.read(&rd);
+
+        if (s > 3) {
+            raw_se += (rssi - truth) * (rssi - truth);
+            smoothed_se += (rd.smoothed - truth) * (rd.smoothed - truth);
+            n++;
+        }
+        if (s >= WALK_APPROACH_S && r.approach_ms < 0 && rd.trend == RSSI_APPROACHING) {
+            r.approach_ms = (int)((s - WALK_APPROACH_S) * 1000);
+        }
+        if (s >= WALK_RECEDE_S && r.recede_ms < 0 && rd.trend == RSSI_RECEDING) {
+            r.recede_ms = (int)((s - WALK_RECEDE_S) * 1000);
+        }
+        if (s > WALK_APPROACH_S + 3 && s < WALK_NEAR_S) {
+            approach_n++;
+            approach_hits += rd.trend == RSSI_APPROACHING;
+        }
+    }
+    r.raw_rms = sqrt(raw_se / n);
+    r.smoothed_rms = sqrt(smoothed_se / n);
+    r.approaching_share = (float)approach_hits / approach_n;
+    return r;
+}
+
+// Smoothing must cut the RMS error to max_ratio of the raw readings' and
+// the trend must turn within max_detect_ms of the walk changing direction
+static void check_walk(int hz, float max_smoothed_rms, float max_ratio, int max_detect_ms) {
+    float raw = 0, smoothed = 0, share = 0;
+    int slowest = 0;
+    for (int run = 0; run < WALK_RUNS; run++) {
+        WalkResult r = walk(hz, 0x9E3779B97F4A7C15ULL * (run + 1));
+        TEST_ASSERT_GREATER_OR_EQUAL(0, r.approach_ms);
+        TEST_ASSERT_GREATER_OR_EQUAL(0, r.recede_ms);
+        raw += r.raw_rms / WALK_RUNS;
+        smoothed += r.smoothed_rms / WALK_RUNS;
+        share += r.approaching_share / WALK_RUNS;
+        slowest = std::max(slowest, std::max(r.approach_ms, r.recede_ms));
+    }
+    printf("%2d Hz: rms raw %.1f dB smoothed %.1f dB, trend turns within %d ms, %.0f%% approaching\n",
+           hz, raw, smoothed, slowest, 100 * share);
+    TEST_ASSERT_LESS_THAN(max_smoothed_rms, smoothed);
+    TEST_ASSERT_LESS_THAN(max_ratio * raw, smoothed);
+    TEST_ASSERT_LESS_OR_EQUAL(max_detect_ms, slowest);
+    TEST_ASSERT_GREATER_THAN(0.7f, share);
+}
+
+static void test_walk_2hz() { check_walk(2, 5.0f, 0.7f, 7000); }
+static void test_walk_10hz() { check_walk(10, 3.0f, 0.45f, 4500); }
+static void test_walk_50hz() { check_walk(50, 2.0f, 0.3f, 3500); }
+
+static void test_empty_and_stale() {
+    RssiTrack t;
+    t.reset();
+    TEST_ASSERT_TRUE(t.empty());
+    TEST_ASSERT_EQUAL_INT(0, t.smoothed());
+    for (uint32_t ms = 0; ms < 2000; ms += 100) t.add(-70, 1000 + ms);
+    TEST_ASSERT_EQUAL_INT(-70, t.smoothed());
+
+    // After a long gap the track restarts at the new level
+    t.add(-40, 1000 + 2000 + RSSI_TRACK_STALE_MS + 1);
+    TEST_ASSERT_EQUAL_INT(-40, t.smoothed());
+}
+
+static void test_outlier_dropped_step_followed() {
+    RssiTrack t;
+    t.reset();
+    uint32_t now = 1000;
+    for (int i = 0; i < 50; i++) t.add(-60, now += 100);
+    t.add(-85, now += 100);                    // One shadowed reading is ignored
+    TEST_ASSERT_EQUAL_INT(-60, t.smoothed());
+    t.add(-60, now += 100);
+    for (int i = 0; i < 20; i++) t.add(-80, now += 100);   // A real step is followed
+    TEST_ASSERT_INT_WITHIN(3, -80, t.smoothed());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_walk_2hz);
+    RUN_TEST(test_walk_10hz);
+    RUN_TEST(test_walk_50hz);
+    RUN_TEST(test_empty_and_stale);
+    RUN_TEST(test_outlier_dropped_step_followed);
+    return UNITY_END();
+}
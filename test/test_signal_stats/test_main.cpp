@@ -0,0 +1,135 @@
+// Signal estimators against exact nearest-rank percentiles: P2Quantile on
+// integer dBm samples from uniform, Gaussian and two-cluster distributions,
+// and ChannelSignal on the same streams while the window slides across both
+// panes and one ages out. Each case runs SIGNAL_RUNS times with different
+// samples; every estimate must be within SIGNAL_QUANTILE_TOLERANCE_DB.
+
+#include <unity.h>
+#include <math.h>
+#include <vector>
+#include <algorithm>
+#include "signal_stats.h"
+
+#define SIGNAL_RUNS 8
+#define SIGNAL_SAMPLES 2000
+
+static uint64_t rng_state;
+
+void setUp() { rng_state = 0x2545F4914F6CDD1DULL; }
+void tearDown() {}
+
+static float uniform() {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return ((rng_state >> 40) + 0.5f) / (float)(1 << 24);
+}
+
+static float gaussian(float sd) {
+    return sd * sqrtf(-2.0f * logf(uniform())) * cosf(6.2831853f * uniform());
+}
+
+static int8_t dbm(float v) { return (int8_t)lroundf(fmaxf(-100.0f, fminf(-20.0f, v))); }
+
+enum Shape { SHAPE_UNIFORM, SHAPE_GAUSSIAN, SHAPE_CLUSTERS };
+
+// Uniform over -90..-40, N(-65, 6), or 70% near -75 and 30% near -45
+static int8_t sample(Shape shape, float level) {
+    switch (shape) {
+        case SHAPE_UNIFORM: return dbm(level - 25.0f + 50.0f * uniform());
+        case SHAPE_GAUSSIAN: return dbm(level + gaussian(6.0f));
+        default: return dbm(uniform() < 0.7f ? level - 10.0f + gaussian(3.0f) : level + 20.0f + gaussian(3.0f));
+    }
+}
+
+static int exact_quantile(std::vector<int> values, float p) {
+    std::sort(values.begin(), values.end());
+    size_t rank = (size_t)ceilf(p * values.size());
+    return values[rank > 0 ? rank - 1 : 0];
+}
+
+static void test_first_samples_are_exact() {
+    P2Quantile q;
+    q.reset(0.9f);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, q.value());
+    static const float xs[] = {-60, -80, -50, -70, -65};
+    std::vector<int> seen;
+    for (float x : xs) {
+        q.add(x);
+        seen.push_back((int)x);
+        TEST_ASSERT_EQUAL_FLOAT((float)exact_quantile(seen, 0.9f), q.value());
+    }
+}
+
+static void test_quantile_matches_nearest_rank() {
+    static const float ps[] = {0.5f, 0.9f};
+    for (int shape = SHAPE_UNIFORM; shape <= SHAPE_CLUSTERS; shape++) {
+        for (int run = 0; run < SIGNAL_RUNS; run++) {
+            P2Quantile q[2];
+            q[0].reset(ps[0]);
+            q[1].reset(ps[1]);
+            std::vector<int> values;
+            for (int i = 0; i < SIGNAL_SAMPLES; i++) {
+                int8_t x = sample((Shape)shape, -65.0f);
+                values.push_back(x);
+                q[0].add(x);
+                q[1].add(x);
+            }
+            for (int i = 0; i < 2; i++) {
+                TEST_ASSERT_INT_WITHIN_MESSAGE(SIGNAL_QUANTILE_TOLERANCE_DB, exact_quantile(values, ps[i]),
+                                               lroundf(q[i].value()), "single estimator");
+            }
+        }
+    }
+}
+
+// 10 frames per second from 1 s to 80 s; summaries at 45 s and 80 s (both
+// panes merged) and 95 s (the older pane has aged out)
+static void test_window_matches_nearest_rank() {
+    struct Frame {
+        uint32_t ms;
+        int rssi, noise;
+    };
+    static const uint32_t checks[] = {45000, 80000, 95000};
+    for (int shape = SHAPE_UNIFORM; shape <= SHAPE_CLUSTERS; shape++) {
+        for (int run = 0; run < SIGNAL_RUNS; run++) {
+            ChannelSignal sig;
+            sig.reset();
+            std::vector<Frame> frames;
+            size_t next_check = 0;
+            for (uint32_t ms = 1000; next_check < 3; ms += 100) {
+                if (ms > checks[next_check]) {
+                    uint32_t now = checks[next_check++];
+                    SignalSummary s;
+                    sig.summary(now, &s);
+                    std::vector<int> rssi, noise;
+                    for (const Frame& f : frames) {
+                        if (f.ms < s.window_start) continue;
+                        rssi.push_back(f.rssi);
+                        noise.push_back(f.noise);
+                    }
+                    TEST_ASSERT_EQUAL(rssi.size(), s.frames);
+                    TEST_ASSERT_LESS_OR_EQUAL(SIGNAL_WINDOW_MS, now - s.window_start);
+                    TEST_ASSERT_INT_WITHIN_MESSAGE(SIGNAL_QUANTILE_TOLERANCE_DB, exact_quantile(rssi, 0.5f),
+                                                   s.rssi_p50, "window rssi p50");
+                    TEST_ASSERT_INT_WITHIN_MESSAGE(SIGNAL_QUANTILE_TOLERANCE_DB, exact_quantile(rssi, 0.9f),
+                                                   s.rssi_p90, "window rssi p90");
+                    TEST_ASSERT_INT_WITHIN_MESSAGE(SIGNAL_QUANTILE_TOLERANCE_DB, exact_quantile(noise, 0.5f),
+                                                   s.noise_p50, "window noise p50");
+                }
+                if (ms > 80000) continue;   // Silent after 80 s
+                Frame f = {ms, sample((Shape)shape, -65.0f), dbm(-95.0f + gaussian(1.5f))};
+                sig.add((int8_t)f.rssi, (int8_t)f.noise, false, ms);
+                frames.push_back(f);
+            }
+        }
+    }
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_first_samples_are_exact);
+    RUN_TEST(test_quantile_matches_nearest_rank);
+    RUN_TEST(test_window_matches_nearest_rank);
+    return UNITY_END();
+}
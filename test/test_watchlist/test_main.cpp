@@ -0,0 +1,133 @@
+// Watchlist: parsing and formatting, exact entries over prefixes, per-target
+// statistics across removals, the persisted key form, and matching in the
+// parser
+
+#include <Arduino.h>
+#include <unity.h>
+#include "sniffer.h"
+#include "watchlist.h"
+#include "frame_builder.h"
+
+static Watchlist list;
+
+void setUp() { list.clear(); }
+void tearDown() {}
+
+static void test_parse_and_format() {
+    MacAddr key;
+    bool prefix;
+    TEST_ASSERT_TRUE(Watchlist::parse("AA:BB:CC", &key, &prefix));
+    TEST_ASSERT_TRUE(prefix);
+    TEST_ASSERT_EQUAL_HEX64(0xAABBCC000000ULL, key.value);
+    TEST_ASSERT_TRUE(Watchlist::parse("aa-bb-cc-dd-ee-ff", &key, &prefix));
+    TEST_ASSERT_FALSE(prefix);
+    TEST_ASSERT_EQUAL_HEX64(0xAABBCCDDEEFFULL, key.value);
+    TEST_ASSERT_FALSE(Watchlist::parse("AA:BB", &key, &prefix));
+    TEST_ASSERT_FALSE(Watchlist::parse("AA:BB:CC:DD", &key, &prefix));
+    TEST_ASSERT_FALSE(Watchlist::parse("GG:BB:CC", &key, &prefix));
+
+    char out[18];
+    Watchlist::format(MacAddr::from_u64(0xAABBCC000000ULL), true, out);
+    TEST_ASSERT_EQUAL_STRING("AA:BB:CC:*", out);
+    Watchlist::format(MacAddr::from_u64(0xAABBCCDDEEFFULL), false, out);
+    TEST_ASSERT_EQUAL_STRING("AA:BB:CC:DD:EE:FF", out);
+}
+
+static void test_exact_beats_prefix() {
+    TEST_ASSERT_TRUE(list.add(MacAddr::from_u64(0xAABBCC000000ULL), true));
+    TEST_ASSERT_TRUE(list.add(MacAddr::from_u64(0xAABBCC112233ULL), false));
+    TEST_ASSERT_FALSE(list.add(MacAddr::from_u64(0xAABBCC999999ULL), true));    // Same OUI prefix
+    TEST_ASSERT_FALSE(list.add(MacAddr::from_u64(0xAABBCC112233ULL), false));
+    TEST_ASSERT_EQUAL_INT(1, list.match(MacAddr::from_u64(0xAABBCC112233ULL)));
+    TEST_ASSERT_EQUAL_INT(0, list.match(MacAddr::from_u64(0xAABBCC445566ULL)));
+    TEST_ASSERT_EQUAL_INT(-1, list.match(MacAddr::from_u64(0xAABBCD112233ULL)));
+
+    // Without the prefix only the exact address matches
+    TEST_ASSERT_TRUE(list.remove(MacAddr::from_u64(0xAABBCC000000ULL), true));
+    TEST_ASSERT_EQUAL_INT(0, list.match(MacAddr::from_u64(0xAABBCC112233ULL)));
+    TEST_ASSERT_EQUAL_INT(-1, list.match(MacAddr::from_u64(0xAABBCC445566ULL)));
+}
+
+static void test_stats_survive_removal_of_others() {
+    for (uint64_t i = 0; i < 5; i++) list.add(MacAddr::from_u64(0x020000000000ULL + i), false);
+    list.at(3).tx_packets = 7;
+    list.at(3).rx_packets = 11;
+    strcpy(list.at(3).ssid, "Home");
+    TEST_ASSERT_TRUE(list.remove(MacAddr::from_u64(0x020000000000ULL), false));
+    TEST_ASSERT_TRUE(list.remove(MacAddr::from_u64(0x020000000004ULL), false));
+    TEST_ASSERT_FALSE(list.remove(MacAddr::from_u64(0x020000000004ULL), false));
+    TEST_ASSERT_EQUAL(3, list.size());
+
+    int i = list.match(MacAddr::from_u64(0x020000000003ULL));
+    TEST_ASSERT_GREATER_OR_EQUAL(0, i);
+    TEST_ASSERT_EQUAL_UINT32(7, list.at(i).tx_packets);
+    TEST_ASSERT_EQUAL_UINT32(11, list.at(i).rx_packets);
+    TEST_ASSERT_EQUAL_STRING("Home", list.at(i).ssid);
+    TEST_ASSERT_EQUAL_INT(i, list.find(MacAddr::from_u64(0x020000000003ULL), false));
+}
+
+static void test_full_list_and_key_round_trip() {
+    for (int i = 0; i < WATCHLIST_MAX; i++) {
+        bool prefix = i % 3 == 0;
+        uint64_t key = prefix ? (0x100000ULL + i * 7919) << 24 : 0x020000000000ULL + i * 7919;
+        TEST_ASSERT_TRUE(list.add(MacAddr::from_u64(key), prefix));
+    }
+    TEST_ASSERT_FALSE(list.add(MacAddr::from_u64(0x0200FFFFFFFFULL), false));
+
+    uint64_t keys[WATCHLIST_MAX];
+    size_t n = list.export_keys(keys, WATCHLIST_MAX);
+    TEST_ASSERT_EQUAL(WATCHLIST_MAX, n);
+    static Watchlist copy;
+    copy.import_keys(keys, n);
+    TEST_ASSERT_EQUAL(list.size(), copy.size());
+    for (size_t i = 0; i < list.size(); i++) {
+        TEST_ASSERT_EQUAL_HEX64(list.at(i).key.value, copy.at(i).key.value);
+        TEST_ASSERT_EQUAL(list.at(i).prefix, copy.at(i).prefix);
+        MacAddr probe = MacAddr::from_u64(list.at(i).key.value | (list.at(i).prefix ? 0x123456 : 0));
+        TEST_ASSERT_EQUAL_INT(list.match(probe), copy.match(probe));
+    }
+}
+
+static void test_found_expires() {
+    list.add(MacAddr::from_u64(0x020000000001ULL), false);
+    list.at(0).found = true;
+    list.at(0).last_seen = 1000;
+    list.expire(1000 + WATCH_TIMEOUT_MS, WATCH_TIMEOUT_MS);
+    TEST_ASSERT_TRUE(list.at(0).found);
+    list.expire(1001 + WATCH_TIMEOUT_MS, WATCH_TIMEOUT_MS);
+    TEST_ASSERT_FALSE(list.at(0).found);
+}
+
+static void test_parser_counts_prefix_and_exact_targets() {
+    TEST_ASSERT_TRUE(sniffer_init());
+    watchlist.clear();
+    watchlist.add(MacAddr::from_u64(0x3C0754000000ULL), true);
+    watchlist.add(MacAddr::from_u64(0x3C0754000001ULL), false);
+    MacAddr ap = MacAddr::from_u64(0x00A0C9000001ULL);
+    host_clock_set_us(5000000);
+
+    deliver_frame(probe_request_frame(MacAddr::from_u64(0x3C0754000001ULL), "Office"), -55);
+    deliver_frame(data_frame(8, FRAME_TO_DS, ap, MacAddr::from_u64(0x3C0754ABCDEFULL), ap), -60);
+    deliver_frame(data_frame(8, FRAME_FROM_DS, MacAddr::from_u64(0x3C0754ABCDEFULL), ap, ap), -40);
+
+    const WatchTarget& prefix = watchlist.at(0);
+    const WatchTarget& exact = watchlist.at(1);
+    TEST_ASSERT_EQUAL_UINT32(1, exact.tx_packets);
+    TEST_ASSERT_EQUAL_STRING("Office", exact.ssid);
+    TEST_ASSERT_EQUAL_UINT32(1, prefix.tx_packets);
+    TEST_ASSERT_EQUAL_UINT32(1, prefix.rx_packets);
+    TEST_ASSERT_EQUAL_HEX64(0x3C0754ABCDEFULL, prefix.last_mac.value);
+    TEST_ASSERT_EQUAL_INT(-60, prefix.rssi);
+    TEST_ASSERT_TRUE(prefix.found);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_parse_and_format);
+    RUN_TEST(test_exact_beats_prefix);
+    RUN_TEST(test_stats_survive_removal_of_others);
+    RUN_TEST(test_full_list_and_key_round_trip);
+    RUN_TEST(test_found_expires);
+    RUN_TEST(test_parser_counts_prefix_and_exact_targets);
+    return UNITY_END();
+}
@@ -0,0 +1,182 @@
+#!/usr/bin/env python3
+"""
+OUI vendor table generator
+
+Turns the IEEE registry CSV exports into src/oui_table.h: sorted, padded
+constexpr key arrays (MA-L 24-bit, MA-M 28-bit, MA-S 36-bit prefixes) with an
+index into one interned pool of short vendor names. The table is const data,
+so on the ESP32 it stays in flash.
+
+Inputs, read from tools/oui/ when present, otherwise tools/oui_seed.csv:
+  oui.csv    https://standards-oui.ieee.org/oui/oui.csv      (MA-L)
+  mam.csv    https://standards-oui.ieee.org/oui28/mam.csv    (MA-M)
+  oui36.csv  https://standards-oui.ieee.org/oui36/oui36.csv  (MA-S)
+
+Run by hand (python3 tools/gen_oui.py) or as a PlatformIO pre-script, where it
+only regenerates when an input is newer than the header.
+"""
+
+import csv
+import os
+import re
+import sys
+
+try:
+    ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+except NameError:
+    # PlatformIO runs pre-scripts without __file__
+    Import("env")  # noqa: F821
+    ROOT = env.subst("$PROJECT_DIR")  # noqa: F821
+SCRIPT = os.path.join(ROOT, "tools", "gen_oui.py")
+OUI_DIR = os.path.join(ROOT, "tools", "oui")
+SEED = os.path.join(ROOT, "tools", "oui_seed.csv")
+OUTPUT = os.path.join(ROOT, "src", "oui_table.h")
+
+# Registry name -> prefix length in bits
+REGISTRIES = {"MA-L": 24, "MA-M": 28, "MA-S": 36}
+
+# Display names must fit the DEVICES card's vendor badge
+NAME_MAX = 12
+
+# Vendors whose legal names shorten badly
+ALIASES = {
+    "raspberry pi": "RaspPi",
+    "hewlett packard": "HP",
+    "hewlett-packard": "HP",
+    "cisco-linksys": "Linksys",
+    "cisco meraki": "Meraki",
+    "samsung electronics": "Samsung",
+    "texas instruments": "TI",
+    "pcs systemtechnik": "VBox",
+    "vmware": "VMware",
+    "espressif": "Espressif",
+    "avm audiovisuelles": "AVM",
+    "hon hai": "Foxconn",
+    "amazon technologies": "Amazon",
+    "google": "Google",
+}
+
+SUFFIXES = re.compile(
+    r"[,.]?\s+(inc|incorporated|ltd|limited|llc|l\.l\.c|co|corp|corporation|company|gmbh|ag|sa|s\.a|bv|b\.v|"
+    r"plc|pte|pty|oy|ab|as|kg|spa|s\.p\.a|srl|technologies|technology|electronics|international|"
+    r"communications|systems|group|holdings|trading|foundation)\b\.?.*$",
+    re.IGNORECASE,
+)
+
+
+def short_name(org):
+    lower = org.lower()
+    for prefix, alias in ALIASES.items():
+        if lower.startswith(prefix):
+            return alias
+    name = org.strip().strip('"')
+    # Drop legal suffixes repeatedly ("Foo Technologies Co., Ltd." -> "Foo")
+    while True:
+        shorter = SUFFIXES.sub("", name).strip(" ,.")
+        if shorter == name or not shorter:
+            break
+        name = shorter
+    if len(name) > NAME_MAX:
+        name = name.split()[0]
+    return name[:NAME_MAX]
+
+
+def read_registry(path):
+    entries = []
+    with open(path, newline="", encoding="utf-8", errors="replace") as f:
+        for row in csv.DictReader(f):
+            bits = REGISTRIES.get(row.get("Registry", "").strip())
+            assignment = row.get("Assignment", "").strip()
+            org = row.get("Organization Name", "").strip()
+            if bits is None or not assignment or not org or org.upper() == "PRIVATE":
+                continue
+            if len(assignment) * 4 != bits:
+                continue
+            entries.append((bits, int(assignment, 16), short_name(org)))
+    return entries
+
+
+def inputs():
+    found = [os.path.join(OUI_DIR, n) for n in ("oui.csv", "mam.csv", "oui36.csv")
+             if os.path.exists(os.path.join(OUI_DIR, n))]
+    return found or [SEED]
+
+
+def padded(keys):
+    # Power-of-two length so the lookup can halve without a bounds check
+    n = 1
+    while n < len(keys) + 1:
+        n <<= 1
+    return keys + [None] * (n - len(keys))
+
+
+def emit(entries, sources):
+    names = sorted({name for _, _, name in entries})
+    pool = ""
+    offsets = {}
+    for name in names:
+        offsets[name] = len(pool)
+        pool += name + "\0"
+
+    out = []
+    out.append("// Generated by tools/gen_oui.py from: %s. Do not edit." %
+               ", ".join(os.path.relpath(s, ROOT) for s in sources))
+    out.append("// Keys are sorted and padded with all-ones keys to a power of two; each value")
+    out.append("// is an offset into OUI_NAMES.")
+    out.append("")
+    out.append("#ifndef OUI_TABLE_H")
+    out.append("#define OUI_TABLE_H")
+    out.append("")
+    out.append("#include <stdint.h>")
+    out.append("")
+    out.append("static constexpr char OUI_NAMES[] =")
+    for name in names:
+        out.append('    "%s\\0"' % name.replace("\\", "\\\\").replace('"', '\\"'))
+    out.append("    ;")
+    out.append("")
+
+    for label, bits in (("MAL", 24), ("MAM", 28), ("MAS", 36)):
+        table = sorted({key: name for b, key, name in entries if b == bits}.items())
+        rows = padded(table)
+        ctype = "uint32_t" if bits <= 32 else "uint64_t"
+        fill = "0xFFFFFFFFu" if bits <= 32 else "0xFFFFFFFFFFFFFFFFull"
+        width = (bits + 3) // 4
+        out.append("static constexpr unsigned OUI_%s_COUNT = %d;      // Real entries" % (label, len(table)))
+        out.append("static constexpr unsigned OUI_%s_SIZE = %d;       // Padded length" % (label, len(rows)))
+        out.append("static constexpr %s OUI_%s_KEYS[OUI_%s_SIZE] = {" % (ctype, label, label))
+        keys = [("0x%0*X" % (width, r[0])) if r else fill for r in rows]
+        for i in range(0, len(keys), 6):
+            out.append("    " + ", ".join(keys[i:i + 6]) + ",")
+        out.append("};")
+        out.append("static constexpr uint16_t OUI_%s_NAMES[OUI_%s_SIZE] = {" % (label, label))
+        vals = [str(offsets[r[1]]) if r else "0" for r in rows]
+        for i in range(0, len(vals), 12):
+            out.append("    " + ", ".join(vals[i:i + 12]) + ",")
+        out.append("};")
+        out.append("")
+
+    out.append("#endif // OUI_TABLE_H")
+    if len(pool) > 0xFFFF:
+        sys.exit("gen_oui: name pool exceeds 64 KB")
+    return "\n".join(out) + "\n"
+
+
+def generate(force=False):
+    sources = inputs()
+    if not force and os.path.exists(OUTPUT):
+        newest = max(os.path.getmtime(s) for s in sources + [SCRIPT])
+        if os.path.getmtime(OUTPUT) >= newest:
+            return
+    entries = []
+    for src in sources:
+        entries.extend(read_registry(src))
+    with open(OUTPUT, "w", newline="\n") as f:
+        f.write(emit(entries, sources))
+    print("gen_oui: %d prefixes from %s -> %s" % (len(entries), ", ".join(os.path.basename(s) for s in sources),
+                                                  os.path.relpath(OUTPUT, ROOT)))
+
+
+if __name__ == "__main__":
+    generate(force=True)
+else:
+    generate()